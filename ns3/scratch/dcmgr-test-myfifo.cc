@@ -2,9 +2,13 @@
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/traffic-control-module.h"
+#include "ns3/dcn-module.h"
 
+#include <cstdio>
+#include <cstdlib>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -52,6 +56,31 @@ uint32_t fabric_queue_size, edge_queue_size;
 double fabric_threshold, edge_threshold;
 uint32_t queue_type; //0: pfifo_first, 1: my_fifo
 
+// in-band telemetry, disabled when int_file is empty
+std::string int_file;
+Ptr<OutputStreamWrapper> int_stream;
+std::vector<Ptr<IntCollector> > int_collectors;
+
+// checkpoint after the warm-up, disabled when checkpoint_time is zero
+Time checkpoint_time;
+std::string restore_models; // models run from the checkpoint, comma separated
+uint32_t restore_jobs;      // copies of the checkpoint run at once
+std::string path_out;
+
+// background flows simulated as fluid flows, disabled unless hybrid
+bool hybrid;
+uint64_t fluid_min_size;
+Ptr<dcn::FluidFlowModel> fluid_model;
+struct FluidFlowRecord
+{
+  uint64_t size;
+  Time deadline;
+  uint32_t src;
+  uint32_t dst;
+};
+std::map<uint32_t, FluidFlowRecord> fluid_flows;
+bool print_events; // print the number of events scheduled by the run
+
 // The times
 Time global_start_time;
 Time global_stop_time;
@@ -76,11 +105,55 @@ Ipv4InterfaceContainer dst_interfaces;
 void
 SocketCreateTrace (uint64_t flowSize, Time deadline, Ptr<Socket> socket)
 {
-  socket->SetAttribute ("TotalBytes", UintegerValue (flowSize));
-  socket->SetAttribute ("Deadline", TimeValue (deadline));
+  // every flow of a run uses the same socket type, the attributes are
+  // resolved again only if the type changes
+  static TypeId socketTid;
+  static AttributeHandle<UintegerValue> totalBytes;
+  static AttributeHandle<TimeValue> socketDeadline;
+  TypeId tid = socket->GetInstanceTypeId ();
+  if (tid != socketTid)
+    {
+      socketTid = tid;
+      totalBytes = tid.LookupAttributeHandle<UintegerValue> ("TotalBytes");
+      socketDeadline = tid.LookupAttributeHandle<TimeValue> ("Deadline");
+    }
+  totalBytes.Set (socket, UintegerValue (flowSize));
+  socketDeadline.Set (socket, TimeValue (deadline));
   //socket->SetAttribute ("InitialCwnd", UintegerValue(2)); //set initial Cwnd to 2;
 }
 
+void
+FluidCompletionTrace (uint32_t flowId, Time start, Time fct)
+{
+  std::map<uint32_t, FluidFlowRecord>::iterator it = fluid_flows.find (flowId);
+  NS_ASSERT (it != fluid_flows.end ());
+  // the record MySendApp logs for the packet-level flows
+  std::clog << flowId << "," <<
+    fct.GetNanoSeconds () << "," <<
+    start.GetNanoSeconds () << "," <<
+    (start + fct).GetNanoSeconds () << "," <<
+    it->second.size << "," <<
+    it->second.deadline.GetNanoSeconds () << "," <<
+    it->second.src << "," <<
+    it->second.dst << std::endl;
+  fluid_flows.erase (it);
+}
+
+void
+NoEvent (void)
+{
+}
+
+void
+PrintEvents (void)
+{
+  if (print_events)
+    {
+      // the uid of a new event counts the events scheduled before it
+      std::cout << "events scheduled: " << Simulator::Schedule (Seconds (0), &NoEvent).GetUid () << std::endl;
+    }
+}
+
 void 
 SocketCloseTrace (uint32_t source_node, Ptr<Socket> socket)
 {
@@ -157,24 +230,6 @@ void printlink(Ptr<Node> n1, Ptr<Node> n2)
 void createTopology(void)
 {
   NS_LOG_DEBUG("Creating "<<num_spines<<" spines "<<num_leafs<<" leaves "<<num_hosts_per_leaf<<" hosts  per leaf ");
-  hosts.Create(num_hosts_per_leaf*num_leafs);
-  leafnodes.Create(num_leafs);
-  spines.Create(num_spines);
-  
-  ports = new uint16_t [hosts.GetN()];
-  queue_map = new uint32_t [hosts.GetN()];
-
-  for (uint32_t i=0; i <hosts.GetN(); i++) 
-    {
-      ports[i] = 0;
-      queue_map[i] = 0;
-
-    }
-
-  allnodes = NodeContainer (hosts,  leafnodes, spines);
-  InternetStackHelper internet;
-  internet.Install (allnodes);
-
   // We create the channels first without any IP addressing information
   // Queue, Channel and link characteristics
   NS_LOG_INFO ("Create channels.");
@@ -188,7 +243,8 @@ void createTopology(void)
                                 "LinkDelay", TimeValue(Time(fabric_delay)),
                                 "MinTh", DoubleValue(fabric_threshold),
                                 "MaxTh", DoubleValue(fabric_threshold),
-                                "QueueLimit", UintegerValue(fabric_queue_size)
+                                "QueueLimit", UintegerValue(fabric_queue_size),
+                                "InbandTelemetry", BooleanValue (!int_file.empty ())
                                 );
 
   PointToPointHelper edge_link;
@@ -203,78 +259,60 @@ void createTopology(void)
                                 "LinkDelay", TimeValue(Time(edge_delay)),
                                 "MinTh", DoubleValue(edge_threshold),
                                 "MaxTh", DoubleValue(edge_threshold),
-                                "QueueLimit", UintegerValue(edge_queue_size)
+                                "QueueLimit", UintegerValue(edge_queue_size),
+                                "InbandTelemetry", BooleanValue (!int_file.empty ())
                                 );
   TrafficControlHelper host_fifo;
   host_fifo.SetRootQueueDisc ("ns3::MyFifoQueueDisc");
 
-  Ipv4AddressHelper ipv4AddrHelper;
-  ipv4AddrHelper.SetBase ("10.1.0.0", "255.255.255.0");
-  // Create links between all sourcenodes and bottleneck switch
-  //
-  std::vector<NetDeviceContainer> fabric_devs;
-  std::vector<NetDeviceContainer> edge_devs;
+  PointToPointClosHelper clos (num_spines, num_leafs, num_hosts_per_leaf, edge_link, fabric_link);
+  hosts = clos.GetHosts ();
+  leafnodes = clos.GetLeaves ();
+  spines = clos.GetSpines ();
+  allnodes = NodeContainer (hosts, clos.GetSwitches ());
+
+  ports = new uint16_t [hosts.GetN()];
+  queue_map = new uint32_t [hosts.GetN()];
 
-  NS_LOG_DEBUG("Creating edge links..");
-  for(uint32_t lidx = 0; lidx < leafnodes.GetN(); lidx++) 
+  for (uint32_t i=0; i <hosts.GetN(); i++) 
     {
-      uint32_t start_index = lidx * num_hosts_per_leaf;
-      for(uint32_t hidx = start_index; hidx < start_index + num_hosts_per_leaf; hidx++) 
-        {
-          NetDeviceContainer net_dev = edge_link.Install(leafnodes.Get(lidx), hosts.Get(hidx));
-          edge_devs.push_back(net_dev);
-          //edge_red.Install(net_dev);
-          for(uint32_t i = 0; i < net_dev.GetN(); i++)
-            {
-              if (net_dev.Get(i)->GetNode() == leafnodes.Get(lidx))
-                {
-                  edge_red.Install (net_dev.Get(i));
-                }
-              if (net_dev.Get(i)->GetNode() == hosts.Get(hidx))
-                {
-                  host_fifo.Install (net_dev.Get(i));
-                }
-            }
+      ports[i] = 0;
+      queue_map[i] = 0;
 
-          ipv4AddrHelper.Assign(net_dev);
-          ipv4AddrHelper.NewNetwork ();
-          // debug information
-          //printlink(leafnodes.Get(lidx), hosts.Get(hidx));
-        }
     }
 
-  NS_LOG_DEBUG("Creating fabric links..");
-  for(uint32_t sidx = 0; sidx < spines.GetN(); sidx++) 
+  InternetStackHelper internet;
+  clos.InstallStack (internet);
+  clos.InstallQueueDiscs (host_fifo, edge_red, fabric_red);
+  // one /30 per host link out of 10.0.0.0, aggregated per leaf.  This
+  // replaces the former /24 per link out of 10.1.0.0 (and the fabric links
+  // are created leaf by leaf rather than spine by spine): ECMP_HASH hashes
+  // the addresses, so the paths and the FCTs differ from earlier runs
+  clos.AssignIpv4Addresses (Ipv4Address ("10.0.0.0"), Ipv4Address ("10.128.0.0"));
+
+  if (!int_file.empty ())
     {
-      for(uint32_t lidx = 0; lidx < leafnodes.GetN(); lidx++) 
+      int_stream = Create<OutputStreamWrapper> (int_file, std::ios::out | std::ios::binary);
+      for (uint32_t i = 0; i < hosts.GetN (); i++)
         {
-          NetDeviceContainer net_dev = fabric_link.Install(spines.Get(sidx), leafnodes.Get(lidx));
-          fabric_devs.push_back(net_dev);
-          fabric_red.Install (net_dev);
-          ipv4AddrHelper.Assign(net_dev);
-          ipv4AddrHelper.NewNetwork ();
-          // debug information
-          //printlink(spines.Get(sidx), leafnodes.Get(lidx));
+          Ptr<IntCollector> collector = CreateObject<IntCollector> ();
+          collector->SetStream (int_stream);
+          collector->Install (hosts.Get (i));
+          int_collectors.push_back (collector);
         }
     }
 
-  // Ptr<NetDevice> device;
-  // for(auto x : edge_devs)
-  //   {
-  //     for(uint32_t i = 0; i < x.GetN(); i++)
-  //         {
-  //           if (x.Get(i)->GetNode() == hosts.Get(208))
-  //             {
-  //               device = x.Get(i);
-  //               break;
-  //             }
-  //         }
-  //   }
-  // edge_link.EnablePcap ("mytest_edge", device);
-
   //fabric_link.EnablePcapAll ("mytest_fabric");
-  //Turn on global static routing
-  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  // aggregated ECMP routes instead of the global route manager
+  clos.PopulateRoutingTables ();
+
+  if (hybrid)
+    {
+      fluid_model = CreateObject<dcn::FluidFlowModel> ();
+      fluid_model->SetAttribute ("MinSize", UintegerValue (fluid_min_size));
+      fluid_model->Install (allnodes);
+      fluid_model->TraceConnectWithoutContext ("Completion", MakeCallback (&FluidCompletionTrace));
+    }
   // Ptr<OutputStreamWrapper> x = Create<OutputStreamWrapper> (&std::cout);
   // Ipv4GlobalRoutingHelper::PrintRoutingTableAllAt (Simulator::Now(),x);
 }
@@ -389,14 +427,42 @@ void startFlow(uint32_t flow_id)
   Time deadline = Time(0);
   if (flow_id%5 == 0)
     deadline = getDeadline(flow_size);   
+
+  // the flows with a deadline are class 1, and stay packets by default
+  if (fluid_model != 0 && fluid_model->IsFluid (flow_size, deadline.IsZero () ? 0 : 1)
+      && fluid_model->AddFlow (hosts.Get (source_node), hosts.Get (sink_node), flow_size, flow_id))
+    {
+      // no socket will release the queue
+      queue_map[source_node] &= ~(0x1 << (queue_index-1));
+      FluidFlowRecord record = { flow_size, deadline,
+                                 hosts.Get (source_node)->GetId (), hosts.Get (sink_node)->GetId () };
+      fluid_flows[flow_id] = record;
+      return;
+    }
   uint16_t port = ++ports[sink_node];
   NS_LOG_INFO ("flow id: " << flow_id << " src: " << source_node << " dst: " << sink_node << "flow_start_time:" << Simulator::Now().GetNanoSeconds() << "ms." << " flow size: " << flow_size << " deadline: " << deadline.GetSeconds() << "s");
  
   //sink app set up
+  // attributes set for every flow are resolved once
+  static TypeId sinkTid = MySinkApp::GetTypeId ();
+  static AttributeHandle<TypeIdValue> sinkProtocol = sinkTid.LookupAttributeHandle<TypeIdValue> ("Protocol");
+  static AttributeHandle<AddressValue> sinkLocal = sinkTid.LookupAttributeHandle<AddressValue> ("Local");
+  static AttributeHandle<UintegerValue> sinkFlowSize = sinkTid.LookupAttributeHandle<UintegerValue> ("FlowSize");
+  static AttributeHandle<UintegerValue> sinkFlowId = sinkTid.LookupAttributeHandle<UintegerValue> ("FlowId");
+  static TypeId sendTid = MySendApp::GetTypeId ();
+  static AttributeHandle<AddressValue> sendRemote = sendTid.LookupAttributeHandle<AddressValue> ("Remote");
+  static AttributeHandle<UintegerValue> sendFlowSize = sendTid.LookupAttributeHandle<UintegerValue> ("FlowSize");
+  static AttributeHandle<PointerValue> sendSrcNode = sendTid.LookupAttributeHandle<PointerValue> ("SrcNode");
+  static AttributeHandle<PointerValue> sendSinkNode = sendTid.LookupAttributeHandle<PointerValue> ("SinkNode");
+  static AttributeHandle<UintegerValue> sendFlowId = sendTid.LookupAttributeHandle<UintegerValue> ("FlowId");
+  static AttributeHandle<TimeValue> sendDeadline = sendTid.LookupAttributeHandle<TimeValue> ("Deadline");
+  static AttributeHandle<UintegerValue> sendQueueIndex = sendTid.LookupAttributeHandle<UintegerValue> ("QueueIndex");
+
   Ptr<MySinkApp> SinkingApp = CreateObject<MySinkApp> ();
-  SinkingApp->SetAttribute("Protocol",  TypeIdValue (TcpSocketFactory::GetTypeId ()));
-  SinkingApp->SetAttribute("Local", AddressValue(InetSocketAddress(Ipv4Address::GetAny (), port)));
-  SinkingApp->SetAttribute("FlowSize", UintegerValue (flow_size));
+  sinkProtocol.Set (SinkingApp, TypeIdValue (TcpSocketFactory::GetTypeId ()));
+  sinkLocal.Set (SinkingApp, AddressValue(InetSocketAddress(Ipv4Address::GetAny (), port)));
+  sinkFlowSize.Set (SinkingApp, UintegerValue (flow_size));
+  sinkFlowId.Set (SinkingApp, UintegerValue (flow_id));
   
   SinkingApp->SetStartTime (Time(0));
   SinkingApp->SetStopTime (global_stop_time); 
@@ -420,13 +486,13 @@ void startFlow(uint32_t flow_id)
   Ptr<Ipv4L3Protocol> sink_node_ipv4 = StaticCast<Ipv4L3Protocol> (hosts.Get(sink_node)->GetObject<Ipv4> ());
   Ipv4Address remoteIp = sink_node_ipv4->GetAddress (1,0).GetLocal(); //?
   Ptr<MySendApp> SendingApp = CreateObject<MySendApp> ();
-  SendingApp->SetAttribute("Remote", AddressValue(InetSocketAddress(remoteIp, port)));
-  SendingApp->SetAttribute("FlowSize", UintegerValue (flow_size));
-  SendingApp->SetAttribute("SrcNode", PointerValue (hosts.Get(source_node)));
-  SendingApp->SetAttribute("SinkNode", PointerValue (hosts.Get(sink_node)));
-  SendingApp->SetAttribute("FlowId", UintegerValue (flow_id));
-  SendingApp->SetAttribute("Deadline", TimeValue(deadline));
-  SendingApp->SetAttribute("QueueIndex", UintegerValue(queue_index));
+  sendRemote.Set (SendingApp, AddressValue(InetSocketAddress(remoteIp, port)));
+  sendFlowSize.Set (SendingApp, UintegerValue (flow_size));
+  sendSrcNode.Set (SendingApp, PointerValue (hosts.Get(source_node)));
+  sendSinkNode.Set (SendingApp, PointerValue (hosts.Get(sink_node)));
+  sendFlowId.Set (SendingApp, UintegerValue (flow_id));
+  sendDeadline.Set (SendingApp, TimeValue(deadline));
+  sendQueueIndex.Set (SendingApp, UintegerValue(queue_index));
   SendingApp->SetStartTime(Time(0));
   SendingApp->SetStopTime(global_stop_time);   // need reviewing
   hosts.Get(source_node)->AddApplication(SendingApp);
@@ -502,6 +568,8 @@ void setUpTraffic()
     }
 }
 
+void SetupTransport (void);
+
 void
 SetupConfig (void)
 {
@@ -546,7 +614,12 @@ SetupConfig (void)
   //config ecmp
   Config::SetDefault ("ns3::Ipv4GlobalRouting::EcmpMode", EnumValue(ECMP_HASH));  
 
-  
+  SetupTransport ();
+}
+
+void
+SetupTransport (void)
+{
   if (use_model == DCTCP_MODEL)
     {
       Config::SetDefault ("ns3::DctcpSocket::DctcpWeight", DoubleValue (m_g));
@@ -575,10 +648,117 @@ SetupConfig (void)
 
 }
 
+// switch a copy of the checkpoint to another model: the flows started
+// from now on use it, those of the warm-up go on with theirs; the
+// marking thresholds of the warm-up are kept, except for MGR
+void
+RestoreModel (uint32_t model)
+{
+  use_model = model;
+  Config::SetDefault ("ns3::TcpSocketBase::UseEcn", BooleanValue (true));
+  SetupTransport ();
+  // the TcpL4Protocol of the nodes exist already
+  struct TypeId::AttributeInformation socketType;
+  TcpL4Protocol::GetTypeId ().LookupAttributeByName ("SocketBaseType", &socketType);
+  Config::Set ("/NodeList/*/$ns3::TcpL4Protocol/SocketBaseType", *socketType.initialValue);
+  if (use_model == MGR_MODEL)
+    {
+      // marking thresholds at the queue limits
+      for (uint32_t i = 0; i < allnodes.GetN (); i++)
+        {
+          Ptr<Node> node = allnodes.Get (i);
+          Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer> ();
+          for (uint32_t j = 0; j < node->GetNDevices (); j++)
+            {
+              Ptr<RedQueueDisc> red = DynamicCast<RedQueueDisc> (tc->GetRootQueueDiscOnDevice (node->GetDevice (j)));
+              if (red != 0)
+                {
+                  UintegerValue limit;
+                  red->GetAttribute ("QueueLimit", limit);
+                  red->SetAttribute ("MinTh", DoubleValue (limit.Get ()));
+                  red->SetAttribute ("MaxTh", DoubleValue (limit.Get ()));
+                }
+            }
+        }
+    }
+
+  // each copy writes its own results
+  std::ostringstream name;
+  name << path_out << "/restore_model" << model;
+  if (std::freopen ((name.str () + ".out").c_str (), "w", stdout) == 0
+      || std::freopen ((name.str () + ".out").c_str (), "a", stderr) == 0)
+    {
+      std::exit (1);
+    }
+  if (!int_file.empty ())
+    {
+      std::ostringstream intName;
+      intName << int_file << ".model" << model;
+      int_stream = Create<OutputStreamWrapper> (intName.str (), std::ios::out | std::ios::binary);
+      for (uint32_t i = 0; i < int_collectors.size (); i++)
+        {
+          int_collectors[i]->SetStream (int_stream);
+        }
+    }
+  std::cout << "restored at " << Simulator::Now ().GetSeconds () << "s with model " << model << std::endl;
+  std::cout << "flow id,fct,start time,stop time,flow size,deadline,src,dst" << std::endl;
+  // deadline.py reads the records after this line
+  std::cout << "simulation start" << std::endl;
+}
+
+// run the warm-up once, then every model of restore_models from its end
+int
+RunFromCheckpoint (void)
+{
+  std::vector<uint32_t> models;
+  std::istringstream iss (restore_models);
+  std::string model;
+  while (std::getline (iss, model, ','))
+    {
+      models.push_back (std::atoi (model.c_str ()));
+    }
+  if (models.empty ())
+    {
+      models.push_back (use_model);
+    }
+
+  std::cout << "warm-up until " << checkpoint_time.GetSeconds () << "s" << std::endl;
+  Simulator::Stop (checkpoint_time);
+  Simulator::Run ();
+  // the copies would write the records still buffered again when they
+  // reopen the telemetry file; no pcap or aggregator thread is open here
+  if (int_stream)
+    {
+      int_stream->GetStream ()->flush ();
+    }
+  uint32_t copy = SimulatorCheckpoint::Fork (models.size (), restore_jobs);
+  if (copy == models.size ())
+    {
+      for (uint32_t i = 0; i < models.size (); i++)
+        {
+          std::cout << "model " << models[i] << " exited with status " << SimulatorCheckpoint::GetExitStatus (i) << std::endl;
+        }
+      Simulator::Destroy ();
+      return SimulatorCheckpoint::GetNFailed ();
+    }
+
+  RestoreModel (models[copy]);
+  Simulator::Stop (global_stop_time - checkpoint_time);
+  Simulator::Run ();
+  PrintEvents ();
+  Simulator::Destroy ();
+  return 0;
+}
+
 
 CommandLine addCmdOptions(void)
 {
-  std::string pathOut ("."); // Current directory
+  path_out = "."; // Current directory
+  checkpoint_time = Seconds (0);
+  restore_jobs = 1;
+  hybrid = false;
+  fluid_min_size = 1000000;
+  print_events = false;
 
   global_start_time = Seconds (0);
   flow_stop_time = Seconds (1);
@@ -624,6 +804,7 @@ CommandLine addCmdOptions(void)
   cmd.AddValue ("flowStopTime", "flow stop time, unit (s)", flow_stop_time);
 
   cmd.AddValue ("queueType", "the type of host queue, 0: pfifo; 1: myfifo", queue_type);
+  cmd.AddValue ("intFile", "binary file for per-flow in-band telemetry, disabled if empty", int_file);
 
   // RED params
   cmd.AddValue ("fabricThreshold", "the packet thread in the queue", fabric_threshold);
@@ -634,7 +815,7 @@ CommandLine addCmdOptions(void)
   //dcmgr or dctcp or d2tcp
   cmd.AddValue ("m_g", "the weight of dcmgr of dctcp", m_g);
 
-  cmd.AddValue ("pathOut", "Path to save results from --writeForPlot/--writePcap/--writeFlowMonitor", pathOut);
+  cmd.AddValue ("pathOut", "Path to save results from --writeForPlot/--writePcap/--writeFlowMonitor", path_out);
   cmd.AddValue ("rcos", "increase rate when rwnd < wmin", rcos);
 
   //deadline
@@ -642,6 +823,16 @@ CommandLine addCmdOptions(void)
   cmd.AddValue ("BigOffset", "the deadline offset of big flow (s)", big_offset);
   cmd.AddValue ("MediumSpeed", "the required speed of medium flow (Gbps)", medium_speed);
   cmd.AddValue ("BigSpeed", "the required speed of medium flow (Gbps)", big_speed);
+
+  //checkpoint
+  cmd.AddValue ("checkpointTime", "warm-up run once before the restored models, disabled if 0 (s)", checkpoint_time);
+  cmd.AddValue ("restoreModels", "models run from the checkpoint, comma separated, each writing pathOut/restore_model<m>.out", restore_models);
+  cmd.AddValue ("restoreJobs", "copies of the checkpoint run at once, 0 for all", restore_jobs);
+
+  //hybrid
+  cmd.AddValue ("hybrid", "simulate the large flows without a deadline as fluid flows", hybrid);
+  cmd.AddValue ("fluidMinSize", "the smallest fluid flow (bytes)", fluid_min_size);
+  cmd.AddValue ("printEvents", "print the number of events scheduled when the run ends", print_events);
   return cmd;
 }
 
@@ -686,9 +877,15 @@ int main (int argc, char *argv[])
   setUpTraffic();
 
 
+  if (!checkpoint_time.IsZero ())
+    {
+      return RunFromCheckpoint ();
+    }
+
   std::cout << "simulation start" << std::endl;
   Simulator::Stop (global_stop_time);
   Simulator::Run ();
+  PrintEvents ();
 
 
 
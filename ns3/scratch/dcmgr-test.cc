@@ -2,6 +2,7 @@
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/traffic-control-module.h"
 
@@ -27,6 +28,7 @@ uint16_t *ports;
 uint32_t traffic_type;  //0: Web search; 1: data mining
 uint32_t load;
 uint32_t seed;
+std::string flow_trace; //replayed instead of the generated traffic if set
 
 // attributes
 std::string fabric_datarate, edge_datarate;
@@ -67,8 +69,20 @@ Ipv4InterfaceContainer dst_interfaces;
 void
 SocketCreateTrace (uint64_t flowSize, Time deadline, Ptr<Socket> socket)
 {
-  socket->SetAttribute ("TotalBytes", UintegerValue (flowSize));
-  socket->SetAttribute ("Deadline", TimeValue (deadline));
+  // every flow of a run uses the same socket type, the attributes are
+  // resolved again only if the type changes
+  static TypeId socketTid;
+  static AttributeHandle<UintegerValue> totalBytes;
+  static AttributeHandle<TimeValue> socketDeadline;
+  TypeId tid = socket->GetInstanceTypeId ();
+  if (tid != socketTid)
+    {
+      socketTid = tid;
+      totalBytes = tid.LookupAttributeHandle<UintegerValue> ("TotalBytes");
+      socketDeadline = tid.LookupAttributeHandle<TimeValue> ("Deadline");
+    }
+  totalBytes.Set (socket, UintegerValue (flowSize));
+  socketDeadline.Set (socket, TimeValue (deadline));
   //socket->SetAttribute ("InitialCwnd", UintegerValue(2)); //set initial Cwnd to 2;
 }
 
@@ -139,21 +153,6 @@ void printlink(Ptr<Node> n1, Ptr<Node> n2)
 void createTopology(void)
 {
   NS_LOG_DEBUG("Creating "<<num_spines<<" spines "<<num_leafs<<" leaves "<<num_hosts_per_leaf<<" hosts  per leaf ");
-  hosts.Create(num_hosts_per_leaf*num_leafs);
-  leafnodes.Create(num_leafs);
-  spines.Create(num_spines);
-  
-  ports = new uint16_t [hosts.GetN()];
-   
-  for (uint32_t i=0; i <hosts.GetN(); i++) 
-    {
-      ports[i] = 1;
-    }
-
-  allnodes = NodeContainer (hosts,  leafnodes, spines);
-  InternetStackHelper internet;
-  internet.Install (allnodes);
-
   // We create the channels first without any IP addressing information
   // Queue, Channel and link characteristics
   NS_LOG_INFO ("Create channels.");
@@ -184,70 +183,33 @@ void createTopology(void)
                                 "MaxTh", DoubleValue(edge_threshold),
                                 "QueueLimit", UintegerValue(edge_queue_size)
                                 );
+  TrafficControlHelper host_default = TrafficControlHelper::Default ();
 
-  Ipv4AddressHelper ipv4AddrHelper;
-  ipv4AddrHelper.SetBase ("10.1.0.0", "255.255.255.0");
-  // Create links between all sourcenodes and bottleneck switch
-  //
-  std::vector<NetDeviceContainer> fabric_devs;
-  std::vector<NetDeviceContainer> edge_devs;
-
-  NS_LOG_DEBUG("Creating edge links..");
-  for(uint32_t lidx = 0; lidx < leafnodes.GetN(); lidx++) 
-    {
-      uint32_t start_index = lidx * num_hosts_per_leaf;
-      for(uint32_t hidx = start_index; hidx < start_index + num_hosts_per_leaf; hidx++) 
-        {
-          NetDeviceContainer net_dev = edge_link.Install(leafnodes.Get(lidx), hosts.Get(hidx));
-          edge_devs.push_back(net_dev);
-          //edge_red.Install(net_dev);
-          for(uint32_t i = 0; i < net_dev.GetN(); i++)
-            {
-              if (net_dev.Get(i)->GetNode() == leafnodes.Get(lidx))
-                {
-                  edge_red.Install (net_dev.Get(i));
-                }
-            }
-
-          ipv4AddrHelper.Assign(net_dev);
-          ipv4AddrHelper.NewNetwork ();
-          // debug information
-          //printlink(leafnodes.Get(lidx), hosts.Get(hidx));
-        }
-    }
+  PointToPointClosHelper clos (num_spines, num_leafs, num_hosts_per_leaf, edge_link, fabric_link);
+  hosts = clos.GetHosts ();
+  leafnodes = clos.GetLeaves ();
+  spines = clos.GetSpines ();
+  allnodes = NodeContainer (hosts, clos.GetSwitches ());
 
-  NS_LOG_DEBUG("Creating fabric links..");
-  for(uint32_t sidx = 0; sidx < spines.GetN(); sidx++) 
+  ports = new uint16_t [hosts.GetN()];
+   
+  for (uint32_t i=0; i <hosts.GetN(); i++) 
     {
-      for(uint32_t lidx = 0; lidx < leafnodes.GetN(); lidx++) 
-        {
-          NetDeviceContainer net_dev = fabric_link.Install(spines.Get(sidx), leafnodes.Get(lidx));
-          fabric_devs.push_back(net_dev);
-          fabric_red.Install (net_dev);
-          ipv4AddrHelper.Assign(net_dev);
-          ipv4AddrHelper.NewNetwork ();
-          // debug information
-          //printlink(spines.Get(sidx), leafnodes.Get(lidx));
-        }
+      ports[i] = 1;
     }
 
-  // Ptr<NetDevice> device;
-  // for(auto x : edge_devs)
-  //   {
-  //     for(uint32_t i = 0; i < x.GetN(); i++)
-  //         {
-  //           if (x.Get(i)->GetNode() == hosts.Get(208))
-  //             {
-  //               device = x.Get(i);
-  //               break;
-  //             }
-  //         }
-  //   }
-  // edge_link.EnablePcap ("mytest_edge", device);
+  InternetStackHelper internet;
+  clos.InstallStack (internet);
+  clos.InstallQueueDiscs (host_default, edge_red, fabric_red);
+  // one /30 per host link out of 10.0.0.0, aggregated per leaf.  This
+  // replaces the former /24 per link out of 10.1.0.0 (and the fabric links
+  // are created leaf by leaf rather than spine by spine): ECMP_HASH hashes
+  // the addresses, so the paths and the FCTs differ from earlier runs
+  clos.AssignIpv4Addresses (Ipv4Address ("10.0.0.0"), Ipv4Address ("10.128.0.0"));
 
   //fabric_link.EnablePcapAll ("mytest_fabric");
-  //Turn on global static routing
-  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  // aggregated ECMP routes instead of the global route manager
+  clos.PopulateRoutingTables ();
   // Ptr<OutputStreamWrapper> x = Create<OutputStreamWrapper> (&std::cout);
   // Ipv4GlobalRoutingHelper::PrintRoutingTableAllAt (Simulator::Now(),x);
 }
@@ -255,7 +217,7 @@ void createTopology(void)
 
 
 
-void startFlow(uint32_t sourceN, uint32_t sinkN, Time flow_start, uint32_t flow_size, uint32_t flow_id, Time deadline)
+void startFlow(uint32_t sourceN, uint32_t sinkN, Time flow_start, uint64_t flow_size, uint32_t flow_id, Time deadline)
 {
   uint16_t port = ++ports[sinkN];
   Ptr<Ipv4L3Protocol> sink_node_ipv4 = StaticCast<Ipv4L3Protocol> ((hosts.Get(sinkN))->GetObject<Ipv4> ());
@@ -318,7 +280,7 @@ void startFlow(uint32_t sourceN, uint32_t sinkN, Time flow_start, uint32_t flow_
   //NS_LOG_DEBUG("flow id: " << flow_id << " source node: " <<  sourceN << " sink node: " << sinkN << " start time: " << flow_start <<" deadline: " << deadline);
 }
 
-Time getDeadline(uint32_t flow_size)
+Time getDeadline(uint64_t flow_size)
 {
   double dead = 0;
   if (flow_size < 1000000)
@@ -462,6 +424,12 @@ void setUpTraffic()
     }
 }
 
+void replayFlow (const FlowTraceReplay::Flow &flow)
+{
+  // the applications are created as the flow starts
+  startFlow(flow.src, flow.dst, Seconds(0), flow.size, flow.id, flow.deadline);
+}
+
 void
 SetupConfig (void)
 {
@@ -571,6 +539,7 @@ CommandLine addCmdOptions(void)
   cmd.AddValue ("trafficType", "traffic type, 0: web search 1: data mining", traffic_type);
   cmd.AddValue ("seed", "Random seed", seed);
   cmd.AddValue ("flowStopTime", "flow stop time, unit (s)", flow_stop_time);
+  cmd.AddValue ("flowTrace", "flow trace to replay instead of the generated traffic", flow_trace);
 
   // RED params
   cmd.AddValue ("fabricThreshold", "the packet thread in the queue", fabric_threshold);
@@ -618,7 +587,23 @@ int main (int argc, char *argv[])
   createTopology();
   //SetupTopo (10, 1, link_data_rate, link_delay);
   
-  setUpTraffic();
+  Ptr<FlowTraceReplay> replay;
+  if (flow_trace.empty())
+    {
+      setUpTraffic();
+    }
+  else
+    {
+      replay = CreateObject<FlowTraceReplay> ();
+      replay->SetAttribute ("FileName", StringValue (flow_trace));
+      replay->SetHosts (hosts);
+      replay->SetStartFlowCallback (MakeCallback (&replayFlow));
+      if (!replay->Start ())
+        {
+          std::cout << "cannot open flow trace " << flow_trace << std::endl;
+          exit(1);
+        }
+    }
 
 
   std::cout << "simulation start" << std::endl;
@@ -0,0 +1,264 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Compare the Ipv4GlobalRouting ECMP modes on a leaf-spine fabric with
+// one degraded leaf-spine link: the same random set of TCP flows is
+// replayed for every mode, and the flow completion times and the
+// fraction of data segments delivered out of order are reported.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("EcmpLbBench");
+
+struct FlowSpec
+{
+  uint32_t src;
+  uint32_t dst;
+  uint32_t size;
+  Time start;
+};
+
+// per run results
+std::vector<Time> fct;           // 0 until the flow completes
+std::vector<uint32_t> rxBytes;
+uint64_t dataSegments;
+uint64_t reorderedSegments;
+std::map<std::string, uint32_t> highestSeq; // flow -> highest sequence received
+
+void
+SinkRx (uint32_t flow, uint32_t size, Time start, Ptr<const Packet> p, const Address &from)
+{
+  rxBytes[flow] += p->GetSize ();
+  if (rxBytes[flow] >= size && fct[flow].IsZero ())
+    {
+      fct[flow] = Simulator::Now () - start;
+    }
+}
+
+void
+LocalDeliver (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface)
+{
+  if (header.GetProtocol () != TcpL4Protocol::PROT_NUMBER)
+    {
+      return;
+    }
+  TcpHeader tcpHeader;
+  p->PeekHeader (tcpHeader);
+  if (p->GetSize () == tcpHeader.GetSerializedSize ())
+    {
+      return; // pure ACK
+    }
+  std::ostringstream key;
+  key << header.GetSource () << ":" << tcpHeader.GetSourcePort () << ">" << tcpHeader.GetDestinationPort ();
+  uint32_t seq = tcpHeader.GetSequenceNumber ().GetValue ();
+  dataSegments++;
+  std::map<std::string, uint32_t>::iterator it = highestSeq.find (key.str ());
+  if (it == highestSeq.end ())
+    {
+      highestSeq[key.str ()] = seq;
+    }
+  else if (seq < it->second)
+    {
+      reorderedSegments++;
+    }
+  else
+    {
+      it->second = seq;
+    }
+}
+
+void
+RunMode (std::string mode, const std::vector<FlowSpec> &flows,
+         uint32_t numSpines, uint32_t numLeafs, uint32_t hostsPerLeaf,
+         std::string edgeRate, std::string fabricRate, std::string degradedRate,
+         Time stopTime)
+{
+  Config::SetDefault ("ns3::Ipv4GlobalRouting::EcmpMode", StringValue (mode));
+
+  PointToPointHelper edgeLink;
+  edgeLink.SetDeviceAttribute ("DataRate", StringValue (edgeRate));
+  edgeLink.SetChannelAttribute ("Delay", StringValue ("10us"));
+  PointToPointHelper fabricLink;
+  fabricLink.SetDeviceAttribute ("DataRate", StringValue (fabricRate));
+  fabricLink.SetChannelAttribute ("Delay", StringValue ("30us"));
+
+  PointToPointClosHelper clos (numSpines, numLeafs, hostsPerLeaf, edgeLink, fabricLink);
+  // asymmetry: the link between leaf 0 and spine 0 is slower
+  clos.GetLeaf (0)->GetDevice (hostsPerLeaf)->SetAttribute ("DataRate", StringValue (degradedRate));
+  clos.GetSpine (0)->GetDevice (0)->SetAttribute ("DataRate", StringValue (degradedRate));
+
+  InternetStackHelper internet;
+  clos.InstallStack (internet);
+  TrafficControlHelper fifo;
+  fifo.SetRootQueueDisc ("ns3::PfifoFastQueueDisc", "Limit", UintegerValue (1000));
+  clos.InstallQueueDiscs (fifo, fifo, fifo);
+  clos.AssignIpv4Addresses (Ipv4Address ("10.0.0.0"), Ipv4Address ("10.128.0.0"));
+  clos.PopulateRoutingTables ();
+
+  fct.assign (flows.size (), Seconds (0));
+  rxBytes.assign (flows.size (), 0);
+  dataSegments = 0;
+  reorderedSegments = 0;
+  highestSeq.clear ();
+  for (uint32_t i = 0; i < clos.GetHosts ().GetN (); i++)
+    {
+      clos.GetHost (i)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("LocalDeliver", MakeCallback (&LocalDeliver));
+    }
+
+  for (uint32_t i = 0; i < flows.size (); i++)
+    {
+      uint16_t port = 10000 + i;
+      PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+      ApplicationContainer sink = sinkHelper.Install (clos.GetHost (flows[i].dst));
+      sink.Get (0)->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&SinkRx, i, flows[i].size, flows[i].start));
+
+      BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (clos.GetHostIpv4Address (flows[i].dst), port));
+      source.SetAttribute ("MaxBytes", UintegerValue (flows[i].size));
+      source.SetAttribute ("SendSize", UintegerValue (1460));
+      ApplicationContainer app = source.Install (clos.GetHost (flows[i].src));
+      app.Start (flows[i].start);
+    }
+
+  Simulator::Stop (stopTime);
+  Simulator::Run ();
+
+  std::vector<double> small, large;
+  for (uint32_t i = 0; i < flows.size (); i++)
+    {
+      if (fct[i].IsZero ())
+        {
+          continue;
+        }
+      (flows[i].size < 100000 ? small : large).push_back (fct[i].GetSeconds () * 1000);
+    }
+  std::sort (small.begin (), small.end ());
+  double smallMean = 0, largeMean = 0;
+  for (uint32_t i = 0; i < small.size (); i++)
+    {
+      smallMean += small[i] / small.size ();
+    }
+  for (uint32_t i = 0; i < large.size (); i++)
+    {
+      largeMean += large[i] / large.size ();
+    }
+  double smallP99 = small.empty () ? 0 : small[std::min<size_t> (small.size () - 1, small.size () * 99 / 100)];
+
+  std::ostringstream completed;
+  completed << small.size () + large.size () << "/" << flows.size ();
+  std::cout << std::setw (14) << std::left << mode
+            << std::setw (17) << completed.str ()
+            << std::setw (14) << std::fixed << std::setprecision (3) << smallMean
+            << std::setw (14) << smallP99
+            << std::setw (14) << largeMean
+            << std::setw (12) << std::setprecision (4)
+            << (dataSegments ? 100.0 * reorderedSegments / dataSegments : 0) << std::endl;
+
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t numSpines = 4;
+  uint32_t numLeafs = 4;
+  uint32_t hostsPerLeaf = 8;
+  uint32_t numFlows = 300;
+  double meanInterval = 20e-6;
+  std::string edgeRate = "10Gbps";
+  std::string fabricRate = "20Gbps";
+  std::string degradedRate = "5Gbps";
+  std::string modes = "ECMP_HASH,ECMP_RANDOM,ECMP_FLOWCELL,ECMP_FLOWLET";
+  Time flowletGap = MicroSeconds (100);
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("numSpines", "the number of spines", numSpines);
+  cmd.AddValue ("numLeafs", "the number of leaves", numLeafs);
+  cmd.AddValue ("hostsPerLeaf", "the number of hosts per leaf", hostsPerLeaf);
+  cmd.AddValue ("numFlows", "the number of flows", numFlows);
+  cmd.AddValue ("meanInterval", "mean flow inter-arrival time (s)", meanInterval);
+  cmd.AddValue ("edgeRate", "host link rate", edgeRate);
+  cmd.AddValue ("fabricRate", "leaf-spine link rate", fabricRate);
+  cmd.AddValue ("degradedRate", "rate of the link between leaf 0 and spine 0", degradedRate);
+  cmd.AddValue ("modes", "comma separated EcmpMode values to compare", modes);
+  cmd.AddValue ("flowletGap", "Ipv4GlobalRouting::FlowletGap", flowletGap);
+  cmd.AddValue ("seed", "Random seed", seed);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::Ipv4GlobalRouting::FlowletGap", TimeValue (flowletGap));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1460));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 20));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 20));
+  Config::SetDefault ("ns3::TcpSocketBase::MinRto", TimeValue (MilliSeconds (10)));
+  // keep the backlog in the queue discs, where ECMP_FLOWLET can see it
+  Config::SetDefault ("ns3::Queue::MaxPackets", UintegerValue (1));
+
+  RngSeedManager::SetSeed (10);
+  RngSeedManager::SetRun (seed);
+
+  // the same flows are replayed for every mode; most flows are short,
+  // a few large ones create the collisions
+  uint32_t numHosts = numLeafs * hostsPerLeaf;
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  Ptr<ExponentialRandomVariable> interval = CreateObject<ExponentialRandomVariable> ();
+  interval->SetAttribute ("Mean", DoubleValue (meanInterval));
+  std::vector<FlowSpec> flows;
+  Time start = MilliSeconds (1);
+  for (uint32_t i = 0; i < numFlows; i++)
+    {
+      FlowSpec flow;
+      flow.src = uniform->GetInteger (0, numHosts - 1);
+      do
+        {
+          flow.dst = uniform->GetInteger (0, numHosts - 1);
+        }
+      while (flow.dst / hostsPerLeaf == flow.src / hostsPerLeaf);
+      flow.size = uniform->GetValue () < 0.8 ? uniform->GetInteger (10000, 100000) : uniform->GetInteger (1000000, 3000000);
+      flow.start = start;
+      flows.push_back (flow);
+      start += Seconds (interval->GetValue ());
+    }
+
+  std::cout << std::setw (14) << std::left << "mode"
+            << std::setw (17) << "completed"
+            << std::setw (14) << "small ms"
+            << std::setw (14) << "small p99 ms"
+            << std::setw (14) << "large ms"
+            << std::setw (12) << "reordered %" << std::endl;
+  std::istringstream list (modes);
+  std::string mode;
+  while (std::getline (list, mode, ','))
+    {
+      RunMode (mode, flows, numSpines, numLeafs, hostsPerLeaf, edgeRate, fabricRate, degradedRate,
+               start + Seconds (1));
+    }
+  return 0;
+}
@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "incast-helper.h"
+#include "ns3/incast-aggregator.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4.h"
+#include "ns3/string.h"
+
+namespace ns3 {
+
+IncastHelper::IncastHelper (std::string protocol, uint16_t port)
+  : m_port (port)
+{
+  m_aggregatorFactory.SetTypeId ("ns3::IncastAggregator");
+  m_aggregatorFactory.Set ("Protocol", StringValue (protocol));
+  m_workerFactory.SetTypeId ("ns3::IncastWorker");
+  m_workerFactory.Set ("Protocol", StringValue (protocol));
+  m_workerFactory.Set ("Local", AddressValue (InetSocketAddress (Ipv4Address::GetAny (), port)));
+}
+
+void
+IncastHelper::SetAggregatorAttribute (std::string name, const AttributeValue &value)
+{
+  m_aggregatorFactory.Set (name, value);
+}
+
+void
+IncastHelper::SetWorkerAttribute (std::string name, const AttributeValue &value)
+{
+  m_workerFactory.Set (name, value);
+}
+
+ApplicationContainer
+IncastHelper::InstallWorkers (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Application> app = m_workerFactory.Create<Application> ();
+      (*i)->AddApplication (app);
+      apps.Add (app);
+    }
+  return apps;
+}
+
+ApplicationContainer
+IncastHelper::InstallAggregator (Ptr<Node> node, NodeContainer workers) const
+{
+  Ptr<IncastAggregator> app = m_aggregatorFactory.Create<IncastAggregator> ();
+  for (NodeContainer::Iterator i = workers.Begin (); i != workers.End (); ++i)
+    {
+      Ptr<Ipv4> ipv4 = (*i)->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4 && ipv4->GetNInterfaces () > 1, "Worker without IPv4 address");
+      InetSocketAddress address (ipv4->GetAddress (1, 0).GetLocal (), m_port);
+      app->AddWorker (address, (*i)->GetId ());
+    }
+  node->AddApplication (app);
+  return ApplicationContainer (app);
+}
+
+} // namespace ns3
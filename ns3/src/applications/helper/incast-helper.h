@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef INCAST_HELPER_H
+#define INCAST_HELPER_H
+
+#include <stdint.h>
+#include <string>
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+#include "ns3/node-container.h"
+#include "ns3/application-container.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup incast
+ * \brief A helper to make it easier to instantiate an IncastAggregator
+ * and its IncastWorker applications.
+ */
+class IncastHelper
+{
+public:
+  /**
+   * Create an IncastHelper to make it easier to work with incast
+   * applications
+   *
+   * \param protocol the name of the stream protocol to use, e.g.
+   *        ns3::TcpSocketFactory.
+   * \param port the port the workers listen on.
+   */
+  IncastHelper (std::string protocol, uint16_t port);
+
+  /**
+   * \param name the name of the IncastAggregator attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAggregatorAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * \param name the name of the IncastWorker attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetWorkerAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Install an IncastWorker on each node of the input container.
+   *
+   * \param c the nodes of the workers
+   * \returns Container of Ptr to the applications installed.
+   */
+  ApplicationContainer InstallWorkers (NodeContainer c) const;
+
+  /**
+   * Install an IncastAggregator querying the workers of the given nodes,
+   * at the first address of their first IPv4 interface after the
+   * loopback.
+   *
+   * \param node the node of the aggregator
+   * \param workers the nodes of the workers
+   * \returns Container of Ptr to the application installed.
+   */
+  ApplicationContainer InstallAggregator (Ptr<Node> node, NodeContainer workers) const;
+
+private:
+  ObjectFactory m_aggregatorFactory; //!< Object factory of the aggregators.
+  ObjectFactory m_workerFactory;     //!< Object factory of the workers.
+  uint16_t m_port;                   //!< Port of the workers.
+};
+
+} // namespace ns3
+
+#endif /* INCAST_HELPER_H */
@@ -0,0 +1,255 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "flow-trace-replay.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowTraceReplay");
+
+NS_OBJECT_ENSURE_REGISTERED (FlowTraceReplay);
+
+TypeId
+FlowTraceReplay::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FlowTraceReplay")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<FlowTraceReplay> ()
+    .AddAttribute ("FileName",
+                   "The flow trace file.",
+                   StringValue (""),
+                   MakeStringAccessor (&FlowTraceReplay::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("Window",
+                   "The number of upcoming flows scheduled at once.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&FlowTraceReplay::m_window),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("BufferSize",
+                   "The size of the read buffer of the trace in bytes.",
+                   UintegerValue (1 << 20),
+                   MakeUintegerAccessor (&FlowTraceReplay::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("TimeOffset",
+                   "The time added to the start times of the trace.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&FlowTraceReplay::m_offset),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Flow",
+                     "A flow of the trace is started",
+                     MakeTraceSourceAccessor (&FlowTraceReplay::m_flowTrace),
+                     "ns3::FlowTraceReplay::FlowTracedCallback")
+  ;
+  return tid;
+}
+
+FlowTraceReplay::FlowTraceReplay ()
+  : m_nRead (0),
+    m_nStarted (0),
+    m_nSkipped (0),
+    m_nReordered (0),
+    m_nScheduled (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FlowTraceReplay::~FlowTraceReplay ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FlowTraceReplay::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  m_hosts = NodeContainer ();
+  m_startFlow = MakeNullCallback<void, const Flow &> ();
+  Object::DoDispose ();
+}
+
+void
+FlowTraceReplay::SetHosts (NodeContainer hosts)
+{
+  m_hosts = hosts;
+}
+
+void
+FlowTraceReplay::MapHost (uint32_t traceId, uint32_t host)
+{
+  NS_LOG_FUNCTION (this << traceId << host);
+  m_hostMap[traceId] = host;
+}
+
+void
+FlowTraceReplay::SetStartFlowCallback (StartFlowCallback cb)
+{
+  m_startFlow = cb;
+}
+
+uint64_t
+FlowTraceReplay::GetNStarted (void) const
+{
+  return m_nStarted;
+}
+
+uint64_t
+FlowTraceReplay::GetNSkipped (void) const
+{
+  return m_nSkipped;
+}
+
+uint64_t
+FlowTraceReplay::GetNReordered (void) const
+{
+  return m_nReordered;
+}
+
+uint32_t
+FlowTraceReplay::GetNScheduled (void) const
+{
+  return m_nScheduled;
+}
+
+bool
+FlowTraceReplay::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_hosts.GetN () == 0, "No host to replay the flow trace on");
+  // the buffer must be set before the file is opened
+  m_buffer.resize (m_bufferSize);
+  m_file.rdbuf ()->pubsetbuf (&m_buffer[0], m_buffer.size ());
+  m_file.open (m_fileName.c_str ());
+  if (!m_file.is_open ())
+    {
+      NS_LOG_ERROR ("Cannot open the flow trace " << m_fileName);
+      return false;
+    }
+  m_last = Simulator::Now ();
+  Refill ();
+  return true;
+}
+
+bool
+FlowTraceReplay::ReadFlow (Flow &flow)
+{
+  NS_LOG_FUNCTION (this);
+  while (std::getline (m_file, m_line))
+    {
+      std::string::size_type first = m_line.find_first_not_of (" \t\r");
+      if (first == std::string::npos || m_line[first] == '#')
+        {
+          continue;
+        }
+      flow.id = m_nRead++;
+      std::replace (m_line.begin (), m_line.end (), ',', ' ');
+
+      const char *p = m_line.c_str ();
+      char *end;
+      double start = std::strtod (p, &end);
+      bool valid = end != p;
+      p = end;
+      flow.srcId = std::strtoul (p, &end, 10);
+      valid = valid && end != p;
+      p = end;
+      flow.dstId = std::strtoul (p, &end, 10);
+      valid = valid && end != p;
+      p = end;
+      flow.size = std::strtoull (p, &end, 10);
+      valid = valid && end != p;
+      p = end;
+      // optional fields
+      double deadline = std::strtod (p, &end);
+      p = end;
+      flow.priority = std::strtoul (p, &end, 10);
+      if (!valid)
+        {
+          NS_LOG_WARN ("Invalid flow " << flow.id << ": " << m_line);
+          m_nSkipped++;
+          continue;
+        }
+
+      std::map<uint32_t, uint32_t>::const_iterator it = m_hostMap.find (flow.srcId);
+      flow.src = (it != m_hostMap.end ()) ? it->second : flow.srcId % m_hosts.GetN ();
+      it = m_hostMap.find (flow.dstId);
+      flow.dst = (it != m_hostMap.end ()) ? it->second : flow.dstId % m_hosts.GetN ();
+      NS_ABORT_MSG_IF (flow.src >= m_hosts.GetN () || flow.dst >= m_hosts.GetN (),
+                       "Flow " << flow.id << " mapped onto a missing host");
+      if (flow.src == flow.dst)
+        {
+          NS_LOG_WARN ("Flow " << flow.id << " mapped onto a single host " << flow.src);
+          m_nSkipped++;
+          continue;
+        }
+
+      // to the nearest ns, as decimal seconds are seldom exact doubles
+      flow.start = NanoSeconds (std::llround (start * 1e9)) + m_offset;
+      if (flow.start < m_last)
+        {
+          NS_LOG_WARN ("Flow " << flow.id << " starts at " << flow.start
+                       << ", before the previous flow: started at " << m_last);
+          flow.start = m_last;
+          m_nReordered++;
+        }
+      m_last = flow.start;
+      flow.deadline = NanoSeconds (std::llround (deadline * 1e9));
+      return true;
+    }
+  return false;
+}
+
+void
+FlowTraceReplay::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  Flow flow;
+  while (m_nScheduled < m_window && ReadFlow (flow))
+    {
+      NS_LOG_LOGIC ("Schedule flow " << flow.id << " at " << flow.start);
+      Simulator::Schedule (flow.start - Simulator::Now (), &FlowTraceReplay::StartFlow, this, flow);
+      m_nScheduled++;
+    }
+}
+
+void
+FlowTraceReplay::StartFlow (Flow flow)
+{
+  NS_LOG_FUNCTION (this << flow.id);
+  m_nScheduled--;
+  m_nStarted++;
+  m_flowTrace (flow);
+  if (!m_startFlow.IsNull ())
+    {
+      m_startFlow (flow);
+    }
+  Refill ();
+}
+
+} // namespace ns3
@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef FLOW_TRACE_REPLAY_H
+#define FLOW_TRACE_REPLAY_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/node-container.h"
+#include "ns3/callback.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Replay the flows of a flow trace file
+ *
+ * The trace has one flow per line: start time (s), source host, destination
+ * host, size (bytes), and optionally a deadline (s, 0 for none) and a
+ * priority, separated by spaces, tabs or commas. Empty lines and lines
+ * starting with '#' are skipped. The lines must be sorted by start time:
+ * as only the next flows are read, a flow starting before the previous
+ * one is started with it instead, with a warning, and counted by
+ * GetNReordered.
+ *
+ * The file is streamed through a read buffer of BufferSize bytes, and
+ * only the next Window flows are scheduled at any time: each flow
+ * started reads the next one, so neither the trace nor its events are
+ * held in memory.
+ *
+ * The host ids of the trace are mapped onto the hosts given with
+ * SetHosts: an id mapped with MapHost goes to that host, any other id
+ * to the host of index id modulo the number of hosts. Flows whose source
+ * and destination map onto the same host are skipped.
+ *
+ * The flows are started by the callback set with SetStartFlowCallback,
+ * typically creating the sending and receiving applications.
+ */
+class FlowTraceReplay : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  FlowTraceReplay ();
+  virtual ~FlowTraceReplay ();
+
+  /// A flow of the trace
+  struct Flow
+  {
+    uint64_t id;          //!< index of the flow in the trace
+    Time start;           //!< start time
+    uint32_t srcId;       //!< source host id in the trace
+    uint32_t dstId;       //!< destination host id in the trace
+    uint32_t src;         //!< index of the source host
+    uint32_t dst;         //!< index of the destination host
+    uint64_t size;        //!< size in bytes
+    Time deadline;        //!< deadline, 0 for none
+    uint8_t priority;     //!< priority
+  };
+
+  /**
+   * Callback starting a flow
+   * \param flow the flow
+   */
+  typedef Callback<void, const Flow &> StartFlowCallback;
+
+  /**
+   * TracedCallback signature for the flows started.
+   *
+   * \param [in] flow the flow
+   */
+  typedef void (* FlowTracedCallback)(const Flow &flow);
+
+  /**
+   * \param hosts the hosts the trace host ids are mapped onto
+   */
+  void SetHosts (NodeContainer hosts);
+
+  /**
+   * \param traceId a host id of the trace
+   * \param host the index of the host in the container given to SetHosts
+   */
+  void MapHost (uint32_t traceId, uint32_t host);
+
+  /**
+   * \param cb the callback starting the flows
+   */
+  void SetStartFlowCallback (StartFlowCallback cb);
+
+  /**
+   * \brief Open the trace and schedule its first flows
+   * \return false if the trace cannot be opened
+   */
+  bool Start (void);
+
+  /**
+   * \return the flows started
+   */
+  uint64_t GetNStarted (void) const;
+
+  /**
+   * \return the flows skipped, because of invalid lines or hosts
+   */
+  uint64_t GetNSkipped (void) const;
+
+  /**
+   * \return the flows started later than their start time, because they
+   * start before the previous flow of the trace
+   */
+  uint64_t GetNReordered (void) const;
+
+  /**
+   * \return the flows currently scheduled
+   */
+  uint32_t GetNScheduled (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Read and schedule flows until Window flows are scheduled or
+   * the trace ends
+   */
+  void Refill (void);
+  /**
+   * \brief Read the next flow of the trace
+   * \param flow the flow read
+   * \return false at the end of the trace
+   */
+  bool ReadFlow (Flow &flow);
+  /**
+   * \brief Start a scheduled flow and schedule the next one
+   * \param flow the flow
+   */
+  void StartFlow (Flow flow);
+
+  std::string m_fileName;                 //!< trace file
+  uint32_t m_window;                      //!< flows scheduled ahead
+  uint32_t m_bufferSize;                  //!< size of the read buffer
+  Time m_offset;                          //!< added to the start times
+  std::ifstream m_file;                   //!< the trace
+  std::vector<char> m_buffer;             //!< the read buffer
+  std::string m_line;                     //!< the line being parsed
+  NodeContainer m_hosts;                  //!< the hosts
+  std::map<uint32_t, uint32_t> m_hostMap; //!< explicit host mapping
+  StartFlowCallback m_startFlow;          //!< starts the flows
+  uint64_t m_nRead;                       //!< lines of flows read
+  uint64_t m_nStarted;                    //!< flows started
+  uint64_t m_nSkipped;                    //!< flows skipped
+  uint64_t m_nReordered;                  //!< flows out of order
+  uint32_t m_nScheduled;                  //!< flows scheduled
+  Time m_last;                            //!< start time of the last flow read
+  TracedCallback<const Flow &> m_flowTrace; //!< flows started
+};
+
+} // namespace ns3
+
+#endif /* FLOW_TRACE_REPLAY_H */
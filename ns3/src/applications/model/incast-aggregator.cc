@@ -0,0 +1,353 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <algorithm>
+
+#include "incast-aggregator.h"
+#include "incast-header.h"
+#include "int-collector.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("IncastAggregator");
+
+NS_OBJECT_ENSURE_REGISTERED (IncastAggregator);
+
+TypeId
+IncastAggregator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IncastAggregator")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<IncastAggregator> ()
+    .AddAttribute ("Protocol",
+                   "The type id of the stream protocol to use.",
+                   TypeIdValue (TcpSocketFactory::GetTypeId ()),
+                   MakeTypeIdAccessor (&IncastAggregator::m_tid),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("FanOut",
+                   "The number of workers queried at once, 0 for all the workers.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&IncastAggregator::m_fanOut),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxQueries",
+                   "The number of queries to issue, 0 for no limit.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&IncastAggregator::m_maxQueries),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("FlowId",
+                   "The flow id of the first response.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&IncastAggregator::m_flowId),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ResponseSize",
+                   "A RandomVariableStream used to pick the size of each response in bytes.",
+                   StringValue ("ns3::ConstantRandomVariable[Constant=20000]"),
+                   MakePointerAccessor (&IncastAggregator::m_responseSize),
+                   MakePointerChecker <RandomVariableStream> ())
+    .AddAttribute ("QueryInterval",
+                   "A RandomVariableStream used to pick the time between queries in seconds.",
+                   StringValue ("ns3::ConstantRandomVariable[Constant=0.01]"),
+                   MakePointerAccessor (&IncastAggregator::m_queryInterval),
+                   MakePointerChecker <RandomVariableStream> ())
+    .AddTraceSource ("Response",
+                     "A response has been received completely",
+                     MakeTraceSourceAccessor (&IncastAggregator::m_responseTrace),
+                     "ns3::IncastAggregator::ResponseTracedCallback")
+    .AddTraceSource ("Query",
+                     "A query has ended",
+                     MakeTraceSourceAccessor (&IncastAggregator::m_queryTrace),
+                     "ns3::IncastAggregator::QueryTracedCallback")
+  ;
+  return tid;
+}
+
+IncastAggregator::IncastAggregator ()
+  : m_nQueries (0),
+    m_nCompleted (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_pick = CreateObject<UniformRandomVariable> ();
+}
+
+IncastAggregator::~IncastAggregator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+IncastAggregator::AddWorker (const Address &address, uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (this << address << nodeId);
+  Worker worker;
+  worker.address = address;
+  worker.nodeId = nodeId;
+  m_workers.push_back (worker);
+}
+
+void
+IncastAggregator::SetStream (Ptr<OutputStreamWrapper> stream)
+{
+  m_stream = stream;
+}
+
+void
+IncastAggregator::SetQueryStream (Ptr<OutputStreamWrapper> stream)
+{
+  m_queryStream = stream;
+}
+
+uint32_t
+IncastAggregator::GetNCompletedQueries (void) const
+{
+  return m_nCompleted;
+}
+
+int64_t
+IncastAggregator::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_responseSize->SetStream (stream);
+  m_queryInterval->SetStream (stream + 1);
+  m_pick->SetStream (stream + 2);
+  return 3;
+}
+
+void
+IncastAggregator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_responses.clear ();
+  m_queries.clear ();
+  m_stream = 0;
+  m_queryStream = 0;
+  Application::DoDispose ();
+}
+
+void
+IncastAggregator::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_queryEvent = Simulator::ScheduleNow (&IncastAggregator::IssueQuery, this);
+}
+
+void
+IncastAggregator::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_queryEvent);
+  for (std::map<Ptr<Socket>, Response>::iterator it = m_responses.begin ();
+       it != m_responses.end (); ++it)
+    {
+      it->first->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      it->first->Close ();
+    }
+  m_responses.clear ();
+}
+
+void
+IncastAggregator::IssueQuery (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t n = m_workers.size ();
+  if (n == 0)
+    {
+      NS_LOG_WARN ("No worker to query");
+      return;
+    }
+  uint32_t query = m_nQueries++;
+  uint32_t fanOut = (m_fanOut == 0 || m_fanOut > n) ? n : m_fanOut;
+
+  // the first fanOut entries are a random subset of the workers
+  std::vector<uint32_t> picked (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      picked[i] = i;
+    }
+  if (fanOut < n)
+    {
+      for (uint32_t i = 0; i < fanOut; i++)
+        {
+          std::swap (picked[i], picked[i + m_pick->GetInteger (0, n - 1 - i)]);
+        }
+    }
+
+  Query &q = m_queries[query];
+  q.start = Simulator::Now ();
+  q.pending = fanOut;
+  q.responses = 0;
+  q.bytes = 0;
+
+  NS_LOG_INFO ("Query " << query << " to " << fanOut << " workers");
+  for (uint32_t i = 0; i < fanOut; i++)
+    {
+      Ptr<Socket> socket = Socket::CreateSocket (GetNode (), m_tid);
+      Response &r = m_responses[socket];
+      r.query = query;
+      r.flowId = m_flowId++;
+      r.worker = picked[i];
+      r.size = std::max (1.0, m_responseSize->GetValue ());
+      r.received = 0;
+      r.start = q.start;
+
+      socket->Bind ();
+      socket->SetConnectCallback (MakeCallback (&IncastAggregator::ConnectionSucceeded, this),
+                                  MakeCallback (&IncastAggregator::ConnectionFailed, this));
+      socket->SetRecvCallback (MakeCallback (&IncastAggregator::HandleRead, this));
+      socket->SetCloseCallbacks (MakeCallback (&IncastAggregator::ConnectionFailed, this),
+                                 MakeCallback (&IncastAggregator::ConnectionFailed, this));
+      socket->Connect (m_workers[r.worker].address);
+    }
+
+  if (m_maxQueries == 0 || m_nQueries < m_maxQueries)
+    {
+      m_queryEvent = Simulator::Schedule (Seconds (m_queryInterval->GetValue ()),
+                                          &IncastAggregator::IssueQuery, this);
+    }
+}
+
+void
+IncastAggregator::ConnectionSucceeded (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  std::map<Ptr<Socket>, Response>::iterator it = m_responses.find (socket);
+  if (it == m_responses.end ())
+    {
+      return;
+    }
+  IncastHeader header;
+  header.SetQuery (it->second.query);
+  header.SetResponseSize (it->second.size);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (header);
+  socket->Send (p);
+}
+
+void
+IncastAggregator::ConnectionFailed (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  // the complete responses are already released
+  EndResponse (socket, false);
+}
+
+void
+IncastAggregator::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      std::map<Ptr<Socket>, Response>::iterator it = m_responses.find (socket);
+      if (it == m_responses.end ())
+        {
+          continue;
+        }
+      it->second.received += packet->GetSize ();
+      if (it->second.received >= it->second.size)
+        {
+          EndResponse (socket, true);
+        }
+    }
+}
+
+void
+IncastAggregator::EndResponse (Ptr<Socket> socket, bool complete)
+{
+  NS_LOG_FUNCTION (this << socket << complete);
+  std::map<Ptr<Socket>, Response>::iterator it = m_responses.find (socket);
+  if (it == m_responses.end ())
+    {
+      return;
+    }
+  Response r = it->second;
+  m_responses.erase (it);
+  Time now = Simulator::Now ();
+
+  if (complete)
+    {
+      Time fct = now - r.start;
+      NS_LOG_LOGIC ("Response " << r.flowId << " of query " << r.query << " in " << fct);
+      m_responseTrace (r.query, r.flowId, fct, r.size);
+      if (m_stream)
+        {
+          *m_stream->GetStream () << r.flowId << ","
+                                  << fct.GetNanoSeconds () << ","
+                                  << r.start.GetNanoSeconds () << ","
+                                  << now.GetNanoSeconds () << ","
+                                  << r.size << ",0,"
+                                  << m_workers[r.worker].nodeId << ","
+                                  << GetNode ()->GetId () << std::endl;
+        }
+      Ptr<IntCollector> collector = GetNode ()->GetObject<IntCollector> ();
+      Address local;
+      if (collector && socket->GetSockName (local) == 0 && InetSocketAddress::IsMatchingType (local))
+        {
+          collector->Export (r.flowId, m_workers[r.worker].address,
+                             InetSocketAddress::ConvertFrom (local).GetPort ());
+        }
+    }
+  else
+    {
+      NS_LOG_WARN ("Response " << r.flowId << " of query " << r.query << " failed after "
+                   << r.received << " bytes");
+    }
+  socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (),
+                             MakeNullCallback<void, Ptr<Socket> > ());
+  socket->Close ();
+
+  std::map<uint32_t, Query>::iterator qit = m_queries.find (r.query);
+  NS_ASSERT (qit != m_queries.end ());
+  Query &q = qit->second;
+  q.pending--;
+  if (complete)
+    {
+      q.responses++;
+      q.bytes += r.size;
+    }
+  if (q.pending == 0)
+    {
+      Time qct = now - q.start;
+      NS_LOG_INFO ("Query " << r.query << " completed in " << qct << " with "
+                   << q.responses << " responses");
+      m_nCompleted++;
+      m_queryTrace (r.query, qct, q.responses);
+      if (m_queryStream)
+        {
+          *m_queryStream->GetStream () << r.query << ","
+                                       << qct.GetNanoSeconds () << ","
+                                       << q.start.GetNanoSeconds () << ","
+                                       << now.GetNanoSeconds () << ","
+                                       << q.responses << ","
+                                       << q.bytes << ","
+                                       << GetNode ()->GetId () << std::endl;
+        }
+      m_queries.erase (qit);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef INCAST_AGGREGATOR_H
+#define INCAST_AGGREGATOR_H
+
+#include <map>
+#include <vector>
+
+#include "ns3/application.h"
+#include "ns3/address.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/socket.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup incast
+ *
+ * \brief Issue partition/aggregate queries to a set of IncastWorker
+ *
+ * Each query is sent at once, from a single event, to FanOut workers
+ * drawn at random among the workers added (all of them by default), each
+ * asked for a response of a size drawn from ResponseSize. The next query
+ * is issued QueryInterval later, whether or not the previous one is
+ * complete, until MaxQueries queries are issued.
+ *
+ * Every response is a flow with its own id, FlowId being the id of the
+ * first one. A completed response is written to the flow stream with the
+ * columns of the flow completion records of MySendApp, i.e. "flow id,fct,
+ * start time,stop time,flow size,deadline,src,dst", times in nanoseconds,
+ * and its in-band telemetry is exported by the IntCollector of the node,
+ * if any. A completed query, whose completion time is the one of its
+ * slowest response, is written to the query stream as "query id,qct,
+ * start time,stop time,responses,bytes,aggregator".
+ */
+class IncastAggregator : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  IncastAggregator ();
+  virtual ~IncastAggregator ();
+
+  /**
+   * \brief Add a worker
+   * \param address the address of the worker, with its port
+   * \param nodeId the id of the node of the worker, for the records
+   */
+  void AddWorker (const Address &address, uint32_t nodeId);
+
+  /**
+   * \param stream the stream the response records are written to
+   */
+  void SetStream (Ptr<OutputStreamWrapper> stream);
+
+  /**
+   * \param stream the stream the query records are written to
+   */
+  void SetQueryStream (Ptr<OutputStreamWrapper> stream);
+
+  /**
+   * \return the number of queries completed
+   */
+  uint32_t GetNCompletedQueries (void) const;
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variables used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * TracedCallback signature for completed responses.
+   *
+   * \param [in] query the query id
+   * \param [in] flowId the flow id of the response
+   * \param [in] fct the flow completion time
+   * \param [in] size the size of the response
+   */
+  typedef void (* ResponseTracedCallback)
+    (uint32_t query, uint32_t flowId, Time fct, uint32_t size);
+
+  /**
+   * TracedCallback signature for completed queries.
+   *
+   * \param [in] query the query id
+   * \param [in] qct the query completion time
+   * \param [in] responses the number of responses received
+   */
+  typedef void (* QueryTracedCallback)
+    (uint32_t query, Time qct, uint32_t responses);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief Send a query to the workers and schedule the next one
+   */
+  void IssueQuery (void);
+  /**
+   * \brief Send the request of a response once connected
+   * \param socket the connected socket
+   */
+  void ConnectionSucceeded (Ptr<Socket> socket);
+  /**
+   * \brief Give up a response which could not be requested
+   * \param socket the socket
+   */
+  void ConnectionFailed (Ptr<Socket> socket);
+  /**
+   * \brief Count the bytes of a response
+   * \param socket the connected socket
+   */
+  void HandleRead (Ptr<Socket> socket);
+  /**
+   * \brief Account for a response ending, complete or not
+   * \param socket the socket of the response
+   * \param complete whether all the bytes were received
+   */
+  void EndResponse (Ptr<Socket> socket, bool complete);
+
+  /// A worker
+  struct Worker
+  {
+    Address address;   //!< the address of the worker
+    uint32_t nodeId;   //!< the id of its node
+  };
+
+  /// A response in progress
+  struct Response
+  {
+    uint32_t query;     //!< the query id
+    uint32_t flowId;    //!< the flow id
+    uint32_t worker;    //!< the index of the worker
+    uint32_t size;      //!< the bytes requested
+    uint32_t received;  //!< the bytes received
+    Time start;         //!< the time the query was issued
+  };
+
+  /// A query in progress
+  struct Query
+  {
+    Time start;          //!< the time the query was issued
+    uint32_t pending;    //!< the responses not ended
+    uint32_t responses;  //!< the responses complete
+    uint64_t bytes;      //!< the bytes of the complete responses
+  };
+
+  TypeId m_tid;                               //!< protocol TypeId
+  uint32_t m_fanOut;                          //!< workers per query, 0 for all
+  uint32_t m_maxQueries;                      //!< queries to issue, 0 for no limit
+  uint32_t m_flowId;                          //!< flow id of the next response
+  Ptr<RandomVariableStream> m_responseSize;   //!< response size in bytes
+  Ptr<RandomVariableStream> m_queryInterval;  //!< time between queries in seconds
+  Ptr<UniformRandomVariable> m_pick;          //!< selects the workers of a query
+  std::vector<Worker> m_workers;              //!< the workers
+  uint32_t m_nQueries;                        //!< queries issued
+  uint32_t m_nCompleted;                      //!< queries complete
+  EventId m_queryEvent;                       //!< next query
+  std::map<Ptr<Socket>, Response> m_responses; //!< responses in progress
+  std::map<uint32_t, Query> m_queries;        //!< queries in progress
+  Ptr<OutputStreamWrapper> m_stream;          //!< stream of response records
+  Ptr<OutputStreamWrapper> m_queryStream;     //!< stream of query records
+
+  /// Traced Callback: completed responses
+  TracedCallback<uint32_t, uint32_t, Time, uint32_t> m_responseTrace;
+  /// Traced Callback: completed queries
+  TracedCallback<uint32_t, Time, uint32_t> m_queryTrace;
+};
+
+} // namespace ns3
+
+#endif /* INCAST_AGGREGATOR_H */
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "incast-header.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (IncastHeader);
+
+IncastHeader::IncastHeader ()
+  : m_query (0),
+    m_responseSize (0)
+{
+}
+
+void
+IncastHeader::SetQuery (uint32_t query)
+{
+  m_query = query;
+}
+
+uint32_t
+IncastHeader::GetQuery (void) const
+{
+  return m_query;
+}
+
+void
+IncastHeader::SetResponseSize (uint32_t size)
+{
+  m_responseSize = size;
+}
+
+uint32_t
+IncastHeader::GetResponseSize (void) const
+{
+  return m_responseSize;
+}
+
+TypeId
+IncastHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IncastHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<IncastHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+IncastHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+IncastHeader::Print (std::ostream &os) const
+{
+  os << "(query=" << m_query << " size=" << m_responseSize << ")";
+}
+
+uint32_t
+IncastHeader::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+IncastHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_query);
+  i.WriteHtonU32 (m_responseSize);
+}
+
+uint32_t
+IncastHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_query = i.ReadNtohU32 ();
+  m_responseSize = i.ReadNtohU32 ();
+  return GetSerializedSize ();
+}
+
+} // namespace ns3
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef INCAST_HEADER_H
+#define INCAST_HEADER_H
+
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup incast
+ *
+ * \brief Request of an IncastAggregator to an IncastWorker
+ *
+ * The header is made of a 32bits query id followed by the 32bits size,
+ * in bytes, of the response requested.
+ */
+class IncastHeader : public Header
+{
+public:
+  IncastHeader ();
+
+  /**
+   * \param query the query id
+   */
+  void SetQuery (uint32_t query);
+  /**
+   * \return the query id
+   */
+  uint32_t GetQuery (void) const;
+  /**
+   * \param size the size of the response in bytes
+   */
+  void SetResponseSize (uint32_t size);
+  /**
+   * \return the size of the response in bytes
+   */
+  uint32_t GetResponseSize (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint32_t m_query;         //!< Query id
+  uint32_t m_responseSize;  //!< Response size
+};
+
+} // namespace ns3
+
+#endif /* INCAST_HEADER_H */
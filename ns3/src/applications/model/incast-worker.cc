@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "incast-worker.h"
+#include "incast-header.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/tcp-socket-factory.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("IncastWorker");
+
+NS_OBJECT_ENSURE_REGISTERED (IncastWorker);
+
+TypeId
+IncastWorker::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IncastWorker")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<IncastWorker> ()
+    .AddAttribute ("Local",
+                   "The Address on which to bind the listening socket.",
+                   AddressValue (),
+                   MakeAddressAccessor (&IncastWorker::m_local),
+                   MakeAddressChecker ())
+    .AddAttribute ("Protocol",
+                   "The type id of the stream protocol to use.",
+                   TypeIdValue (TcpSocketFactory::GetTypeId ()),
+                   MakeTypeIdAccessor (&IncastWorker::m_tid),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("SendSize",
+                   "The amount of data to send each time.",
+                   UintegerValue (1448),
+                   MakeUintegerAccessor (&IncastWorker::m_sendSize),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+IncastWorker::IncastWorker ()
+  : m_socket (0),
+    m_nResponses (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+IncastWorker::~IncastWorker ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+IncastWorker::GetNResponses (void) const
+{
+  return m_nResponses;
+}
+
+void
+IncastWorker::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_socket = 0;
+  m_connections.clear ();
+  Application::DoDispose ();
+}
+
+void
+IncastWorker::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_socket)
+    {
+      m_socket = Socket::CreateSocket (GetNode (), m_tid);
+      if (m_socket->Bind (m_local) == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind socket");
+        }
+      m_socket->Listen ();
+    }
+  m_socket->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&IncastWorker::HandleAccept, this));
+}
+
+void
+IncastWorker::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<Ptr<Socket>, Connection>::iterator it = m_connections.begin ();
+       it != m_connections.end (); ++it)
+    {
+      it->first->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      it->first->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+      it->first->Close ();
+    }
+  m_connections.clear ();
+  if (m_socket)
+    {
+      m_socket->Close ();
+      m_socket->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                                   MakeNullCallback<void, Ptr<Socket>, const Address &> ());
+    }
+}
+
+void
+IncastWorker::HandleAccept (Ptr<Socket> socket, const Address &from)
+{
+  NS_LOG_FUNCTION (this << socket << from);
+  Connection connection;
+  connection.request = Create<Packet> ();
+  connection.remaining = 0;
+  connection.responding = false;
+  m_connections[socket] = connection;
+  socket->SetRecvCallback (MakeCallback (&IncastWorker::HandleRead, this));
+  socket->SetSendCallback (MakeCallback (&IncastWorker::DataSend, this));
+  socket->SetCloseCallbacks (MakeCallback (&IncastWorker::HandleClose, this),
+                             MakeCallback (&IncastWorker::HandleClose, this));
+}
+
+void
+IncastWorker::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      // the connection is released once the response is sent
+      std::map<Ptr<Socket>, Connection>::iterator it = m_connections.find (socket);
+      if (it == m_connections.end () || it->second.responding)
+        {
+          continue;
+        }
+      Connection &connection = it->second;
+      connection.request->AddAtEnd (packet);
+      IncastHeader header;
+      if (connection.request->GetSize () < header.GetSerializedSize ())
+        {
+          continue;
+        }
+      connection.request->RemoveHeader (header);
+      connection.request = 0;
+      connection.remaining = header.GetResponseSize ();
+      connection.responding = true;
+      NS_LOG_LOGIC ("Query " << header.GetQuery () << " requests " << connection.remaining << " bytes");
+      DataSend (socket, socket->GetTxAvailable ());
+    }
+}
+
+void
+IncastWorker::DataSend (Ptr<Socket> socket, uint32_t available)
+{
+  NS_LOG_FUNCTION (this << socket << available);
+  std::map<Ptr<Socket>, Connection>::iterator it = m_connections.find (socket);
+  if (it == m_connections.end () || !it->second.responding)
+    {
+      return;
+    }
+  Connection &connection = it->second;
+  while (connection.remaining > 0)
+    {
+      uint32_t toSend = std::min (std::min (m_sendSize, connection.remaining),
+                                  socket->GetTxAvailable ());
+      if (toSend == 0)
+        {
+          // wait for the DataSend callback
+          return;
+        }
+      int actual = socket->Send (Create<Packet> (toSend));
+      if (actual <= 0)
+        {
+          return;
+        }
+      connection.remaining -= actual;
+    }
+  NS_LOG_LOGIC ("Response sent");
+  m_nResponses++;
+  m_connections.erase (it);
+  socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+  socket->Close ();
+}
+
+void
+IncastWorker::HandleClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  m_connections.erase (socket);
+}
+
+} // namespace ns3
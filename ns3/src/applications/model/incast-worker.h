@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef INCAST_WORKER_H
+#define INCAST_WORKER_H
+
+#include <map>
+
+#include "ns3/application.h"
+#include "ns3/address.h"
+#include "ns3/socket.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \defgroup incast Incast
+ *
+ * Partition/aggregate workload: an IncastAggregator sends a query to a
+ * set of IncastWorker applications at once and waits for all their
+ * responses, so that the responses converge on the link of the
+ * aggregator. The query completes with the slowest response.
+ */
+
+/**
+ * \ingroup incast
+ *
+ * \brief Answer the queries of an IncastAggregator
+ *
+ * The worker accepts the connections of the aggregator and, once the
+ * IncastHeader of a request is received, sends the number of bytes
+ * requested and closes the connection.
+ */
+class IncastWorker : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  IncastWorker ();
+  virtual ~IncastWorker ();
+
+  /**
+   * \return the number of responses sent completely
+   */
+  uint32_t GetNResponses (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief Handle an incoming connection
+   * \param socket the connected socket
+   * \param from the address of the aggregator
+   */
+  void HandleAccept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Read the request of a connection
+   * \param socket the connected socket
+   */
+  void HandleRead (Ptr<Socket> socket);
+  /**
+   * \brief Send the response as far as the socket buffer allows
+   * \param socket the connected socket
+   * \param available the space available in the buffer
+   */
+  void DataSend (Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief Forget a closed connection
+   * \param socket the connected socket
+   */
+  void HandleClose (Ptr<Socket> socket);
+
+  /// State of a connection
+  struct Connection
+  {
+    Ptr<Packet> request;  //!< request bytes received until the header is complete
+    uint32_t remaining;   //!< bytes of the response left to send
+    bool responding;      //!< whether the request was received
+  };
+
+  Ptr<Socket> m_socket;                         //!< listening socket
+  Address m_local;                              //!< local address to bind to
+  TypeId m_tid;                                 //!< protocol TypeId
+  uint32_t m_sendSize;                          //!< size of the data sent each time
+  uint32_t m_nResponses;                        //!< responses sent completely
+  std::map<Ptr<Socket>, Connection> m_connections; //!< accepted connections
+};
+
+} // namespace ns3
+
+#endif /* INCAST_WORKER_H */
@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "int-collector.h"
+
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/int-tag.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("IntCollector");
+
+NS_OBJECT_ENSURE_REGISTERED (IntCollector);
+
+namespace {
+
+template <typename T>
+void
+WriteValue (std::ostream *os, T value)
+{
+  os->write (reinterpret_cast<const char *> (&value), sizeof (T));
+}
+
+} // anonymous namespace
+
+TypeId
+IntCollector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IntCollector")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<IntCollector> ()
+  ;
+  return tid;
+}
+
+IntCollector::IntCollector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+IntCollector::~IntCollector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+IntCollector::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_node = 0;
+  m_stream = 0;
+  m_flows.clear ();
+  Object::DoDispose ();
+}
+
+void
+IntCollector::Install (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol> ();
+  NS_ASSERT_MSG (ipv4, "IntCollector requires an IPv4 stack");
+  m_node = node;
+  node->AggregateObject (this);
+  ipv4->TraceConnectWithoutContext ("LocalDeliver", MakeCallback (&IntCollector::LocalDeliver, this));
+}
+
+void
+IntCollector::SetStream (Ptr<OutputStreamWrapper> stream)
+{
+  m_stream = stream;
+}
+
+uint64_t
+IntCollector::GetKey (Ipv4Address src, uint16_t srcPort, uint16_t dstPort)
+{
+  return (static_cast<uint64_t> (src.Get ()) << 32) | (static_cast<uint64_t> (srcPort) << 16) | dstPort;
+}
+
+void
+IntCollector::LocalDeliver (const Ipv4Header &header, Ptr<const Packet> p, uint32_t iif)
+{
+  IntTag tag;
+  if (!p->PeekPacketTag (tag))
+    {
+      return;
+    }
+
+  // ports are the first four bytes of both the TCP and the UDP header
+  uint8_t l4[13];
+  uint32_t len = p->CopyData (l4, sizeof (l4));
+  if (len < 4)
+    {
+      return;
+    }
+  if (header.GetProtocol () == 6 && (len < sizeof (l4) || p->GetSize () <= 4u * (l4[12] >> 4)))
+    {
+      // TCP segment without payload
+      return;
+    }
+  uint16_t srcPort = (l4[0] << 8) | l4[1];
+  uint16_t dstPort = (l4[2] << 8) | l4[3];
+
+  FlowSummary &flow = m_flows[GetKey (header.GetSource (), srcPort, dstPort)];
+  flow.packets++;
+  bool ce = false;
+  for (uint8_t i = 0; i < tag.GetNHops (); i++)
+    {
+      IntTag::Hop hop = tag.GetHop (i);
+      if (i >= flow.hops.size () || flow.hops[i].nodeId != hop.nodeId)
+        {
+          // first packet of the flow, or the path changed at this hop
+          HopSummary s = { hop.nodeId, 0, 0, 0, 0, 0, 0 };
+          if (i >= flow.hops.size ())
+            {
+              flow.hops.push_back (s);
+            }
+          else
+            {
+              flow.hops[i] = s;
+            }
+        }
+      HopSummary &s = flow.hops[i];
+      int64_t sojourn = hop.sojourn.GetNanoSeconds ();
+      s.packets++;
+      s.ceMarks += hop.ce;
+      s.maxQDepth = std::max (s.maxQDepth, hop.qDepth);
+      s.sumQDepth += hop.qDepth;
+      s.maxSojourn = std::max (s.maxSojourn, sojourn);
+      s.sumSojourn += sojourn;
+      ce = ce || hop.ce;
+    }
+  flow.ceMarked += ce;
+}
+
+bool
+IntCollector::Export (uint32_t flowId, const Address &from, uint16_t localPort)
+{
+  NS_LOG_FUNCTION (this << flowId << from << localPort);
+  if (!InetSocketAddress::IsMatchingType (from))
+    {
+      return false;
+    }
+  InetSocketAddress inet = InetSocketAddress::ConvertFrom (from);
+  std::map<uint64_t, FlowSummary>::iterator it = m_flows.find (GetKey (inet.GetIpv4 (), inet.GetPort (), localPort));
+  if (it == m_flows.end ())
+    {
+      return false;
+    }
+  if (m_stream)
+    {
+      std::ostream *os = m_stream->GetStream ();
+      const FlowSummary &flow = it->second;
+      WriteValue<uint32_t> (os, flowId);
+      WriteValue<uint32_t> (os, m_node->GetId ());
+      WriteValue<uint32_t> (os, flow.packets);
+      WriteValue<uint32_t> (os, flow.ceMarked);
+      WriteValue<uint8_t> (os, flow.hops.size ());
+      for (std::vector<HopSummary>::const_iterator h = flow.hops.begin (); h != flow.hops.end (); ++h)
+        {
+          WriteValue<uint16_t> (os, h->nodeId);
+          WriteValue<uint32_t> (os, h->packets);
+          WriteValue<uint32_t> (os, h->ceMarks);
+          WriteValue<uint16_t> (os, h->maxQDepth);
+          WriteValue<uint64_t> (os, h->sumQDepth);
+          WriteValue<uint32_t> (os, h->maxSojourn);
+          WriteValue<uint64_t> (os, h->sumSojourn);
+        }
+    }
+  m_flows.erase (it);
+  return true;
+}
+
+} // namespace ns3
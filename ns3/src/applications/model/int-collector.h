@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INT_COLLECTOR_H
+#define INT_COLLECTOR_H
+
+#include <map>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/output-stream-wrapper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Receiver side aggregation of in-band telemetry
+ *
+ * The collector listens to the LocalDeliver trace of the Ipv4L3Protocol of
+ * its node and folds the IntTag hop records of every data packet into a
+ * per-flow summary, keyed by source address, source port and destination
+ * port. Pure TCP ACKs are ignored. When a flow completes, the receiving
+ * application calls Export, which appends one binary record to the output
+ * stream and releases the summary.
+ *
+ * Record layout (host byte order):
+ * - uint32 flow id, uint32 receiver node id
+ * - uint32 data packets, uint32 packets marked CE on any hop
+ * - uint8 number of hop summaries, followed by one entry per hop:
+ *   uint16 node id, uint32 packets, uint32 CE marks, uint16 max queue depth,
+ *   uint64 sum of queue depths, uint32 max sojourn (ns), uint64 sum of sojourn (ns)
+ */
+class IntCollector : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  IntCollector ();
+  virtual ~IntCollector ();
+
+  /**
+   * \brief Aggregate the collector to a node and start collecting
+   * \param node the receiving node, which must have an IPv4 stack
+   */
+  void Install (Ptr<Node> node);
+
+  /**
+   * \brief Set the stream the flow records are written to
+   * \param stream the output stream, opened in binary mode
+   */
+  void SetStream (Ptr<OutputStreamWrapper> stream);
+
+  /**
+   * \brief Write the record of a completed flow and release its summary
+   * \param flowId the flow id written in the record
+   * \param from the address of the sender
+   * \param localPort the local port of the flow
+   * \return false if no telemetry was collected for the flow
+   */
+  bool Export (uint32_t flowId, const Address &from, uint16_t localPort);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Aggregated telemetry of a single hop
+   */
+  struct HopSummary
+  {
+    uint16_t nodeId;      //!< id of the forwarding node
+    uint32_t packets;     //!< packets seen through this hop
+    uint32_t ceMarks;     //!< packets marked at this hop
+    uint16_t maxQDepth;   //!< max queue depth
+    uint64_t sumQDepth;   //!< sum of queue depths
+    int64_t maxSojourn;   //!< max sojourn time (ns)
+    int64_t sumSojourn;   //!< sum of sojourn times (ns)
+  };
+
+  /**
+   * \brief Aggregated telemetry of a flow
+   */
+  struct FlowSummary
+  {
+    uint32_t packets;                 //!< data packets received
+    uint32_t ceMarked;                //!< packets marked on any hop
+    std::vector<HopSummary> hops;     //!< per hop summaries
+  };
+
+  /**
+   * \brief Trace sink for the LocalDeliver trace of Ipv4L3Protocol
+   * \param header the IPv4 header
+   * \param p the packet, starting with the L4 header
+   * \param iif the incoming interface
+   */
+  void LocalDeliver (const Ipv4Header &header, Ptr<const Packet> p, uint32_t iif);
+
+  /**
+   * \brief Build the flow key
+   * \param src the source address
+   * \param srcPort the source port
+   * \param dstPort the destination port
+   * \return the key
+   */
+  static uint64_t GetKey (Ipv4Address src, uint16_t srcPort, uint16_t dstPort);
+
+  Ptr<Node> m_node;                         //!< the receiving node
+  Ptr<OutputStreamWrapper> m_stream;        //!< stream for flow records
+  std::map<uint64_t, FlowSummary> m_flows;  //!< summaries of running flows
+};
+
+} // namespace ns3
+
+#endif /* INT_COLLECTOR_H */
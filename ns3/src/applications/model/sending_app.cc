@@ -162,7 +162,9 @@ namespace ns3
   {
     NS_LOG_FUNCTION (this << newAck);
     //std::cout << "ack" << newAck;
-    if (newAck.GetValue() == m_maxBytes+1)
+    // the ack number wraps past 4 GB: the last one only counts once
+    // every byte is sent
+    if (m_totBytes == m_maxBytes && newAck.GetValue() == static_cast<uint32_t> (m_maxBytes+1))
       {
         m_real_stop = Simulator::Now().GetNanoSeconds();
         int64_t fct = m_real_stop - m_real_start;
@@ -263,7 +265,7 @@ namespace ns3
   MySendApp::SendPacket (void)
   {
     uint32_t pktsize = m_packetSize;
-    uint32_t bytes_remaining = m_maxBytes - m_totBytes;
+    uint64_t bytes_remaining = m_maxBytes - m_totBytes;
     if(bytes_remaining < m_packetSize) 
       {
         pktsize = bytes_remaining;
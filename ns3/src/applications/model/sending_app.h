@@ -41,11 +41,11 @@ namespace ns3
     EventId         m_sendEvent;
     bool            m_running;
     uint32_t        m_packetsSent;
-    uint32_t        m_maxBytes;
+    uint64_t        m_maxBytes;
     //double        m_startTime;
     //double        m_stoptime;
     EventId         m_startEvent;
-    uint32_t        m_totBytes;
+    uint64_t        m_totBytes;
     //Address       myAddress;
     Ptr<Node>       srcNode;
     Ptr<Node>       destNode;
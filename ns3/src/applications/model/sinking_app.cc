@@ -31,6 +31,7 @@
 // #include "ns3/trace-source-accessor.h"
 // #include "ns3/udp-socket-factory.h"
 #include "sinking_app.h"
+#include "int-collector.h"
 
 namespace ns3 {
 
@@ -60,6 +61,11 @@ MySinkApp::GetTypeId (void)
                   UintegerValue (100),
                   MakeUintegerAccessor (&MySinkApp::m_maxBytes),
                   MakeUintegerChecker<uint64_t> (0))
+    .AddAttribute ("FlowId",
+                   "The flow id reported with the in-band telemetry of this flow",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MySinkApp::m_fid),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("UseMyFifo", "True to use my-fofo-queue-disc",
                       BooleanValue (false),
                       MakeBooleanAccessor (&MySinkApp::m_useMyFifo),
@@ -203,6 +209,7 @@ void MySinkApp::HandleRead (Ptr<Socket> socket)
       //std::cout << "m_totalrx=" << m_totalRx << " m_maxBytes=" << m_maxBytes << std::endl;
       if (m_totalRx >= m_maxBytes)
       {
+        ExportTelemetry (from);
         StopApplication();
         break;
       }
@@ -211,6 +218,16 @@ void MySinkApp::HandleRead (Ptr<Socket> socket)
 }
 
 
+void MySinkApp::ExportTelemetry (const Address &from)
+{
+  NS_LOG_FUNCTION (this << from);
+  Ptr<IntCollector> collector = GetNode ()->GetObject<IntCollector> ();
+  if (collector && InetSocketAddress::IsMatchingType (m_local))
+    {
+      collector->Export (m_fid, from, InetSocketAddress::ConvertFrom (m_local).GetPort ());
+    }
+}
+
 void MySinkApp::HandlePeerClose (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
@@ -133,6 +133,11 @@ private:
    * \param socket the connected socket
    */
   void HandlePeerError (Ptr<Socket> socket);
+  /**
+   * \brief Export the in-band telemetry of the completed flow
+   * \param from the address of the sender
+   */
+  void ExportTelemetry (const Address &from);
 
   // In the case of TCP, each socket accept returns a new socket, so the 
   // listening socket is stored separately from the accepted sockets
@@ -143,7 +148,8 @@ private:
   uint64_t        m_totalRx;      //!< Total bytes received
   TypeId          m_tid;          //!< Protocol TypeId
 
-  uint32_t        m_maxBytes;
+  uint64_t        m_maxBytes;
+  uint32_t        m_fid;          //!< Flow id used in telemetry records
 
   bool    m_useMyFifo; //for my fifo queue disc added by zcw
   
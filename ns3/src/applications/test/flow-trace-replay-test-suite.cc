@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <cstdio>
+#include <fstream>
+
+#include "ns3/flow-trace-replay.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Replay a trace through a small window and check that every flow starts
+ * at its time on the hosts it is mapped onto.
+ */
+class FlowTraceReplayTestCase : public TestCase
+{
+public:
+  FlowTraceReplayTestCase ();
+  virtual ~FlowTraceReplayTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param flow the flow started
+   */
+  void StartFlow (const FlowTraceReplay::Flow &flow);
+
+  Ptr<FlowTraceReplay> m_replay;              //!< the replay
+  std::vector<FlowTraceReplay::Flow> m_flows; //!< the flows started
+  uint32_t m_maxScheduled;                    //!< flows scheduled at most
+};
+
+FlowTraceReplayTestCase::FlowTraceReplayTestCase ()
+  : TestCase ("FlowTraceReplay starts the flows of the trace in a sliding window"),
+    m_maxScheduled (0)
+{
+}
+
+FlowTraceReplayTestCase::~FlowTraceReplayTestCase ()
+{
+}
+
+void
+FlowTraceReplayTestCase::StartFlow (const FlowTraceReplay::Flow &flow)
+{
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), flow.start, "flow started at the wrong time");
+  m_maxScheduled = std::max (m_maxScheduled, m_replay->GetNScheduled () + 1);
+  m_flows.push_back (flow);
+}
+
+void
+FlowTraceReplayTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("flow-trace-replay.txt");
+  std::ofstream trace (fileName.c_str ());
+  trace << "# start src dst size deadline priority" << std::endl;
+  uint32_t n = 1000;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      trace << i * 1e-4 << "," << i << "," << i + 1 << "," << 1000 + i;
+      if (i % 2)
+        {
+          trace << "," << 0.01 << "," << i % 8;
+        }
+      trace << std::endl;
+    }
+  trace << std::endl << "0.2 1 x 1000" << std::endl;
+  // out of order, started with the previous flow
+  trace << "0.05 1 2 1000" << std::endl;
+  // the same host once mapped
+  trace << "0.3 5000 5001 1000" << std::endl;
+  trace.close ();
+
+  NodeContainer hosts;
+  hosts.Create (4);
+  m_replay = CreateObject<FlowTraceReplay> ();
+  m_replay->SetAttribute ("FileName", StringValue (fileName));
+  m_replay->SetAttribute ("Window", UintegerValue (16));
+  m_replay->SetAttribute ("BufferSize", UintegerValue (64));
+  m_replay->SetHosts (hosts);
+  m_replay->MapHost (5000, 1);
+  m_replay->SetStartFlowCallback (MakeCallback (&FlowTraceReplayTestCase::StartFlow, this));
+  NS_TEST_ASSERT_MSG_EQ (m_replay->Start (), true, "trace not opened");
+  NS_TEST_EXPECT_MSG_EQ (m_replay->GetNScheduled (), 16, "window not filled");
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_maxScheduled, 16, "window exceeded");
+  NS_TEST_EXPECT_MSG_EQ (m_replay->GetNStarted (), n + 1, "wrong number of flows started");
+  NS_TEST_EXPECT_MSG_EQ (m_replay->GetNSkipped (), 2, "wrong number of flows skipped");
+  NS_TEST_EXPECT_MSG_EQ (m_replay->GetNReordered (), 1, "wrong number of flows out of order");
+  NS_TEST_ASSERT_MSG_EQ (m_flows.size (), n + 1, "wrong number of flows started");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      const FlowTraceReplay::Flow &flow = m_flows[i];
+      NS_TEST_ASSERT_MSG_EQ (flow.id, i, "wrong flow id");
+      NS_TEST_ASSERT_MSG_EQ (flow.start, MicroSeconds (i * 100), "wrong start time");
+      NS_TEST_ASSERT_MSG_EQ (flow.src, i % 4, "wrong source host");
+      NS_TEST_ASSERT_MSG_EQ (flow.dst, (i + 1) % 4, "wrong destination host");
+      NS_TEST_ASSERT_MSG_EQ (flow.size, 1000 + i, "wrong size");
+      NS_TEST_ASSERT_MSG_EQ (flow.deadline, (i % 2) ? MilliSeconds (10) : Seconds (0), "wrong deadline");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) flow.priority, (i % 2) ? i % 8 : 0, "wrong priority");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_flows[n].id, n + 1, "wrong flow id");
+  NS_TEST_EXPECT_MSG_EQ (m_flows[n].start, MicroSeconds ((n - 1) * 100), "out of order flow not started at once");
+  m_replay->Dispose ();
+  std::remove (fileName.c_str ());
+}
+
+static class FlowTraceReplayTestSuite : public TestSuite
+{
+public:
+  FlowTraceReplayTestSuite ()
+    : TestSuite ("flow-trace-replay", UNIT)
+  {
+    AddTestCase (new FlowTraceReplayTestCase (), TestCase::QUICK);
+  }
+} g_flowTraceReplayTestSuite;
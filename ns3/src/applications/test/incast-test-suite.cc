@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <sstream>
+#include <algorithm>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/incast-helper.h"
+#include "ns3/incast-aggregator.h"
+#include "ns3/incast-worker.h"
+
+using namespace ns3;
+
+/**
+ * Issue queries to a subset of the workers and check that every query
+ * completes with its slowest response.
+ */
+class IncastTestCase : public TestCase
+{
+public:
+  IncastTestCase ();
+  virtual ~IncastTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param query the query id
+   * \param flowId the flow id of the response
+   * \param fct the flow completion time
+   * \param size the size of the response
+   */
+  void Response (uint32_t query, uint32_t flowId, Time fct, uint32_t size);
+  /**
+   * \param query the query id
+   * \param qct the query completion time
+   * \param responses the number of responses received
+   */
+  void Query (uint32_t query, Time qct, uint32_t responses);
+
+  std::map<uint32_t, Time> m_slowest;  //!< slowest response of each query
+  std::vector<uint32_t> m_flowIds;     //!< flow ids of the responses
+  uint32_t m_nQueries;                 //!< queries ended
+};
+
+IncastTestCase::IncastTestCase ()
+  : TestCase ("Incast queries complete with their slowest response"),
+    m_nQueries (0)
+{
+}
+
+IncastTestCase::~IncastTestCase ()
+{
+}
+
+void
+IncastTestCase::Response (uint32_t query, uint32_t flowId, Time fct, uint32_t size)
+{
+  NS_TEST_EXPECT_MSG_EQ (size, 10000, "wrong response size");
+  m_slowest[query] = std::max (m_slowest[query], fct);
+  m_flowIds.push_back (flowId);
+}
+
+void
+IncastTestCase::Query (uint32_t query, Time qct, uint32_t responses)
+{
+  NS_TEST_EXPECT_MSG_EQ (responses, 3, "wrong number of responses");
+  NS_TEST_EXPECT_MSG_EQ (qct, m_slowest[query], "query not completed by its slowest response");
+  m_nQueries++;
+}
+
+void
+IncastTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+  NodeContainer workers;
+  for (uint32_t i = 1; i < 5; i++)
+    {
+      workers.Add (nodes.Get (i));
+    }
+
+  SimpleNetDeviceHelper simple;
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (devices);
+
+  IncastHelper incast ("ns3::TcpSocketFactory", 5000);
+  incast.SetAggregatorAttribute ("FanOut", UintegerValue (3));
+  incast.SetAggregatorAttribute ("MaxQueries", UintegerValue (4));
+  incast.SetAggregatorAttribute ("FlowId", UintegerValue (100));
+  incast.SetAggregatorAttribute ("ResponseSize", StringValue ("ns3::ConstantRandomVariable[Constant=10000]"));
+  incast.SetAggregatorAttribute ("QueryInterval", StringValue ("ns3::ConstantRandomVariable[Constant=0.001]"));
+  ApplicationContainer workerApps = incast.InstallWorkers (workers);
+  workerApps.Start (Seconds (0.5));
+  ApplicationContainer apps = incast.InstallAggregator (nodes.Get (0), workers);
+  apps.Start (Seconds (1.0));
+
+  Ptr<IncastAggregator> aggregator = DynamicCast<IncastAggregator> (apps.Get (0));
+  aggregator->AssignStreams (1);
+  std::ostringstream responses;
+  std::ostringstream queries;
+  aggregator->SetStream (Create<OutputStreamWrapper> (&responses));
+  aggregator->SetQueryStream (Create<OutputStreamWrapper> (&queries));
+  aggregator->TraceConnectWithoutContext ("Response", MakeCallback (&IncastTestCase::Response, this));
+  aggregator->TraceConnectWithoutContext ("Query", MakeCallback (&IncastTestCase::Query, this));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nQueries, 4, "wrong number of queries");
+  NS_TEST_EXPECT_MSG_EQ (aggregator->GetNCompletedQueries (), 4, "wrong number of queries");
+  uint32_t sent = 0;
+  for (uint32_t i = 0; i < workerApps.GetN (); i++)
+    {
+      sent += DynamicCast<IncastWorker> (workerApps.Get (i))->GetNResponses ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (sent, 12, "wrong number of responses sent");
+  std::sort (m_flowIds.begin (), m_flowIds.end ());
+  NS_TEST_ASSERT_MSG_EQ (m_flowIds.size (), 12, "wrong number of responses received");
+  for (uint32_t i = 0; i < m_flowIds.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_flowIds[i], 100 + i, "wrong flow ids");
+    }
+  std::string records = responses.str ();
+  NS_TEST_EXPECT_MSG_EQ (std::count (records.begin (), records.end (), '\n'), 12,
+                         "wrong number of response records");
+  // the queries end in any order
+  std::string queryRecords = "\n" + queries.str ();
+  std::string::size_type pos = queryRecords.find ("\n0,");
+  NS_TEST_ASSERT_MSG_NE (pos, std::string::npos, "no record of query 0");
+  std::string first = queryRecords.substr (pos + 1, queryRecords.find ('\n', pos + 1) - pos - 1);
+  std::ostringstream expected;
+  expected << "0," << m_slowest[0].GetNanoSeconds () << ",1000000000,"
+           << 1000000000 + m_slowest[0].GetNanoSeconds () << ",3,30000,0";
+  NS_TEST_EXPECT_MSG_EQ (first, expected.str (), "wrong query record");
+
+  Simulator::Destroy ();
+}
+
+static class IncastTestSuite : public TestSuite
+{
+public:
+  IncastTestSuite ()
+    : TestSuite ("applications-incast", UNIT)
+  {
+    AddTestCase (new IncastTestCase (), TestCase::QUICK);
+  }
+} g_incastTestSuite;
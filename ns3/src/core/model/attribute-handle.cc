@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "attribute-handle.h"
+#include "object-base.h"
+#include "assert.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup attribute
+ * ns3::AttributeHandle and ns3::TraceSourceHandle implementations.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AttributeHandle");
+
+/**
+ * \param [in] object The object.
+ * \param [in] tid The TypeId a handle was looked up in.
+ * \return true if the object is an instance of tid or of a subclass
+ */
+static bool
+IsInstanceOf (const ObjectBase *object, TypeId tid)
+{
+  TypeId instance = object->GetInstanceTypeId ();
+  return instance == tid || instance.IsChildOf (tid);
+}
+
+AttributeHandleBase::AttributeHandleBase ()
+  : m_flags (0)
+{
+}
+
+AttributeHandleBase::AttributeHandleBase (TypeId tid, const struct TypeId::AttributeInformation &info)
+  : m_tid (tid),
+    m_name (info.name),
+    m_flags (info.flags),
+    m_accessor (info.accessor),
+    m_checker (info.checker)
+{
+  NS_LOG_FUNCTION (this << tid.GetName () << info.name);
+}
+
+bool
+AttributeHandleBase::IsValid (void) const
+{
+  return m_accessor != 0;
+}
+
+std::string
+AttributeHandleBase::GetName (void) const
+{
+  return m_name;
+}
+
+TypeId
+AttributeHandleBase::GetTypeId (void) const
+{
+  return m_tid;
+}
+
+Ptr<const AttributeChecker>
+AttributeHandleBase::GetChecker (void) const
+{
+  return m_checker;
+}
+
+void
+AttributeHandleBase::DoSet (ObjectBase *object, const AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << object << &value);
+  NS_ASSERT_MSG (IsValid (), "Invalid attribute handle");
+  NS_ASSERT_MSG (IsInstanceOf (object, m_tid), "Attribute " << m_name << " of " << m_tid.GetName () <<
+                 " set on a " << object->GetInstanceTypeId ().GetName ());
+  NS_ASSERT_MSG (m_checker->Check (value), "Invalid value for attribute " << m_name);
+  if (!(m_flags & TypeId::ATTR_SET) || !m_accessor->Set (object, value))
+    {
+      NS_FATAL_ERROR ("Attribute name=" << m_name << " could not be set for tid=" << m_tid.GetName ());
+    }
+}
+
+void
+AttributeHandleBase::DoGet (const ObjectBase *object, AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << object << &value);
+  NS_ASSERT_MSG (IsValid (), "Invalid attribute handle");
+  NS_ASSERT_MSG (IsInstanceOf (object, m_tid), "Attribute " << m_name << " of " << m_tid.GetName () <<
+                 " read on a " << object->GetInstanceTypeId ().GetName ());
+  if (!(m_flags & TypeId::ATTR_GET) || !m_accessor->Get (object, value))
+    {
+      NS_FATAL_ERROR ("Attribute name=" << m_name << " could not be read for tid=" << m_tid.GetName ());
+    }
+}
+
+TraceSourceHandle::TraceSourceHandle ()
+{
+}
+
+TraceSourceHandle::TraceSourceHandle (TypeId tid, std::string name, Ptr<const TraceSourceAccessor> accessor)
+  : m_tid (tid),
+    m_name (name),
+    m_accessor (accessor)
+{
+  NS_LOG_FUNCTION (this << tid.GetName () << name);
+}
+
+bool
+TraceSourceHandle::IsValid (void) const
+{
+  return m_accessor != 0;
+}
+
+bool
+TraceSourceHandle::ConnectWithoutContext (ObjectBase *object, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << object);
+  NS_ASSERT_MSG (IsValid (), "Invalid trace source handle");
+  NS_ASSERT_MSG (IsInstanceOf (object, m_tid), "Trace source " << m_name << " of " << m_tid.GetName () <<
+                 " connected on a " << object->GetInstanceTypeId ().GetName ());
+  return m_accessor->ConnectWithoutContext (object, cb);
+}
+
+bool
+TraceSourceHandle::Connect (ObjectBase *object, std::string context, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << object << context);
+  NS_ASSERT_MSG (IsValid (), "Invalid trace source handle");
+  NS_ASSERT_MSG (IsInstanceOf (object, m_tid), "Trace source " << m_name << " of " << m_tid.GetName () <<
+                 " connected on a " << object->GetInstanceTypeId ().GetName ());
+  return m_accessor->Connect (object, context, cb);
+}
+
+bool
+TraceSourceHandle::DisconnectWithoutContext (ObjectBase *object, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << object);
+  NS_ASSERT_MSG (IsValid (), "Invalid trace source handle");
+  return m_accessor->DisconnectWithoutContext (object, cb);
+}
+
+} // namespace ns3
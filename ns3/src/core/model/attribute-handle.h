@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef ATTRIBUTE_HANDLE_H
+#define ATTRIBUTE_HANDLE_H
+
+#include <string>
+#include "type-id.h"
+#include "fatal-error.h"
+
+/**
+ * \file
+ * \ingroup attribute
+ * ns3::AttributeHandle and ns3::TraceSourceHandle declarations.
+ */
+
+namespace ns3 {
+
+class ObjectBase;
+class CallbackBase;
+
+/**
+ * \ingroup attribute
+ *
+ * \brief Untyped part of AttributeHandle.
+ */
+class AttributeHandleBase
+{
+public:
+  /** An invalid handle. */
+  AttributeHandleBase ();
+  /**
+   * \return true if the handle was obtained from a TypeId
+   */
+  bool IsValid (void) const;
+  /**
+   * \return the name of the attribute
+   */
+  std::string GetName (void) const;
+  /**
+   * \return the TypeId the attribute was looked up in
+   */
+  TypeId GetTypeId (void) const;
+  /**
+   * \return the checker of the attribute
+   */
+  Ptr<const AttributeChecker> GetChecker (void) const;
+
+protected:
+  /**
+   * \param [in] tid The TypeId the attribute was looked up in.
+   * \param [in] info The attribute.
+   */
+  AttributeHandleBase (TypeId tid, const struct TypeId::AttributeInformation &info);
+  /**
+   * Set the attribute of an object, aborting on failure.  The value
+   * is only checked in debug builds.
+   *
+   * \param [in] object The object, an instance of GetTypeId () or a subclass.
+   * \param [in] value The value, of the type of the attribute.
+   */
+  void DoSet (ObjectBase *object, const AttributeValue &value) const;
+  /**
+   * Get the attribute of an object, aborting on failure.
+   *
+   * \param [in] object The object, an instance of GetTypeId () or a subclass.
+   * \param [out] value The value, of the type of the attribute.
+   */
+  void DoGet (const ObjectBase *object, AttributeValue &value) const;
+
+private:
+  TypeId m_tid;                             //!< where the attribute was found
+  std::string m_name;                       //!< the attribute name
+  uint32_t m_flags;                         //!< TypeId::AttributeFlag
+  Ptr<const AttributeAccessor> m_accessor;  //!< the attribute accessor
+  Ptr<const AttributeChecker> m_checker;    //!< the attribute checker
+};
+
+/**
+ * \ingroup attribute
+ *
+ * \brief An attribute resolved once, to be set on many objects.
+ *
+ * ObjectBase::SetAttribute looks the attribute up by name and copies
+ * the value through its checker every time.  A handle, obtained once
+ * with TypeId::LookupAttributeHandle, calls the accessor directly: no
+ * string comparison, no heap allocation.
+ *
+ * \code
+ *   static AttributeHandle<UintegerValue> flowSize =
+ *     SendingApp::GetTypeId ().LookupAttributeHandle<UintegerValue> ("FlowSize");
+ *   flowSize.Set (app, UintegerValue (size));
+ * \endcode
+ *
+ * \tparam T \pname{T}Value type of the attribute.
+ */
+template <typename T>
+class AttributeHandle : public AttributeHandleBase
+{
+public:
+  /** An invalid handle. */
+  AttributeHandle ()
+  {
+  }
+  /**
+   * \param [in] tid The TypeId the attribute was looked up in.
+   * \param [in] info The attribute.
+   */
+  AttributeHandle (TypeId tid, const struct TypeId::AttributeInformation &info)
+    : AttributeHandleBase (tid, info)
+  {
+  }
+  /**
+   * \param [in] object The object.
+   * \param [in] value The new value.
+   */
+  void Set (ObjectBase *object, const T &value) const
+  {
+    DoSet (object, value);
+  }
+  /**
+   * \param [in] object The object.
+   * \param [in] value The new value.
+   */
+  template <typename U>
+  void Set (const Ptr<U> &object, const T &value) const
+  {
+    DoSet (PeekPointer (object), value);
+  }
+  /**
+   * \param [in] object The object.
+   * \param [out] value The current value.
+   */
+  void Get (const ObjectBase *object, T &value) const
+  {
+    DoGet (object, value);
+  }
+  /**
+   * \param [in] object The object.
+   * \param [out] value The current value.
+   */
+  template <typename U>
+  void Get (const Ptr<U> &object, T &value) const
+  {
+    DoGet (PeekPointer (object), value);
+  }
+};
+
+/**
+ * \ingroup attribute
+ *
+ * \brief A trace source resolved once, to be connected on many objects.
+ */
+class TraceSourceHandle
+{
+public:
+  /** An invalid handle. */
+  TraceSourceHandle ();
+  /**
+   * \param [in] tid The TypeId the trace source was looked up in.
+   * \param [in] name The trace source name.
+   * \param [in] accessor The trace source accessor.
+   */
+  TraceSourceHandle (TypeId tid, std::string name, Ptr<const TraceSourceAccessor> accessor);
+  /**
+   * \return true if the handle was obtained from a TypeId
+   */
+  bool IsValid (void) const;
+  /**
+   * \param [in] object The object, an instance of the TypeId or a subclass.
+   * \param [in] cb The sink.
+   * \return true on success
+   */
+  bool ConnectWithoutContext (ObjectBase *object, const CallbackBase &cb) const;
+  /**
+   * \param [in] object The object, an instance of the TypeId or a subclass.
+   * \param [in] context The context passed to the sink.
+   * \param [in] cb The sink.
+   * \return true on success
+   */
+  bool Connect (ObjectBase *object, std::string context, const CallbackBase &cb) const;
+  /**
+   * \param [in] object The object.
+   * \param [in] cb The sink.
+   * \return true on success
+   */
+  bool DisconnectWithoutContext (ObjectBase *object, const CallbackBase &cb) const;
+
+private:
+  TypeId m_tid;                               //!< where the trace source was found
+  std::string m_name;                         //!< the trace source name
+  Ptr<const TraceSourceAccessor> m_accessor;  //!< the trace source accessor
+};
+
+/*************************************************************************
+ *  The TypeId implementation which depends on templates
+ *************************************************************************/
+
+template <typename T>
+AttributeHandle<T>
+TypeId::LookupAttributeHandle (std::string name) const
+{
+  struct AttributeInformation info;
+  if (!LookupAttributeByName (name, &info))
+    {
+      NS_FATAL_ERROR ("Attribute name=" << name << " does not exist for tid=" << GetName ());
+    }
+  Ptr<AttributeValue> probe = info.checker->Create ();
+  if (dynamic_cast<T *> (PeekPointer (probe)) == 0)
+    {
+      NS_FATAL_ERROR ("Attribute name=" << name << " of tid=" << GetName () <<
+                      " is a " << info.checker->GetValueTypeName ());
+    }
+  return AttributeHandle<T> (*this, info);
+}
+
+} // namespace ns3
+
+#endif /* ATTRIBUTE_HANDLE_H */
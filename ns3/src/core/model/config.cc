@@ -26,6 +26,8 @@
 #include "pointer.h"
 #include "log.h"
 
+#include <map>
+#include <set>
 #include <sstream>
 
 /**
@@ -166,6 +168,16 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (uint32_t i) const;
+  /**
+   * Enumerate the indices matching the Config Path, when they form
+   * a small finite set.
+   *
+   * \param [in] limit The largest number of indices to enumerate.
+   * \param [in,out] indices The set the matching indices are added to.
+   * \returns \c false if the specification is a wildcard or matches
+   *          more than \p limit indices.
+   */
+  bool GetIndices (uint32_t limit, std::set<uint32_t> *indices) const;
 private:
   /**
    * Convert a string to an \c uint32_t.
@@ -249,6 +261,56 @@ ArrayMatcher::Matches (uint32_t i) const
   return false;
 }
 
+bool
+ArrayMatcher::GetIndices (uint32_t limit, std::set<uint32_t> *indices) const
+{
+  NS_LOG_FUNCTION (this << limit << indices);
+  if (m_element == "*")
+    {
+      return false;
+    }
+  std::string::size_type tmp;
+  tmp = m_element.find ("|");
+  if (tmp != std::string::npos)
+    {
+      std::string left = m_element.substr (0, tmp-0);
+      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
+      return ArrayMatcher (left).GetIndices (limit, indices) &&
+             ArrayMatcher (right).GetIndices (limit, indices);
+    }
+  std::string::size_type leftBracket = m_element.find ("[");
+  std::string::size_type rightBracket = m_element.find ("]");
+  std::string::size_type dash = m_element.find ("-");
+  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+      dash > leftBracket && dash < rightBracket)
+    {
+      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      uint32_t min;
+      uint32_t max;
+      if (StringToUint32 (lowerBound, &min) && 
+          StringToUint32 (upperBound, &max) &&
+          min <= max)
+        {
+          if (max - min >= limit)
+            {
+              return false;
+            }
+          for (uint32_t i = 0; i <= max - min; i++)
+            {
+              indices->insert (min + i);
+            }
+        }
+      return indices->size () <= limit;
+    }
+  uint32_t value;
+  if (StringToUint32 (m_element, &value))
+    {
+      indices->insert (value);
+    }
+  return indices->size () <= limit;
+}
+
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 {
@@ -259,6 +321,44 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * A Config path split into its elements once, so that repeated lookups
+ * of the same path do not parse it again.
+ */
+struct CompiledPath
+{
+  /** One element of the path. */
+  struct Element
+  {
+    std::string item;   //!< The path element.
+    bool getObject;     //!< The element is a $TypeId.
+    bool tidFound;      //!< The TypeId of a $TypeId element is registered.
+    TypeId tid;         //!< The TypeId of a $TypeId element.
+  };
+  /** The elements of the path. */
+  std::vector<Element> elements;
+};
+
+/**
+ * An attribute through which a path element continues to the next
+ * objects: a Pointer or an ObjectPtrContainer attribute.
+ */
+struct PathLink
+{
+  std::string name;                             //!< The attribute name.
+  Ptr<const AttributeAccessor> accessor;        //!< The attribute accessor.
+  /** The accessor of an ObjectPtrContainer attribute, if it has the standard one. */
+  const ObjectPtrContainerAccessor *container;
+  bool pointer;                                 //!< A Pointer attribute, else a container.
+};
+
+/**
+ * The PathLinks of each (instance TypeId uid, path element) pair, shared by
+ * all the lookups so that the attributes of a TypeId and of its parents
+ * are searched once per element name rather than once per object.
+ */
+typedef std::map<std::pair<uint16_t, std::string>, std::vector<PathLink> > PathLinkIndex;
+
 /**
  * Abstract class to parse Config paths into object references.
  */
@@ -266,11 +366,12 @@ class Resolver
 {
 public:
   /**
-   * Construct from a base Config path.
+   * Construct from a compiled Config path.
    *
    * \param [in] path The Config path.
+   * \param [in] links The attribute index to use and extend.
    */
-  Resolver (std::string path);
+  Resolver (const CompiledPath &path, PathLinkIndex *links);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -284,23 +385,33 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] element The index of the next element of the Config path.
    * \param [in] root The object corresponding to the current positon
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (uint32_t element, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * When the element names a few indices of a container whose indices
+   * are its positions, only those are fetched from the container.
+   *
+   * \param [in] element The index of the array element of the Config path.
+   * \param [in] root The object holding the container.
+   * \param [in] link The container attribute.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (uint32_t element, Ptr<Object> root, const PathLink &link);
+  /**
+   * Get the attributes of a TypeId through which a path element continues.
+   *
+   * \param [in] tid The instance TypeId of the current object.
+   * \param [in] item The path element.
+   * \returns The matching Pointer and ObjectPtrContainer attributes.
+   */
+  const std::vector<PathLink> &GetLinks (TypeId tid, const std::string &item);
   /**
    * Handle one object found on the path.
    *
@@ -324,45 +435,28 @@ private:
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
   /** The Config path. */
-  std::string m_path;
+  const CompiledPath &m_path;
+  /** The attribute index. */
+  PathLinkIndex *m_links;
 };
 
-Resolver::Resolver (std::string path)
-  : m_path (path)
+Resolver::Resolver (const CompiledPath &path, PathLinkIndex *links)
+  : m_path (path),
+    m_links (links)
 {
-  NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  NS_LOG_FUNCTION (this << &path << links);
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
-void
-Resolver::Canonicalize (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
-  if (tmp != 0)
-    {
-      // no slash at start
-      m_path = "/" + m_path;
-    }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
-    {
-      // no slash at end
-      m_path = m_path + "/";
-    }
-}
 
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -387,14 +481,58 @@ Resolver::DoResolveOne (Ptr<Object> object)
   DoOne (object, GetResolvedPath ());
 }
 
+const std::vector<PathLink> &
+Resolver::GetLinks (TypeId tid, const std::string &item)
+{
+  NS_LOG_FUNCTION (this << tid << item);
+  std::pair<uint16_t, std::string> key (tid.GetUid (), item);
+  PathLinkIndex::const_iterator found = m_links->find (key);
+  if (found != m_links->end ())
+    {
+      return found->second;
+    }
+  std::vector<PathLink> &links = (*m_links)[key];
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute (i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          PathLink link;
+          link.name = info.name;
+          link.accessor = info.accessor;
+          link.container = dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (info.accessor));
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              link.pointer = true;
+              links.push_back (link);
+            }
+          if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              link.pointer = false;
+              links.push_back (link);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    }
+  while (nextTid != tid);
+  return links;
+}
+
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t element, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << element << root);
 
-  if (next == std::string::npos)
+  if (element == m_path.elements.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -410,8 +548,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const CompiledPath::Element &current = m_path.elements[element];
+  const std::string &item = current.item;
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -422,11 +560,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (element + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -443,7 +580,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (element + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -459,13 +596,12 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (current.getObject)
     {
       // This is a call to GetObject
       std::string tidString = item.substr (1, item.size () - 1);
       NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      TypeId tid = current.tidFound ? current.tid : TypeId::LookupByName (tidString);
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
@@ -473,68 +609,44 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (element + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
+      const std::vector<PathLink> &links = GetLinks (root->GetInstanceTypeId (), item);
       bool foundMatch = false;
-      
-      do
+      for (std::vector<PathLink>::const_iterator i = links.begin (); i != links.end (); ++i)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (i->pointer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<i->name<<" on path="<<GetResolvedPath ());
+              PointerValue ptr;
+              i->accessor->Get (PeekPointer (root), ptr);
+              Ptr<Object> object = ptr.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              foundMatch = true;
+              m_workStack.push_back (i->name);
+              DoResolve (element + 1, object);
+              m_workStack.pop_back ();
+            }
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<i->name<<" on path="<<GetResolvedPath ());
+              foundMatch = true;
+              m_workStack.push_back (i->name);
+              DoArrayResolve (element + 1, root, *i);
+              m_workStack.pop_back ();
             }
+        }
 
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
-      
       if (!foundMatch)
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
@@ -544,20 +656,42 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (uint32_t element, Ptr<Object> root, const PathLink &link)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << element << root << link.name);
+  if (element == m_path.elements.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+  ArrayMatcher matcher = ArrayMatcher (m_path.elements[element].item);
+  uint32_t n;
+  std::set<uint32_t> indices;
+  if (link.container != 0 && link.container->GetN (PeekPointer (root), &n) &&
+      n > 0 && matcher.GetIndices (n, &indices))
+    {
+      // the indices of a container are its positions when the last
+      // one is n - 1: fetch only the requested objects
+      uint32_t last;
+      link.container->Get (PeekPointer (root), n - 1, &last);
+      if (last == n - 1)
+        {
+          for (std::set<uint32_t>::const_iterator i = indices.begin (); i != indices.end () && *i < n; ++i)
+            {
+              uint32_t index;
+              Ptr<Object> object = link.container->Get (PeekPointer (root), *i, &index);
+              std::ostringstream oss;
+              oss << index;
+              m_workStack.push_back (oss.str ());
+              DoResolve (element + 1, object);
+              m_workStack.pop_back ();
+            }
+          return;
+        }
+    }
+
+  ObjectPtrContainerValue container;
+  link.accessor->Get (PeekPointer (root), container);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -566,7 +700,7 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (element + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
@@ -588,6 +722,13 @@ public:
   void Disconnect (std::string path, const CallbackBase &cb);
   /** \copydoc Config::LookupMatches() */
   Config::MatchContainer LookupMatches (std::string path);
+  /**
+   * Connect a list of sinks, resolving each distinct path only once.
+   *
+   * \param [in] connections The paths and sinks.
+   * \param [in] context Whether the sinks take a context argument.
+   */
+  void ConnectList (const Config::ConnectionList &connections, bool context);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -608,12 +749,29 @@ private:
    * \param [in,out] leaf The trailing part of the \p path.
    */
   void ParsePath (std::string path, std::string *root, std::string *leaf) const;
+  /**
+   * Get the compiled form of a Config path.
+   * \param [in] path The Config path.
+   * \returns The path split into its elements.
+   */
+  const CompiledPath &Compile (std::string path);
 
   /** Container type to hold the root Config path tokens. */
   typedef std::vector<Ptr<Object> > Roots;
+  /** Container type to hold the compiled paths. */
+  typedef std::map<std::string, CompiledPath> CompiledPaths;
+  /** Container type to hold the matches of the paths of a ConnectList. */
+  typedef std::map<std::string, Config::MatchContainer> Matches;
+
+  /** The largest number of compiled paths kept. */
+  static const uint32_t MAX_COMPILED_PATHS = 4096;
 
   /** The list of Config path roots. */
   Roots m_roots;
+  /** The compiled paths. */
+  CompiledPaths m_paths;
+  /** The attributes followed by the path elements. */
+  PathLinkIndex m_links;
 };
 
 void 
@@ -677,15 +835,58 @@ ConfigImpl::Disconnect (std::string path, const CallbackBase &cb)
   container.Disconnect (leaf, cb);
 }
 
+const CompiledPath &
+ConfigImpl::Compile (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  CompiledPaths::const_iterator found = m_paths.find (path);
+  if (found != m_paths.end ())
+    {
+      return found->second;
+    }
+  if (m_paths.size () >= MAX_COMPILED_PATHS)
+    {
+      m_paths.clear ();
+    }
+
+  // ensure that we start and end with a '/'
+  std::string canonical = path;
+  if (canonical.find ("/") != 0)
+    {
+      canonical = "/" + canonical;
+    }
+  if (canonical.find_last_of ("/") != canonical.size () - 1)
+    {
+      canonical = canonical + "/";
+    }
+
+  CompiledPath &compiled = m_paths[path];
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = canonical.find ("/", start)) != std::string::npos)
+    {
+      CompiledPath::Element element;
+      element.item = canonical.substr (start, next - start);
+      element.getObject = element.item.find ("$") == 0;
+      element.tidFound = element.getObject &&
+        TypeId::LookupByNameFailSafe (element.item.substr (1, element.item.size () - 1), &element.tid);
+      compiled.elements.push_back (element);
+      start = next + 1;
+    }
+  return compiled;
+}
+
 Config::MatchContainer 
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
+    LookupMatchesResolver (const CompiledPath &path, PathLinkIndex *links)
+      : Resolver (path, links)
     {}
     virtual void DoOne (Ptr<Object> object, std::string path) {
       m_objects.push_back (object);
@@ -693,7 +894,7 @@ ConfigImpl::LookupMatches (std::string path)
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  } resolver = LookupMatchesResolver (Compile (path), &m_links);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -709,6 +910,34 @@ ConfigImpl::LookupMatches (std::string path)
   return Config::MatchContainer (resolver.m_objects, resolver.m_contexts, path);
 }
 
+void
+ConfigImpl::ConnectList (const Config::ConnectionList &connections, bool context)
+{
+  NS_LOG_FUNCTION (this << &connections << context);
+
+  // keep the matches of every path for the whole list, even if a
+  // connection changes the object graph
+  Matches matches;
+  for (Config::ConnectionList::const_iterator i = connections.begin (); i != connections.end (); ++i)
+    {
+      std::string root, leaf;
+      ParsePath (i->first, &root, &leaf);
+      Matches::iterator container = matches.find (root);
+      if (container == matches.end ())
+        {
+          container = matches.insert (std::make_pair (root, LookupMatches (root))).first;
+        }
+      if (context)
+        {
+          container->second.Connect (leaf, i->second);
+        }
+      else
+        {
+          container->second.ConnectWithoutContext (leaf, i->second);
+        }
+    }
+}
+
 void 
 ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
@@ -843,6 +1072,18 @@ Disconnect (std::string path, const CallbackBase &cb)
   NS_LOG_FUNCTION (path << &cb);
   ConfigImpl::Get ()->Disconnect (path, cb);
 }
+void
+Connect (const ConnectionList &connections)
+{
+  NS_LOG_FUNCTION (&connections);
+  ConfigImpl::Get ()->ConnectList (connections, true);
+}
+void
+ConnectWithoutContext (const ConnectionList &connections)
+{
+  NS_LOG_FUNCTION (&connections);
+  ConfigImpl::Get ()->ConnectList (connections, false);
+}
 Config::MatchContainer LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (path);
@@ -22,6 +22,7 @@
 
 #include "ptr.h"
 #include <string>
+#include <utility>
 #include <vector>
 
 /**
@@ -140,6 +141,30 @@ void Connect (std::string path, const CallbackBase &cb);
  */
 void Disconnect (std::string path, const CallbackBase &cb);
 
+/**
+ * \ingroup config
+ * A list of trace source paths, each with the callback to connect to it.
+ */
+typedef std::vector<std::pair<std::string, CallbackBase> > ConnectionList;
+/**
+ * \ingroup config
+ * \param [in] connections The paths and callbacks to connect.
+ *
+ * Equivalent to calling Config::Connect on every element of the list,
+ * but the objects matched by each distinct path, up to the trace source
+ * name, are looked up only once for the whole list.
+ */
+void Connect (const ConnectionList &connections);
+/**
+ * \ingroup config
+ * \param [in] connections The paths and callbacks to connect.
+ *
+ * Equivalent to calling Config::ConnectWithoutContext on every element
+ * of the list, but the objects matched by each distinct path, up to the
+ * trace source name, are looked up only once for the whole list.
+ */
+void ConnectWithoutContext (const ConnectionList &connections);
+
 /**
  * \ingroup config
  * \brief hold a set of objects which match a specific search string.
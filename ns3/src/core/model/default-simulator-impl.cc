@@ -22,6 +22,7 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
@@ -146,6 +147,9 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
+#ifdef ENABLE_PROFILING
+  Profiler::CountEvent (next.impl, next.key.m_context);
+#endif
   next.impl->Invoke ();
   next.impl->Unref ();
 
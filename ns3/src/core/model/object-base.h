@@ -21,6 +21,7 @@
 #define OBJECT_BASE_H
 
 #include "type-id.h"
+#include "attribute-handle.h"
 #include "callback.h"
 #include <string>
 #include <list>
@@ -79,6 +79,17 @@ public:
    * \param [in] value The value of the attribute to set.
    */
   void Set (std::string name, const AttributeValue &value);
+  /**
+   * Set an attribute to be set during construction, without looking
+   * it up by name.
+   *
+   * \tparam T \pname{T}Value type of the attribute.
+   * \param [in] handle The attribute, of the TypeId of this factory or
+   *   of one of its parents.
+   * \param [in] value The value of the attribute to set.
+   */
+  template <typename T>
+  void Set (const AttributeHandle<T> &handle, const T &value);
 
   /**
    * Get the TypeId which will be created by this ObjectFactory.
@@ -201,6 +212,16 @@ ObjectFactory::Create (void) const
   return object->GetObject<T> ();
 }
 
+template <typename T>
+void
+ObjectFactory::Set (const AttributeHandle<T> &handle, const T &value)
+{
+  NS_ASSERT_MSG (m_tid == handle.GetTypeId () || m_tid.IsChildOf (handle.GetTypeId ()),
+                 "Attribute " << handle.GetName () << " of " << handle.GetTypeId ().GetName () <<
+                 " set on a factory of " << m_tid.GetName ());
+  m_parameters.Add (handle.GetName (), handle.GetChecker (), value.Copy ());
+}
+
 template <typename T>
 Ptr<T> 
 CreateObjectWithAttributes (std::string n1, const AttributeValue & v1,
@@ -0,0 +1,331 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::Profiler implementation.
+ */
+
+#include "profiler.h"
+#include "event-impl.h"
+#include "global-value.h"
+#include "string.h"
+#include "system-mutex.h"
+#include "log.h"
+
+#include <chrono>
+#include <cxxabi.h>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <typeinfo>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Profiler");
+
+/**
+ * \ingroup simulator
+ * The file the profiling report is written to at Simulator::Destroy.
+ */
+static GlobalValue g_profilingReport = GlobalValue
+  ("ProfilingReport",
+   "File to write the profiling report to at Simulator::Destroy, \"-\" for "
+   "standard output, empty to disable. Requires --enable-profiling.",
+   StringValue (""),
+   MakeStringChecker ());
+
+namespace {
+
+/** Samples of a counter or timer. */
+struct Slot
+{
+  uint64_t count;   //!< Number of samples.
+  uint64_t ns;      //!< Accumulated wall clock time.
+};
+
+/** Samples collected by a single thread. */
+struct ThreadData
+{
+  std::vector<Slot> slots;                                //!< Indexed by Profiler::Id.
+  std::map<const std::type_info *, uint64_t> events;      //!< Events per EventImpl type.
+  std::vector<uint64_t> nodeEvents;                       //!< Events per context.
+  uint64_t noContextEvents;                               //!< Events without a context.
+};
+
+/** \returns The mutex protecting the registry. */
+SystemMutex &
+GetMutex (void)
+{
+  static SystemMutex mutex;
+  return mutex;
+}
+
+/** \returns The registered names, indexed by Profiler::Id. */
+std::vector<std::string> &
+GetNames (void)
+{
+  static std::vector<std::string> names;
+  return names;
+}
+
+/**
+ * \returns The data of every thread that recorded samples. Thread data is
+ * never released, so samples of threads which already exited still show up
+ * in the report.
+ */
+std::vector<ThreadData *> &
+GetThreads (void)
+{
+  static std::vector<ThreadData *> threads;
+  return threads;
+}
+
+/** \returns The data of the calling thread. */
+ThreadData *
+GetThreadData (void)
+{
+  static thread_local ThreadData *data = 0;
+  if (data == 0)
+    {
+      data = new ThreadData ();
+      data->noContextEvents = 0;
+      CriticalSection cs (GetMutex ());
+      GetThreads ().push_back (data);
+    }
+  return data;
+}
+
+/**
+ * \param [in] data The thread data.
+ * \param [in] id The counter or timer id.
+ * \returns The slot of the counter or timer.
+ */
+Slot &
+GetSlot (ThreadData *data, Profiler::Id id)
+{
+  if (id >= data->slots.size ())
+    {
+      Slot empty = { 0, 0 };
+      data->slots.resize (id + 1, empty);
+    }
+  return data->slots[id];
+}
+
+/**
+ * \param [in] mangled A mangled C++ type name.
+ * \returns The demangled name.
+ */
+std::string
+Demangle (const char *mangled)
+{
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, 0, 0, &status);
+  std::string ret = (status == 0) ? demangled : mangled;
+  std::free (demangled);
+  return ret;
+}
+
+/**
+ * Print a table sorted by decreasing count.
+ * \param [in] os The output stream.
+ * \param [in] rows The rows, mapping the row name to its count.
+ */
+void
+PrintByCount (std::ostream &os, const std::map<std::string, uint64_t> &rows)
+{
+  std::multimap<uint64_t, std::string> sorted;
+  for (std::map<std::string, uint64_t>::const_iterator i = rows.begin (); i != rows.end (); ++i)
+    {
+      sorted.insert (std::make_pair (i->second, i->first));
+    }
+  for (std::multimap<uint64_t, std::string>::const_reverse_iterator i = sorted.rbegin (); i != sorted.rend (); ++i)
+    {
+      os << "  " << std::setw (14) << i->first << "  " << i->second << std::endl;
+    }
+}
+
+} // anonymous namespace
+
+Profiler::Id
+Profiler::Register (const std::string &name)
+{
+  CriticalSection cs (GetMutex ());
+  std::vector<std::string> &names = GetNames ();
+  for (Id id = 0; id < names.size (); ++id)
+    {
+      if (names[id] == name)
+        {
+          return id;
+        }
+    }
+  names.push_back (name);
+  return names.size () - 1;
+}
+
+void
+Profiler::Count (Id id)
+{
+  GetSlot (GetThreadData (), id).count++;
+}
+
+void
+Profiler::AddTime (Id id, uint64_t ns)
+{
+  Slot &slot = GetSlot (GetThreadData (), id);
+  slot.count++;
+  slot.ns += ns;
+}
+
+void
+Profiler::CountEvent (const EventImpl *event, uint32_t context)
+{
+  ThreadData *data = GetThreadData ();
+  data->events[&typeid (*event)]++;
+  if (context == 0xffffffff)
+    {
+      data->noContextEvents++;
+      return;
+    }
+  if (context >= data->nodeEvents.size ())
+    {
+      data->nodeEvents.resize (context + 1, 0);
+    }
+  data->nodeEvents[context]++;
+}
+
+uint64_t
+Profiler::GetWallTime (void)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+           (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
+
+void
+Profiler::Report (std::ostream &os)
+{
+  CriticalSection cs (GetMutex ());
+  const std::vector<std::string> &names = GetNames ();
+  const std::vector<ThreadData *> &threads = GetThreads ();
+
+  std::vector<Slot> slots (names.size ());
+  std::map<std::string, uint64_t> events;
+  std::vector<uint64_t> nodeEvents;
+  uint64_t noContextEvents = 0;
+  for (std::vector<ThreadData *>::const_iterator t = threads.begin (); t != threads.end (); ++t)
+    {
+      for (Id id = 0; id < (*t)->slots.size (); ++id)
+        {
+          slots[id].count += (*t)->slots[id].count;
+          slots[id].ns += (*t)->slots[id].ns;
+        }
+      for (std::map<const std::type_info *, uint64_t>::const_iterator e = (*t)->events.begin ();
+           e != (*t)->events.end (); ++e)
+        {
+          events[Demangle (e->first->name ())] += e->second;
+        }
+      if ((*t)->nodeEvents.size () > nodeEvents.size ())
+        {
+          nodeEvents.resize ((*t)->nodeEvents.size (), 0);
+        }
+      for (uint32_t n = 0; n < (*t)->nodeEvents.size (); ++n)
+        {
+          nodeEvents[n] += (*t)->nodeEvents[n];
+        }
+      noContextEvents += (*t)->noContextEvents;
+    }
+
+  std::ios::fmtflags flags = os.flags ();
+  os << "Counters and timers (" << threads.size () << " threads)" << std::endl;
+  os << "  " << std::setw (14) << "count" << "  " << std::setw (12) << "total (ms)"
+     << "  " << std::setw (10) << "mean (ns)" << "  name" << std::endl;
+  for (Id id = 0; id < names.size (); ++id)
+    {
+      os << "  " << std::setw (14) << slots[id].count << "  ";
+      if (slots[id].ns > 0)
+        {
+          os << std::setw (12) << std::fixed << std::setprecision (3) << slots[id].ns / 1e6
+             << "  " << std::setw (10) << std::setprecision (1)
+             << static_cast<double> (slots[id].ns) / slots[id].count;
+        }
+      else
+        {
+          os << std::setw (12) << "-" << "  " << std::setw (10) << "-";
+        }
+      os << "  " << names[id] << std::endl;
+    }
+
+  os << "Events by type" << std::endl;
+  PrintByCount (os, events);
+
+  os << "Events by node" << std::endl;
+  std::map<std::string, uint64_t> nodes;
+  for (uint32_t n = 0; n < nodeEvents.size (); ++n)
+    {
+      if (nodeEvents[n] > 0)
+        {
+          std::ostringstream oss;
+          oss << "node " << n;
+          nodes[oss.str ()] = nodeEvents[n];
+        }
+    }
+  if (noContextEvents > 0)
+    {
+      nodes["no context"] = noContextEvents;
+    }
+  PrintByCount (os, nodes);
+  os.flags (flags);
+}
+
+void
+Profiler::ReportAndReset (void)
+{
+  StringValue file;
+  g_profilingReport.GetValue (file);
+  if (file.Get () == "-")
+    {
+      Report (std::cout);
+    }
+  else if (file.Get () != "")
+    {
+      std::ofstream os (file.Get ().c_str ());
+      if (os.is_open ())
+        {
+          Report (os);
+        }
+      else
+        {
+          NS_LOG_WARN ("Cannot open profiling report file " << file.Get ());
+        }
+    }
+
+  CriticalSection cs (GetMutex ());
+  std::vector<ThreadData *> &threads = GetThreads ();
+  for (std::vector<ThreadData *>::iterator t = threads.begin (); t != threads.end (); ++t)
+    {
+      (*t)->slots.clear ();
+      (*t)->events.clear ();
+      (*t)->nodeEvents.clear ();
+      (*t)->noContextEvents = 0;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::Profiler declaration and the NS_PROFILE_* macros.
+ */
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * @ingroup simulator
+ *
+ * @brief Hot-path counters and timers for attributing run time to subsystems.
+ *
+ * The profiler keeps named counters and scoped timers, plus the number of
+ * events executed per EventImpl type and per node (simulation context).
+ * Samples are accumulated in thread-local storage without locking; the
+ * per-thread tables are only merged when the report is written.
+ *
+ * Instrumentation points use the NS_PROFILE_COUNT and NS_PROFILE_SCOPE
+ * macros, which expand to nothing unless the profiler is enabled at
+ * configure time, so optimized builds without it pay nothing:
+ * \verbatim
+   $ waf configure ... --enable-profiling \endverbatim
+ *
+ * When enabled, the report is written by Simulator::Destroy to the file
+ * named by the \c ProfilingReport global value ("-" for standard output),
+ * e.g. with \c --ProfilingReport=profile.txt on the command line.
+ */
+class Profiler
+{
+public:
+  /** Identifier of a registered counter or timer. */
+  typedef uint32_t Id;
+
+  /**
+   * Register a counter or timer name.
+   *
+   * Registering the same name twice returns the same id.
+   *
+   * \param [in] name The name shown in the report.
+   * \returns The id to use for Count and AddTime.
+   */
+  static Id Register (const std::string &name);
+
+  /**
+   * Increment a counter.
+   * \param [in] id The counter id.
+   */
+  static void Count (Id id);
+
+  /**
+   * Account one timed invocation.
+   * \param [in] id The timer id.
+   * \param [in] ns The wall clock time spent, in nanoseconds.
+   */
+  static void AddTime (Id id, uint64_t ns);
+
+  /**
+   * Account one executed event.
+   * \param [in] event The event being executed.
+   * \param [in] context The context (node id) of the event.
+   */
+  static void CountEvent (const EventImpl *event, uint32_t context);
+
+  /** \returns The current wall clock time, in nanoseconds. */
+  static uint64_t GetWallTime (void);
+
+  /**
+   * Merge the samples of all threads and write the report.
+   * \param [in] os The output stream.
+   */
+  static void Report (std::ostream &os);
+
+  /**
+   * Write the report if requested by the \c ProfilingReport global value,
+   * then clear all samples.
+   */
+  static void ReportAndReset (void);
+
+  /**
+   * Times the enclosing scope and accounts it to a timer.
+   */
+  class Scope
+  {
+  public:
+    /**
+     * Start timing.
+     * \param [in] id The timer id.
+     */
+    Scope (Id id)
+      : m_id (id),
+        m_start (GetWallTime ())
+    {
+    }
+    /** Stop timing. */
+    ~Scope ()
+    {
+      AddTime (m_id, GetWallTime () - m_start);
+    }
+  private:
+    Id m_id;            //!< The timer id.
+    uint64_t m_start;   //!< The start of the scope, in nanoseconds.
+  };
+};
+
+} // namespace ns3
+
+
+#ifdef ENABLE_PROFILING
+
+/** Concatenate two tokens after expanding them. */
+#define NS_PROFILE_CAT_(a, b) a ## b
+/** Concatenate two tokens after expanding them. */
+#define NS_PROFILE_CAT(a, b) NS_PROFILE_CAT_ (a, b)
+
+/**
+ * @ingroup simulator
+ * Increment the counter named \p name (a string literal).
+ */
+#define NS_PROFILE_COUNT(name)                                          \
+  do                                                                    \
+    {                                                                   \
+      static ns3::Profiler::Id ns3ProfileId = ns3::Profiler::Register (name); \
+      ns3::Profiler::Count (ns3ProfileId);                              \
+    }                                                                   \
+  while (false)
+
+/**
+ * @ingroup simulator
+ * Time the rest of the enclosing scope with the timer named \p name
+ * (a string literal).
+ */
+#define NS_PROFILE_SCOPE(name)                                          \
+  static ns3::Profiler::Id NS_PROFILE_CAT (ns3ProfileId, __LINE__) =    \
+    ns3::Profiler::Register (name);                                     \
+  ns3::Profiler::Scope NS_PROFILE_CAT (ns3ProfileScope, __LINE__)       \
+    (NS_PROFILE_CAT (ns3ProfileId, __LINE__))
+
+/**
+ * @ingroup simulator
+ * Time the rest of the enclosing scope with the timer \p id, obtained
+ * from Profiler::Register.
+ */
+#define NS_PROFILE_SCOPE_ID(id)                                         \
+  ns3::Profiler::Scope NS_PROFILE_CAT (ns3ProfileScope, __LINE__) (id)
+
+#else /* ENABLE_PROFILING */
+
+#define NS_PROFILE_COUNT(name)
+#define NS_PROFILE_SCOPE(name)
+#define NS_PROFILE_SCOPE_ID(id)
+
+#endif /* ENABLE_PROFILING */
+
+#endif /* PROFILER_H */
@@ -109,7 +109,8 @@ RandomVariableStream::SetStream (int64_t stream)
       NS_ASSERT(nextStream <= ((1ULL)<<63));
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              nextStream,
-                             RngSeedManager::GetRun ());
+                             RngSeedManager::GetRun (),
+                             RngSeedManager::GetType ());
     }
   else
     {
@@ -119,7 +120,8 @@ RandomVariableStream::SetStream (int64_t stream)
       uint64_t target = base + stream;
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              target,
-                             RngSeedManager::GetRun ());
+                             RngSeedManager::GetRun (),
+                             RngSeedManager::GetType ());
     }
   m_stream = stream;
 }
@@ -21,6 +21,7 @@
 #define RNG_SEED_MANAGER_H
 
 #include <stdint.h>
+#include "rng-stream.h"
 
 /**
  * \file
@@ -98,6 +99,19 @@ public:
    * \see SetRun
    */
   static uint64_t GetRun (void);
+  /**
+   * \brief Set the generator of all subsequently instantiated
+   * RandomVariableStream objects.
+   *
+   * This is accessible as "--RngType=Philox" from CommandLine.
+   * \param [in] type The generator.
+   */
+  static void SetType (RngStream::Type type);
+  /**
+   * \brief Get the generator of the new RandomVariableStream objects.
+   * \returns The generator.
+   */
+  static RngStream::Type GetType (void);
 
   /**
    * Get the next automatically assigned stream index.
@@ -328,6 +328,18 @@ void PowerOfTwoMatrix (int n, Matrix a1p, Matrix a2p)
     }
 }
 
+/// \ingroup rngimpl
+/// Philox4x32 round multipliers.
+const uint32_t philoxM0 = 0xD2511F53;
+const uint32_t philoxM1 = 0xCD9E8D57;
+/// \ingroup rngimpl
+/// Philox4x32 key increments (golden ratio and sqrt(3) - 1).
+const uint32_t philoxW0 = 0x9E3779B9;
+const uint32_t philoxW1 = 0xBB67AE85;
+/// \ingroup rngimpl
+/// 2^-53, to map 53 random bits to a double.
+const double twoM53 = 1.0 / 9007199254740992.0;
+
 } // end of anonymous namespace
 
 
@@ -337,6 +349,15 @@ namespace ns3 {
 //
 double RngStream::RandU01 ()
 {
+  if (m_type == PHILOX)
+    {
+      if (m_next == PHILOX_BATCH)
+        {
+          PhiloxFill ();
+        }
+      return m_batch[m_next++];
+    }
+
   int32_t k;
   double p1, p2, u;
 
@@ -366,8 +387,21 @@ double RngStream::RandU01 ()
   return u;
 }
 
-RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
+RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream, Type type)
+  : m_type (type)
 {
+  if (type == PHILOX)
+    {
+      // no state to advance: the stream and substream select the counter and key
+      m_key[0] = seedNumber;
+      m_key[1] = substream;
+      m_counter[0] = 0;
+      m_counter[1] = 0;
+      m_counter[2] = stream;
+      m_counter[3] = stream >> 32;
+      m_next = PHILOX_BATCH;
+      return;
+    }
   if (seedNumber >= m1 || seedNumber >= m2 || seedNumber == 0)
     {
       NS_FATAL_ERROR ("invalid Seed " << seedNumber);
@@ -381,11 +415,78 @@ RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
 }
 
 RngStream::RngStream(const RngStream& r)
+  : m_type (r.m_type),
+    m_next (r.m_next)
 {
   for (int i = 0; i < 6; ++i)
     {
       m_currentState[i] = r.m_currentState[i];
     }
+  for (int i = 0; i < 2; ++i)
+    {
+      m_key[i] = r.m_key[i];
+    }
+  for (int i = 0; i < 4; ++i)
+    {
+      m_counter[i] = r.m_counter[i];
+    }
+  for (uint32_t i = 0; i < PHILOX_BATCH; ++i)
+    {
+      m_batch[i] = r.m_batch[i];
+    }
+}
+
+void
+RngStream::PhiloxBlock (const uint32_t counter[4], const uint32_t key[2], uint32_t out[4])
+{
+  uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  uint32_t k0 = key[0], k1 = key[1];
+  for (int round = 0; round < 10; ++round)
+    {
+      uint64_t p0 = (uint64_t)philoxM0 * c0;
+      uint64_t p1 = (uint64_t)philoxM1 * c2;
+      uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+      uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+      c0 = n0;
+      c1 = (uint32_t)p1;
+      c2 = n2;
+      c3 = (uint32_t)p0;
+      k0 += philoxW0;
+      k1 += philoxW1;
+    }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+void
+RngStream::PhiloxFill (void)
+{
+  // each block gives two values of 53 bits, the blocks are independent
+  uint32_t words[PHILOX_BATCH * 2];
+  for (uint32_t b = 0; b < PHILOX_BATCH / 2; ++b)
+    {
+      uint32_t counter[4] = { m_counter[0] + b, m_counter[1], m_counter[2], m_counter[3] };
+      if (counter[0] < m_counter[0])
+        {
+          counter[1]++;
+        }
+      PhiloxBlock (counter, m_key, &words[4 * b]);
+    }
+  uint32_t low = m_counter[0];
+  m_counter[0] += PHILOX_BATCH / 2;
+  if (m_counter[0] < low)
+    {
+      m_counter[1]++;
+    }
+  for (uint32_t i = 0; i < PHILOX_BATCH; ++i)
+    {
+      uint64_t bits = ((uint64_t)words[2 * i] << 32) | words[2 * i + 1];
+      // the centre of one of 2^53 intervals, never 0 or 1
+      m_batch[i] = ((bits >> 11) + 0.5) * twoM53;
+    }
+  m_next = 0;
 }
 
 void 
@@ -45,18 +45,35 @@ namespace ns3 {
  * holds a static instance of this class.  The details of this
  * class are explained in:
  * http://www.iro.umontreal.ca/~lecuyer/myftp/papers/streams00.pdf
+ *
+ * Alternatively, the stream can use the counter-based generator
+ * Philox4x32-10 described in:
+ * J. K. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3",
+ * SC 2011.  The key is made of the seed and the substream, the upper
+ * half of the counter is the stream and the lower half the position in
+ * the stream, so a stream is created in constant time and its values
+ * only depend on (seed, stream, substream).  Values are generated by
+ * batches of PHILOX_BATCH.
  */
 class RngStream
 {
 public:
+  /** The underlying generator. */
+  enum Type
+  {
+    MRG32K3A,   //!< Combined multiple-recursive generator
+    PHILOX      //!< Counter-based Philox4x32-10
+  };
+
   /**
    * Construct from explicit seed, stream and substream values.
    *
    * \param [in] seed The starting seed.
    * \param [in] stream The stream number.
    * \param [in] substream The sub-stream number.
+   * \param [in] type The generator.
    */
-  RngStream (uint32_t seed, uint64_t stream, uint64_t substream);
+  RngStream (uint32_t seed, uint64_t stream, uint64_t substream, Type type = MRG32K3A);
   /**
    * Copy constructor.
    *
@@ -71,7 +88,24 @@ public:
    */
   double RandU01 (void);
 
+  /**
+   * Compute one Philox4x32-10 block.
+   *
+   * \param [in] counter The counter.
+   * \param [in] key The key.
+   * \param [out] out The four random words.
+   */
+  static void PhiloxBlock (const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
 private:
+  /** The number of values generated at once by Philox. */
+  static const uint32_t PHILOX_BATCH = 8;
+
+  /**
+   * Generate the next PHILOX_BATCH values of a Philox stream.
+   */
+  void PhiloxFill (void);
+
   /**
    * Advance \p state of the RNG by leaps and bounds.
    *
@@ -81,8 +115,18 @@ private:
    */
   void AdvanceNthBy (uint64_t nth, int by, double state[6]);
 
+  /** The generator. */
+  Type m_type;
   /** The RNG state vector. */
   double m_currentState[6];
+  /** The Philox key: seed and substream. */
+  uint32_t m_key[2];
+  /** The Philox counter: position in the stream, then the stream. */
+  uint32_t m_counter[4];
+  /** The next Philox values. */
+  double m_batch[PHILOX_BATCH];
+  /** Index of the next value in m_batch. */
+  uint32_t m_next;
 };
 
 } // namespace ns3
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-config.h"
+#include "simulator-checkpoint.h"
+#include "simulator.h"
+#include "simulator-impl.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include "log.h"
+#ifdef HAVE_PTHREAD_H
+#include "system-thread.h"
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::SimulatorCheckpoint implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulatorCheckpoint");
+
+bool SimulatorCheckpoint::m_copy = false;
+std::vector<int> SimulatorCheckpoint::m_status;
+
+uint32_t
+SimulatorCheckpoint::Fork (uint32_t copies, uint32_t jobs)
+{
+  NS_LOG_FUNCTION (copies << jobs);
+  std::string impl = Simulator::GetImplementation ()->GetInstanceTypeId ().GetName ();
+  if (impl != "ns3::DefaultSimulatorImpl")
+    {
+      NS_FATAL_ERROR ("Cannot checkpoint a simulation run by " << impl);
+    }
+#ifdef HAVE_PTHREAD_H
+  // a copy would wait forever for work handed to a thread it does not have
+  if (SystemThread::GetNRunning () > 0)
+    {
+      NS_FATAL_ERROR ("Cannot checkpoint with " << SystemThread::GetNRunning ()
+                      << " threads running, e.g. the writers of asynchronous pcap"
+                      << " files or of a BinaryAggregator: close them first");
+    }
+#endif
+  if (jobs == 0 || jobs > copies)
+    {
+      jobs = copies;
+    }
+
+  m_status.assign (copies, 0);
+  std::map<pid_t, uint32_t> running;
+  uint32_t next = 0;
+  while (next < copies || !running.empty ())
+    {
+      if (next < copies && running.size () < jobs)
+        {
+          // the copies would print what is still buffered again
+          std::cout.flush ();
+          std::cerr.flush ();
+          std::fflush (0);
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("Cannot fork copy " << next << ": " << std::strerror (errno));
+            }
+          if (pid == 0)
+            {
+              m_copy = true;
+              m_status.clear ();
+              NS_LOG_LOGIC ("Copy " << next << " restored at " << Simulator::Now ().GetSeconds () << "s");
+              return next;
+            }
+          running[pid] = next++;
+          continue;
+        }
+
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("Cannot wait for the copies: " << std::strerror (errno));
+        }
+      std::map<pid_t, uint32_t>::iterator it = running.find (pid);
+      if (it == running.end ())
+        {
+          // not one of ours
+          continue;
+        }
+      if (WIFEXITED (status))
+        {
+          m_status[it->second] = WEXITSTATUS (status);
+        }
+      else if (WIFSIGNALED (status))
+        {
+          m_status[it->second] = 128 + WTERMSIG (status);
+        }
+      NS_LOG_LOGIC ("Copy " << it->second << " ended with status " << m_status[it->second]);
+      running.erase (it);
+    }
+  return copies;
+}
+
+bool
+SimulatorCheckpoint::IsCopy (void)
+{
+  return m_copy;
+}
+
+int
+SimulatorCheckpoint::GetExitStatus (uint32_t copy)
+{
+  NS_ASSERT_MSG (copy < m_status.size (), "No copy " << copy);
+  return m_status[copy];
+}
+
+uint32_t
+SimulatorCheckpoint::GetNFailed (void)
+{
+  uint32_t failed = 0;
+  for (std::vector<int>::const_iterator i = m_status.begin (); i != m_status.end (); i++)
+    {
+      if (*i != 0)
+        {
+          failed++;
+        }
+    }
+  return failed;
+}
+
+} // namespace ns3
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIMULATOR_CHECKPOINT_H
+#define SIMULATOR_CHECKPOINT_H
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::SimulatorCheckpoint declaration.
+ */
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @ingroup simulator
+ *
+ * @brief In-memory checkpoints of a whole simulation, taken with fork().
+ *
+ * A checkpoint is taken between two calls to Simulator::Run: every copy
+ * restored from it starts with the same scheduler contents, objects,
+ * sockets, queues and random stream positions as the simulation at that
+ * time.  Each copy may then override parameters, e.g. with Config::Set
+ * or Config::SetDefault for the objects created from now on, before
+ * running on.  This saves the warm-up of parameter sweeps:
+ * \code
+   Simulator::Stop (warmup);
+   Simulator::Run ();
+   uint32_t copy = SimulatorCheckpoint::Fork (variants.size ());
+   if (copy == variants.size ())
+     {
+       // the checkpoint itself, once every copy is done
+       Simulator::Destroy ();
+       return SimulatorCheckpoint::GetNFailed ();
+     }
+   ApplyVariant (variants[copy]);
+   Simulator::Stop (end - warmup);
+   Simulator::Run ();
+   \endcode
+ *
+ * Each copy is a process of its own, which ends where the program
+ * ends.  The output buffered by stdio and the standard streams before
+ * the checkpoint is flushed first so that it is not repeated by every
+ * copy; other buffered streams must be flushed by the caller.  The
+ * copies share the files opened before the checkpoint: a copy should
+ * reopen its output files, or close them.  Only the default simulator
+ * implementation can be checkpointed, neither the real time nor the
+ * distributed ones.
+ *
+ * A copy only has the thread which called Fork, so Fork fails while any
+ * SystemThread runs: the asynchronous pcap files and the
+ * BinaryAggregator objects must be closed before the checkpoint, and
+ * reopened by the copies.
+ */
+class SimulatorCheckpoint
+{
+public:
+  /**
+   * @brief Restore copies of the simulation as it is now
+   *
+   * @param copies the number of copies
+   * @param jobs the maximum number of copies running at once, 0 for
+   *        all of them
+   * @returns the index of the copy in the copies, copies in the
+   *          checkpoint, which returns once every copy has ended
+   */
+  static uint32_t Fork (uint32_t copies, uint32_t jobs = 1);
+
+  /**
+   * @returns true in a copy restored from a checkpoint
+   */
+  static bool IsCopy (void);
+
+  /**
+   * @param copy the index of a copy of the last checkpoint
+   * @returns the exit status of the copy, or 128 plus the number of
+   *          the signal which ended it
+   */
+  static int GetExitStatus (uint32_t copy);
+
+  /**
+   * @returns the number of copies of the last checkpoint which did not
+   *          exit with status 0
+   */
+  static uint32_t GetNFailed (void);
+
+private:
+  static bool m_copy;                //!< running in a copy
+  static std::vector<int> m_status;  //!< exit status of the copies
+};
+
+} // namespace ns3
+
+#endif /* SIMULATOR_CHECKPOINT_H */
@@ -24,6 +24,7 @@
 #include "map-scheduler.h"
 #include "event-impl.h"
 #include "des-metrics.h"
+#include "profiler.h"
 
 #include "ptr.h"
 #include "string.h"
@@ -181,6 +182,9 @@ Simulator::Destroy (void)
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
+#ifdef ENABLE_PROFILING
+  Profiler::ReportAndReset ();
+#endif
 }
 
 void
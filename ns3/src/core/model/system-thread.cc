@@ -35,6 +35,8 @@ NS_LOG_COMPONENT_DEFINE ("SystemThread");
 
 #ifdef HAVE_PTHREAD_H
 
+uint32_t SystemThread::m_nRunning = 0;
+
 SystemThread::SystemThread (Callback<void> callback)
   : m_callback (callback)
 {
@@ -59,6 +61,7 @@ SystemThread::Start (void)
       NS_FATAL_ERROR ("pthread_create failed: " << rc << "=\"" << 
                       strerror (rc) << "\".");
     }
+  m_nRunning++;
 }
 
 void
@@ -73,6 +76,7 @@ SystemThread::Join (void)
       NS_FATAL_ERROR ("pthread_join failed: " << rc << "=\"" << 
                       strerror (rc) << "\".");
     }
+  m_nRunning--;
 }
 
 void *
@@ -99,6 +103,13 @@ SystemThread::Equals (SystemThread::ThreadId id)
   return (pthread_equal (pthread_self (), id) != 0);
 }
 
+uint32_t
+SystemThread::GetNRunning (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_nRunning;
+}
+
 #endif /* HAVE_PTHREAD_H */
 
 } // namespace ns3
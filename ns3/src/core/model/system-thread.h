@@ -156,6 +156,16 @@ public:
    */
   static bool Equals(ThreadId id);
 
+  /**
+   * @brief Get the number of threads started and not joined yet.
+   *
+   * Like the threads themselves, the count is managed from the thread
+   * which starts and joins them.
+   *
+   * @returns The number of threads running.
+   */
+  static uint32_t GetNRunning (void);
+
 private:
 #ifdef HAVE_PTHREAD_H
   /**
@@ -168,6 +178,7 @@ private:
 
   Callback<void> m_callback;  /**< The main function for this thread when launched. */
   pthread_t m_thread;  /**< The thread id of the child thread. */
+  static uint32_t m_nRunning;  /**< The threads started and not joined. */
 #endif 
 };
 
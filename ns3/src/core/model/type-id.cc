@@ -20,6 +20,7 @@
 #include "log.h"  // NS_ASSERT and NS_LOG
 #include "hash.h"
 #include "type-id.h"
+#include "attribute-handle.h"
 #include "singleton.h"
 #include "trace-source-accessor.h"
 
@@ -1168,6 +1169,18 @@ TypeId::LookupTraceSourceByName (std::string name) const
   return LookupTraceSourceByName (name, &info);
 }
 
+TraceSourceHandle
+TypeId::LookupTraceSourceHandle (std::string name) const
+{
+  NS_LOG_FUNCTION (this << name);
+  Ptr<const TraceSourceAccessor> accessor = LookupTraceSourceByName (name);
+  if (accessor == 0)
+    {
+      NS_FATAL_ERROR ("Trace source name=" << name << " does not exist for tid=" << GetName ());
+    }
+  return TraceSourceHandle (*this, name, accessor);
+}
+
 uint16_t 
 TypeId::GetUid (void) const
 {
@@ -39,6 +39,8 @@
 namespace ns3 {
 
 class ObjectBase;
+template <typename T> class AttributeHandle;
+class TraceSourceHandle;
 
 /**
  * \ingroup object
@@ -485,6 +487,20 @@ public:
    * \returns \c true if the requested attribute could be found.
    */
   bool LookupAttributeByName (std::string name, struct AttributeInformation *info) const;
+  /**
+   * Find an attribute by name once, to set or get it later on many
+   * objects without string lookups or allocations.  Defined in
+   * attribute-handle.h.
+   *
+   * The simulation aborts if the attribute does not exist or if
+   * its values are not of type \pname{T}.
+   *
+   * \tparam T \pname{T}Value type of the attribute.
+   * \param [in] name The name of the requested attribute.
+   * \return The handle.
+   */
+  template <typename T>
+  AttributeHandle<T> LookupAttributeHandle (std::string name) const;
   /**
    * Find a TraceSource by name.
    *
@@ -496,6 +512,16 @@ public:
    *  an object instance.
    */
   Ptr<const TraceSourceAccessor> LookupTraceSourceByName (std::string name) const;
+  /**
+   * Find a trace source by name once, to connect it later on many
+   * objects without looking it up again.
+   *
+   * The simulation aborts if the trace source does not exist.
+   *
+   * \param [in] name The name of the requested trace source.
+   * \return The handle.
+   */
+  TraceSourceHandle LookupTraceSourceHandle (std::string name) const;
   /**
    * Find a TraceSource by name, retrieving the associated TraceSourceInformation.
    *
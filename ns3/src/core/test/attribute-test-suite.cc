@@ -1202,6 +1202,81 @@ TracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_got2, 1.0, "Invoking disconnected TracedCallback unexpectedly results in trace callback");
 }
 
+// ===========================================================================
+// Attributes and trace sources resolved once and used on several objects
+// through typed handles.
+// ===========================================================================
+class AttributeHandleTestCase : public TestCase
+{
+public:
+  AttributeHandleTestCase (std::string description);
+  virtual ~AttributeHandleTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void NotifySource2 (double a, int b, float c) { m_got2 = a; }
+
+  double m_got2;
+};
+
+AttributeHandleTestCase::AttributeHandleTestCase (std::string description)
+  : TestCase (description)
+{
+}
+
+void
+AttributeHandleTestCase::DoRun (void)
+{
+  TypeId tid = AttributeObjectTest::GetTypeId ();
+  AttributeHandle<UintegerValue> uint8 = tid.LookupAttributeHandle<UintegerValue> ("TestUint8");
+  AttributeHandle<IntegerValue> int16SetGet = tid.LookupAttributeHandle<IntegerValue> ("TestInt16SetGet");
+  AttributeHandle<TimeValue> time = tid.LookupAttributeHandle<TimeValue> ("TestTimeWithBounds");
+  TraceSourceHandle source2 = tid.LookupTraceSourceHandle ("Source2");
+  NS_TEST_ASSERT_MSG_EQ (uint8.IsValid (), true, "Could not resolve TestUint8");
+  NS_TEST_ASSERT_MSG_EQ (AttributeHandle<UintegerValue> ().IsValid (), false, "Default handle is valid");
+
+  //
+  // The same handles set and get the attributes of several objects, through
+  // member variables and through setters and getters.
+  //
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Ptr<AttributeObjectTest> p = CreateObject<AttributeObjectTest> ();
+      uint8.Set (p, UintegerValue (10 + i));
+      int16SetGet.Set (p, IntegerValue (-3 - (int)i));
+      time.Set (p, TimeValue (Seconds (i)));
+
+      UintegerValue uv;
+      p->GetAttribute ("TestUint8", uv);
+      NS_TEST_ASSERT_MSG_EQ (uv.Get (), 10 + i, "Handle did not set TestUint8");
+      IntegerValue iv;
+      int16SetGet.Get (p, iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), -3 - (int)i, "Handle did not set TestInt16SetGet");
+      TimeValue tv;
+      time.Get (p, tv);
+      NS_TEST_ASSERT_MSG_EQ (tv.Get (), Seconds (i), "Handle did not set TestTimeWithBounds");
+
+      m_got2 = 0;
+      bool ok = source2.ConnectWithoutContext (PeekPointer (p), MakeCallback (&AttributeHandleTestCase::NotifySource2, this));
+      NS_TEST_ASSERT_MSG_EQ (ok, true, "Could not connect Source2 through its handle");
+      p->InvokeCb (1.0 + i, -5, 0.0);
+      NS_TEST_ASSERT_MSG_EQ (m_got2, 1.0 + i, "Trace sink connected through a handle not called");
+    }
+
+  //
+  // The factory applies the values given through handles at construction.
+  //
+  ObjectFactory factory;
+  factory.SetTypeId (tid);
+  factory.Set (uint8, UintegerValue (42));
+  factory.Set (uint8, UintegerValue (43));
+  Ptr<AttributeObjectTest> p = factory.Create<AttributeObjectTest> ();
+  UintegerValue uv;
+  uint8.Get (p, uv);
+  NS_TEST_ASSERT_MSG_EQ (uv.Get (), 43, "Factory did not use the last value set through the handle");
+}
+
 // ===========================================================================
 // Smart pointers (Ptr) are central to our architecture, so they must work as
 // attributes.
@@ -1421,6 +1496,7 @@ AttributesTestSuite::AttributesTestSuite ()
   AddTestCase (new IntegerTraceSourceAttributeTestCase ("Ensure TracedValue<uint8_t> can be set like IntegerValue"), TestCase::QUICK);
   AddTestCase (new IntegerTraceSourceTestCase ("Ensure TracedValue<uint8_t> also works as trace source"), TestCase::QUICK);
   AddTestCase (new TracedCallbackTestCase ("Ensure TracedCallback<double, int, float> works as trace source"), TestCase::QUICK);
+  AddTestCase (new AttributeHandleTestCase ("Check typed attribute and trace source handles"), TestCase::QUICK);
 }
 
 static AttributesTestSuite attributesTestSuite;
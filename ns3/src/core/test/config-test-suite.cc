@@ -46,6 +46,7 @@ public:
 
   void AddNodeA (Ptr<ConfigTestObject> a);
   void AddNodeB (Ptr<ConfigTestObject> b);
+  void RemoveNodeA (uint32_t i);
 
   void SetNodeA (Ptr<ConfigTestObject> a);
   void SetNodeB (Ptr<ConfigTestObject> b);
@@ -127,6 +128,12 @@ ConfigTestObject::AddNodeB (Ptr<ConfigTestObject> b)
   m_nodesB.push_back (b);
 }
 
+void
+ConfigTestObject::RemoveNodeA (uint32_t i)
+{
+  m_nodesA.erase (m_nodesA.begin () + i);
+}
+
 int8_t 
 ConfigTestObject::GetA (void) const
 {
@@ -721,6 +728,97 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+// ===========================================================================
+// Test the indexed matching, the cache of the matches and the bulk
+// connection of trace sources.
+// ===========================================================================
+class MatchCacheConfigTestCase : public TestCase
+{
+public:
+  MatchCacheConfigTestCase ();
+  virtual ~MatchCacheConfigTestCase () {}
+
+  void TraceWithPath (std::string path, int16_t old, int16_t newValue) { m_paths.push_back (path); }
+
+private:
+  virtual void DoRun (void);
+
+  std::vector<std::string> m_paths;
+};
+
+MatchCacheConfigTestCase::MatchCacheConfigTestCase ()
+  : TestCase ("Check indexed matching, graph changes and bulk connections")
+{
+}
+
+void
+MatchCacheConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Names::Add ("CacheRoot", root);
+  std::vector<Ptr<ConfigTestObject> > objects;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      objects.push_back (CreateObject<ConfigTestObject> ());
+      root->AddNodeA (objects[i]);
+    }
+
+  //
+  // Explicit indices are fetched directly, in increasing order.
+  //
+  Config::MatchContainer matches = Config::LookupMatches ("/Names/CacheRoot/NodesA/4|[1-2]");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), objects[1], "Wrong first match");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (2), objects[4], "Wrong last match");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (2), "/Names/CacheRoot/NodesA/4/", "Wrong matched path");
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/CacheRoot/NodesA/7").GetN (), 0, "Index out of range matched");
+
+  //
+  // Lookups follow the changes of the object graph, including objects
+  // added or removed through plain setters.
+  //
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/CacheRoot/NodesA/*").GetN (), 5, "Wrong number of matches");
+  root->AddNodeA (CreateObject<ConfigTestObject> ());
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/CacheRoot/NodesA/*").GetN (), 6, "New object not matched");
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/CacheRoot/NodeB").GetN (), 0, "Null pointer matched");
+  root->SetAttribute ("NodeB", PointerValue (objects[0]));
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/CacheRoot/NodeB").GetN (), 1, "New pointer not followed");
+  Ptr<ConfigTestObject> removed = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (removed);
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/CacheRoot/NodesA/*").GetN (), 7, "New object not matched");
+  root->RemoveNodeA (6);
+  matches = Config::LookupMatches ("/Names/CacheRoot/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 6, "Removed object matched");
+  for (uint32_t i = 0; i < matches.GetN (); i++)
+    {
+      NS_TEST_ASSERT_MSG_NE (matches.Get (i), removed, "Removed object matched");
+    }
+  NS_TEST_ASSERT_MSG_EQ (removed->GetReferenceCount (), 1, "Removed object kept alive");
+  root->SetNodeB (0);
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/CacheRoot/NodeB").GetN (), 0, "Cleared pointer followed");
+  root->SetNodeB (objects[0]);
+
+  //
+  // Connect several trace sources at once.
+  //
+  Config::ConnectionList connections;
+  connections.push_back (std::make_pair ("/Names/CacheRoot/NodesA/0/Source",
+                                         MakeCallback (&MatchCacheConfigTestCase::TraceWithPath, this)));
+  connections.push_back (std::make_pair ("/Names/CacheRoot/NodesA/3/Source",
+                                         MakeCallback (&MatchCacheConfigTestCase::TraceWithPath, this)));
+  connections.push_back (std::make_pair ("/Names/CacheRoot/NodeB/Source",
+                                         MakeCallback (&MatchCacheConfigTestCase::TraceWithPath, this)));
+  Config::Connect (connections);
+  objects[0]->SetAttribute ("Source", IntegerValue (-2));
+  objects[3]->SetAttribute ("Source", IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (m_paths.size (), 3, "Wrong number of trace calls");
+  NS_TEST_ASSERT_MSG_EQ (m_paths[0], "/Names/CacheRoot/NodesA/0/Source", "Wrong first context");
+  NS_TEST_ASSERT_MSG_EQ (m_paths[1], "/Names/CacheRoot/NodeB/Source", "Wrong second context");
+  NS_TEST_ASSERT_MSG_EQ (m_paths[2], "/Names/CacheRoot/NodesA/3/Source", "Wrong third context");
+
+  Names::Clear ();
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -737,6 +835,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase, TestCase::QUICK);
   AddTestCase (new ObjectVectorConfigTestCase, TestCase::QUICK);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase, TestCase::QUICK);
+  AddTestCase (new MatchCacheConfigTestCase, TestCase::QUICK);
 }
 
 static ConfigTestSuite configTestSuite;
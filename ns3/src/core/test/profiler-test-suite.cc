@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/profiler.h"
+#include "ns3/test.h"
+
+#include <sstream>
+#include <utility>
+
+using namespace ns3;
+
+class ProfilerTestCase : public TestCase
+{
+public:
+  ProfilerTestCase ();
+  virtual ~ProfilerTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param [in] name The counter or timer name.
+   * \returns The count and total time columns of the report line.
+   */
+  std::pair<uint64_t, std::string> GetReportLine (const std::string &name);
+};
+
+ProfilerTestCase::ProfilerTestCase (void)
+  : TestCase ("Check profiler counters and timers")
+{
+}
+
+std::pair<uint64_t, std::string>
+ProfilerTestCase::GetReportLine (const std::string &name)
+{
+  std::ostringstream oss;
+  Profiler::Report (oss);
+  std::istringstream report (oss.str ());
+  std::string line;
+  while (std::getline (report, line))
+    {
+      if (line.size () > name.size () && line.substr (line.size () - name.size () - 1) == " " + name)
+        {
+          std::istringstream iss (line);
+          std::pair<uint64_t, std::string> ret;
+          iss >> ret.first >> ret.second;
+          return ret;
+        }
+    }
+  return std::make_pair (0, std::string ("missing"));
+}
+
+void
+ProfilerTestCase::DoRun (void)
+{
+  Profiler::Id counter = Profiler::Register ("profiler-test-counter");
+  Profiler::Id timer = Profiler::Register ("profiler-test-timer");
+  NS_TEST_ASSERT_MSG_NE (counter, timer, "distinct names share an id");
+  NS_TEST_ASSERT_MSG_EQ (Profiler::Register ("profiler-test-counter"), counter,
+                         "registering a name twice returns a new id");
+
+  Profiler::Count (counter);
+  Profiler::Count (counter);
+  Profiler::Count (counter);
+  Profiler::AddTime (timer, 2000000);
+  Profiler::AddTime (timer, 4000000);
+
+  std::pair<uint64_t, std::string> line = GetReportLine ("profiler-test-counter");
+  NS_TEST_ASSERT_MSG_EQ (line.first, 3, "wrong counter value");
+  NS_TEST_ASSERT_MSG_EQ (line.second, "-", "counter reported with a time");
+  line = GetReportLine ("profiler-test-timer");
+  NS_TEST_ASSERT_MSG_EQ (line.first, 2, "wrong number of timed invocations");
+  NS_TEST_ASSERT_MSG_EQ (line.second, "6.000", "wrong total time");
+
+  // the report is not written unless requested by ProfilingReport
+  Profiler::ReportAndReset ();
+  line = GetReportLine ("profiler-test-counter");
+  NS_TEST_ASSERT_MSG_EQ (line.first, 0, "counter not reset");
+}
+
+class ProfilerTestSuite : public TestSuite
+{
+public:
+  ProfilerTestSuite ();
+};
+
+ProfilerTestSuite::ProfilerTestSuite ()
+  : TestSuite ("profiler", UNIT)
+{
+  AddTestCase (new ProfilerTestCase, TestCase::QUICK);
+}
+
+static ProfilerTestSuite g_profilerTestSuite;
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/rng-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+class RngPhiloxKnownAnswerTestCase : public TestCase
+{
+public:
+  RngPhiloxKnownAnswerTestCase ();
+  virtual ~RngPhiloxKnownAnswerTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+RngPhiloxKnownAnswerTestCase::RngPhiloxKnownAnswerTestCase ()
+  : TestCase ("Philox4x32-10 blocks match the Random123 known answers")
+{
+}
+
+void
+RngPhiloxKnownAnswerTestCase::DoRun (void)
+{
+  uint32_t counters[3][4] = {
+    { 0, 0, 0, 0 },
+    { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+    { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }
+  };
+  uint32_t keys[3][2] = {
+    { 0, 0 },
+    { 0xffffffff, 0xffffffff },
+    { 0xa4093822, 0x299f31d0 }
+  };
+  uint32_t expected[3][4] = {
+    { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+    { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+    { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }
+  };
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      uint32_t out[4];
+      RngStream::PhiloxBlock (counters[i], keys[i], out);
+      for (uint32_t j = 0; j < 4; ++j)
+        {
+          NS_TEST_ASSERT_MSG_EQ (out[j], expected[i][j], "block " << i << " word " << j);
+        }
+    }
+}
+
+class RngPhiloxStreamTestCase : public TestCase
+{
+public:
+  RngPhiloxStreamTestCase ();
+  virtual ~RngPhiloxStreamTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+RngPhiloxStreamTestCase::RngPhiloxStreamTestCase ()
+  : TestCase ("Philox streams are reproducible, independent and uniform")
+{
+}
+
+void
+RngPhiloxStreamTestCase::DoRun (void)
+{
+  // a stream only depends on (seed, stream, substream)
+  RngStream a (3, 1000, 2, RngStream::PHILOX);
+  RngStream b (3, 1001, 2, RngStream::PHILOX);
+  RngStream c (3, 1000, 2, RngStream::PHILOX);
+  RngStream d (3, 1000, 3, RngStream::PHILOX);
+  uint32_t sameB = 0;
+  uint32_t sameD = 0;
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      double v = a.RandU01 ();
+      NS_TEST_ASSERT_MSG_EQ (v, c.RandU01 (), "stream not reproducible");
+      NS_TEST_ASSERT_MSG_EQ ((v > 0 && v < 1), true, "value out of (0, 1)");
+      sameB += (v == b.RandU01 ());
+      sameD += (v == d.RandU01 ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (sameB, 0, "streams are correlated");
+  NS_TEST_ASSERT_MSG_EQ (sameD, 0, "substreams are correlated");
+
+  // selected globally, the random variables draw uniform values
+  RngSeedManager::SetType (RngStream::PHILOX);
+  Ptr<UniformRandomVariable> u = CreateObject<UniformRandomVariable> ();
+  RngSeedManager::SetType (RngStream::MRG32K3A);
+
+  const uint32_t nBins = 50;
+  const uint32_t n = 1000000;
+  uint32_t bins[nBins] = { 0 };
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      bins[(uint32_t)(u->GetValue () * nBins)]++;
+    }
+  double expected = (double)n / nBins;
+  double chiSquared = 0;
+  for (uint32_t i = 0; i < nBins; ++i)
+    {
+      chiSquared += (bins[i] - expected) * (bins[i] - expected) / expected;
+    }
+  // the 0.999 quantile of chi-squared with 49 degrees of freedom
+  NS_TEST_ASSERT_MSG_LT (chiSquared, 85.35, "Chi-squared statistic out of range");
+}
+
+static class RngPhiloxTestSuite : public TestSuite
+{
+public:
+  RngPhiloxTestSuite ()
+    : TestSuite ("rng-philox", UNIT)
+  {
+    AddTestCase (new RngPhiloxKnownAnswerTestCase, TestCase::QUICK);
+    AddTestCase (new RngPhiloxStreamTestCase, TestCase::QUICK);
+  }
+} g_rngPhiloxTestSuite;
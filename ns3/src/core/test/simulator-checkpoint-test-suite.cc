@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-config.h"
+#include "ns3/simulator-checkpoint.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
+
+#include <csignal>
+#include <cstdio>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+class SimulatorCheckpointTestCase : public TestCase
+{
+public:
+  SimulatorCheckpointTestCase ();
+  virtual ~SimulatorCheckpointTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Count the ticks, and schedule the next one.
+   */
+  void Tick (void);
+  /**
+   * \returns The state after the checkpoint, which the copies exit with:
+   * the next random value, plus 128 if the ticks did not go on.
+   */
+  int RunOn (void);
+
+  uint32_t m_ticks;                     //!< Ticks so far.
+  Ptr<UniformRandomVariable> m_random;  //!< Stream drawn before and after the checkpoint.
+};
+
+SimulatorCheckpointTestCase::SimulatorCheckpointTestCase (void)
+  : TestCase ("Check that the copies of a checkpoint resume its state"),
+    m_ticks (0)
+{
+}
+
+void
+SimulatorCheckpointTestCase::Tick (void)
+{
+  m_ticks++;
+  m_random->GetInteger (0, 100);
+  Simulator::Schedule (MilliSeconds (1), &SimulatorCheckpointTestCase::Tick, this);
+}
+
+int
+SimulatorCheckpointTestCase::RunOn (void)
+{
+  Simulator::Stop (MilliSeconds (10));
+  Simulator::Run ();
+  int state = m_random->GetInteger (0, 100);
+  if (m_ticks != 20 || Simulator::Now () != MilliSeconds (20) + MicroSeconds (1))
+    {
+      state += 128;
+    }
+  return state;
+}
+
+void
+SimulatorCheckpointTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  Simulator::Schedule (MilliSeconds (1), &SimulatorCheckpointTestCase::Tick, this);
+  Simulator::Stop (MilliSeconds (10) + MicroSeconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_ticks, 10, "warm-up not run");
+
+  uint32_t copy = SimulatorCheckpoint::Fork (3, 2);
+  if (copy < 3)
+    {
+      // leave the test runner to the checkpoint
+      _exit (RunOn ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (SimulatorCheckpoint::IsCopy (), false, "checkpoint taken for a copy");
+
+  // the checkpoint is left as it was, and runs on as the copies did
+  int state = RunOn ();
+  NS_TEST_ASSERT_MSG_LT (state, 128, "checkpoint did not run on");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (SimulatorCheckpoint::GetExitStatus (i), state, "copy " << i << " did not resume the checkpoint");
+    }
+
+  Simulator::Destroy ();
+}
+
+#ifdef HAVE_PTHREAD_H
+class SimulatorCheckpointThreadTestCase : public TestCase
+{
+public:
+  SimulatorCheckpointThreadTestCase ();
+  virtual ~SimulatorCheckpointThreadTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  /**
+   * The work of a thread running during the checkpoint.
+   */
+  static void Sleep (void);
+};
+
+SimulatorCheckpointThreadTestCase::SimulatorCheckpointThreadTestCase (void)
+  : TestCase ("Check that no checkpoint is taken while threads run")
+{
+}
+
+void
+SimulatorCheckpointThreadTestCase::Sleep (void)
+{
+  usleep (10000);
+}
+
+void
+SimulatorCheckpointThreadTestCase::DoRun (void)
+{
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&SimulatorCheckpointThreadTestCase::Sleep));
+  thread->Start ();
+  NS_TEST_EXPECT_MSG_EQ (SystemThread::GetNRunning (), 1, "thread not counted");
+  thread->Join ();
+  NS_TEST_ASSERT_MSG_EQ (SystemThread::GetNRunning (), 0, "thread joined still counted");
+
+  // the checkpoint fails in a process of its own
+  pid_t pid = fork ();
+  NS_TEST_ASSERT_MSG_NE (pid, -1, "cannot fork");
+  if (pid == 0)
+    {
+      if (std::freopen ("/dev/null", "w", stderr) == 0)
+        {
+          _exit (1);
+        }
+      thread = Create<SystemThread> (MakeCallback (&SimulatorCheckpointThreadTestCase::Sleep));
+      thread->Start ();
+      SimulatorCheckpoint::Fork (1);
+      _exit (0);
+    }
+  int status;
+  waitpid (pid, &status, 0);
+  NS_TEST_EXPECT_MSG_EQ (WIFSIGNALED (status) && WTERMSIG (status) == SIGABRT, true, "checkpoint taken with a thread running");
+}
+#endif /* HAVE_PTHREAD_H */
+
+class SimulatorCheckpointTestSuite : public TestSuite
+{
+public:
+  SimulatorCheckpointTestSuite ();
+};
+
+SimulatorCheckpointTestSuite::SimulatorCheckpointTestSuite ()
+  : TestSuite ("simulator-checkpoint", UNIT)
+{
+  AddTestCase (new SimulatorCheckpointTestCase, TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new SimulatorCheckpointThreadTestCase, TestCase::QUICK);
+#endif
+}
+
+static SimulatorCheckpointTestSuite g_simulatorCheckpointTestSuite;
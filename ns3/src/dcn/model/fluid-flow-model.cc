@@ -0,0 +1,473 @@
+#include "fluid-flow-model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/tcp-header.h"
+#include "ns3/ppp-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FluidFlowModel");
+
+namespace dcn {
+
+NS_OBJECT_ENSURE_REGISTERED (FluidFlowModel);
+
+TypeId
+FluidFlowModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::dcn::FluidFlowModel")
+      .SetParent<Object> ()
+      .SetGroupName ("DCN")
+      .AddConstructor<FluidFlowModel> ()
+      .AddAttribute ("UpdateInterval",
+                     "Period at which the packet-level traffic is measured and the rates allocated again",
+                     TimeValue (MicroSeconds (100)),
+                     MakeTimeAccessor (&FluidFlowModel::m_interval),
+                     MakeTimeChecker (NanoSeconds (1)))
+      .AddAttribute ("Headroom",
+                     "Growth of its rate over the last interval that the packet-level traffic of a link gets before the fluid flows",
+                     DoubleValue (1.0),
+                     MakeDoubleAccessor (&FluidFlowModel::m_headroom),
+                     MakeDoubleChecker<double> (0))
+      .AddAttribute ("MinPacketShare",
+                     "Share of the capacity of a link the packet-level traffic gets at least, however much the fluid flows take",
+                     DoubleValue (0.5),
+                     MakeDoubleAccessor (&FluidFlowModel::m_minPacketShare),
+                     MakeDoubleChecker<double> (0, 1))
+      .AddAttribute ("MinSize",
+                     "Bytes of the smallest flow simulated as a fluid flow",
+                     UintegerValue (1000000),
+                     MakeUintegerAccessor (&FluidFlowModel::m_minSize),
+                     MakeUintegerChecker<uint64_t> ())
+      .AddAttribute ("Classes",
+                     "Bit mask of the flow classes simulated as fluid flows",
+                     UintegerValue (0x1),
+                     MakeUintegerAccessor (&FluidFlowModel::m_classes),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddTraceSource ("Completion",
+                       "A fluid flow has been completed",
+                       MakeTraceSourceAccessor (&FluidFlowModel::m_completionTrace),
+                       "ns3::dcn::FluidFlowModel::CompletionTracedCallback")
+  ;
+  return tid;
+}
+
+FluidFlowModel::FluidFlowModel ()
+  : m_nAllocations (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FluidFlowModel::~FluidFlowModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FluidFlowModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tick.Cancel ();
+  m_completion.Cancel ();
+  m_ports.clear ();
+  m_portIndex.clear ();
+  m_flows.clear ();
+  Object::DoDispose ();
+}
+
+void
+FluidFlowModel::Install (NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this);
+  for (NodeContainer::Iterator n = nodes.Begin (); n != nodes.End (); ++n)
+    {
+      Ptr<TrafficControlLayer> tc = (*n)->GetObject<TrafficControlLayer> ();
+      for (uint32_t i = 0; i < (*n)->GetNDevices (); ++i)
+        {
+          Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> ((*n)->GetDevice (i));
+          if (device == 0 || m_portIndex.find (device) != m_portIndex.end ())
+            {
+              continue;
+            }
+          Ptr<PointToPointChannel> channel = DynamicCast<PointToPointChannel> (device->GetChannel ());
+          if (channel == 0 || channel->GetNDevices () != 2)
+            {
+              continue;
+            }
+          Port port;
+          port.device = device;
+          port.channel = channel;
+          port.qdisc = tc != 0 ? tc->GetRootQueueDiscOnDevice (device) : 0;
+          port.red = DynamicCast<RedQueueDisc> (port.qdisc);
+          DataRateValue rate;
+          device->GetAttribute ("DataRate", rate);
+          port.capacity = rate.Get ().GetBitRate ();
+          port.meanPktSize = 1;
+          if (port.red != 0 && port.red->GetMode () == Queue::QUEUE_MODE_PACKETS)
+            {
+              UintegerValue size;
+              port.red->GetAttribute ("MeanPktSize", size);
+              port.meanPktSize = size.Get ();
+            }
+          TimeValue delay;
+          channel->GetAttribute ("Delay", delay);
+          port.delay = delay.Get ();
+          TimeValue gap;
+          device->GetAttribute ("InterframeGap", gap);
+          port.gap = gap.Get ();
+          port.dequeued = 0;
+          port.dequeuedPackets = 0;
+          port.frameSize = device->GetMtu () + PppHeader ().GetSerializedSize ();
+          port.packetRate = 0;
+          port.fluidRate = 0;
+          port.saturated = false;
+          port.available = 0;
+          port.unfrozen = 0;
+          port.share = 0;
+          port.demand = 0;
+          m_portIndex[device] = m_ports.size ();
+          m_ports.push_back (port);
+        }
+    }
+}
+
+bool
+FluidFlowModel::IsFluid (uint64_t size, uint8_t cls) const
+{
+  return size >= m_minSize && cls < 32 && (m_classes >> cls) & 1;
+}
+
+bool
+FluidFlowModel::GetPath (Ptr<Node> src, Ptr<Node> dst, uint32_t id,
+                         std::vector<uint32_t> &path, Time &delay) const
+{
+  Ipv4Header header;
+  header.SetSource (src->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ());
+  header.SetDestination (dst->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ());
+  header.SetProtocol (6);
+  // the probe stands for the first packet of the flow, which the equal
+  // cost paths are hashed on
+  TcpHeader tcp;
+  tcp.SetSourcePort (49152 + id % 16384);
+  tcp.SetDestinationPort (9);
+  Ptr<Packet> probe = Create<Packet> ();
+  probe->AddHeader (tcp);
+
+  path.clear ();
+  delay = Seconds (0);
+  Ptr<Node> node = src;
+  while (node != dst)
+    {
+      if (path.size () >= 64)
+        {
+          return false;
+        }
+      Socket::SocketErrno err;
+      Ptr<Ipv4RoutingProtocol> routing = node->GetObject<Ipv4> ()->GetRoutingProtocol ();
+      Ptr<Ipv4Route> route = routing->RouteOutput (probe, header, 0, err);
+      if (route == 0)
+        {
+          return false;
+        }
+      std::map<Ptr<NetDevice>, uint32_t>::const_iterator it = m_portIndex.find (route->GetOutputDevice ());
+      if (it == m_portIndex.end ())
+        {
+          return false;
+        }
+      const Port &port = m_ports[it->second];
+      path.push_back (it->second);
+      delay += port.delay;
+      Ptr<NetDevice> peer = port.channel->GetDevice (0) == port.device ?
+        port.channel->GetDevice (1) : port.channel->GetDevice (0);
+      node = peer->GetNode ();
+    }
+  return true;
+}
+
+bool
+FluidFlowModel::AddFlow (Ptr<Node> src, Ptr<Node> dst, uint64_t size, uint32_t id)
+{
+  NS_LOG_FUNCTION (this << src << dst << size << id);
+  Flow flow;
+  if (!GetPath (src, dst, id, flow.path, flow.delay))
+    {
+      NS_LOG_WARN ("No modelled path from node " << src->GetId () << " to node " << dst->GetId ());
+      return false;
+    }
+  flow.id = id;
+  flow.start = Simulator::Now ();
+  flow.remaining = size;
+  flow.rate = 0;
+  flow.frozen = false;
+
+  // the others sent at their old rates until now
+  Advance ();
+  m_flows.push_back (flow);
+  Update ();
+  if (!m_tick.IsRunning ())
+    {
+      m_lastTick = Simulator::Now ();
+      m_tick = Simulator::Schedule (m_interval, &FluidFlowModel::Tick, this);
+    }
+  return true;
+}
+
+uint32_t
+FluidFlowModel::GetNFlows (void) const
+{
+  return m_flows.size ();
+}
+
+uint64_t
+FluidFlowModel::GetNAllocations (void) const
+{
+  return m_nAllocations;
+}
+
+double
+FluidFlowModel::GetFluidRate (Ptr<NetDevice> device) const
+{
+  std::map<Ptr<NetDevice>, uint32_t>::const_iterator it = m_portIndex.find (device);
+  return it != m_portIndex.end () ? m_ports[it->second].fluidRate : 0;
+}
+
+void
+FluidFlowModel::Tick (void)
+{
+  NS_LOG_FUNCTION (this);
+  double elapsed = (Simulator::Now () - m_lastTick).GetSeconds ();
+  m_lastTick = Simulator::Now ();
+  for (std::vector<Port>::iterator port = m_ports.begin (); port != m_ports.end (); ++port)
+    {
+      if (port->qdisc == 0)
+        {
+          continue;
+        }
+      // wraps as the counters do
+      uint32_t dequeued = port->qdisc->GetTotalReceivedBytes () - port->qdisc->GetTotalDroppedBytes ()
+        - port->qdisc->GetNBytes ();
+      uint32_t packets = port->qdisc->GetTotalReceivedPackets () - port->qdisc->GetTotalDroppedPackets ()
+        - port->qdisc->GetNPackets ();
+      port->packetRate = elapsed > 0 ? (dequeued - port->dequeued) * 8.0 / elapsed : 0;
+      if (packets != port->dequeuedPackets)
+        {
+          port->frameSize = double (dequeued - port->dequeued) / (packets - port->dequeuedPackets)
+            + PppHeader ().GetSerializedSize ();
+        }
+      port->dequeued = dequeued;
+      port->dequeuedPackets = packets;
+    }
+  Update ();
+  if (!m_flows.empty ())
+    {
+      m_tick = Simulator::Schedule (m_interval, &FluidFlowModel::Tick, this);
+    }
+}
+
+void
+FluidFlowModel::Advance (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  double elapsed = (now - m_lastUpdate).GetSeconds ();
+  m_lastUpdate = now;
+
+  for (uint32_t i = 0; i < m_flows.size (); )
+    {
+      Flow &flow = m_flows[i];
+      flow.remaining -= flow.rate * elapsed / 8;
+      // done if it would be within the next nanosecond
+      if (flow.remaining * 8 < flow.rate * 1e-9 || flow.remaining < 1e-6)
+        {
+          Time fct = now + flow.delay - flow.start;
+          NS_LOG_LOGIC ("Fluid flow " << flow.id << " completed in " << fct);
+          m_completionTrace (flow.id, flow.start, fct);
+          m_flows[i] = m_flows.back ();
+          m_flows.pop_back ();
+          continue;
+        }
+      ++i;
+    }
+}
+
+void
+FluidFlowModel::Update (void)
+{
+  NS_LOG_FUNCTION (this);
+  Advance ();
+  Allocate ();
+  Apply ();
+
+  m_completion.Cancel ();
+  double next = std::numeric_limits<double>::infinity ();
+  for (std::vector<Flow>::const_iterator flow = m_flows.begin (); flow != m_flows.end (); ++flow)
+    {
+      if (flow->rate > 0)
+        {
+          next = std::min (next, flow->remaining * 8 / flow->rate);
+        }
+    }
+  if (next != std::numeric_limits<double>::infinity ())
+    {
+      m_completion = Simulator::Schedule (NanoSeconds (std::ceil (next * 1e9)), &FluidFlowModel::Update, this);
+    }
+}
+
+void
+FluidFlowModel::Allocate (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nAllocations++;
+  for (std::vector<Port>::iterator port = m_ports.begin (); port != m_ports.end (); ++port)
+    {
+      port->flows.clear ();
+      port->available = port->capacity;
+      port->unfrozen = 0;
+      port->fluidRate = 0;
+      port->saturated = false;
+      port->demand = 0;
+    }
+  for (uint32_t i = 0; i < m_flows.size (); ++i)
+    {
+      m_flows[i].rate = 0;
+      m_flows[i].frozen = false;
+      for (std::vector<uint32_t>::const_iterator p = m_flows[i].path.begin (); p != m_flows[i].path.end (); ++p)
+        {
+          m_ports[*p].flows.push_back (i);
+          m_ports[*p].unfrozen++;
+        }
+    }
+
+  // water filling: the port with the smallest fair share is the
+  // bottleneck of its flows, unless the packet-level traffic of some port
+  // demands less than that share
+  typedef std::set<std::pair<double, uint32_t> > Heap;
+  Heap shares;
+  Heap demands;
+  for (uint32_t p = 0; p < m_ports.size (); ++p)
+    {
+      Port &port = m_ports[p];
+      if (port.flows.empty ())
+        {
+          continue;
+        }
+      bool backlogged = port.qdisc != 0 && port.qdisc->GetNPackets () > 0;
+      port.demand = backlogged ? port.capacity : port.packetRate * (1 + m_headroom);
+      if (port.demand > 0)
+        {
+          port.unfrozen++;
+          demands.insert (std::make_pair (port.demand, p));
+        }
+      port.share = port.available / port.unfrozen;
+      shares.insert (std::make_pair (port.share, p));
+    }
+
+  while (!shares.empty ())
+    {
+      double share = shares.begin ()->first;
+      uint32_t b = shares.begin ()->second;
+      if (!demands.empty () && demands.begin ()->first <= share)
+        {
+          // the packet-level traffic of a port gets all it demands
+          uint32_t p = demands.begin ()->second;
+          demands.erase (demands.begin ());
+          Port &port = m_ports[p];
+          shares.erase (std::make_pair (port.share, p));
+          port.available = std::max (0.0, port.available - port.demand);
+          port.demand = 0;
+          if (--port.unfrozen > 0)
+            {
+              port.share = port.available / port.unfrozen;
+              shares.insert (std::make_pair (port.share, p));
+            }
+          continue;
+        }
+
+      shares.erase (shares.begin ());
+      Port &bottleneck = m_ports[b];
+      if (bottleneck.demand > 0)
+        {
+          demands.erase (std::make_pair (bottleneck.demand, b));
+          bottleneck.demand = 0;
+        }
+      for (std::vector<uint32_t>::const_iterator i = bottleneck.flows.begin (); i != bottleneck.flows.end (); ++i)
+        {
+          Flow &flow = m_flows[*i];
+          if (flow.frozen)
+            {
+              continue;
+            }
+          flow.frozen = true;
+          flow.rate = share;
+          bottleneck.saturated = true;
+          for (std::vector<uint32_t>::const_iterator p = flow.path.begin (); p != flow.path.end (); ++p)
+            {
+              Port &port = m_ports[*p];
+              port.fluidRate += share;
+              if (*p == b)
+                {
+                  continue;
+                }
+              shares.erase (std::make_pair (port.share, *p));
+              port.available = std::max (0.0, port.available - share);
+              if (--port.unfrozen > 0)
+                {
+                  port.share = port.available / port.unfrozen;
+                  shares.insert (std::make_pair (port.share, *p));
+                }
+              else if (port.demand > 0)
+                {
+                  // only the packet-level traffic is left
+                  demands.erase (std::make_pair (port.demand, *p));
+                  port.demand = 0;
+                }
+            }
+        }
+      bottleneck.unfrozen = 0;
+    }
+}
+
+void
+FluidFlowModel::Apply (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Port>::iterator port = m_ports.begin (); port != m_ports.end (); ++port)
+    {
+      // a frame sent at the device rate, then the fluid bytes that leave
+      // the packets their rate
+      Time gap = port->gap;
+      if (port->fluidRate > 0 && m_minPacketShare > 0)
+        {
+          double left = std::max (port->capacity - port->fluidRate, port->capacity * m_minPacketShare);
+          gap += Seconds (port->frameSize * 8 / left - port->frameSize * 8 / port->capacity);
+        }
+      port->device->SetInterframeGap (gap);
+
+      if (port->red == 0)
+        {
+          continue;
+        }
+      port->red->SetVirtualLoad (port->saturated ? 1 : port->fluidRate / port->capacity);
+      // the fluid flows wait in the virtual queue as the packets do
+      double bytes = port->red->GetVirtualBacklog () * port->meanPktSize;
+      port->channel->SetQueueingDelay (port->device, Seconds (bytes * 8 / port->capacity));
+    }
+}
+
+} // namespace dcn
+} // namespace ns3
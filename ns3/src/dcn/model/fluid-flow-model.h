@@ -0,0 +1,210 @@
+#ifndef FLUID_FLOW_MODEL_H
+#define FLUID_FLOW_MODEL_H
+
+#include <stdint.h>
+#include <vector>
+#include <map>
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
+#include "ns3/queue-disc.h"
+#include "ns3/red-queue-disc.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-channel.h"
+
+namespace ns3 {
+namespace dcn {
+
+/**
+ * \ingroup dcn
+ *
+ * \brief flow-level model of the background flows of a PointToPoint
+ * fabric, sharing its links with the packet-level traffic
+ *
+ * Fluid flows send no packets: they follow the route the global routing
+ * gives to their first packet, and get a max-min fair rate on the links
+ * of their path, allocated again when a fluid flow starts or ends and
+ * every UpdateInterval.  In the allocation the packet-level traffic of a
+ * link direction counts as one more flow, whose demand is unlimited
+ * while the root queue disc of the device is backlogged, and its rate
+ * over the last interval plus Headroom otherwise.
+ *
+ * The packet-level traffic feels the fluid flows in three ways.  It
+ * gets only the capacity they leave: each frame is still sent at the
+ * device rate, but followed by an interframe gap that stands for the
+ * fluid bytes sent between the packets.  The virtual load of the
+ * RedQueueDisc of the device marks and drops as if the queue of the
+ * fluid flows were there; on a link they saturate that queue reaches
+ * the thresholds, so they alone make the packets back off.  And the
+ * queueing delay of that queue is added on the wire.
+ *
+ * A fluid flow ends when its bytes are sent at its successive rates; its
+ * completion time includes the propagation delay of its path, but
+ * neither its slow start nor its losses.  IsFluid selects the flows to
+ * simulate as fluid by size and class.
+ */
+class FluidFlowModel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  FluidFlowModel ();
+  virtual ~FluidFlowModel ();
+
+  /**
+   * \brief model the PointToPoint devices of nodes
+   *
+   * Must be called once the devices and the root queue discs are
+   * installed; the routes must be set before the first flow starts.
+   *
+   * \param nodes the nodes
+   */
+  void Install (NodeContainer nodes);
+
+  /**
+   * \param size the flow size in bytes
+   * \param cls the class of the flow, below 32
+   * \return true if the flow is to be simulated as a fluid flow
+   */
+  bool IsFluid (uint64_t size, uint8_t cls) const;
+
+  /**
+   * \brief start a fluid flow now
+   * \param src the source node
+   * \param dst the destination node
+   * \param size the flow size in bytes
+   * \param id the flow identifier, for the Completion trace
+   * \return false if the route of the flow leaves the modelled devices
+   */
+  bool AddFlow (Ptr<Node> src, Ptr<Node> dst, uint64_t size, uint32_t id);
+
+  /**
+   * \return the number of fluid flows still sending
+   */
+  uint32_t GetNFlows (void) const;
+
+  /**
+   * \return the number of rate allocations so far
+   */
+  uint64_t GetNAllocations (void) const;
+
+  /**
+   * \param device a modelled device
+   * \return the rate of the fluid flows sent by the device, in bit/s
+   */
+  double GetFluidRate (Ptr<NetDevice> device) const;
+
+  /**
+   * \brief TracedCallback signature for the end of a fluid flow
+   * \param id the flow identifier
+   * \param start the start time of the flow
+   * \param fct the flow completion time
+   */
+  typedef void (* CompletionTracedCallback) (uint32_t id, Time start, Time fct);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief find the devices a flow goes through
+   * \param src the source node
+   * \param dst the destination node
+   * \param id the flow identifier, which chooses among equal cost paths
+   * \param path the ports on the path
+   * \param delay the propagation delay of the path
+   * \return false if the route leaves the modelled devices
+   */
+  bool GetPath (Ptr<Node> src, Ptr<Node> dst, uint32_t id,
+                std::vector<uint32_t> &path, Time &delay) const;
+  /**
+   * \brief measure the packet-level traffic and allocate the rates again
+   */
+  void Tick (void);
+  /**
+   * \brief advance the flows to now, and end those done
+   */
+  void Advance (void);
+  /**
+   * \brief advance the flows and allocate the rates again
+   */
+  void Update (void);
+  /**
+   * \brief allocate max-min fair rates to the fluid flows
+   */
+  void Allocate (void);
+  /**
+   * \brief apply the fluid rates to the devices, queue discs and channels
+   *
+   * The packet-level traffic of a port gets the capacity the fluid flows
+   * leave, and at least MinPacketShare of it: a FIFO queue serves the
+   * packets as they arrive, whatever the number of flows they belong
+   * to, so a burst coming at the line rate gets about every other frame.
+   */
+  void Apply (void);
+
+  /// a modelled device
+  struct Port
+  {
+    Ptr<PointToPointNetDevice> device; //!< the sending device
+    Ptr<PointToPointChannel> channel;  //!< its channel
+    Ptr<QueueDisc> qdisc;              //!< its root queue disc, if any
+    Ptr<RedQueueDisc> red;             //!< the same, if it is RED
+    double capacity;                   //!< the device rate at install, in bit/s
+    double meanPktSize;                //!< bytes per packet of the RED queue length
+    Time delay;                        //!< propagation delay of the channel
+    Time gap;                          //!< interframe gap of the device at install
+    uint32_t dequeued;                 //!< bytes dequeued by the queue disc at the last tick
+    uint32_t dequeuedPackets;          //!< packets dequeued by the queue disc at the last tick
+    double frameSize;                  //!< mean frame of the packet-level traffic, in bytes
+    double packetRate;                 //!< rate of the packet-level traffic, in bit/s
+    double fluidRate;                  //!< rate of the fluid flows, in bit/s
+    bool saturated;                    //!< some fluid flows are bottlenecked here
+    // allocation state
+    std::vector<uint32_t> flows;       //!< the fluid flows through the port
+    double available;                  //!< capacity not allocated yet
+    uint32_t unfrozen;                 //!< flows not allocated yet, the packet-level one included
+    double share;                      //!< key of the port in the shares
+    double demand;                     //!< demand of the packet-level traffic, 0 if allocated
+  };
+
+  /// a fluid flow
+  struct Flow
+  {
+    uint32_t id;                       //!< the flow identifier
+    Time start;                        //!< start time
+    Time delay;                        //!< propagation delay of the path
+    std::vector<uint32_t> path;        //!< the ports on the path
+    double remaining;                  //!< bytes to send
+    double rate;                       //!< current rate, in bit/s
+    bool frozen;                       //!< rate allocated
+  };
+
+  std::vector<Port> m_ports;           //!< the modelled devices
+  std::map<Ptr<NetDevice>, uint32_t> m_portIndex; //!< port of each modelled device
+  std::vector<Flow> m_flows;           //!< the fluid flows sending
+  Time m_lastUpdate;                   //!< time the flows were last advanced
+  Time m_lastTick;                     //!< time the packet-level traffic was last measured
+  EventId m_tick;                      //!< next tick
+  EventId m_completion;                //!< next flow end
+  uint64_t m_nAllocations;             //!< rate allocations so far
+  Time m_interval;                     //!< period of the ticks
+  double m_headroom;                   //!< growth allowed to the packet-level traffic
+  double m_minPacketShare;             //!< capacity share left to the packet-level traffic at least
+  uint64_t m_minSize;                  //!< smallest fluid flow
+  uint32_t m_classes;                  //!< classes simulated as fluid flows
+  TracedCallback<uint32_t, Time, Time> m_completionTrace; //!< fluid flows ended
+};
+
+} // namespace dcn
+} // namespace ns3
+
+#endif /* FLUID_FLOW_MODEL_H */
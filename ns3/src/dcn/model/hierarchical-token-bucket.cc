@@ -0,0 +1,562 @@
+#include "hierarchical-token-bucket.h"
+
+#include <limits>
+#include <vector>
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/node-list.h"
+#include "ns3/trace-source-accessor.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HierarchicalTokenBucket");
+
+namespace dcn {
+
+static const int64_t NS_PER_S = 1000000000;
+
+TokenBucket::TokenBucket ()
+  : m_rate (0),
+    m_depth (0),
+    m_tokens (std::numeric_limits<int64_t>::max ()),
+    m_last (0)
+{
+}
+
+void
+TokenBucket::Configure (DataRate rate, uint64_t depth, int64_t now)
+{
+  Update (now);
+  m_rate = rate.GetBitRate ();
+  // keep enough headroom below INT64_MAX for Update and Consume
+  uint64_t maxDepth = static_cast<uint64_t> (std::numeric_limits<int64_t>::max () / 4 / NS_PER_S);
+  m_depth = static_cast<int64_t> (std::min (depth, maxDepth)) * NS_PER_S;
+  m_tokens = std::min (m_tokens, m_depth);
+}
+
+bool
+TokenBucket::IsLimited (void) const
+{
+  return m_rate != 0;
+}
+
+void
+TokenBucket::Update (int64_t now)
+{
+  int64_t elapsed = now - m_last;
+  m_last = now;
+  if (m_rate == 0 || elapsed <= 0 || m_tokens >= m_depth)
+    {
+      return;
+    }
+  uint64_t need = static_cast<uint64_t> (m_depth - m_tokens);
+  if (static_cast<uint64_t> (elapsed) > need / m_rate)
+    {
+      m_tokens = m_depth;
+    }
+  else
+    {
+      // elapsed * m_rate <= need, no overflow
+      m_tokens += static_cast<int64_t> (elapsed * m_rate);
+    }
+}
+
+int64_t
+TokenBucket::GetDelay (uint64_t bits) const
+{
+  if (m_rate == 0)
+    {
+      return 0;
+    }
+  // a packet larger than the bucket conforms once the bucket is full
+  int64_t want = std::min (static_cast<int64_t> (bits) * NS_PER_S, m_depth);
+  if (m_tokens >= want)
+    {
+      return 0;
+    }
+  uint64_t deficit = static_cast<uint64_t> (want - m_tokens);
+  return static_cast<int64_t> ((deficit + m_rate - 1) / m_rate);
+}
+
+void
+TokenBucket::Consume (uint64_t bits)
+{
+  if (m_rate != 0)
+    {
+      m_tokens -= static_cast<int64_t> (bits) * NS_PER_S;
+    }
+}
+
+NS_OBJECT_ENSURE_REGISTERED (TokenBucketScheduler);
+
+TypeId
+TokenBucketScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::dcn::TokenBucketScheduler")
+      .SetParent<Object> ()
+      .SetGroupName ("DCN")
+      .AddConstructor<TokenBucketScheduler> ()
+  ;
+  return tid;
+}
+
+TokenBucketScheduler::TokenBucketScheduler ()
+  : m_eventTime (-1),
+    m_nRelease (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TokenBucketScheduler::~TokenBucketScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<TokenBucketScheduler>
+TokenBucketScheduler::GetScheduler (Ptr<Node> node)
+{
+  Ptr<TokenBucketScheduler> scheduler = node->GetObject<TokenBucketScheduler> ();
+  if (scheduler == 0)
+    {
+      scheduler = CreateObject<TokenBucketScheduler> ();
+      node->AggregateObject (scheduler);
+    }
+  return scheduler;
+}
+
+void
+TokenBucketScheduler::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  m_wake.clear ();
+  m_time.clear ();
+  Object::DoDispose ();
+}
+
+void
+TokenBucketScheduler::Wake (HierarchicalTokenBucket *filter, int64_t when)
+{
+  NS_LOG_FUNCTION (this << filter << when);
+  std::map<HierarchicalTokenBucket *, int64_t>::iterator it = m_time.find (filter);
+  if (it != m_time.end ())
+    {
+      if (it->second <= when)
+        {
+          return;
+        }
+      m_wake.erase (std::make_pair (it->second, filter));
+      it->second = when;
+    }
+  else
+    {
+      m_time[filter] = when;
+    }
+  m_wake.insert (std::make_pair (when, filter));
+  Arm ();
+}
+
+void
+TokenBucketScheduler::Cancel (HierarchicalTokenBucket *filter)
+{
+  NS_LOG_FUNCTION (this << filter);
+  std::map<HierarchicalTokenBucket *, int64_t>::iterator it = m_time.find (filter);
+  if (it != m_time.end ())
+    {
+      m_wake.erase (std::make_pair (it->second, filter));
+      m_time.erase (it);
+    }
+}
+
+uint64_t
+TokenBucketScheduler::GetNRelease (void) const
+{
+  return m_nRelease;
+}
+
+void
+TokenBucketScheduler::Arm (void)
+{
+  if (m_wake.empty ())
+    {
+      return;
+    }
+  int64_t earliest = m_wake.begin ()->first;
+  if (m_event.IsRunning () && m_eventTime <= earliest)
+    {
+      // a pending release comes first, it will rearm
+      return;
+    }
+  m_event.Cancel ();
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  m_eventTime = std::max (earliest, now);
+  m_event = Simulator::Schedule (NanoSeconds (m_eventTime - now),
+                                 &TokenBucketScheduler::Release, this);
+}
+
+void
+TokenBucketScheduler::Release (void)
+{
+  NS_LOG_FUNCTION (this);
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  m_eventTime = -1;
+  m_nRelease++;
+
+  std::vector<HierarchicalTokenBucket *> due;
+  while (!m_wake.empty () && m_wake.begin ()->first <= now)
+    {
+      due.push_back (m_wake.begin ()->second);
+      m_time.erase (m_wake.begin ()->second);
+      m_wake.erase (m_wake.begin ());
+    }
+  for (std::vector<HierarchicalTokenBucket *>::iterator it = due.begin (); it != due.end (); ++it)
+    {
+      int64_t next = (*it)->Release (now);
+      if (next >= 0)
+        {
+          Wake (*it, next);
+        }
+    }
+  Arm ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (HierarchicalTokenBucket);
+
+TypeId
+HierarchicalTokenBucket::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::dcn::HierarchicalTokenBucket")
+      .SetParent<Connector> ()
+      .SetGroupName ("DCN")
+      .AddConstructor<HierarchicalTokenBucket> ()
+      .AddAttribute ("DataRate",
+                     "The host rate, 0 for unlimited",
+                     DataRateValue (DataRate (0)),
+                     MakeDataRateAccessor (&HierarchicalTokenBucket::m_rate),
+                     MakeDataRateChecker ())
+      .AddAttribute ("Bucket",
+                     "The host bucket in bits",
+                     UintegerValue (12000),
+                     MakeUintegerAccessor (&HierarchicalTokenBucket::m_bucket),
+                     MakeUintegerChecker<uint64_t> ())
+      .AddAttribute ("DestinationDataRate",
+                     "The default rate of a destination class, 0 for unlimited",
+                     DataRateValue (DataRate (0)),
+                     MakeDataRateAccessor (&HierarchicalTokenBucket::m_dstRate),
+                     MakeDataRateChecker ())
+      .AddAttribute ("DestinationBucket",
+                     "The default bucket of a destination class in bits",
+                     UintegerValue (12000),
+                     MakeUintegerAccessor (&HierarchicalTokenBucket::m_dstBucket),
+                     MakeUintegerChecker<uint64_t> ())
+      .AddAttribute ("FlowDataRate",
+                     "The default rate of a flow class, 0 for unlimited",
+                     DataRateValue (DataRate (0)),
+                     MakeDataRateAccessor (&HierarchicalTokenBucket::m_flowRate),
+                     MakeDataRateChecker ())
+      .AddAttribute ("FlowBucket",
+                     "The default bucket of a flow class in bits",
+                     UintegerValue (12000),
+                     MakeUintegerAccessor (&HierarchicalTokenBucket::m_flowBucket),
+                     MakeUintegerChecker<uint64_t> ())
+      .AddAttribute ("QueueLimit",
+                     "Maximum number of packets queued over all the classes",
+                     UintegerValue (1000),
+                     MakeUintegerAccessor (&HierarchicalTokenBucket::m_limit),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddTraceSource ("Drop", "Drop a packet on queue overflow",
+                       MakeTraceSourceAccessor (&HierarchicalTokenBucket::m_dropTrace),
+                       "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+HierarchicalTokenBucket::HierarchicalTokenBucket ()
+  : m_rate (0),
+    m_bucket (0),
+    m_dstRate (0),
+    m_dstBucket (0),
+    m_flowRate (0),
+    m_flowBucket (0),
+    m_limit (0),
+    m_nPackets (0),
+    m_init (true)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HierarchicalTokenBucket::~HierarchicalTokenBucket ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_scheduler != 0)
+    {
+      m_scheduler->Cancel (this);
+    }
+}
+
+void
+HierarchicalTokenBucket::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_scheduler != 0)
+    {
+      m_scheduler->Cancel (this);
+      m_scheduler = 0;
+    }
+  // drop all packet in the queues
+  for (std::list<Flow *>::iterator it = m_active.begin (); it != m_active.end (); ++it)
+    {
+      while (!(*it)->queue.empty ())
+        {
+          if (!m_dropTarget.IsNull ())
+            {
+              m_dropTarget ((*it)->queue.front ());
+            }
+          (*it)->queue.pop_front ();
+        }
+    }
+  m_active.clear ();
+  m_dsts.clear ();
+  m_nPackets = 0;
+  m_classify = MakeNullCallback<std::pair<uint32_t, uint32_t>, Ptr<const Packet> > ();
+  Connector::DoDispose ();
+}
+
+void
+HierarchicalTokenBucket::SetClassifier (ClassifyCallback cb)
+{
+  m_classify = cb;
+}
+
+void
+HierarchicalTokenBucket::SetScheduler (Ptr<TokenBucketScheduler> scheduler)
+{
+  NS_LOG_FUNCTION (this << scheduler);
+  if (m_scheduler != 0)
+    {
+      m_scheduler->Cancel (this);
+    }
+  m_scheduler = scheduler;
+  if (!m_active.empty ())
+    {
+      m_scheduler->Wake (this, Simulator::Now ().GetNanoSeconds ());
+    }
+}
+
+Ptr<TokenBucketScheduler>
+HierarchicalTokenBucket::GetScheduler (void)
+{
+  if (m_scheduler == 0)
+    {
+      // packets are sent in the context of the node the filter runs on,
+      // share the scheduler of that node
+      uint32_t context = Simulator::GetContext ();
+      if (context < NodeList::GetNNodes ())
+        {
+          m_scheduler = TokenBucketScheduler::GetScheduler (NodeList::GetNode (context));
+        }
+      else
+        {
+          m_scheduler = CreateObject<TokenBucketScheduler> ();
+        }
+    }
+  return m_scheduler;
+}
+
+void
+HierarchicalTokenBucket::SetRate (DataRate rate, uint64_t bucket)
+{
+  NS_LOG_FUNCTION (this << rate << bucket);
+  m_rate = rate;
+  m_bucket = bucket;
+  m_host.Configure (m_rate, m_bucket, Simulator::Now ().GetNanoSeconds ());
+  m_init = false;
+  if (!m_active.empty ())
+    {
+      GetScheduler ()->Wake (this, Simulator::Now ().GetNanoSeconds ());
+    }
+}
+
+void
+HierarchicalTokenBucket::SetDestinationRate (uint32_t dst, DataRate rate, uint64_t bucket)
+{
+  NS_LOG_FUNCTION (this << dst << rate << bucket);
+  GetDestination (dst).bucket.Configure (rate, bucket, Simulator::Now ().GetNanoSeconds ());
+  if (!m_active.empty ())
+    {
+      GetScheduler ()->Wake (this, Simulator::Now ().GetNanoSeconds ());
+    }
+}
+
+void
+HierarchicalTokenBucket::SetFlowRate (uint32_t dst, uint32_t flow, DataRate rate, uint64_t bucket)
+{
+  NS_LOG_FUNCTION (this << dst << flow << rate << bucket);
+  GetFlow (dst, flow).bucket.Configure (rate, bucket, Simulator::Now ().GetNanoSeconds ());
+  if (!m_active.empty ())
+    {
+      GetScheduler ()->Wake (this, Simulator::Now ().GetNanoSeconds ());
+    }
+}
+
+uint32_t
+HierarchicalTokenBucket::GetNPackets (void) const
+{
+  return m_nPackets;
+}
+
+HierarchicalTokenBucket::Destination &
+HierarchicalTokenBucket::GetDestination (uint32_t dst)
+{
+  std::map<uint32_t, Destination>::iterator it = m_dsts.find (dst);
+  if (it == m_dsts.end ())
+    {
+      it = m_dsts.insert (std::make_pair (dst, Destination ())).first;
+      it->second.bucket.Configure (m_dstRate, m_dstBucket, Simulator::Now ().GetNanoSeconds ());
+    }
+  return it->second;
+}
+
+HierarchicalTokenBucket::Flow &
+HierarchicalTokenBucket::GetFlow (uint32_t dst, uint32_t flow)
+{
+  Destination &d = GetDestination (dst);
+  std::map<uint32_t, Flow>::iterator it = d.flows.find (flow);
+  if (it == d.flows.end ())
+    {
+      it = d.flows.insert (std::make_pair (flow, Flow ())).first;
+      it->second.bucket.Configure (m_flowRate, m_flowBucket, Simulator::Now ().GetNanoSeconds ());
+      it->second.dst = dst;
+      it->second.active = false;
+    }
+  return it->second;
+}
+
+int64_t
+HierarchicalTokenBucket::GetDelay (Flow &flow, uint64_t bits)
+{
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  TokenBucket &dst = m_dsts[flow.dst].bucket;
+  flow.bucket.Update (now);
+  dst.Update (now);
+  return std::max (m_host.GetDelay (bits),
+                   std::max (dst.GetDelay (bits), flow.bucket.GetDelay (bits)));
+}
+
+void
+HierarchicalTokenBucket::Transmit (Flow &flow, Ptr<Packet> p, uint64_t bits)
+{
+  m_host.Consume (bits);
+  m_dsts[flow.dst].bucket.Consume (bits);
+  flow.bucket.Consume (bits);
+  m_sendTarget (p);
+}
+
+void
+HierarchicalTokenBucket::Send (Ptr<Packet> p)
+{
+  std::pair<uint32_t, uint32_t> cls (0, 0);
+  if (!m_classify.IsNull ())
+    {
+      cls = m_classify (p);
+    }
+  Send (p, cls.first, cls.second);
+}
+
+void
+HierarchicalTokenBucket::Send (Ptr<Packet> p, uint32_t dst, uint32_t flow)
+{
+  NS_LOG_FUNCTION (this << p << dst << flow);
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+
+  // start with a full bucket
+  if (m_init)
+    {
+      m_host.Configure (m_rate, m_bucket, now);
+      m_init = false;
+    }
+
+  if (m_nPackets >= m_limit)
+    {
+      NS_LOG_DEBUG ("Queue full, drop packet: " << p);
+      m_dropTrace (p);
+      if (!m_dropTarget.IsNull ())
+        {
+          m_dropTarget (p);
+        }
+      return;
+    }
+
+  Flow &f = GetFlow (dst, flow);
+  uint64_t bits = static_cast<uint64_t> (p->GetSize ()) << 3; //packet size in bits
+  if (!f.queue.empty ())
+    {
+      // the head of the flow is already waiting for the scheduler
+      f.queue.push_back (p);
+      m_nPackets++;
+      return;
+    }
+
+  m_host.Update (now);
+  int64_t delay = GetDelay (f, bits);
+  if (delay == 0)
+    {
+      Transmit (f, p, bits);
+      return;
+    }
+  NS_LOG_DEBUG ("Enqueue packet: " << p << " eligible in " << delay << "ns");
+  f.queue.push_back (p);
+  m_nPackets++;
+  f.active = true;
+  m_active.push_back (&f);
+  GetScheduler ()->Wake (this, now + delay);
+}
+
+int64_t
+HierarchicalTokenBucket::Release (int64_t now)
+{
+  NS_LOG_FUNCTION (this << now);
+  m_host.Update (now);
+  int64_t next = -1;
+  bool progress = true;
+  while (progress && !m_active.empty ())
+    {
+      // one round robin pass over the backlogged flows
+      progress = false;
+      next = -1;
+      for (size_t n = m_active.size (); n > 0; n--)
+        {
+          Flow *f = m_active.front ();
+          m_active.pop_front ();
+          uint64_t bits = static_cast<uint64_t> (f->queue.front ()->GetSize ()) << 3;
+          int64_t delay = GetDelay (*f, bits);
+          if (delay == 0)
+            {
+              Ptr<Packet> p = f->queue.front ();
+              f->queue.pop_front ();
+              m_nPackets--;
+              Transmit (*f, p, bits);
+              progress = true;
+            }
+          else if (next < 0 || now + delay < next)
+            {
+              next = now + delay;
+            }
+          if (f->queue.empty ())
+            {
+              f->active = false;
+            }
+          else
+            {
+              m_active.push_back (f);
+            }
+        }
+    }
+  return next;
+}
+
+} //namespace dcn
+} //namespace ns3
@@ -0,0 +1,294 @@
+#ifndef HIERARCHICAL_TOKEN_BUCKET_H
+#define HIERARCHICAL_TOKEN_BUCKET_H
+
+#include <stdint.h>
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/traced-callback.h"
+
+#include "connector.h"
+
+namespace ns3 {
+namespace dcn {
+
+class HierarchicalTokenBucket;
+
+/**
+ * \ingroup dcn
+ *
+ * \brief integer, nanosecond exact token bucket
+ *
+ * Tokens are kept in bit-nanoseconds (bits scaled by 10^9) so that
+ * refilling at r bit/s during t ns adds exactly r * t units and no
+ * rounding error accumulates.  A rate of zero means the bucket does
+ * not limit the traffic.
+ */
+class TokenBucket
+{
+public:
+  TokenBucket ();
+  /**
+   * \brief configure the bucket, a new bucket starts full
+   * \param rate the token rate
+   * \param depth the bucket depth in bits
+   * \param now the current time in ns
+   */
+  void Configure (DataRate rate, uint64_t depth, int64_t now);
+  /**
+   * \return true if the bucket limits the traffic
+   */
+  bool IsLimited (void) const;
+  /**
+   * \brief add the tokens accumulated since the last update
+   * \param now the current time in ns
+   */
+  void Update (int64_t now);
+  /**
+   * \param bits the packet size in bits
+   * \return the time in ns until the packet conforms (0 if it does)
+   */
+  int64_t GetDelay (uint64_t bits) const;
+  /**
+   * \brief remove the tokens of a packet
+   * \param bits the packet size in bits
+   */
+  void Consume (uint64_t bits);
+
+private:
+  uint64_t m_rate;   //!< rate in bit/s
+  int64_t m_depth;   //!< depth in bit-ns
+  int64_t m_tokens;  //!< current tokens in bit-ns, may go negative
+  int64_t m_last;    //!< time of the last update in ns
+};
+
+/**
+ * \ingroup dcn
+ *
+ * \brief per node release scheduler for HierarchicalTokenBucket
+ *
+ * Keeps the earliest eligible time of every registered filter and a
+ * single pending event for the earliest of them.  When it fires, every
+ * due filter releases all its conforming packets in one batch.
+ */
+class TokenBucketScheduler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TokenBucketScheduler ();
+  virtual ~TokenBucketScheduler ();
+
+  /**
+   * \brief get the scheduler of a node, aggregating one if needed
+   * \param node the node
+   * \return the scheduler shared by the filters of the node
+   */
+  static Ptr<TokenBucketScheduler> GetScheduler (Ptr<Node> node);
+
+  /**
+   * \brief arm a filter, keeping the earlier time if already armed
+   * \param filter the filter
+   * \param when absolute time in ns of its next eligible packet
+   */
+  void Wake (HierarchicalTokenBucket *filter, int64_t when);
+
+  /**
+   * \brief disarm a filter
+   * \param filter the filter
+   */
+  void Cancel (HierarchicalTokenBucket *filter);
+
+  /**
+   * \return the number of release events executed so far
+   */
+  uint64_t GetNRelease (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief release the packets of all the due filters
+   */
+  void Release (void);
+  /**
+   * \brief make sure an event is pending for the earliest filter
+   */
+  void Arm (void);
+
+  typedef std::set<std::pair<int64_t, HierarchicalTokenBucket *> > WakeSet;
+  WakeSet m_wake;                   //!< filters ordered by eligible time
+  std::map<HierarchicalTokenBucket *, int64_t> m_time; //!< eligible time of each filter
+  EventId m_event;                  //!< the pending release
+  int64_t m_eventTime;              //!< time of the pending release in ns
+  uint64_t m_nRelease;              //!< release events executed
+};
+
+/**
+ * \ingroup dcn
+ *
+ * \brief hierarchical token bucket filter
+ *
+ * Packets are classified into flows, flows are grouped by destination
+ * and every destination shares the host bucket.  A packet leaves when
+ * the host, destination and flow buckets all conform; flows are served
+ * round robin.  Release events are shared by all the filters of a node
+ * through a TokenBucketScheduler, so the number of pending events does
+ * not grow with the number of classes.  Unless SetScheduler is called,
+ * a filter uses the scheduler of the node it first sends a packet from.
+ */
+class HierarchicalTokenBucket : public Connector
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  HierarchicalTokenBucket ();
+  virtual ~HierarchicalTokenBucket ();
+
+  /**
+   * \brief callback to classify a packet into (destination, flow)
+   */
+  typedef Callback<std::pair<uint32_t, uint32_t>, Ptr<const Packet> > ClassifyCallback;
+
+  //inherited from Connector
+  virtual void Send (Ptr<Packet> p);
+
+  /**
+   * \brief send a packet of a known class
+   * \param p the packet
+   * \param dst the destination class
+   * \param flow the flow class within the destination
+   */
+  void Send (Ptr<Packet> p, uint32_t dst, uint32_t flow);
+
+  /**
+   * \brief set the classifier used by Send (Ptr<Packet>)
+   * \param cb the classifier, packets go to class (0, 0) without one
+   */
+  void SetClassifier (ClassifyCallback cb);
+
+  /**
+   * \brief set the scheduler shared with the other filters of the node
+   * \param scheduler the scheduler
+   */
+  void SetScheduler (Ptr<TokenBucketScheduler> scheduler);
+
+  /**
+   * \brief set the host rate
+   * \param rate the rate, 0 for unlimited
+   * \param bucket the depth in bits
+   */
+  void SetRate (DataRate rate, uint64_t bucket);
+  /**
+   * \brief set the rate of a destination class
+   * \param dst the destination
+   * \param rate the rate, 0 for unlimited
+   * \param bucket the depth in bits
+   */
+  void SetDestinationRate (uint32_t dst, DataRate rate, uint64_t bucket);
+  /**
+   * \brief set the rate of a flow class
+   * \param dst the destination
+   * \param flow the flow
+   * \param rate the rate, 0 for unlimited
+   * \param bucket the depth in bits
+   */
+  void SetFlowRate (uint32_t dst, uint32_t flow, DataRate rate, uint64_t bucket);
+
+  /**
+   * \return the number of queued packets
+   */
+  uint32_t GetNPackets (void) const;
+
+  /**
+   * \brief release the conforming packets, called by the scheduler
+   * \param now the current time in ns
+   * \return the time in ns of the next eligible packet, -1 if idle
+   */
+  int64_t Release (int64_t now);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// a flow class
+  struct Flow
+  {
+    TokenBucket bucket;               //!< flow bucket
+    std::deque<Ptr<Packet> > queue;   //!< queued packets
+    uint32_t dst;                     //!< destination class
+    bool active;                      //!< whether in the active list
+  };
+  /// a destination class
+  struct Destination
+  {
+    TokenBucket bucket;               //!< destination bucket
+    std::map<uint32_t, Flow> flows;   //!< flow classes
+  };
+
+  /**
+   * \param dst the destination
+   * \return the destination class, created with the default rate if needed
+   */
+  Destination &GetDestination (uint32_t dst);
+  /**
+   * \param dst the destination
+   * \param flow the flow
+   * \return the flow class, created with the default rate if needed
+   */
+  Flow &GetFlow (uint32_t dst, uint32_t flow);
+  /**
+   * \param flow the flow class
+   * \param bits the size of its head packet in bits
+   * \return the time in ns until the head packet conforms
+   */
+  int64_t GetDelay (Flow &flow, uint64_t bits);
+  /**
+   * \brief remove the tokens of a packet on every level and send it
+   */
+  void Transmit (Flow &flow, Ptr<Packet> p, uint64_t bits);
+  /**
+   * \return the scheduler; if none was set, the scheduler of the node
+   * of the current simulation context, or a private one outside of any
+   * node context
+   */
+  Ptr<TokenBucketScheduler> GetScheduler (void);
+
+  DataRate m_rate;                      //!< host rate
+  uint64_t m_bucket;                    //!< host depth in bits
+  DataRate m_dstRate;                   //!< default destination rate
+  uint64_t m_dstBucket;                 //!< default destination depth
+  DataRate m_flowRate;                  //!< default flow rate
+  uint64_t m_flowBucket;                //!< default flow depth
+  uint32_t m_limit;                     //!< queue limit in packets
+  uint32_t m_nPackets;                  //!< queued packets
+  bool m_init;                          //!< host bucket not configured yet
+  TokenBucket m_host;                   //!< host bucket
+  std::map<uint32_t, Destination> m_dsts; //!< destination classes
+  std::list<Flow *> m_active;           //!< backlogged flows, round robin
+  ClassifyCallback m_classify;          //!< packet classifier
+  Ptr<TokenBucketScheduler> m_scheduler; //!< release scheduler
+  TracedCallback<Ptr<const Packet> > m_dropTrace; //!< dropped packets
+};
+
+} //namespace dcn
+} //namespace ns3
+
+#endif // HIERARCHICAL_TOKEN_BUCKET_H
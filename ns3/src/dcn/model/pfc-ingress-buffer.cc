@@ -0,0 +1,233 @@
+#include "pfc-ingress-buffer.h"
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/traffic-control-layer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PfcIngressBuffer");
+
+namespace dcn {
+
+NS_OBJECT_ENSURE_REGISTERED (PfcIngressBuffer);
+
+TypeId
+PfcIngressBuffer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::dcn::PfcIngressBuffer")
+      .SetParent<Object> ()
+      .SetGroupName ("DCN")
+      .AddConstructor<PfcIngressBuffer> ()
+      .AddAttribute ("XoffThreshold",
+                     "Bytes of a port and priority above which the upstream device is paused",
+                     UintegerValue (100000),
+                     MakeUintegerAccessor (&PfcIngressBuffer::m_xoff),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("XonThreshold",
+                     "Bytes of a port and priority at or below which the upstream device is resumed",
+                     UintegerValue (50000),
+                     MakeUintegerAccessor (&PfcIngressBuffer::m_xon),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("Headroom",
+                     "Bytes of a port and priority accepted above XoffThreshold",
+                     UintegerValue (50000),
+                     MakeUintegerAccessor (&PfcIngressBuffer::m_headroom),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("PauseQuanta",
+                     "Pause time of the PAUSE frames, in quanta of 512 bit times",
+                     UintegerValue (0xffff),
+                     MakeUintegerAccessor (&PfcIngressBuffer::m_quanta),
+                     MakeUintegerChecker<uint16_t> (1))
+      .AddTraceSource ("Drop",
+                       "A frame has been dropped because the headroom is full",
+                       MakeTraceSourceAccessor (&PfcIngressBuffer::m_dropTrace),
+                       "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+PfcIngressBuffer::PfcIngressBuffer ()
+  : m_nPause (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PfcIngressBuffer::~PfcIngressBuffer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<PfcIngressBuffer>
+PfcIngressBuffer::Install (Ptr<Node> node)
+{
+  Ptr<PfcIngressBuffer> buffer = node->GetObject<PfcIngressBuffer> ();
+  if (buffer == 0)
+    {
+      buffer = CreateObject<PfcIngressBuffer> ();
+      node->AggregateObject (buffer);
+      buffer->Setup (node);
+    }
+  return buffer;
+}
+
+void
+PfcIngressBuffer::Setup (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  m_counters.resize (node->GetNDevices () * PfcHeader::PRIORITIES);
+  Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer> ();
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = node->GetDevice (i);
+      device->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&PfcIngressBuffer::Release, this));
+      device->TraceConnectWithoutContext ("MacTxDrop", MakeCallback (&PfcIngressBuffer::Release, this));
+      Ptr<QueueDisc> root = tc ? tc->GetRootQueueDiscOnDevice (device) : 0;
+      if (root)
+        {
+          root->TraceConnectWithoutContext ("Drop", MakeCallback (&PfcIngressBuffer::ReleaseItem, this));
+        }
+      Ptr<PointToPointNetDevice> p2p = DynamicCast<PointToPointNetDevice> (device);
+      if (p2p && p2p->IsPfcEnabled ())
+        {
+          for (uint8_t prio = 0; prio < PfcHeader::PRIORITIES; prio++)
+            {
+              m_counters[i * PfcHeader::PRIORITIES + prio].device = p2p;
+            }
+          p2p->SetPfcIngressCallback (MakeCallback (&PfcIngressBuffer::Admit, this));
+        }
+    }
+  Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol> ();
+  if (ipv4)
+    {
+      ipv4->TraceConnectWithoutContext ("Drop", MakeCallback (&PfcIngressBuffer::ReleaseDrop, this));
+      ipv4->TraceConnectWithoutContext ("LocalDeliver", MakeCallback (&PfcIngressBuffer::ReleaseLocal, this));
+    }
+}
+
+void
+PfcIngressBuffer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_counters.size (); i++)
+    {
+      m_counters[i].refresh.Cancel ();
+    }
+  m_counters.clear ();
+  m_packets.clear ();
+  Object::DoDispose ();
+}
+
+uint32_t
+PfcIngressBuffer::GetBytes (Ptr<NetDevice> device, uint8_t priority) const
+{
+  uint32_t index = device->GetIfIndex () * PfcHeader::PRIORITIES + priority;
+  return index < m_counters.size () ? m_counters[index].bytes : 0;
+}
+
+uint64_t
+PfcIngressBuffer::GetNPause (void) const
+{
+  return m_nPause;
+}
+
+bool
+PfcIngressBuffer::Admit (Ptr<PointToPointNetDevice> device, Ptr<const Packet> p, uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << device << p << (uint32_t) priority);
+  uint32_t index = device->GetIfIndex () * PfcHeader::PRIORITIES + priority;
+  if (index >= m_counters.size () || m_counters[index].device == 0)
+    {
+      return true;
+    }
+  Counter &counter = m_counters[index];
+  uint32_t size = p->GetSize ();
+  if (counter.bytes + size > m_xoff + m_headroom)
+    {
+      NS_LOG_LOGIC ("Headroom of port " << device->GetIfIndex () << " priority " << (uint32_t) priority << " full");
+      m_dropTrace (p);
+      return false;
+    }
+  if (!m_packets.insert (std::make_pair (p->GetUid (), std::make_pair (index, size))).second)
+    {
+      // already accounted, e.g. a packet looped back to the node
+      return true;
+    }
+  counter.bytes += size;
+  if (!counter.paused && counter.bytes > m_xoff)
+    {
+      counter.paused = true;
+      SendPause (index);
+    }
+  return true;
+}
+
+void
+PfcIngressBuffer::SendPause (uint32_t index)
+{
+  Counter &counter = m_counters[index];
+  counter.device->SendPfc (index % PfcHeader::PRIORITIES, m_quanta);
+  m_nPause++;
+  DataRateValue rate;
+  counter.device->GetAttribute ("DataRate", rate);
+  // refresh when half of the pause time has elapsed
+  Time pause = rate.Get ().CalculateBytesTxTime (64 * m_quanta);
+  counter.refresh.Cancel ();
+  counter.refresh = Simulator::Schedule (pause / 2, &PfcIngressBuffer::Refresh, this, index);
+}
+
+void
+PfcIngressBuffer::Refresh (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  if (m_counters[index].paused)
+    {
+      SendPause (index);
+    }
+}
+
+void
+PfcIngressBuffer::Release (Ptr<const Packet> p)
+{
+  std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t> >::iterator it = m_packets.find (p->GetUid ());
+  if (it == m_packets.end ())
+    {
+      return;
+    }
+  uint32_t index = it->second.first;
+  Counter &counter = m_counters[index];
+  counter.bytes -= it->second.second;
+  m_packets.erase (it);
+  if (counter.paused && counter.bytes <= m_xon)
+    {
+      NS_LOG_LOGIC ("Resume port " << index / PfcHeader::PRIORITIES << " priority " << index % PfcHeader::PRIORITIES);
+      counter.paused = false;
+      counter.refresh.Cancel ();
+      counter.device->SendPfc (index % PfcHeader::PRIORITIES, 0);
+    }
+}
+
+void
+PfcIngressBuffer::ReleaseItem (Ptr<const QueueItem> item)
+{
+  Release (item->GetPacket ());
+}
+
+void
+PfcIngressBuffer::ReleaseDrop (const Ipv4Header &header, Ptr<const Packet> p,
+                               Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  Release (p);
+}
+
+void
+PfcIngressBuffer::ReleaseLocal (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface)
+{
+  Release (p);
+}
+
+} // namespace dcn
+} // namespace ns3
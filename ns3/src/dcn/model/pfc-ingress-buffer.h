@@ -0,0 +1,147 @@
+#ifndef PFC_INGRESS_BUFFER_H
+#define PFC_INGRESS_BUFFER_H
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
+#include "ns3/queue-disc.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/point-to-point-net-device.h"
+
+namespace ns3 {
+namespace dcn {
+
+/**
+ * \ingroup dcn
+ *
+ * \brief ingress buffer accounting of a switch running PFC
+ *
+ * Counts the bytes received on each port and priority of a node and not
+ * yet forwarded, like the shared buffer of a lossless switch.  When the
+ * count of a port and priority exceeds XoffThreshold, a PAUSE frame is
+ * sent to the upstream device, and refreshed before it expires; when it
+ * falls back to XonThreshold, the priority is resumed.  Headroom bytes
+ * above XoffThreshold absorb the frames in flight during the pause
+ * round trip; frames beyond it are dropped.
+ *
+ * The bytes of a packet are released when it starts being transmitted
+ * on any device of the node, or is dropped by a root queue disc, the
+ * IPv4 layer or a device, or delivered locally.  Only the
+ * PointToPointNetDevices with PfcEnabled are accounted.
+ */
+class PfcIngressBuffer : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PfcIngressBuffer ();
+  virtual ~PfcIngressBuffer ();
+
+  /**
+   * \brief account the ingress buffer of a node, aggregating a buffer if
+   * needed
+   *
+   * Must be called once the devices, the internet stack and the root
+   * queue discs of the node are installed.
+   *
+   * \param node the node
+   * \return the buffer of the node
+   */
+  static Ptr<PfcIngressBuffer> Install (Ptr<Node> node);
+
+  /**
+   * \param device a device of the node
+   * \param priority a priority
+   * \return the bytes received on the device with this priority and
+   * still in the node
+   */
+  uint32_t GetBytes (Ptr<NetDevice> device, uint8_t priority) const;
+
+  /**
+   * \return the number of PAUSE frames sent, refreshes included
+   */
+  uint64_t GetNPause (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief connect to the devices and the layers of a node
+   * \param node the node
+   */
+  void Setup (Ptr<Node> node);
+
+  /**
+   * \brief PfcIngressCallback of the devices
+   * \param device the receiving device
+   * \param p the frame
+   * \param priority its priority
+   * \return true if the frame fits in the buffer
+   */
+  bool Admit (Ptr<PointToPointNetDevice> device, Ptr<const Packet> p, uint8_t priority);
+  /**
+   * \brief release the bytes of a packet leaving the node
+   * \param p the packet
+   */
+  void Release (Ptr<const Packet> p);
+  /**
+   * \brief release the bytes of a packet dropped by a queue disc
+   * \param item the item dropped
+   */
+  void ReleaseItem (Ptr<const QueueItem> item);
+  /**
+   * \brief release the bytes of a packet dropped by IPv4
+   */
+  void ReleaseDrop (const Ipv4Header &header, Ptr<const Packet> p,
+                    Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * \brief release the bytes of a packet delivered locally
+   */
+  void ReleaseLocal (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface);
+  /**
+   * \brief pause a port and priority again before the previous pause expires
+   * \param index the counter
+   */
+  void Refresh (uint32_t index);
+  /**
+   * \brief send a PAUSE frame and schedule its refresh
+   * \param index the counter
+   */
+  void SendPause (uint32_t index);
+
+  /// accounting of a port and priority
+  struct Counter
+  {
+    Counter () : bytes (0), paused (false) {}
+    Ptr<PointToPointNetDevice> device; //!< the ingress port
+    uint32_t bytes;                    //!< bytes in the node
+    bool paused;                       //!< the upstream device is paused
+    EventId refresh;                   //!< next PAUSE refresh
+  };
+
+  std::vector<Counter> m_counters;     //!< counters by ifIndex and priority
+  /// counter and size of the packets in the node, by packet uid
+  std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t> > m_packets;
+  uint32_t m_xoff;                     //!< pause threshold in bytes
+  uint32_t m_xon;                      //!< resume threshold in bytes
+  uint32_t m_headroom;                 //!< bytes accepted above m_xoff
+  uint16_t m_quanta;                   //!< pause time of the PAUSE frames
+  uint64_t m_nPause;                   //!< PAUSE frames sent
+  TracedCallback<Ptr<const Packet> > m_dropTrace; //!< frames beyond the headroom
+};
+
+} // namespace dcn
+} // namespace ns3
+
+#endif /* PFC_INGRESS_BUFFER_H */
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/red-queue-disc.h"
+#include "ns3/fluid-flow-model.h"
+
+using namespace ns3;
+using namespace ns3::dcn;
+
+/**
+ * Two senders start a fluid flow each, 4 ms apart, through a switch to a
+ * receiver behind a ten times slower link.  The first flow has the
+ * bottleneck to itself, then shares it evenly with the second, which
+ * then has it to itself: both complete in the same time.  While the
+ * bottleneck is saturated its RED queue disc sees a virtual backlog at
+ * MinTh, and its packets get the fair share of a third flow.
+ */
+class FluidFlowSharingTestCase : public TestCase
+{
+public:
+  FluidFlowSharingTestCase ();
+  virtual ~FluidFlowSharingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief record the end of a fluid flow
+   * \param id the flow identifier
+   * \param start the start time of the flow
+   * \param fct the flow completion time
+   */
+  void Completion (uint32_t id, Time start, Time fct);
+  /// \brief check the state of the bottleneck while both flows send
+  void CheckShared (void);
+
+  Ptr<FluidFlowModel> m_model;     //!< the model
+  Ptr<NetDevice> m_bottleneck;     //!< sending device of the bottleneck
+  Ptr<RedQueueDisc> m_red;         //!< its queue disc
+  Time m_fct[2];                   //!< completion time of the flows
+  uint32_t m_completed;            //!< flows completed
+  double m_sharedRate;             //!< fluid rate of the bottleneck while shared
+  double m_sharedBacklog;          //!< virtual backlog of the bottleneck while shared
+  Time m_sharedGap;                //!< interframe gap of the bottleneck while shared
+};
+
+FluidFlowSharingTestCase::FluidFlowSharingTestCase ()
+  : TestCase ("Fluid flows share a bottleneck max-min fairly"),
+    m_completed (0),
+    m_sharedRate (0),
+    m_sharedBacklog (0)
+{
+}
+
+FluidFlowSharingTestCase::~FluidFlowSharingTestCase ()
+{
+}
+
+void
+FluidFlowSharingTestCase::Completion (uint32_t id, Time start, Time fct)
+{
+  m_fct[id] = fct;
+  m_completed++;
+}
+
+void
+FluidFlowSharingTestCase::CheckShared (void)
+{
+  m_sharedRate = m_model->GetFluidRate (m_bottleneck);
+  m_sharedBacklog = m_red->GetVirtualBacklog ();
+  TimeValue gap;
+  m_bottleneck->GetAttribute ("InterframeGap", gap);
+  m_sharedGap = gap.Get ();
+}
+
+void
+FluidFlowSharingTestCase::DoRun (void)
+{
+  NodeContainer senders;
+  senders.Create (2);
+  Ptr<Node> sw = CreateObject<Node> ();
+  Ptr<Node> receiver = CreateObject<Node> ();
+
+  PointToPointHelper p2p;
+  p2p.SetChannelAttribute ("Delay", StringValue ("1us"));
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  NetDeviceContainer access0 = p2p.Install (senders.Get (0), sw);
+  NetDeviceContainer access1 = p2p.Install (senders.Get (1), sw);
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  NetDeviceContainer bottleneck = p2p.Install (sw, receiver);
+
+  InternetStackHelper stack;
+  stack.Install (senders);
+  stack.Install (sw);
+  stack.Install (receiver);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::RedQueueDisc", "MinTh", DoubleValue (10), "MaxTh", DoubleValue (20));
+  tch.Install (bottleneck.Get (0));
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  address.Assign (access0);
+  address.SetBase ("10.0.1.0", "255.255.255.0");
+  address.Assign (access1);
+  address.SetBase ("10.0.2.0", "255.255.255.0");
+  address.Assign (bottleneck);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  m_bottleneck = bottleneck.Get (0);
+  m_red = DynamicCast<RedQueueDisc> (sw->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (m_bottleneck));
+  NS_TEST_ASSERT_MSG_NE (m_red, 0, "no RED queue disc on the bottleneck");
+
+  m_model = CreateObject<FluidFlowModel> ();
+  NodeContainer all (senders, NodeContainer (sw), NodeContainer (receiver));
+  m_model->Install (all);
+  m_model->TraceConnectWithoutContext ("Completion", MakeCallback (&FluidFlowSharingTestCase::Completion, this));
+  NS_TEST_ASSERT_MSG_EQ (m_model->IsFluid (1000000, 0), true, "a large flow of class 0 is not fluid");
+  NS_TEST_ASSERT_MSG_EQ (m_model->IsFluid (999999, 0), false, "a small flow is fluid");
+  NS_TEST_ASSERT_MSG_EQ (m_model->IsFluid (1000000, 1), false, "a flow of class 1 is fluid");
+
+  Simulator::Schedule (MilliSeconds (1), &FluidFlowModel::AddFlow, m_model, senders.Get (0), receiver, 1000000, 0);
+  Simulator::Schedule (MilliSeconds (5), &FluidFlowModel::AddFlow, m_model, senders.Get (1), receiver, 1000000, 1);
+  Simulator::Schedule (MilliSeconds (10), &FluidFlowSharingTestCase::CheckShared, this);
+  Simulator::Stop (MilliSeconds (30));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_completed, 2, "fluid flows not completed");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_sharedRate, 1e9, 1, "the bottleneck is not filled");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_sharedBacklog, 10, 1e-9, "the saturated bottleneck has no virtual backlog");
+  // a frame of 1502 bytes at 1 Gbps, then two more for the fluid flows
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_sharedGap.GetNanoSeconds (), 24032, 1, "the packets get more than a third of the bottleneck");
+  // alone for 4 ms, then shared for 8 ms, plus two links of 1 us
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_fct[i].GetSeconds (), 0.012002, 1e-8, "wrong completion time of flow " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_model->GetNFlows (), 0, "fluid flows left");
+  NS_TEST_EXPECT_MSG_EQ (m_red->GetVirtualBacklog (), 0, "virtual backlog left");
+  TimeValue gap;
+  m_bottleneck->GetAttribute ("InterframeGap", gap);
+  NS_TEST_EXPECT_MSG_EQ (gap.Get (), Seconds (0), "interframe gap left");
+
+  Simulator::Destroy ();
+}
+
+static class FluidFlowTestSuite : public TestSuite
+{
+public:
+  FluidFlowTestSuite ()
+    : TestSuite ("dcn-fluid-flow", UNIT)
+  {
+    AddTestCase (new FluidFlowSharingTestCase, TestCase::QUICK);
+  }
+} g_fluidFlowTestSuite;
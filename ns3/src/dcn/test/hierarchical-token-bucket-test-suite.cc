@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/node.h"
+#include "ns3/hierarchical-token-bucket.h"
+
+using namespace ns3;
+using namespace ns3::dcn;
+
+/**
+ * Record the departure time and flow of every packet
+ */
+class HtbTestSink
+{
+public:
+  void Receive (uint32_t id, Ptr<Packet> p)
+  {
+    times.push_back (Simulator::Now ());
+    ids.push_back (id);
+  }
+  void Drop (Ptr<const Packet> p)
+  {
+    drops++;
+  }
+  HtbTestSink () : drops (0) {}
+  std::vector<Time> times;
+  std::vector<uint32_t> ids;
+  uint32_t drops;
+};
+
+static void
+HtbTestReceive (HtbTestSink *sink, uint32_t id, Ptr<Packet> p)
+{
+  sink->Receive (id, p);
+}
+
+/**
+ * Check that the host bucket releases packets at exact nanosecond times
+ * and drops on queue overflow
+ */
+class HtbPacingTestCase : public TestCase
+{
+public:
+  HtbPacingTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+HtbPacingTestCase::HtbPacingTestCase ()
+  : TestCase ("Hierarchical token bucket paces at the host rate")
+{
+}
+
+void
+HtbPacingTestCase::DoRun (void)
+{
+  HtbTestSink sink;
+  Ptr<HierarchicalTokenBucket> htb = CreateObject<HierarchicalTokenBucket> ();
+  htb->SetAttribute ("QueueLimit", UintegerValue (3));
+  htb->SetSendTarget (MakeBoundCallback (&HtbTestReceive, &sink, 0));
+  htb->SetDropTarget (MakeCallback (&HtbTestSink::Drop, &sink));
+  // 1000 bytes every 1 ms, at most one packet of burst
+  htb->SetRate (DataRate ("8Mbps"), 8000);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      htb->Send (Create<Packet> (1000));
+    }
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (sink.drops, 1, "wrong number of drops");
+  NS_TEST_ASSERT_MSG_EQ (sink.times.size (), 4, "wrong number of packets");
+  for (uint32_t i = 0; i < sink.times.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (sink.times[i], MilliSeconds (i), "packet not released at the exact time");
+    }
+  htb->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Check the destination and flow levels and the batched release of
+ * filters sharing one scheduler
+ */
+class HtbHierarchyTestCase : public TestCase
+{
+public:
+  HtbHierarchyTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+HtbHierarchyTestCase::HtbHierarchyTestCase ()
+  : TestCase ("Hierarchical token bucket classes and batched release")
+{
+}
+
+void
+HtbHierarchyTestCase::DoRun (void)
+{
+  HtbTestSink sink;
+  Ptr<TokenBucketScheduler> scheduler = CreateObject<TokenBucketScheduler> ();
+  Ptr<HierarchicalTokenBucket> a = CreateObject<HierarchicalTokenBucket> ();
+  Ptr<HierarchicalTokenBucket> b = CreateObject<HierarchicalTokenBucket> ();
+  a->SetScheduler (scheduler);
+  b->SetScheduler (scheduler);
+  a->SetSendTarget (MakeBoundCallback (&HtbTestReceive, &sink, 1));
+  b->SetSendTarget (MakeBoundCallback (&HtbTestReceive, &sink, 2));
+
+  // a: the destination limits, both flows share it
+  a->SetDestinationRate (7, DataRate ("8Mbps"), 8000);
+  a->Send (Create<Packet> (1000), 7, 1);
+  a->Send (Create<Packet> (1000), 7, 2);
+  // b: one flow limited to half the rate, the other is not
+  b->SetFlowRate (3, 1, DataRate ("4Mbps"), 8000);
+  b->Send (Create<Packet> (1000), 3, 1);
+  b->Send (Create<Packet> (1000), 3, 1);
+  b->Send (Create<Packet> (1000), 3, 2);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (sink.times.size (), 5, "wrong number of packets");
+  // immediate departures: a flow 1, b flow 1, b flow 2
+  NS_TEST_ASSERT_MSG_EQ (sink.times[2], Seconds (0), "unlimited flow delayed");
+  // a flow 2 at 1 ms, b flow 1 at 2 ms
+  NS_TEST_ASSERT_MSG_EQ (sink.times[3], MilliSeconds (1), "destination rate not enforced");
+  NS_TEST_ASSERT_MSG_EQ (sink.ids[3], 1, "wrong filter released");
+  NS_TEST_ASSERT_MSG_EQ (sink.times[4], MilliSeconds (2), "flow rate not enforced");
+  NS_TEST_ASSERT_MSG_EQ (scheduler->GetNRelease (), 2, "one release event per eligible time expected");
+
+  // both filters due at the same time are released in a single event
+  a->Send (Create<Packet> (1000), 7, 1);
+  a->Send (Create<Packet> (1000), 7, 1);
+  b->SetFlowRate (3, 4, DataRate ("8Mbps"), 8000);
+  b->Send (Create<Packet> (1000), 3, 4);
+  b->Send (Create<Packet> (1000), 3, 4);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (sink.times.size (), 9, "wrong number of packets");
+  NS_TEST_ASSERT_MSG_EQ (sink.times[6], MilliSeconds (2), "wrong release time");
+  NS_TEST_ASSERT_MSG_EQ (sink.times[7], MilliSeconds (3), "wrong release time");
+  NS_TEST_ASSERT_MSG_EQ (sink.times[8], MilliSeconds (3), "wrong release time");
+  NS_TEST_ASSERT_MSG_EQ (scheduler->GetNRelease (), 3, "filters not released in a batch");
+
+  a->Dispose ();
+  b->Dispose ();
+  Simulator::Destroy ();
+}
+
+static void
+HtbTestSend (Ptr<HierarchicalTokenBucket> htb, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      htb->Send (Create<Packet> (1000));
+    }
+}
+
+/**
+ * Check that filters without an explicit scheduler share the one of
+ * the node they send from
+ */
+class HtbNodeSchedulerTestCase : public TestCase
+{
+public:
+  HtbNodeSchedulerTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+HtbNodeSchedulerTestCase::HtbNodeSchedulerTestCase ()
+  : TestCase ("Hierarchical token buckets default to the node scheduler")
+{
+}
+
+void
+HtbNodeSchedulerTestCase::DoRun (void)
+{
+  HtbTestSink sink;
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<HierarchicalTokenBucket> a = CreateObject<HierarchicalTokenBucket> ();
+  Ptr<HierarchicalTokenBucket> b = CreateObject<HierarchicalTokenBucket> ();
+  a->SetSendTarget (MakeBoundCallback (&HtbTestReceive, &sink, 1));
+  b->SetSendTarget (MakeBoundCallback (&HtbTestReceive, &sink, 2));
+  a->SetRate (DataRate ("8Mbps"), 8000);
+  b->SetRate (DataRate ("8Mbps"), 8000);
+  Simulator::ScheduleWithContext (node->GetId (), Seconds (0), &HtbTestSend, a, 2);
+  Simulator::ScheduleWithContext (node->GetId (), Seconds (0), &HtbTestSend, b, 2);
+  Simulator::Run ();
+
+  Ptr<TokenBucketScheduler> scheduler = node->GetObject<TokenBucketScheduler> ();
+  NS_TEST_ASSERT_MSG_NE (scheduler, 0, "no scheduler aggregated on the node");
+  NS_TEST_ASSERT_MSG_EQ (sink.times.size (), 4, "wrong number of packets");
+  NS_TEST_ASSERT_MSG_EQ (sink.times[3], MilliSeconds (1), "wrong release time");
+  NS_TEST_ASSERT_MSG_EQ (scheduler->GetNRelease (), 1, "filters of the node not released in a batch");
+
+  a->Dispose ();
+  b->Dispose ();
+  Simulator::Destroy ();
+}
+
+static class HierarchicalTokenBucketTestSuite : public TestSuite
+{
+public:
+  HierarchicalTokenBucketTestSuite ()
+    : TestSuite ("hierarchical-token-bucket", UNIT)
+  {
+    AddTestCase (new HtbPacingTestCase (), TestCase::QUICK);
+    AddTestCase (new HtbHierarchyTestCase (), TestCase::QUICK);
+    AddTestCase (new HtbNodeSchedulerTestCase (), TestCase::QUICK);
+  }
+} g_hierarchicalTokenBucketTestSuite;
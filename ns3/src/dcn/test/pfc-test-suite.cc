@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/pfc-ingress-buffer.h"
+
+using namespace ns3;
+using namespace ns3::dcn;
+
+/**
+ * Two senders blast UDP through a switch to a receiver behind a ten times
+ * slower link.  With the ingress buffer of the switch running PFC the
+ * senders are paused and nothing is lost; without it the egress queue of
+ * the switch overflows.
+ */
+class PfcIncastTestCase : public TestCase
+{
+public:
+  /**
+   * \param pfc whether the switch runs PFC
+   */
+  PfcIncastTestCase (bool pfc);
+  virtual ~PfcIncastTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief send the next packet of a sender
+   * \param socket the socket of the sender
+   * \param left packets left to send
+   */
+  void Send (Ptr<Socket> socket, uint32_t left);
+  /// \param socket the receiving socket
+  void Receive (Ptr<Socket> socket);
+  /// \param item a packet dropped by the switch
+  void Drop (Ptr<const QueueItem> item);
+  /**
+   * \brief count the pauses of the senders
+   * \param priority the priority paused
+   * \param duration the pause time
+   */
+  void Pause (uint8_t priority, Time duration);
+
+  bool m_pfc;          //!< the switch runs PFC
+  Ipv4Address m_sink;  //!< address of the receiver
+  uint32_t m_received; //!< packets received
+  uint32_t m_drops;    //!< packets dropped by the switch
+  uint32_t m_pauses;   //!< pauses of the senders
+};
+
+static const uint32_t PFC_TEST_PACKETS = 400;
+static const uint32_t PFC_TEST_SIZE = 1000;
+
+PfcIncastTestCase::PfcIncastTestCase (bool pfc)
+  : TestCase (pfc ? "PFC makes an incast lossless" : "An incast without PFC overflows the switch"),
+    m_pfc (pfc),
+    m_received (0),
+    m_drops (0),
+    m_pauses (0)
+{
+}
+
+PfcIncastTestCase::~PfcIncastTestCase ()
+{
+}
+
+void
+PfcIncastTestCase::Send (Ptr<Socket> socket, uint32_t left)
+{
+  socket->SendTo (Create<Packet> (PFC_TEST_SIZE), 0, InetSocketAddress (m_sink, 9));
+  if (left > 1)
+    {
+      // 10 Gb/s
+      Simulator::Schedule (NanoSeconds (PFC_TEST_SIZE * 8 / 10), &PfcIncastTestCase::Send, this, socket, left - 1);
+    }
+}
+
+void
+PfcIncastTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+PfcIncastTestCase::Drop (Ptr<const QueueItem> item)
+{
+  m_drops++;
+}
+
+void
+PfcIncastTestCase::Pause (uint8_t priority, Time duration)
+{
+  m_pauses++;
+}
+
+void
+PfcIncastTestCase::DoRun (void)
+{
+  NodeContainer senders;
+  senders.Create (2);
+  Ptr<Node> sw = CreateObject<Node> ();
+  Ptr<Node> receiver = CreateObject<Node> ();
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("PfcEnabled", BooleanValue (true));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1us"));
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  NetDeviceContainer access0 = p2p.Install (senders.Get (0), sw);
+  NetDeviceContainer access1 = p2p.Install (senders.Get (1), sw);
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  NetDeviceContainer bottleneck = p2p.Install (sw, receiver);
+
+  InternetStackHelper stack;
+  stack.Install (senders);
+  stack.Install (sw);
+  stack.Install (receiver);
+
+  // the senders hold their backlog while paused
+  TrafficControlHelper host;
+  host.SetRootQueueDisc ("ns3::PfcQueueDisc", "Limit", UintegerValue (1000));
+  host.Install (access0.Get (0));
+  host.Install (access1.Get (0));
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::PfcQueueDisc", "Limit", UintegerValue (100));
+  tch.Install (access0.Get (1));
+  tch.Install (access1.Get (1));
+  tch.Install (bottleneck);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  address.Assign (access0);
+  address.SetBase ("10.0.1.0", "255.255.255.0");
+  address.Assign (access1);
+  address.SetBase ("10.0.2.0", "255.255.255.0");
+  m_sink = address.Assign (bottleneck).GetAddress (1);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<PfcIngressBuffer> buffer;
+  if (m_pfc)
+    {
+      buffer = PfcIngressBuffer::Install (sw);
+      buffer->SetAttribute ("XoffThreshold", UintegerValue (20000));
+      buffer->SetAttribute ("XonThreshold", UintegerValue (10000));
+      buffer->SetAttribute ("Headroom", UintegerValue (20000));
+    }
+  sw->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (bottleneck.Get (0))
+    ->TraceConnectWithoutContext ("Drop", MakeCallback (&PfcIncastTestCase::Drop, this));
+  access0.Get (0)->TraceConnectWithoutContext ("Pause", MakeCallback (&PfcIncastTestCase::Pause, this));
+  access1.Get (0)->TraceConnectWithoutContext ("Pause", MakeCallback (&PfcIncastTestCase::Pause, this));
+
+  Ptr<Socket> sink = Socket::CreateSocket (receiver, UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->SetRecvCallback (MakeCallback (&PfcIncastTestCase::Receive, this));
+  for (uint32_t i = 0; i < senders.GetN (); i++)
+    {
+      Ptr<Socket> socket = Socket::CreateSocket (senders.Get (i), UdpSocketFactory::GetTypeId ());
+      socket->Bind ();
+      Simulator::Schedule (MicroSeconds (10), &PfcIncastTestCase::Send, this, socket, PFC_TEST_PACKETS);
+    }
+
+  Simulator::Stop (MilliSeconds (20));
+  Simulator::Run ();
+
+  if (m_pfc)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received, 2 * PFC_TEST_PACKETS, "packets lost despite PFC");
+      NS_TEST_EXPECT_MSG_EQ (m_drops, 0, "the switch dropped packets");
+      NS_TEST_EXPECT_MSG_GT (m_pauses, 0, "the senders were never paused");
+      NS_TEST_EXPECT_MSG_GT (buffer->GetNPause (), 0, "no PAUSE frame sent");
+      for (uint8_t prio = 0; prio < PfcHeader::PRIORITIES; prio++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (buffer->GetBytes (access0.Get (1), prio), 0, "bytes left in the ingress buffer");
+          NS_TEST_EXPECT_MSG_EQ (buffer->GetBytes (access1.Get (1), prio), 0, "bytes left in the ingress buffer");
+        }
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_GT (m_drops, 0, "the switch did not overflow");
+      NS_TEST_EXPECT_MSG_EQ (m_received + m_drops, 2 * PFC_TEST_PACKETS, "packets unaccounted for");
+      NS_TEST_EXPECT_MSG_EQ (m_pauses, 0, "the senders were paused");
+    }
+  Simulator::Destroy ();
+}
+
+static class PfcTestSuite : public TestSuite
+{
+public:
+  PfcTestSuite ()
+    : TestSuite ("dcn-pfc", UNIT)
+  {
+    AddTestCase (new PfcIncastTestCase (true), TestCase::QUICK);
+    AddTestCase (new PfcIncastTestCase (false), TestCase::QUICK);
+  }
+} g_pfcTestSuite;
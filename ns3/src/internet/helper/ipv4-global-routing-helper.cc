@@ -71,5 +71,17 @@ Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
   GlobalRouteManager::InitializeRoutes ();
 }
 
+void
+Ipv4GlobalRoutingHelper::RepairLinkDown (Ptr<Channel> channel)
+{
+  GlobalRouteManager::RepairLinkDown (channel);
+}
+
+void
+Ipv4GlobalRoutingHelper::RepairLinkUp (Ptr<Channel> channel)
+{
+  GlobalRouteManager::RepairLinkUp (channel);
+}
+
 
 } // namespace ns3
@@ -22,6 +22,7 @@
 
 #include "ns3/node-container.h"
 #include "ns3/ipv4-routing-helper.h"
+#include "ns3/channel.h"
 
 namespace ns3 {
 
@@ -84,6 +85,23 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Repair the routing tables after a link went down.
+   *
+   * Unlike RecomputeRoutingTables, only the routes through the channel,
+   * and the equal cost groups of the nodes upstream which would reach a
+   * node left without route, are changed.  The repair holds across
+   * RecomputeRoutingTables until RepairLinkUp is called.
+   *
+   * \param channel the channel which went down
+   */
+  static void RepairLinkDown (Ptr<Channel> channel);
+  /**
+   * \brief Restore the routes changed by RepairLinkDown.
+   *
+   * \param channel the channel which came back up
+   */
+  static void RepairLinkUp (Ptr<Channel> channel);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
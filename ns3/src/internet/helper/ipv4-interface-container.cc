@@ -86,6 +86,12 @@ Ipv4InterfaceContainer::Add (std::string ipv4Name, uint32_t interface)
   m_interfaces.push_back (std::make_pair (ipv4, interface));
 }
 
+void
+Ipv4InterfaceContainer::Reserve (uint32_t n)
+{
+  m_interfaces.reserve (n);
+}
+
 std::pair<Ptr<Ipv4>, uint32_t>
 Ipv4InterfaceContainer::Get (uint32_t i) const
 {
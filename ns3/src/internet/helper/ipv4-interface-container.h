@@ -189,6 +189,14 @@ public:
    */
   void Add (std::string ipv4Name, uint32_t interface);
 
+  /**
+   * Reserve room for a number of entries, so that adding them one by
+   * one does not reallocate the container.
+   *
+   * \param n the total number of entries the container will hold
+   */
+  void Reserve (uint32_t n);
+
   /**
    * Get the std::pair of an Ptr<Ipv4> and interface stored at the location 
    * specified by the index.
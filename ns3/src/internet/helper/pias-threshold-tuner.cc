@@ -0,0 +1,113 @@
+#include "pias-threshold-tuner.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PiasThresholdTuner");
+
+PiasThresholdTuner::PiasThresholdTuner ()
+{
+}
+
+bool
+PiasThresholdTuner::LoadCdf (const std::string &fileName, double sizeScale)
+{
+  NS_LOG_FUNCTION (this << fileName << sizeScale);
+  std::ifstream in (fileName.c_str ());
+  if (!in.is_open ())
+    {
+      NS_LOG_WARN ("Cannot open " << fileName);
+      return false;
+    }
+  std::string line;
+  while (std::getline (in, line))
+    {
+      std::istringstream iss (line);
+      std::vector<double> columns;
+      double value;
+      while (iss >> value)
+        {
+          columns.push_back (value);
+        }
+      if (columns.size () >= 2)
+        {
+          AddPoint (columns.front () * sizeScale, columns.back ());
+        }
+    }
+  return !m_cdf.empty ();
+}
+
+void
+PiasThresholdTuner::AddPoint (double size, double cdf)
+{
+  NS_LOG_FUNCTION (this << size << cdf);
+  std::pair<double, double> point (size, cdf);
+  m_cdf.insert (std::upper_bound (m_cdf.begin (), m_cdf.end (), point), point);
+}
+
+double
+PiasThresholdTuner::GetQuantile (double cdf) const
+{
+  NS_ASSERT (!m_cdf.empty ());
+  if (cdf <= m_cdf.front ().second)
+    {
+      return m_cdf.front ().first;
+    }
+  for (uint32_t i = 1; i < m_cdf.size (); i++)
+    {
+      if (cdf <= m_cdf[i].second)
+        {
+          const std::pair<double, double> &a = m_cdf[i - 1];
+          const std::pair<double, double> &b = m_cdf[i];
+          if (b.second == a.second)
+            {
+              return a.first;
+            }
+          return a.first + (b.first - a.first) * (cdf - a.second) / (b.second - a.second);
+        }
+    }
+  return m_cdf.back ().first;
+}
+
+std::vector<uint64_t>
+PiasThresholdTuner::GetThresholds (uint32_t levels) const
+{
+  NS_LOG_FUNCTION (this << levels);
+  std::vector<uint64_t> thresholds;
+  if (m_cdf.empty ())
+    {
+      return thresholds;
+    }
+  for (uint32_t j = 1; j < levels; j++)
+    {
+      uint64_t threshold = std::llround (GetQuantile (double (j) / levels));
+      // a flow must be able to send at least one byte in each level
+      if (!thresholds.empty () && threshold <= thresholds.back ())
+        {
+          threshold = thresholds.back () + 1;
+        }
+      thresholds.push_back (threshold);
+    }
+  return thresholds;
+}
+
+std::string
+PiasThresholdTuner::GetThresholdsString (uint32_t levels) const
+{
+  std::vector<uint64_t> thresholds = GetThresholds (levels);
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < thresholds.size (); i++)
+    {
+      oss << (i ? "," : "") << thresholds[i];
+    }
+  return oss.str ();
+}
+
+} // namespace ns3
@@ -0,0 +1,67 @@
+#ifndef PIAS_THRESHOLD_TUNER_H
+#define PIAS_THRESHOLD_TUNER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Derive the demotion thresholds of a PiasIpv4PacketFilter from
+ * the flow size distribution of the workload
+ *
+ * The thresholds split the distribution in quantiles, so that the flows
+ * finishing at each priority level are equally many: the short flows
+ * complete in the high priorities, and the long flows, which are few but
+ * carry most of the bytes, end in the low ones.
+ */
+class PiasThresholdTuner
+{
+public:
+  PiasThresholdTuner ();
+
+  /**
+   * @brief Load a flow size distribution
+   * @param fileName a file with one point per line, the flow size in the
+   * first column and the cumulative probability in the last one, as in
+   * the workload files of the traffic generators
+   * @param sizeScale the factor converting the sizes to bytes, e.g. the
+   * packet size if the sizes are in packets
+   * @return false if the file cannot be read
+   */
+  bool LoadCdf (const std::string &fileName, double sizeScale = 1);
+
+  /**
+   * @brief Add a point of the flow size distribution
+   * @param size the flow size in bytes
+   * @param cdf the probability that a flow is not larger than size
+   */
+  void AddPoint (double size, double cdf);
+
+  /**
+   * @param levels the number of priority levels
+   * @return the levels - 1 thresholds in bytes, increasing
+   */
+  std::vector<uint64_t> GetThresholds (uint32_t levels) const;
+
+  /**
+   * @param levels the number of priority levels
+   * @return the thresholds, separated by commas, as the Thresholds
+   * attribute of PiasIpv4PacketFilter
+   */
+  std::string GetThresholdsString (uint32_t levels) const;
+
+private:
+  /**
+   * @param cdf a cumulative probability
+   * @return the flow size at this probability, interpolated linearly
+   */
+  double GetQuantile (double cdf) const;
+
+  std::vector<std::pair<double, double> > m_cdf;  //!< points (size, cdf), sorted
+};
+
+} // namespace ns3
+
+#endif // PIAS_THRESHOLD_TUNER_H
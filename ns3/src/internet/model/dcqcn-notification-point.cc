@@ -0,0 +1,147 @@
+#include "dcqcn-notification-point.h"
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/inet-socket-address.h"
+#include "ipv4-header.h"
+#include "udp-socket-factory.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DcqcnNotificationPoint");
+
+NS_OBJECT_ENSURE_REGISTERED (DcqcnNotificationPoint);
+
+TypeId
+DcqcnNotificationPoint::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DcqcnNotificationPoint")
+      .SetParent<Object> ()
+      .SetGroupName ("Internet")
+      .AddConstructor<DcqcnNotificationPoint> ()
+      .AddAttribute ("Port",
+                     "UDP port of the notification point",
+                     UintegerValue (4791),
+                     MakeUintegerAccessor (&DcqcnNotificationPoint::m_port),
+                     MakeUintegerChecker<uint16_t> ())
+      .AddAttribute ("CnpInterval",
+                     "Minimum time between two CNP to the same sender",
+                     TimeValue (MicroSeconds (50)),
+                     MakeTimeAccessor (&DcqcnNotificationPoint::m_cnpInterval),
+                     MakeTimeChecker ())
+      .AddAttribute ("CnpSize",
+                     "Payload of the CNP",
+                     UintegerValue (16),
+                     MakeUintegerAccessor (&DcqcnNotificationPoint::m_cnpSize),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddTraceSource ("Rx",
+                       "A datagram has been received",
+                       MakeTraceSourceAccessor (&DcqcnNotificationPoint::m_rxTrace),
+                       "ns3::Packet::AddressTracedCallback")
+      .AddTraceSource ("Cnp",
+                       "A CNP has been sent",
+                       MakeTraceSourceAccessor (&DcqcnNotificationPoint::m_cnpTrace),
+                       "ns3::Packet::AddressTracedCallback")
+  ;
+  return tid;
+}
+
+DcqcnNotificationPoint::DcqcnNotificationPoint ()
+  : m_port (4791),
+    m_cnpSize (16),
+    m_received (0),
+    m_nMarked (0),
+    m_nCnp (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DcqcnNotificationPoint::~DcqcnNotificationPoint ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DcqcnNotificationPoint::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  m_lastCnp.clear ();
+  Object::DoDispose ();
+}
+
+void
+DcqcnNotificationPoint::Setup (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  m_socket = Socket::CreateSocket (node, UdpSocketFactory::GetTypeId ());
+  m_socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_port));
+  // the TOS of the datagrams carries their ECN codepoint
+  m_socket->SetIpRecvTos (true);
+  m_socket->SetRecvCallback (MakeCallback (&DcqcnNotificationPoint::HandleRead, this));
+}
+
+void
+DcqcnNotificationPoint::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_socket)
+    {
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_socket->Close ();
+      m_socket = 0;
+    }
+}
+
+uint64_t
+DcqcnNotificationPoint::GetReceivedBytes (void) const
+{
+  return m_received;
+}
+
+uint32_t
+DcqcnNotificationPoint::GetNMarked (void) const
+{
+  return m_nMarked;
+}
+
+uint32_t
+DcqcnNotificationPoint::GetNCnp (void) const
+{
+  return m_nCnp;
+}
+
+void
+DcqcnNotificationPoint::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      m_received += packet->GetSize ();
+      m_rxTrace (packet, from);
+
+      SocketIpTosTag tosTag;
+      if (!packet->PeekPacketTag (tosTag) || (tosTag.GetTos () & 0x03) != Ipv4Header::ECN_CE)
+        {
+          continue;
+        }
+      m_nMarked++;
+      Time now = Simulator::Now ();
+      std::map<Address, Time>::iterator it = m_lastCnp.find (from);
+      if (it != m_lastCnp.end () && now - it->second < m_cnpInterval)
+        {
+          continue;
+        }
+      m_lastCnp[from] = now;
+      Ptr<Packet> cnp = Create<Packet> (m_cnpSize);
+      m_cnpTrace (cnp, from);
+      m_nCnp++;
+      socket->SendTo (cnp, 0, from);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,91 @@
+#ifndef DCQCN_NOTIFICATION_POINT_H
+#define DCQCN_NOTIFICATION_POINT_H
+
+#include <map>
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/address.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup internet
+ *
+ * \brief DCQCN notification point: the receiver of DcqcnReactionPoint flows
+ *
+ * Receives the datagrams of the reaction points on a UDP port.  When a
+ * datagram arrives with the CE codepoint, a congestion notification
+ * packet (CNP) is sent back to its sender, at most once per CnpInterval
+ * for each sender.
+ */
+class DcqcnNotificationPoint : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  DcqcnNotificationPoint ();
+  virtual ~DcqcnNotificationPoint ();
+
+  /**
+   * \brief start receiving on the Port of a node
+   * \param node the receiving node
+   */
+  void Setup (Ptr<Node> node);
+
+  /**
+   * \brief stop receiving and close the socket
+   */
+  void Close (void);
+
+  /**
+   * \return the bytes received
+   */
+  uint64_t GetReceivedBytes (void) const;
+
+  /**
+   * \return the number of datagrams received with CE
+   */
+  uint32_t GetNMarked (void) const;
+
+  /**
+   * \return the number of CNP sent
+   */
+  uint32_t GetNCnp (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief receive the datagrams
+   * \param socket the socket
+   */
+  void HandleRead (Ptr<Socket> socket);
+
+  Ptr<Socket> m_socket;           //!< the UDP socket
+  uint16_t m_port;                //!< the UDP port
+  Time m_cnpInterval;             //!< minimum time between the CNP of a sender
+  uint32_t m_cnpSize;             //!< payload of the CNP
+  std::map<Address, Time> m_lastCnp; //!< time of the last CNP of each sender
+  uint64_t m_received;            //!< bytes received
+  uint32_t m_nMarked;             //!< datagrams received with CE
+  uint32_t m_nCnp;                //!< CNP sent
+
+  /// Traced callback: datagram received
+  TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
+  /// Traced callback: CNP sent
+  TracedCallback<Ptr<const Packet>, const Address &> m_cnpTrace;
+};
+
+} // namespace ns3
+
+#endif /* DCQCN_NOTIFICATION_POINT_H */
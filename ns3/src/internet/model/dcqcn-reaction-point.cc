@@ -0,0 +1,407 @@
+#include "dcqcn-reaction-point.h"
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/ipv4-header.h"
+#include "udp-socket-factory.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DcqcnReactionPoint");
+
+NS_OBJECT_ENSURE_REGISTERED (DcqcnScheduler);
+
+/// IPv4 and UDP header bytes of a datagram, paced with its payload
+static const uint32_t DCQCN_HEADER_BYTES = 28;
+
+TypeId
+DcqcnScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DcqcnScheduler")
+      .SetParent<Object> ()
+      .SetGroupName ("Internet")
+      .AddConstructor<DcqcnScheduler> ()
+      .AddAttribute ("TimerInterval",
+                     "Period of the tick running the timers of the reaction points",
+                     TimeValue (MicroSeconds (55)),
+                     MakeTimeAccessor (&DcqcnScheduler::m_interval),
+                     MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+DcqcnScheduler::DcqcnScheduler ()
+  : m_nTicks (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DcqcnScheduler::~DcqcnScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<DcqcnScheduler>
+DcqcnScheduler::GetScheduler (Ptr<Node> node)
+{
+  Ptr<DcqcnScheduler> scheduler = node->GetObject<DcqcnScheduler> ();
+  if (scheduler == 0)
+    {
+      scheduler = CreateObject<DcqcnScheduler> ();
+      node->AggregateObject (scheduler);
+    }
+  return scheduler;
+}
+
+void
+DcqcnScheduler::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  m_rps.clear ();
+  Object::DoDispose ();
+}
+
+void
+DcqcnScheduler::Add (DcqcnReactionPoint *rp)
+{
+  NS_LOG_FUNCTION (this << rp);
+  m_rps.push_back (rp);
+  if (!m_event.IsRunning ())
+    {
+      m_event = Simulator::Schedule (m_interval, &DcqcnScheduler::Tick, this);
+    }
+}
+
+void
+DcqcnScheduler::Remove (DcqcnReactionPoint *rp)
+{
+  NS_LOG_FUNCTION (this << rp);
+  std::vector<DcqcnReactionPoint *>::iterator it = std::find (m_rps.begin (), m_rps.end (), rp);
+  if (it != m_rps.end ())
+    {
+      m_rps.erase (it);
+    }
+  if (m_rps.empty ())
+    {
+      m_event.Cancel ();
+    }
+}
+
+uint64_t
+DcqcnScheduler::GetNTicks (void) const
+{
+  return m_nTicks;
+}
+
+void
+DcqcnScheduler::Tick (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nTicks++;
+  Time now = Simulator::Now ();
+  // a reaction point may be removed while its timers run
+  std::vector<DcqcnReactionPoint *> rps = m_rps;
+  for (std::vector<DcqcnReactionPoint *>::iterator it = rps.begin (); it != rps.end (); ++it)
+    {
+      (*it)->Tick (now);
+    }
+  if (!m_rps.empty ())
+    {
+      m_event = Simulator::Schedule (m_interval, &DcqcnScheduler::Tick, this);
+    }
+}
+
+NS_OBJECT_ENSURE_REGISTERED (DcqcnReactionPoint);
+
+TypeId
+DcqcnReactionPoint::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DcqcnReactionPoint")
+      .SetParent<Object> ()
+      .SetGroupName ("Internet")
+      .AddConstructor<DcqcnReactionPoint> ()
+      .AddAttribute ("PacketSize",
+                     "Payload of the datagrams",
+                     UintegerValue (1000),
+                     MakeUintegerAccessor (&DcqcnReactionPoint::m_packetSize),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("LineRate",
+                     "Initial and maximum rate of the IP packets",
+                     DataRateValue (DataRate ("10Gb/s")),
+                     MakeDataRateAccessor (&DcqcnReactionPoint::m_lineRate),
+                     MakeDataRateChecker ())
+      .AddAttribute ("MinRate",
+                     "Minimum rate",
+                     DataRateValue (DataRate ("10Mb/s")),
+                     MakeDataRateAccessor (&DcqcnReactionPoint::m_minRate),
+                     MakeDataRateChecker ())
+      .AddAttribute ("RateAi",
+                     "Target rate step of the additive increase",
+                     DataRateValue (DataRate ("40Mb/s")),
+                     MakeDataRateAccessor (&DcqcnReactionPoint::m_rateAi),
+                     MakeDataRateChecker ())
+      .AddAttribute ("RateHai",
+                     "Target rate step of the hyper increase",
+                     DataRateValue (DataRate ("400Mb/s")),
+                     MakeDataRateAccessor (&DcqcnReactionPoint::m_rateHai),
+                     MakeDataRateChecker ())
+      .AddAttribute ("G",
+                     "Gain of the alpha updates",
+                     DoubleValue (1.0 / 256),
+                     MakeDoubleAccessor (&DcqcnReactionPoint::m_g),
+                     MakeDoubleChecker<double> (0.0, 1.0))
+      .AddAttribute ("AlphaTimer",
+                     "Period without CNP after which alpha decays",
+                     TimeValue (MicroSeconds (55)),
+                     MakeTimeAccessor (&DcqcnReactionPoint::m_alphaTimer),
+                     MakeTimeChecker ())
+      .AddAttribute ("RateTimer",
+                     "Period without CNP after which the rate increases",
+                     TimeValue (MicroSeconds (55)),
+                     MakeTimeAccessor (&DcqcnReactionPoint::m_rateTimer),
+                     MakeTimeChecker ())
+      .AddAttribute ("ByteCounter",
+                     "Bytes sent without CNP after which the rate increases",
+                     UintegerValue (10 * 1024 * 1024),
+                     MakeUintegerAccessor (&DcqcnReactionPoint::m_byteCounter),
+                     MakeUintegerChecker<uint64_t> (1))
+      .AddAttribute ("FastRecoveryThreshold",
+                     "Number of rate increases of the fast recovery",
+                     UintegerValue (5),
+                     MakeUintegerAccessor (&DcqcnReactionPoint::m_threshold),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddTraceSource ("Rate",
+                       "The current rate in bit/s",
+                       MakeTraceSourceAccessor (&DcqcnReactionPoint::m_rate),
+                       "ns3::TracedValueCallback::Uint64")
+      .AddTraceSource ("Alpha",
+                       "The estimate of the congestion",
+                       MakeTraceSourceAccessor (&DcqcnReactionPoint::m_alpha),
+                       "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+DcqcnReactionPoint::DcqcnReactionPoint ()
+  : m_active (false),
+    m_packetSize (1000),
+    m_pending (0),
+    m_sent (0),
+    m_nCnp (0),
+    m_g (1.0 / 256),
+    m_byteCounter (10 * 1024 * 1024),
+    m_threshold (5),
+    m_rate (0),
+    m_targetRate (0),
+    m_alpha (1.0),
+    m_timerStage (0),
+    m_byteStage (0),
+    m_stageBytes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DcqcnReactionPoint::~DcqcnReactionPoint ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DcqcnReactionPoint::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  m_scheduler = 0;
+  m_node = 0;
+  Object::DoDispose ();
+}
+
+void
+DcqcnReactionPoint::Setup (Ptr<Node> node, const Address &remote)
+{
+  NS_LOG_FUNCTION (this << node << remote);
+  m_node = node;
+  m_scheduler = DcqcnScheduler::GetScheduler (node);
+  m_socket = Socket::CreateSocket (node, UdpSocketFactory::GetTypeId ());
+  m_socket->Bind ();
+  m_socket->Connect (remote);
+  // ECN capable transport, the CE marks trigger the CNP
+  m_socket->SetIpTos (Ipv4Header::ECN_ECT0);
+  m_socket->SetRecvCallback (MakeCallback (&DcqcnReactionPoint::HandleCnp, this));
+  m_rate = m_lineRate.GetBitRate ();
+  m_targetRate = m_lineRate.GetBitRate ();
+}
+
+void
+DcqcnReactionPoint::Send (uint64_t bytes)
+{
+  NS_LOG_FUNCTION (this << bytes);
+  NS_ASSERT_MSG (m_socket, "DcqcnReactionPoint::Setup not called");
+  m_pending += bytes;
+  Activate ();
+}
+
+void
+DcqcnReactionPoint::Activate (void)
+{
+  if (!m_active && m_pending > 0)
+    {
+      m_active = true;
+      m_alphaDeadline = Simulator::Now () + m_alphaTimer;
+      m_rateDeadline = Simulator::Now () + m_rateTimer;
+      m_scheduler->Add (this);
+    }
+  if (m_pending > 0 && !m_sendEvent.IsRunning ())
+    {
+      m_sendEvent = Simulator::ScheduleNow (&DcqcnReactionPoint::SendPacket, this);
+    }
+}
+
+void
+DcqcnReactionPoint::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sendEvent.Cancel ();
+  if (m_active)
+    {
+      m_scheduler->Remove (this);
+      m_active = false;
+    }
+  if (m_socket)
+    {
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_socket->Close ();
+      m_socket = 0;
+    }
+  m_pending = 0;
+}
+
+DataRate
+DcqcnReactionPoint::GetRate (void) const
+{
+  return DataRate (m_rate);
+}
+
+double
+DcqcnReactionPoint::GetAlpha (void) const
+{
+  return m_alpha;
+}
+
+uint64_t
+DcqcnReactionPoint::GetSentBytes (void) const
+{
+  return m_sent;
+}
+
+uint64_t
+DcqcnReactionPoint::GetPendingBytes (void) const
+{
+  return m_pending;
+}
+
+uint32_t
+DcqcnReactionPoint::GetNCnp (void) const
+{
+  return m_nCnp;
+}
+
+void
+DcqcnReactionPoint::SendPacket (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t size = static_cast<uint32_t> (std::min<uint64_t> (m_packetSize, m_pending));
+  if (m_socket->Send (Create<Packet> (size)) < 0)
+    {
+      NS_LOG_LOGIC ("Datagram not sent, error " << m_socket->GetErrno ());
+    }
+  m_pending -= size;
+  m_sent += size;
+
+  m_stageBytes += size;
+  if (m_stageBytes >= m_byteCounter)
+    {
+      m_stageBytes -= m_byteCounter;
+      m_byteStage++;
+      Increase ();
+    }
+
+  if (m_pending > 0)
+    {
+      Time gap = DataRate (m_rate).CalculateBytesTxTime (size + DCQCN_HEADER_BYTES);
+      m_sendEvent = Simulator::Schedule (gap, &DcqcnReactionPoint::SendPacket, this);
+    }
+  else if (m_active)
+    {
+      // the rate state is kept until more bytes are queued
+      m_scheduler->Remove (this);
+      m_active = false;
+    }
+}
+
+void
+DcqcnReactionPoint::HandleCnp (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  while (socket->Recv ())
+    {
+      m_nCnp++;
+      m_targetRate = m_rate;
+      double rate = m_rate * (1 - m_alpha / 2);
+      m_rate = static_cast<uint64_t> (std::max (rate, static_cast<double> (m_minRate.GetBitRate ())));
+      m_alpha = (1 - m_g) * m_alpha + m_g;
+      m_timerStage = 0;
+      m_byteStage = 0;
+      m_stageBytes = 0;
+      Time now = Simulator::Now ();
+      m_alphaDeadline = now + m_alphaTimer;
+      m_rateDeadline = now + m_rateTimer;
+      NS_LOG_LOGIC ("CNP, rate " << m_rate << " target " << m_targetRate << " alpha " << m_alpha);
+    }
+}
+
+void
+DcqcnReactionPoint::Tick (Time now)
+{
+  if (now >= m_alphaDeadline)
+    {
+      m_alpha = (1 - m_g) * m_alpha;
+      m_alphaDeadline = now + m_alphaTimer;
+    }
+  if (now >= m_rateDeadline)
+    {
+      m_timerStage++;
+      m_rateDeadline = now + m_rateTimer;
+      Increase ();
+    }
+}
+
+void
+DcqcnReactionPoint::Increase (void)
+{
+  double lineRate = m_lineRate.GetBitRate ();
+  if (std::max (m_timerStage, m_byteStage) < m_threshold)
+    {
+      // fast recovery towards the rate before the last cut
+    }
+  else if (std::min (m_timerStage, m_byteStage) > m_threshold)
+    {
+      uint32_t i = std::min (m_timerStage, m_byteStage) - m_threshold;
+      m_targetRate += i * static_cast<double> (m_rateHai.GetBitRate ());
+    }
+  else
+    {
+      m_targetRate += m_rateAi.GetBitRate ();
+    }
+  m_targetRate = std::min (m_targetRate, lineRate);
+  m_rate = static_cast<uint64_t> ((m_targetRate + m_rate) / 2);
+}
+
+} // namespace ns3
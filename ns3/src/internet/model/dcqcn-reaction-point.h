@@ -0,0 +1,216 @@
+#ifndef DCQCN_REACTION_POINT_H
+#define DCQCN_REACTION_POINT_H
+
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/address.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+class DcqcnReactionPoint;
+
+/**
+ * \ingroup internet
+ *
+ * \brief per node timer of the DCQCN reaction points
+ *
+ * Runs the alpha and rate increase timers of all the active reaction
+ * points of a node from a single periodic event, so that the number of
+ * events depends on the number of hosts and not on the number of flows.
+ * A flow timer expires at the first tick after its deadline.
+ */
+class DcqcnScheduler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  DcqcnScheduler ();
+  virtual ~DcqcnScheduler ();
+
+  /**
+   * \brief get the scheduler of a node, aggregating one if needed
+   * \param node the node
+   * \return the scheduler shared by the reaction points of the node
+   */
+  static Ptr<DcqcnScheduler> GetScheduler (Ptr<Node> node);
+
+  /**
+   * \brief start running the timers of a reaction point
+   * \param rp the reaction point
+   */
+  void Add (DcqcnReactionPoint *rp);
+
+  /**
+   * \brief stop running the timers of a reaction point
+   * \param rp the reaction point
+   */
+  void Remove (DcqcnReactionPoint *rp);
+
+  /**
+   * \return the number of ticks executed so far
+   */
+  uint64_t GetNTicks (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief run the timers of all the reaction points
+   */
+  void Tick (void);
+
+  Time m_interval;                          //!< period of the ticks
+  std::vector<DcqcnReactionPoint *> m_rps;  //!< active reaction points, in activation order
+  EventId m_event;                          //!< the next tick
+  uint64_t m_nTicks;                        //!< ticks executed
+};
+
+/**
+ * \ingroup internet
+ *
+ * \brief DCQCN reaction point: a rate based sender over UDP
+ *
+ * Sends the bytes passed to Send to a DcqcnNotificationPoint, paced at
+ * the current rate, in ECN capable (ECT(0)) UDP datagrams.  ECN marking
+ * switches, e.g. RedQueueDisc with UseEcn, set CE on congestion and the
+ * notification point answers with congestion notification packets
+ * (CNP).  On a CNP the reaction point remembers its rate as the target
+ * rate, cuts its rate by alpha / 2 and increases alpha.  Without CNP,
+ * alpha decays every AlphaTimer, and the rate increases every RateTimer
+ * and every ByteCounter bytes sent: the first FastRecoveryThreshold
+ * increases halve the distance to the target rate (fast recovery), then
+ * the target rate grows by RateAi (additive increase), and once both the
+ * timer and the byte counter passed the threshold by RateHai times
+ * their excess (hyper increase).
+ *
+ * The timers of all the reaction points of a node are run by its
+ * DcqcnScheduler.
+ */
+class DcqcnReactionPoint : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  DcqcnReactionPoint ();
+  virtual ~DcqcnReactionPoint ();
+
+  /**
+   * \brief open the flow
+   * \param node the sending node
+   * \param remote the address and port of the notification point
+   */
+  void Setup (Ptr<Node> node, const Address &remote);
+
+  /**
+   * \brief queue application bytes for transmission
+   * \param bytes the number of bytes
+   */
+  void Send (uint64_t bytes);
+
+  /**
+   * \brief stop sending and close the socket
+   */
+  void Close (void);
+
+  /**
+   * \return the current rate
+   */
+  DataRate GetRate (void) const;
+
+  /**
+   * \return the current alpha
+   */
+  double GetAlpha (void) const;
+
+  /**
+   * \return the bytes sent so far
+   */
+  uint64_t GetSentBytes (void) const;
+
+  /**
+   * \return the bytes queued and not sent yet
+   */
+  uint64_t GetPendingBytes (void) const;
+
+  /**
+   * \return the number of CNP received
+   */
+  uint32_t GetNCnp (void) const;
+
+  /**
+   * \brief run the expired timers, called by the DcqcnScheduler
+   * \param now the current time
+   */
+  void Tick (Time now);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief send the next datagram and schedule the following one
+   */
+  void SendPacket (void);
+  /**
+   * \brief receive the CNP from the notification point
+   * \param socket the socket
+   */
+  void HandleCnp (Ptr<Socket> socket);
+  /**
+   * \brief apply a rate increase event
+   */
+  void Increase (void);
+  /**
+   * \brief register the timers and start sending if needed
+   */
+  void Activate (void);
+
+  Ptr<Node> m_node;             //!< the sending node
+  Ptr<Socket> m_socket;         //!< the UDP socket
+  Ptr<DcqcnScheduler> m_scheduler; //!< timers of the node
+  bool m_active;                //!< registered with the scheduler
+  EventId m_sendEvent;          //!< next datagram
+  uint32_t m_packetSize;        //!< payload of the datagrams
+  uint64_t m_pending;           //!< bytes left to send
+  uint64_t m_sent;              //!< bytes sent
+  uint32_t m_nCnp;              //!< CNP received
+
+  DataRate m_lineRate;          //!< maximum rate
+  DataRate m_minRate;           //!< minimum rate
+  DataRate m_rateAi;            //!< additive increase step
+  DataRate m_rateHai;           //!< hyper increase step
+  double m_g;                   //!< alpha gain
+  Time m_alphaTimer;            //!< alpha decay period
+  Time m_rateTimer;             //!< rate increase period
+  uint64_t m_byteCounter;       //!< bytes between rate increases
+  uint32_t m_threshold;         //!< fast recovery steps
+
+  TracedValue<uint64_t> m_rate; //!< current rate in bit/s
+  double m_targetRate;          //!< target rate in bit/s
+  TracedValue<double> m_alpha;  //!< alpha
+  uint32_t m_timerStage;        //!< timer expirations since the last CNP
+  uint32_t m_byteStage;         //!< byte counter expirations since the last CNP
+  uint64_t m_stageBytes;        //!< bytes sent since the last byte counter expiration
+  Time m_alphaDeadline;         //!< next alpha decay
+  Time m_rateDeadline;          //!< next timer rate increase
+};
+
+} // namespace ns3
+
+#endif /* DCQCN_REACTION_POINT_H */
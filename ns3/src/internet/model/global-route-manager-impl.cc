@@ -598,6 +598,9 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
       delete m_lsdb;
       m_lsdb = new GlobalRouteManagerLSDB ();
     }
+  // the routes repaired are gone, the channels down are repaired again
+  // by InitializeRoutes
+  m_repairs.clear ();
 }
 
 //
@@ -728,6 +731,345 @@ GlobalRouteManagerImpl::InitializeRoutes ()
         }
     }
   NS_LOG_INFO ("Finished SPF calculation");
+  // the link state database ignores the channels down
+  for (std::vector<Ptr<Channel> >::const_iterator i = m_downChannels.begin ();
+       i != m_downChannels.end (); i++)
+    {
+      RepairLink (*i);
+    }
+}
+
+void
+GlobalRouteManagerImpl::RepairLinkDown (Ptr<Channel> channel)
+{
+  NS_LOG_FUNCTION (this << channel);
+  if (IsChannelDown (channel))
+    {
+      return;
+    }
+  m_downChannels.push_back (channel);
+  RepairLink (channel);
+}
+
+void
+GlobalRouteManagerImpl::RepairLinkUp (Ptr<Channel> channel)
+{
+  NS_LOG_FUNCTION (this << channel);
+  std::vector<Ptr<Channel> >::iterator it = std::find (m_downChannels.begin (), m_downChannels.end (), channel);
+  if (it == m_downChannels.end ())
+    {
+      return;
+    }
+  m_downChannels.erase (it);
+  for (std::vector<RouteChange>::reverse_iterator i = m_repairs.rbegin (); i != m_repairs.rend (); i++)
+    {
+      if (i->added)
+        {
+          i->routing->RemoveRoute (i->route);
+        }
+      else
+        {
+          i->routing->AddRoute (i->route);
+        }
+    }
+  NS_LOG_LOGIC ("Undid " << m_repairs.size () << " route changes");
+  m_repairs.clear ();
+  for (std::vector<Ptr<Channel> >::const_iterator i = m_downChannels.begin ();
+       i != m_downChannels.end (); i++)
+    {
+      RepairLink (*i);
+    }
+}
+
+void
+GlobalRouteManagerImpl::RepairLink (Ptr<Channel> channel)
+{
+  NS_LOG_FUNCTION (this << channel);
+  std::queue<Withdrawal> withdrawals;
+
+  // both ends stop using the channel
+  for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = channel->GetDevice (i);
+      Ptr<Node> node = device->GetNode ();
+      Ptr<Ipv4GlobalRouting> routing = GetGlobalRouting (node);
+      if (routing == 0)
+        {
+          continue;
+        }
+      int32_t interface = node->GetObject<Ipv4> ()->GetInterfaceForDevice (device);
+      if (interface < 0)
+        {
+          continue;
+        }
+      std::vector<Ipv4RoutingTableEntry> routes = routing->GetRoutes ();
+      std::set<std::pair<uint32_t, uint32_t> > prefixes;
+      for (std::vector<Ipv4RoutingTableEntry>::const_iterator r = routes.begin (); r != routes.end (); r++)
+        {
+          if (r->GetInterface () == (uint32_t) interface)
+            {
+              ChangeRoute (routing, *r, false);
+              prefixes.insert (std::make_pair (r->GetDestNetwork ().Get (), r->GetDestNetworkMask ().Get ()));
+            }
+        }
+      // a prefix left without route of its own is withdrawn, even if a
+      // shorter one covers it: the covering routes may lead back here
+      for (std::set<std::pair<uint32_t, uint32_t> >::const_iterator p = prefixes.begin (); p != prefixes.end (); p++)
+        {
+          Withdrawal withdrawal = { node, Ipv4Address (p->first), Ipv4Mask (p->second) };
+          if (!HasOwnRoute (routing, withdrawal.dest, withdrawal.mask))
+            {
+              withdrawals.push (withdrawal);
+            }
+        }
+    }
+
+  // the withdrawals spread upstream: the neighbors stop going through
+  // the nodes without route
+  std::set<std::pair<uint32_t, uint64_t> > done;
+  std::vector<Withdrawal> withdrawn;
+  while (!withdrawals.empty ())
+    {
+      Withdrawal w = withdrawals.front ();
+      withdrawals.pop ();
+      uint64_t prefix = ((uint64_t) w.dest.Get () << 32) | w.mask.Get ();
+      if (!done.insert (std::make_pair (w.node->GetId (), prefix)).second)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("Node " << w.node->GetId () << " withdraws " << w.dest << "/" << w.mask.GetPrefixLength ());
+      withdrawn.push_back (w);
+      std::vector<Adjacency> adjacencies = GetAdjacencies (w.node);
+      for (std::vector<Adjacency>::const_iterator a = adjacencies.begin (); a != adjacencies.end (); a++)
+        {
+          if (RepairNeighbor (a->routing, a->neighborInterface, a->gateways, w.dest, w.mask))
+            {
+              Withdrawal withdrawal = { a->neighbor, w.dest, w.mask };
+              withdrawals.push (withdrawal);
+            }
+        }
+    }
+
+  // then the nodes without route go through the neighbors which still
+  // have one, the nearest first; these routes avoid the nodes without
+  // route, so they cannot loop
+  while (!withdrawn.empty ())
+    {
+      std::set<std::pair<uint32_t, uint64_t> > pending;
+      for (std::vector<Withdrawal>::const_iterator w = withdrawn.begin (); w != withdrawn.end (); w++)
+        {
+          pending.insert (std::make_pair (w->node->GetId (), ((uint64_t) w->dest.Get () << 32) | w->mask.Get ()));
+        }
+      std::vector<Withdrawal> left;
+      std::vector<RouteChange> reroutes;
+      for (std::vector<Withdrawal>::const_iterator w = withdrawn.begin (); w != withdrawn.end (); w++)
+        {
+          uint64_t prefix = ((uint64_t) w->dest.Get () << 32) | w->mask.Get ();
+          Ptr<Ipv4GlobalRouting> routing = GetGlobalRouting (w->node);
+          std::vector<Adjacency> adjacencies = GetAdjacencies (w->node);
+          bool rerouted = false;
+          for (std::vector<Adjacency>::const_iterator a = adjacencies.begin (); a != adjacencies.end (); a++)
+            {
+              if (pending.count (std::make_pair (a->neighbor->GetId (), prefix)))
+                {
+                  continue;
+                }
+              std::vector<Ipv4RoutingTableEntry> group = GetRouteGroup (a->routing, w->dest, w->mask);
+              bool through = group.empty ();
+              for (std::vector<Ipv4RoutingTableEntry>::const_iterator r = group.begin (); r != group.end () && !through; r++)
+                {
+                  through = IsVia (*r, a->neighborInterface, a->gateways);
+                }
+              if (through)
+                {
+                  continue;
+                }
+              Ipv4Address gateway = a->neighbor->GetObject<Ipv4> ()->GetAddress (a->neighborInterface, 0).GetLocal ();
+              RouteChange reroute = { routing, CreateRoute (w->dest, w->mask, gateway, a->interface), true };
+              reroutes.push_back (reroute);
+              rerouted = true;
+            }
+          if (!rerouted)
+            {
+              left.push_back (*w);
+            }
+        }
+      if (reroutes.empty ())
+        {
+          NS_LOG_LOGIC (left.size () << " prefixes unreachable");
+          break;
+        }
+      for (std::vector<RouteChange>::const_iterator r = reroutes.begin (); r != reroutes.end (); r++)
+        {
+          ChangeRoute (r->routing, r->route, true);
+        }
+      withdrawn = left;
+    }
+}
+
+bool
+GlobalRouteManagerImpl::RepairNeighbor (Ptr<Ipv4GlobalRouting> routing, uint32_t interface,
+                                        const std::vector<Ipv4Address> &gateways,
+                                        Ipv4Address dest, Ipv4Mask mask)
+{
+  std::vector<Ipv4RoutingTableEntry> group = GetRouteGroup (routing, dest, mask);
+  std::vector<Ipv4RoutingTableEntry> via;
+  std::vector<Ipv4RoutingTableEntry> others;
+  for (std::vector<Ipv4RoutingTableEntry>::const_iterator r = group.begin (); r != group.end (); r++)
+    {
+      if (IsVia (*r, interface, gateways))
+        {
+          via.push_back (*r);
+        }
+      else
+        {
+          others.push_back (*r);
+        }
+    }
+  if (via.empty ())
+    {
+      // the neighbor does not go through the node
+      return false;
+    }
+
+  if (group.front ().GetDestNetworkMask () == mask)
+    {
+      for (std::vector<Ipv4RoutingTableEntry>::const_iterator r = via.begin (); r != via.end (); r++)
+        {
+          ChangeRoute (routing, *r, false);
+        }
+    }
+  else
+    {
+      // split the aggregate
+      for (std::vector<Ipv4RoutingTableEntry>::const_iterator r = others.begin (); r != others.end (); r++)
+        {
+          ChangeRoute (routing, CreateRoute (dest, mask, r->GetGateway (), r->GetInterface ()), true);
+        }
+    }
+  return others.empty ();
+}
+
+std::vector<GlobalRouteManagerImpl::Adjacency>
+GlobalRouteManagerImpl::GetAdjacencies (Ptr<Node> node) const
+{
+  std::vector<Adjacency> adjacencies;
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = node->GetDevice (i);
+      Ptr<Channel> link = device->GetChannel ();
+      int32_t interface = ipv4->GetInterfaceForDevice (device);
+      if (link == 0 || interface < 0 || IsChannelDown (link))
+        {
+          continue;
+        }
+      std::vector<Ipv4Address> gateways;
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (interface); j++)
+        {
+          gateways.push_back (ipv4->GetAddress (interface, j).GetLocal ());
+        }
+      for (uint32_t j = 0; j < link->GetNDevices (); j++)
+        {
+          Ptr<NetDevice> neighborDevice = link->GetDevice (j);
+          Ptr<Node> neighbor = neighborDevice->GetNode ();
+          Ptr<Ipv4GlobalRouting> routing = GetGlobalRouting (neighbor);
+          if (neighbor == node || routing == 0)
+            {
+              continue;
+            }
+          int32_t neighborInterface = neighbor->GetObject<Ipv4> ()->GetInterfaceForDevice (neighborDevice);
+          if (neighborInterface < 0)
+            {
+              continue;
+            }
+          Adjacency adjacency = { neighbor, routing, (uint32_t) interface, (uint32_t) neighborInterface, gateways };
+          adjacencies.push_back (adjacency);
+        }
+    }
+  return adjacencies;
+}
+
+std::vector<Ipv4RoutingTableEntry>
+GlobalRouteManagerImpl::GetRouteGroup (Ptr<Ipv4GlobalRouting> routing, Ipv4Address dest, Ipv4Mask mask)
+{
+  std::vector<Ipv4RoutingTableEntry> routes = routing->GetRoutes ();
+  std::vector<Ipv4RoutingTableEntry> group;
+  int32_t longest = -1;
+  for (std::vector<Ipv4RoutingTableEntry>::const_iterator r = routes.begin (); r != routes.end (); r++)
+    {
+      int32_t length = r->GetDestNetworkMask ().GetPrefixLength ();
+      if (length > mask.GetPrefixLength () || length < longest
+          || !r->GetDestNetworkMask ().IsMatch (dest, r->GetDestNetwork ()))
+        {
+          continue;
+        }
+      if (length > longest)
+        {
+          group.clear ();
+          longest = length;
+        }
+      group.push_back (*r);
+    }
+  return group;
+}
+
+bool
+GlobalRouteManagerImpl::HasOwnRoute (Ptr<Ipv4GlobalRouting> routing, Ipv4Address dest, Ipv4Mask mask)
+{
+  std::vector<Ipv4RoutingTableEntry> group = GetRouteGroup (routing, dest, mask);
+  return !group.empty () && group.front ().GetDestNetworkMask () == mask;
+}
+
+bool
+GlobalRouteManagerImpl::IsVia (const Ipv4RoutingTableEntry &route, uint32_t interface,
+                               const std::vector<Ipv4Address> &gateways)
+{
+  return route.GetInterface () == interface
+         && std::find (gateways.begin (), gateways.end (), route.GetGateway ()) != gateways.end ();
+}
+
+Ipv4RoutingTableEntry
+GlobalRouteManagerImpl::CreateRoute (Ipv4Address dest, Ipv4Mask mask, Ipv4Address gateway, uint32_t interface)
+{
+  if (mask == Ipv4Mask::GetOnes ())
+    {
+      return Ipv4RoutingTableEntry::CreateHostRouteTo (dest, gateway, interface);
+    }
+  return Ipv4RoutingTableEntry::CreateNetworkRouteTo (dest, mask, gateway, interface);
+}
+
+void
+GlobalRouteManagerImpl::ChangeRoute (Ptr<Ipv4GlobalRouting> routing, const Ipv4RoutingTableEntry &route, bool added)
+{
+  NS_LOG_LOGIC ((added ? "Adding " : "Removing ") << route);
+  if (added)
+    {
+      routing->AddRoute (route);
+    }
+  else
+    {
+      routing->RemoveRoute (route);
+    }
+  RouteChange change = { routing, route, added };
+  m_repairs.push_back (change);
+}
+
+bool
+GlobalRouteManagerImpl::IsChannelDown (Ptr<Channel> channel) const
+{
+  return std::find (m_downChannels.begin (), m_downChannels.end (), channel) != m_downChannels.end ();
+}
+
+Ptr<Ipv4GlobalRouting>
+GlobalRouteManagerImpl::GetGlobalRouting (Ptr<Node> node)
+{
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return 0;
+    }
+  return router->GetRoutingProtocol ();
 }
 
 //
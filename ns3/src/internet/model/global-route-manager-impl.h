@@ -27,9 +27,13 @@
 #include <queue>
 #include <map>
 #include <vector>
+#include <set>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/channel.h"
+#include "ns3/node.h"
+#include "ipv4-routing-table-entry.h"
 #include "global-router-interface.h"
 
 namespace ns3 {
@@ -735,6 +739,32 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Repair the forwarding tables after a link failure, without SPF
+ *
+ * Only the routes leaving through the channel are removed.  A node left
+ * without route to a prefix withdraws it from its neighbors, which
+ * remove their routes to the prefix through that node, or split a
+ * covering aggregate into routes to the prefix through their other next
+ * hops.  The equal cost groups not using the channel are not touched.
+ * The nodes left without route then go through the neighbors which
+ * still have one, the nearest first, which may be a longer path than
+ * SPF would pick.
+ *
+ * @param channel the channel which went down
+ */
+  virtual void RepairLinkDown (Ptr<Channel> channel);
+
+/**
+ * @brief Undo the repairs made when a channel went down
+ *
+ * The repairs of every failure are undone, then those of the channels
+ * still down are made again.
+ *
+ * @param channel the channel which came back up
+ */
+  virtual void RepairLinkUp (Ptr<Channel> channel);
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -769,8 +799,120 @@ private:
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
 
+  /// A route added or removed by a repair
+  struct RouteChange
+  {
+    Ptr<Ipv4GlobalRouting> routing; //!< the table changed
+    Ipv4RoutingTableEntry route;     //!< the route
+    bool added;                      //!< true if added, false if removed
+  };
+
+  /// A prefix a node has no route to any more
+  struct Withdrawal
+  {
+    Ptr<Node> node;   //!< the node
+    Ipv4Address dest; //!< the prefix address
+    Ipv4Mask mask;    //!< the prefix mask
+  };
+
+  /// A neighbor of a node
+  struct Adjacency
+  {
+    Ptr<Node> neighbor;                 //!< the neighbor
+    Ptr<Ipv4GlobalRouting> routing;     //!< the table of the neighbor
+    uint32_t interface;                 //!< the interface of the node towards the neighbor
+    uint32_t neighborInterface;         //!< the interface of the neighbor towards the node
+    std::vector<Ipv4Address> gateways;  //!< the addresses of the node on the link
+  };
+
+  std::vector<Ptr<Channel> > m_downChannels; //!< channels down, in failure order
+  std::vector<RouteChange> m_repairs;        //!< changes made by the repairs, in order
+
+  /**
+   * @brief Remove the routes through a channel, propagate the resulting
+   * withdrawals and route the nodes left without route around them
+   * @param channel the channel
+   */
+  void RepairLink (Ptr<Channel> channel);
+
+  /**
+   * @brief Update the routes of a neighbor to a prefix withdrawn by a node
+   * @param routing the table of the neighbor
+   * @param interface the interface of the neighbor towards the node
+   * @param gateways the addresses of the node on that link
+   * @param dest the prefix address
+   * @param mask the prefix mask
+   * @returns true if the neighbor has no route to the prefix any more
+   */
+  bool RepairNeighbor (Ptr<Ipv4GlobalRouting> routing, uint32_t interface,
+                       const std::vector<Ipv4Address> &gateways,
+                       Ipv4Address dest, Ipv4Mask mask);
+
+  /**
+   * @brief Add or remove a route and log the change
+   * @param routing the table
+   * @param route the route
+   * @param added true to add the route, false to remove it
+   */
+  void ChangeRoute (Ptr<Ipv4GlobalRouting> routing, const Ipv4RoutingTableEntry &route, bool added);
+
+  /**
+   * @param channel a channel
+   * @returns true if the channel is down
+   */
+  bool IsChannelDown (Ptr<Channel> channel) const;
+
+  /**
+   * @param node a node
+   * @returns the neighbors with global routing over the channels up
+   */
+  std::vector<Adjacency> GetAdjacencies (Ptr<Node> node) const;
+
+  /**
+   * @param routing a table
+   * @param dest the prefix address
+   * @param mask the prefix mask
+   * @returns the routes used for the prefix: its own, else the longest
+   * covering ones
+   */
+  static std::vector<Ipv4RoutingTableEntry> GetRouteGroup (Ptr<Ipv4GlobalRouting> routing,
+                                                           Ipv4Address dest, Ipv4Mask mask);
+
+  /**
+   * @param routing a table
+   * @param dest the prefix address
+   * @param mask the prefix mask
+   * @returns true if the table has routes to exactly the prefix
+   */
+  static bool HasOwnRoute (Ptr<Ipv4GlobalRouting> routing, Ipv4Address dest, Ipv4Mask mask);
+
+  /**
+   * @param route a route
+   * @param interface an interface
+   * @param gateways the addresses of a node on the link of the interface
+   * @returns true if the route goes through the node
+   */
+  static bool IsVia (const Ipv4RoutingTableEntry &route, uint32_t interface,
+                     const std::vector<Ipv4Address> &gateways);
+
+  /**
+   * @param dest the prefix address
+   * @param mask the prefix mask, a host route if /32
+   * @param gateway the next hop
+   * @param interface the output interface
+   * @returns the route
+   */
+  static Ipv4RoutingTableEntry CreateRoute (Ipv4Address dest, Ipv4Mask mask,
+                                            Ipv4Address gateway, uint32_t interface);
+
+  /**
+   * @param node a node
+   * @returns the global routing of the node, 0 if it has none
+   */
+  static Ptr<Ipv4GlobalRouting> GetGlobalRouting (Ptr<Node> node);
+
   /**
-   * \brief Test if a node is a stub, from an OSPF sense.
+   * @brief Test if a node is a stub, from an OSPF sense.
    *
    * If there is only one link of type 1 or 2, then a default route
    * can safely be added to the next-hop router and SPF does not need
@@ -58,6 +58,22 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::RepairLinkDown (Ptr<Channel> channel)
+{
+  NS_LOG_FUNCTION (channel);
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  RepairLinkDown (channel);
+}
+
+void
+GlobalRouteManager::RepairLinkUp (Ptr<Channel> channel)
+{
+  NS_LOG_FUNCTION (channel);
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  RepairLinkUp (channel);
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
@@ -22,6 +22,9 @@
 #ifndef GLOBAL_ROUTE_MANAGER_H
 #define GLOBAL_ROUTE_MANAGER_H
 
+#include "ns3/ptr.h"
+#include "ns3/channel.h"
+
 namespace ns3 {
 
 /**
@@ -58,6 +61,19 @@ public:
  */
   static void BuildGlobalRoutingDatabase ();
 
+/**
+ * @brief Repair the routes of the nodes around a channel which went down,
+ * without recomputing the other routes
+ * @param channel the channel
+ */
+  static void RepairLinkDown (Ptr<Channel> channel);
+
+/**
+ * @brief Restore the routes repaired when a channel went down
+ * @param channel the channel
+ */
+  static void RepairLinkUp (Ptr<Channel> channel);
+
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
@@ -0,0 +1,187 @@
+#include "homa-header.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (HomaHeader);
+
+HomaHeader::HomaHeader ()
+  : m_sourcePort (0),
+    m_destinationPort (0),
+    m_type (DATA),
+    m_priority (0),
+    m_messageId (0),
+    m_messageLength (0),
+    m_offset (0),
+    m_length (0)
+{
+}
+
+HomaHeader::~HomaHeader ()
+{
+}
+
+TypeId
+HomaHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HomaHeader")
+      .SetParent<Header> ()
+      .SetGroupName ("Internet")
+      .AddConstructor<HomaHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+HomaHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+HomaHeader::Print (std::ostream &os) const
+{
+  static const char *types[] = { "DATA", "GRANT", "RESEND", "ACK" };
+  os << m_sourcePort << " > " << m_destinationPort
+     << " " << (m_type < 4 ? types[m_type] : "?")
+     << " id=" << m_messageId
+     << " len=" << m_messageLength
+     << " off=" << m_offset
+     << " prio=" << (uint32_t) m_priority;
+  if (m_type == RESEND)
+    {
+      os << " bytes=" << m_length;
+    }
+}
+
+uint32_t
+HomaHeader::GetSerializedSize (void) const
+{
+  return 26;
+}
+
+void
+HomaHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteHtonU16 (m_sourcePort);
+  i.WriteHtonU16 (m_destinationPort);
+  i.WriteU8 (m_type);
+  i.WriteU8 (m_priority);
+  i.WriteHtonU64 (m_messageId);
+  i.WriteHtonU32 (m_messageLength);
+  i.WriteHtonU32 (m_offset);
+  i.WriteHtonU32 (m_length);
+}
+
+uint32_t
+HomaHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_sourcePort = i.ReadNtohU16 ();
+  m_destinationPort = i.ReadNtohU16 ();
+  m_type = i.ReadU8 ();
+  m_priority = i.ReadU8 ();
+  m_messageId = i.ReadNtohU64 ();
+  m_messageLength = i.ReadNtohU32 ();
+  m_offset = i.ReadNtohU32 ();
+  m_length = i.ReadNtohU32 ();
+  return GetSerializedSize ();
+}
+
+void
+HomaHeader::SetSourcePort (uint16_t port)
+{
+  m_sourcePort = port;
+}
+
+uint16_t
+HomaHeader::GetSourcePort (void) const
+{
+  return m_sourcePort;
+}
+
+void
+HomaHeader::SetDestinationPort (uint16_t port)
+{
+  m_destinationPort = port;
+}
+
+uint16_t
+HomaHeader::GetDestinationPort (void) const
+{
+  return m_destinationPort;
+}
+
+void
+HomaHeader::SetType (uint8_t type)
+{
+  m_type = type;
+}
+
+uint8_t
+HomaHeader::GetType (void) const
+{
+  return m_type;
+}
+
+void
+HomaHeader::SetPriority (uint8_t priority)
+{
+  m_priority = priority;
+}
+
+uint8_t
+HomaHeader::GetPriority (void) const
+{
+  return m_priority;
+}
+
+void
+HomaHeader::SetMessageId (uint64_t id)
+{
+  m_messageId = id;
+}
+
+uint64_t
+HomaHeader::GetMessageId (void) const
+{
+  return m_messageId;
+}
+
+void
+HomaHeader::SetMessageLength (uint32_t length)
+{
+  m_messageLength = length;
+}
+
+uint32_t
+HomaHeader::GetMessageLength (void) const
+{
+  return m_messageLength;
+}
+
+void
+HomaHeader::SetOffset (uint32_t offset)
+{
+  m_offset = offset;
+}
+
+uint32_t
+HomaHeader::GetOffset (void) const
+{
+  return m_offset;
+}
+
+void
+HomaHeader::SetLength (uint32_t length)
+{
+  m_length = length;
+}
+
+uint32_t
+HomaHeader::GetLength (void) const
+{
+  return m_length;
+}
+
+} // namespace ns3
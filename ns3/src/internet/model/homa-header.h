@@ -0,0 +1,78 @@
+#ifndef HOMA_HEADER_H
+#define HOMA_HEADER_H
+
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup internet
+ *
+ * \brief Header of the packets of HomaL4Protocol
+ *
+ * Every packet names its message by the message id, unique per sending
+ * host, and the message length.  The meaning of Offset depends on the
+ * type: the first byte carried by a DATA packet, the granted bytes of a
+ * GRANT, or the first missing byte of a RESEND, which asks for Length
+ * bytes.  Priority is the priority a GRANT or RESEND asks the sender to
+ * use for the data it triggers.
+ */
+class HomaHeader : public Header
+{
+public:
+  /**
+   * \brief Packet types
+   */
+  enum Type
+  {
+    DATA = 0,   //!< message data
+    GRANT = 1,  //!< credit from the receiver
+    RESEND = 2, //!< request for missing data
+    ACK = 3     //!< the message has been received
+  };
+
+  HomaHeader ();
+  virtual ~HomaHeader ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  void SetSourcePort (uint16_t port);
+  uint16_t GetSourcePort (void) const;
+  void SetDestinationPort (uint16_t port);
+  uint16_t GetDestinationPort (void) const;
+  void SetType (uint8_t type);
+  uint8_t GetType (void) const;
+  void SetPriority (uint8_t priority);
+  uint8_t GetPriority (void) const;
+  void SetMessageId (uint64_t id);
+  uint64_t GetMessageId (void) const;
+  void SetMessageLength (uint32_t length);
+  uint32_t GetMessageLength (void) const;
+  void SetOffset (uint32_t offset);
+  uint32_t GetOffset (void) const;
+  void SetLength (uint32_t length);
+  uint32_t GetLength (void) const;
+
+private:
+  uint16_t m_sourcePort;      //!< source port
+  uint16_t m_destinationPort; //!< destination port
+  uint8_t m_type;             //!< packet type
+  uint8_t m_priority;         //!< requested priority
+  uint64_t m_messageId;       //!< message id
+  uint32_t m_messageLength;   //!< message length
+  uint32_t m_offset;          //!< offset, depending on the type
+  uint32_t m_length;          //!< bytes asked by a RESEND
+};
+
+} // namespace ns3
+
+#endif // HOMA_HEADER_H
@@ -0,0 +1,716 @@
+#include "homa-l4-protocol.h"
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/object-vector.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket.h"
+#include "ipv4-end-point-demux.h"
+#include "ipv4-end-point.h"
+#include "ipv4-route.h"
+#include "ipv4-routing-protocol.h"
+#include "ipv4.h"
+#include "homa-socket.h"
+#include "homa-socket-factory.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HomaL4Protocol");
+
+NS_OBJECT_ENSURE_REGISTERED (HomaL4Protocol);
+
+/* unassigned by IANA, the number used by the Linux implementation of Homa */
+const uint8_t HomaL4Protocol::PROT_NUMBER = 146;
+
+TypeId
+HomaL4Protocol::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HomaL4Protocol")
+      .SetParent<IpL4Protocol> ()
+      .SetGroupName ("Internet")
+      .AddConstructor<HomaL4Protocol> ()
+      .AddAttribute ("SocketList", "The list of sockets associated to this protocol.",
+                     ObjectVectorValue (),
+                     MakeObjectVectorAccessor (&HomaL4Protocol::m_sockets),
+                     MakeObjectVectorChecker<HomaSocket> ())
+      .AddAttribute ("RttBytes",
+                     "Bytes sent before the first grant, and granted ahead of the "
+                     "received bytes of a message",
+                     UintegerValue (10000),
+                     MakeUintegerAccessor (&HomaL4Protocol::m_rttBytes),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("PayloadSize",
+                     "Message bytes carried by each data packet",
+                     UintegerValue (1400),
+                     MakeUintegerAccessor (&HomaL4Protocol::m_payloadSize),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("LinkRate",
+                     "Rate at which a receiver grants data packets",
+                     DataRateValue (DataRate ("10Gbps")),
+                     MakeDataRateAccessor (&HomaL4Protocol::m_linkRate),
+                     MakeDataRateChecker ())
+      .AddAttribute ("Overcommit",
+                     "Number of inbound messages granted at the same time",
+                     UintegerValue (4),
+                     MakeUintegerAccessor (&HomaL4Protocol::m_overcommit),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("Priorities",
+                     "Number of priorities, 0 being the highest",
+                     UintegerValue (8),
+                     MakeUintegerAccessor (&HomaL4Protocol::m_priorities),
+                     MakeUintegerChecker<uint8_t> (1, 64))
+      .AddAttribute ("ResendTimeout",
+                     "Time without data before a receiver asks for the missing bytes, "
+                     "and half the time without reply before a sender probes the receiver",
+                     TimeValue (MilliSeconds (1)),
+                     MakeTimeAccessor (&HomaL4Protocol::m_resendTimeout),
+                     MakeTimeChecker ())
+      .AddAttribute ("MaxProbes",
+                     "Number of probes without reply after which a message is dropped",
+                     UintegerValue (10),
+                     MakeUintegerAccessor (&HomaL4Protocol::m_maxProbes),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("CompletedHistory",
+                     "Number of delivered messages remembered to discard duplicates",
+                     UintegerValue (4096),
+                     MakeUintegerAccessor (&HomaL4Protocol::m_completedHistory),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddTraceSource ("Message",
+                       "A message has been received",
+                       MakeTraceSourceAccessor (&HomaL4Protocol::m_messageTrace),
+                       "ns3::Packet::AddressTracedCallback")
+  ;
+  return tid;
+}
+
+HomaL4Protocol::HomaL4Protocol ()
+  : m_endPoints (new Ipv4EndPointDemux ()),
+    m_rttBytes (10000),
+    m_payloadSize (1400),
+    m_overcommit (4),
+    m_priorities (8),
+    m_maxProbes (10),
+    m_completedHistory (4096),
+    m_nextId (0),
+    m_pacing (false),
+    m_nGrants (0),
+    m_nResends (0),
+    m_nProbes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HomaL4Protocol::~HomaL4Protocol ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HomaL4Protocol::SetNode (Ptr<Node> node)
+{
+  m_node = node;
+}
+
+void
+HomaL4Protocol::NotifyNewAggregate ()
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Node> node = this->GetObject<Node> ();
+  Ptr<Ipv4> ipv4 = this->GetObject<Ipv4> ();
+
+  if (m_node == 0 && node != 0 && ipv4 != 0)
+    {
+      this->SetNode (node);
+      Ptr<HomaSocketFactory> homaFactory = CreateObject<HomaSocketFactory> ();
+      homaFactory->SetHoma (this);
+      node->AggregateObject (homaFactory);
+    }
+  if (ipv4 != 0 && m_downTarget.IsNull ())
+    {
+      ipv4->Insert (this);
+      this->SetDownTarget (MakeCallback (&Ipv4::Send, ipv4));
+    }
+  IpL4Protocol::NotifyNewAggregate ();
+}
+
+int
+HomaL4Protocol::GetProtocolNumber (void) const
+{
+  return PROT_NUMBER;
+}
+
+void
+HomaL4Protocol::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Ptr<HomaSocket> >::iterator i = m_sockets.begin (); i != m_sockets.end (); i++)
+    {
+      *i = 0;
+    }
+  m_sockets.clear ();
+  if (m_endPoints != 0)
+    {
+      delete m_endPoints;
+      m_endPoints = 0;
+    }
+  m_schedulerEvent.Cancel ();
+  m_outbound.clear ();
+  m_inbound.clear ();
+  m_schedule.clear ();
+  m_completed.clear ();
+  m_completedOrder.clear ();
+  m_node = 0;
+  m_downTarget.Nullify ();
+  IpL4Protocol::DoDispose ();
+}
+
+Ptr<Socket>
+HomaL4Protocol::CreateSocket (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<HomaSocket> socket = CreateObject<HomaSocket> ();
+  socket->SetNode (m_node);
+  socket->SetHoma (this);
+  m_sockets.push_back (socket);
+  return socket;
+}
+
+Ipv4EndPoint *
+HomaL4Protocol::Allocate (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_endPoints->Allocate ();
+}
+
+Ipv4EndPoint *
+HomaL4Protocol::Allocate (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_endPoints->Allocate (port);
+}
+
+Ipv4EndPoint *
+HomaL4Protocol::Allocate (Ipv4Address address, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << address << port);
+  return m_endPoints->Allocate (address, port);
+}
+
+void
+HomaL4Protocol::DeAllocate (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  if (m_endPoints != 0)
+    {
+      m_endPoints->DeAllocate (endPoint);
+    }
+}
+
+uint64_t
+HomaL4Protocol::SendMessage (Ptr<Packet> message, Ipv4Address saddr, Ipv4Address daddr,
+                             uint16_t sport, uint16_t dport)
+{
+  NS_LOG_FUNCTION (this << message << saddr << daddr << sport << dport);
+  if (saddr == Ipv4Address::GetAny ())
+    {
+      Ptr<Ipv4> ipv4 = m_node->GetObject<Ipv4> ();
+      Ipv4Header header;
+      header.SetDestination (daddr);
+      header.SetProtocol (PROT_NUMBER);
+      Socket::SocketErrno errno_;
+      Ptr<Ipv4Route> route;
+      if (ipv4->GetRoutingProtocol () != 0)
+        {
+          route = ipv4->GetRoutingProtocol ()->RouteOutput (message, header, 0, errno_);
+        }
+      if (route != 0)
+        {
+          saddr = route->GetSource ();
+        }
+    }
+
+  uint64_t id = m_nextId++;
+  OutboundMessage &msg = m_outbound[id];
+  msg.data = message->Copy ();
+  msg.saddr = saddr;
+  msg.daddr = daddr;
+  msg.sport = sport;
+  msg.dport = dport;
+  msg.sent = 0;
+  msg.granted = GetUnscheduled (message->GetSize ());
+  msg.priority = 0;
+  msg.lastRx = Simulator::Now ();
+  msg.probes = 0;
+  if (message->GetSize () == 0)
+    {
+      SendData (id, msg, 0, 0);
+    }
+  SendGranted (id, msg);
+  // the scheduler event probes the receiver if it does not reply
+  WakeTimeouts ();
+  return id;
+}
+
+void
+HomaL4Protocol::SendPacket (Ptr<Packet> p, const HomaHeader &header,
+                            Ipv4Address saddr, Ipv4Address daddr, uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << p << header << saddr << daddr << (uint32_t) priority);
+  p->AddHeader (header);
+  // the DSCP carries the priority across the hops
+  SocketIpTosTag tosTag;
+  tosTag.SetTos (priority << 2);
+  p->ReplacePacketTag (tosTag);
+  SocketPriorityTag priorityTag;
+  priorityTag.SetPriority (priority);
+  p->ReplacePacketTag (priorityTag);
+
+  Ptr<Ipv4> ipv4 = m_node->GetObject<Ipv4> ();
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (saddr);
+  ipHeader.SetDestination (daddr);
+  ipHeader.SetProtocol (PROT_NUMBER);
+  Socket::SocketErrno errno_;
+  Ptr<Ipv4Route> route;
+  if (ipv4->GetRoutingProtocol () != 0)
+    {
+      route = ipv4->GetRoutingProtocol ()->RouteOutput (p, ipHeader, 0, errno_);
+    }
+  else
+    {
+      NS_LOG_ERROR ("No IPV4 Routing Protocol");
+    }
+  m_downTarget (p, saddr, daddr, PROT_NUMBER, route);
+}
+
+void
+HomaL4Protocol::SendData (uint64_t id, OutboundMessage &msg, uint32_t offset, uint8_t priority)
+{
+  uint32_t length = msg.data->GetSize ();
+  uint32_t size = std::min (m_payloadSize, length - offset);
+  Ptr<Packet> p = msg.data->CreateFragment (offset, size);
+  HomaHeader header;
+  header.SetSourcePort (msg.sport);
+  header.SetDestinationPort (msg.dport);
+  header.SetType (HomaHeader::DATA);
+  header.SetMessageId (id);
+  header.SetMessageLength (length);
+  header.SetOffset (offset);
+  header.SetPriority (priority);
+  SendPacket (p, header, msg.saddr, msg.daddr, priority);
+}
+
+void
+HomaL4Protocol::SendGranted (uint64_t id, OutboundMessage &msg)
+{
+  while (msg.sent < msg.granted)
+    {
+      SendData (id, msg, msg.sent, msg.priority);
+      msg.sent = std::min (msg.sent + m_payloadSize, msg.data->GetSize ());
+    }
+}
+
+void
+HomaL4Protocol::SendControl (uint8_t type, const MessageKey &key, const InboundMessage &msg,
+                             uint32_t offset, uint32_t length, uint8_t priority)
+{
+  HomaHeader header;
+  header.SetSourcePort (msg.dport);
+  header.SetDestinationPort (msg.sport);
+  header.SetType (type);
+  header.SetMessageId (key.second);
+  header.SetMessageLength (msg.length);
+  header.SetOffset (offset);
+  header.SetLength (length);
+  header.SetPriority (priority);
+  // control packets always go first, the priority is for the data
+  SendPacket (Create<Packet> (), header, msg.daddr, msg.saddr, 0);
+}
+
+enum IpL4Protocol::RxStatus
+HomaL4Protocol::Receive (Ptr<Packet> packet,
+                         Ipv4Header const &header,
+                         Ptr<Ipv4Interface> interface)
+{
+  NS_LOG_FUNCTION (this << packet << header);
+  HomaHeader homaHeader;
+  packet->RemoveHeader (homaHeader);
+  NS_LOG_LOGIC ("Received " << homaHeader << " from " << header.GetSource ());
+  if (homaHeader.GetType () == HomaHeader::DATA)
+    {
+      return ReceiveData (packet, homaHeader, header, interface);
+    }
+  ReceiveControl (homaHeader);
+  return IpL4Protocol::RX_OK;
+}
+
+enum IpL4Protocol::RxStatus
+HomaL4Protocol::Receive (Ptr<Packet> packet,
+                         Ipv6Header const &header,
+                         Ptr<Ipv6Interface> interface)
+{
+  NS_LOG_FUNCTION (this << packet);
+  return IpL4Protocol::RX_ENDPOINT_UNREACH;
+}
+
+enum IpL4Protocol::RxStatus
+HomaL4Protocol::ReceiveData (Ptr<Packet> p, const HomaHeader &homaHeader,
+                             Ipv4Header const &header,
+                             Ptr<Ipv4Interface> interface)
+{
+  MessageKey key (header.GetSource ().Get (), homaHeader.GetMessageId ());
+  if (IsCompleted (key))
+    {
+      // the ACK may have been lost
+      NS_LOG_LOGIC ("Duplicate of a delivered message");
+      InboundMessage msg;
+      msg.saddr = header.GetSource ();
+      msg.daddr = header.GetDestination ();
+      msg.sport = homaHeader.GetSourcePort ();
+      msg.dport = homaHeader.GetDestinationPort ();
+      msg.length = homaHeader.GetMessageLength ();
+      SendControl (HomaHeader::ACK, key, msg, msg.length, 0, 0);
+      return IpL4Protocol::RX_OK;
+    }
+
+  std::map<MessageKey, InboundMessage>::iterator it = m_inbound.find (key);
+  if (it == m_inbound.end ())
+    {
+      Ipv4EndPointDemux::EndPoints endPoints =
+        m_endPoints->Lookup (header.GetDestination (), homaHeader.GetDestinationPort (),
+                             header.GetSource (), homaHeader.GetSourcePort (), interface);
+      if (endPoints.empty ())
+        {
+          NS_LOG_LOGIC ("RX_ENDPOINT_UNREACH");
+          return IpL4Protocol::RX_ENDPOINT_UNREACH;
+        }
+      InboundMessage msg;
+      msg.saddr = header.GetSource ();
+      msg.daddr = header.GetDestination ();
+      msg.sport = homaHeader.GetSourcePort ();
+      msg.dport = homaHeader.GetDestinationPort ();
+      msg.length = homaHeader.GetMessageLength ();
+      msg.received = 0;
+      msg.granted = GetUnscheduled (msg.length);
+      msg.priority = 0;
+      it = m_inbound.insert (std::make_pair (key, msg)).first;
+      if (msg.granted < msg.length)
+        {
+          m_schedule.insert (std::make_pair (msg.length, key));
+        }
+    }
+
+  InboundMessage &msg = it->second;
+  uint32_t offset = homaHeader.GetOffset ();
+  if (msg.fragments.find (offset) != msg.fragments.end ())
+    {
+      // a probe, or a resend crossing the data: tell the sender the
+      // message is in progress
+      NS_LOG_LOGIC ("Duplicate data at " << offset);
+      SendControl (HomaHeader::GRANT, key, msg, msg.granted, 0, msg.priority);
+      return IpL4Protocol::RX_OK;
+    }
+  bool scheduled = m_schedule.erase (std::make_pair (msg.length - msg.received, key)) > 0;
+  msg.fragments[offset] = p;
+  msg.received += p->GetSize ();
+  msg.lastRx = Simulator::Now ();
+  if (scheduled)
+    {
+      m_schedule.insert (std::make_pair (msg.length - msg.received, key));
+    }
+
+  if (msg.received < msg.length)
+    {
+      WakeScheduler ();
+      return IpL4Protocol::RX_OK;
+    }
+
+  Ptr<Packet> message = Create<Packet> ();
+  for (std::map<uint32_t, Ptr<Packet> >::iterator i = msg.fragments.begin ();
+       i != msg.fragments.end (); i++)
+    {
+      message->AddAtEnd (i->second);
+    }
+  SendControl (HomaHeader::ACK, key, msg, msg.length, 0, 0);
+  m_completed.insert (key);
+  m_completedOrder.push_back (key);
+  while (m_completedOrder.size () > m_completedHistory)
+    {
+      m_completed.erase (m_completedOrder.front ());
+      m_completedOrder.pop_front ();
+    }
+
+  Ipv4Header delivered = header;
+  delivered.SetPayloadSize (message->GetSize ());
+  Ipv4EndPointDemux::EndPoints endPoints =
+    m_endPoints->Lookup (msg.daddr, msg.dport, msg.saddr, msg.sport, interface);
+  for (Ipv4EndPointDemux::EndPointsI endPoint = endPoints.begin ();
+       endPoint != endPoints.end (); endPoint++)
+    {
+      (*endPoint)->ForwardUp (message->Copy (), delivered, msg.sport, interface);
+    }
+  m_messageTrace (message, InetSocketAddress (msg.saddr, msg.sport));
+  m_inbound.erase (it);
+  return IpL4Protocol::RX_OK;
+}
+
+void
+HomaL4Protocol::ReceiveControl (const HomaHeader &homaHeader)
+{
+  std::map<uint64_t, OutboundMessage>::iterator it = m_outbound.find (homaHeader.GetMessageId ());
+  if (it == m_outbound.end ())
+    {
+      NS_LOG_LOGIC ("Unknown message " << homaHeader.GetMessageId ());
+      return;
+    }
+  OutboundMessage &msg = it->second;
+  uint32_t length = msg.data->GetSize ();
+  msg.lastRx = Simulator::Now ();
+  msg.probes = 0;
+  switch (homaHeader.GetType ())
+    {
+    case HomaHeader::GRANT:
+      msg.granted = std::max (msg.granted, std::min (homaHeader.GetOffset (), length));
+      msg.priority = homaHeader.GetPriority ();
+      SendGranted (it->first, msg);
+      break;
+    case HomaHeader::RESEND:
+      {
+        uint32_t end = std::min (homaHeader.GetOffset () + homaHeader.GetLength (), length);
+        for (uint32_t offset = homaHeader.GetOffset (); offset < end && offset < msg.sent;
+             offset += m_payloadSize)
+          {
+            SendData (it->first, msg, offset, homaHeader.GetPriority ());
+          }
+        // a resend also stands for a lost grant
+        msg.granted = std::max (msg.granted, end);
+        SendGranted (it->first, msg);
+        break;
+      }
+    case HomaHeader::ACK:
+      m_outbound.erase (it);
+      break;
+    default:
+      NS_LOG_WARN ("Unknown packet type " << (uint32_t) homaHeader.GetType ());
+    }
+}
+
+void
+HomaL4Protocol::WakeScheduler (void)
+{
+  if (m_pacing)
+    {
+      return;
+    }
+  if (m_schedule.empty ())
+    {
+      // nothing to grant, but the message may need a resend
+      WakeTimeouts ();
+      return;
+    }
+  m_schedulerEvent.Cancel ();
+  Time next = m_lastGrant + m_linkRate.CalculateBytesTxTime (m_payloadSize);
+  Time delay = std::max (Time (0), next - Simulator::Now ());
+  m_pacing = true;
+  m_schedulerEvent = Simulator::Schedule (delay, &HomaL4Protocol::RunScheduler, this);
+}
+
+void
+HomaL4Protocol::WakeTimeouts (void)
+{
+  if (m_schedulerEvent.IsRunning ())
+    {
+      return;
+    }
+  Time now = Simulator::Now ();
+  m_nextResendCheck = std::max (m_nextResendCheck, now + m_resendTimeout);
+  m_schedulerEvent = Simulator::Schedule (m_nextResendCheck - now,
+                                          &HomaL4Protocol::RunScheduler, this);
+}
+
+void
+HomaL4Protocol::RunScheduler (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  m_pacing = false;
+  if (now >= m_nextResendCheck)
+    {
+      CheckResend ();
+      CheckProbe ();
+      m_nextResendCheck = now + m_resendTimeout;
+    }
+
+  uint32_t rank = 0;
+  for (Schedule::iterator it = m_schedule.begin ();
+       it != m_schedule.end () && rank < m_overcommit; it++, rank++)
+    {
+      InboundMessage &msg = m_inbound[it->second];
+      if (msg.received + m_rttBytes <= msg.granted)
+        {
+          continue;
+        }
+      msg.granted = std::min (msg.granted + m_payloadSize, msg.length);
+      msg.priority = m_priorities > 1 ? std::min<uint32_t> (rank + 1, m_priorities - 1) : 0;
+      NS_LOG_LOGIC ("Grant " << msg.granted << " of " << it->second.second << " at " << (uint32_t) msg.priority);
+      SendControl (HomaHeader::GRANT, it->second, msg, msg.granted, 0, msg.priority);
+      m_nGrants++;
+      m_lastGrant = now;
+      if (msg.granted >= msg.length)
+        {
+          m_schedule.erase (it);
+        }
+      m_pacing = true;
+      m_schedulerEvent = Simulator::Schedule (m_linkRate.CalculateBytesTxTime (m_payloadSize),
+                                              &HomaL4Protocol::RunScheduler, this);
+      return;
+    }
+
+  // nothing to grant: wait for data, or for the next resend check
+  if (!m_inbound.empty () || !m_outbound.empty ())
+    {
+      m_schedulerEvent = Simulator::Schedule (m_nextResendCheck - now,
+                                              &HomaL4Protocol::RunScheduler, this);
+    }
+}
+
+void
+HomaL4Protocol::CheckResend (void)
+{
+  Time now = Simulator::Now ();
+  for (std::map<MessageKey, InboundMessage>::iterator it = m_inbound.begin ();
+       it != m_inbound.end (); it++)
+    {
+      InboundMessage &msg = it->second;
+      if (now - msg.lastRx < m_resendTimeout)
+        {
+          continue;
+        }
+      // first range missing below the granted bytes
+      uint32_t expected = 0;
+      uint32_t end = msg.granted;
+      for (std::map<uint32_t, Ptr<Packet> >::iterator i = msg.fragments.begin ();
+           i != msg.fragments.end (); i++)
+        {
+          if (i->first > expected)
+            {
+              end = i->first;
+              break;
+            }
+          expected = i->first + i->second->GetSize ();
+        }
+      if (expected < end)
+        {
+          NS_LOG_LOGIC ("Resend " << expected << "-" << end << " of " << it->first.second);
+          SendControl (HomaHeader::RESEND, it->first, msg, expected, end - expected, msg.priority);
+          m_nResends++;
+          msg.lastRx = now;
+        }
+    }
+}
+
+void
+HomaL4Protocol::CheckProbe (void)
+{
+  Time now = Simulator::Now ();
+  std::map<uint64_t, OutboundMessage>::iterator it = m_outbound.begin ();
+  while (it != m_outbound.end ())
+    {
+      OutboundMessage &msg = it->second;
+      // the receiver asks for the missing data first
+      if (now - msg.lastRx < 2 * m_resendTimeout)
+        {
+          it++;
+          continue;
+        }
+      if (msg.probes >= m_maxProbes)
+        {
+          NS_LOG_WARN ("Drop message " << it->first << " to " << msg.daddr
+                       << ": no reply to " << msg.probes << " probes");
+          m_outbound.erase (it++);
+          continue;
+        }
+      NS_LOG_LOGIC ("Probe " << msg.daddr << " for message " << it->first);
+      SendData (it->first, msg, 0, 0);
+      msg.probes++;
+      msg.lastRx = now;
+      m_nProbes++;
+      it++;
+    }
+}
+
+uint32_t
+HomaL4Protocol::GetUnscheduled (uint32_t length) const
+{
+  // whole packets, so that the grants stay aligned on the data packets
+  uint32_t packets = (m_rttBytes + m_payloadSize - 1) / m_payloadSize;
+  return std::min (length, packets * m_payloadSize);
+}
+
+bool
+HomaL4Protocol::IsCompleted (const MessageKey &key) const
+{
+  return m_completed.find (key) != m_completed.end ();
+}
+
+uint32_t
+HomaL4Protocol::GetNOutbound (void) const
+{
+  return m_outbound.size ();
+}
+
+uint32_t
+HomaL4Protocol::GetNInbound (void) const
+{
+  return m_inbound.size ();
+}
+
+uint32_t
+HomaL4Protocol::GetNGrants (void) const
+{
+  return m_nGrants;
+}
+
+uint32_t
+HomaL4Protocol::GetNResends (void) const
+{
+  return m_nResends;
+}
+
+uint32_t
+HomaL4Protocol::GetNProbes (void) const
+{
+  return m_nProbes;
+}
+
+void
+HomaL4Protocol::SetDownTarget (IpL4Protocol::DownTargetCallback callback)
+{
+  m_downTarget = callback;
+}
+
+void
+HomaL4Protocol::SetDownTarget6 (IpL4Protocol::DownTargetCallback6 callback)
+{
+  m_downTarget6 = callback;
+}
+
+IpL4Protocol::DownTargetCallback
+HomaL4Protocol::GetDownTarget (void) const
+{
+  return m_downTarget;
+}
+
+IpL4Protocol::DownTargetCallback6
+HomaL4Protocol::GetDownTarget6 (void) const
+{
+  return m_downTarget6;
+}
+
+} // namespace ns3
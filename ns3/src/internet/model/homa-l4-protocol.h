@@ -0,0 +1,332 @@
+#ifndef HOMA_L4_PROTOCOL_H
+#define HOMA_L4_PROTOCOL_H
+
+#include <map>
+#include <set>
+#include <deque>
+
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/data-rate.h"
+#include "ns3/traced-callback.h"
+#include "ns3/ipv4-address.h"
+#include "ip-l4-protocol.h"
+#include "homa-header.h"
+
+namespace ns3 {
+
+class Node;
+class Socket;
+class Ipv4EndPointDemux;
+class Ipv4EndPoint;
+class HomaSocket;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Receiver-driven message transport in the style of Homa and pHost
+ *
+ * Messages are sent whole by HomaSocket.  The sender transmits the
+ * first RttBytes of a message at once, rounded up to whole packets, at
+ * the highest priority, and the rest only when the receiver grants it.
+ * Each receiver keeps the inbound messages needing grants ordered by remaining bytes, and a
+ * single scheduler event per host, paced at LinkRate, grants one
+ * packet at a time to the shortest of the Overcommit first messages
+ * whose granted but not received bytes are below RttBytes.  The grant
+ * carries a priority from the rank of the message, so that a
+ * StrictPriorityQueueDisc keyed on the DSCP serves the shorter messages
+ * first; unscheduled data and control packets use priority 0.
+ *
+ * The same event looks for inbound messages which received nothing for
+ * ResendTimeout and asks their sender for the first missing range.  A
+ * receiver acknowledges complete messages so that their sender can
+ * release them.  On the sender side, the event probes the receiver of
+ * an outbound message which got no reply for twice ResendTimeout, so
+ * that the receiver asks for the missing data first, with the first
+ * data packet again, which recovers a message whose unscheduled
+ * packets were all lost; the receiver answers a duplicate with an ACK
+ * if the message is complete, or a GRANT of the granted bytes if not.
+ * A message whose receiver does not answer MaxProbes probes in a row is
+ * dropped.  Only IPv4 is supported.
+ */
+class HomaL4Protocol : public IpL4Protocol
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  static const uint8_t PROT_NUMBER; //!< protocol number (146)
+
+  HomaL4Protocol ();
+  virtual ~HomaL4Protocol ();
+
+  /**
+   * \brief Set node associated with this stack
+   * \param node the node
+   */
+  void SetNode (Ptr<Node> node);
+
+  virtual int GetProtocolNumber (void) const;
+
+  /**
+   * \return A smart Socket pointer to a HomaSocket, allocated by this
+   *         instance of the protocol
+   */
+  Ptr<Socket> CreateSocket (void);
+
+  /**
+   * \brief Allocate an IPv4 Endpoint
+   * \return the Endpoint
+   */
+  Ipv4EndPoint *Allocate (void);
+  /**
+   * \brief Allocate an IPv4 Endpoint
+   * \param port port to use
+   * \return the Endpoint
+   */
+  Ipv4EndPoint *Allocate (uint16_t port);
+  /**
+   * \brief Allocate an IPv4 Endpoint
+   * \param address address to use
+   * \param port port to use
+   * \return the Endpoint
+   */
+  Ipv4EndPoint *Allocate (Ipv4Address address, uint16_t port);
+  /**
+   * \brief Remove an IPv4 Endpoint.
+   * \param endPoint the end point to remove
+   */
+  void DeAllocate (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Send a message
+   *
+   * \param message the message
+   * \param saddr the source address, or any to pick it from the route
+   * \param daddr the destination address
+   * \param sport the source port
+   * \param dport the destination port
+   * \return the message id
+   */
+  uint64_t SendMessage (Ptr<Packet> message, Ipv4Address saddr, Ipv4Address daddr,
+                        uint16_t sport, uint16_t dport);
+
+  /**
+   * \return the number of messages not acknowledged yet
+   */
+  uint32_t GetNOutbound (void) const;
+
+  /**
+   * \return the number of messages being received
+   */
+  uint32_t GetNInbound (void) const;
+
+  /**
+   * \return the number of grants sent
+   */
+  uint32_t GetNGrants (void) const;
+
+  /**
+   * \return the number of resend requests sent
+   */
+  uint32_t GetNResends (void) const;
+
+  /**
+   * \return the number of probes sent
+   */
+  uint32_t GetNProbes (void) const;
+
+  // inherited from IpL4Protocol
+  virtual enum IpL4Protocol::RxStatus Receive (Ptr<Packet> p,
+                                               Ipv4Header const &header,
+                                               Ptr<Ipv4Interface> interface);
+  virtual enum IpL4Protocol::RxStatus Receive (Ptr<Packet> p,
+                                               Ipv6Header const &header,
+                                               Ptr<Ipv6Interface> interface);
+  virtual void SetDownTarget (IpL4Protocol::DownTargetCallback cb);
+  virtual void SetDownTarget6 (IpL4Protocol::DownTargetCallback6 cb);
+  virtual IpL4Protocol::DownTargetCallback GetDownTarget (void) const;
+  virtual IpL4Protocol::DownTargetCallback6 GetDownTarget6 (void) const;
+
+protected:
+  virtual void DoDispose (void);
+  /**
+   * \brief Hook to the IPv4 of the node and aggregate a HomaSocketFactory
+   */
+  virtual void NotifyNewAggregate ();
+
+private:
+  /// A message being sent
+  struct OutboundMessage
+  {
+    Ptr<Packet> data;  //!< the message
+    Ipv4Address saddr; //!< source address
+    Ipv4Address daddr; //!< destination address
+    uint16_t sport;    //!< source port
+    uint16_t dport;    //!< destination port
+    uint32_t sent;     //!< bytes sent
+    uint32_t granted;  //!< bytes the receiver allows
+    uint8_t priority;  //!< priority of the last grant
+    Time lastRx;       //!< last reply of the receiver, for probes
+    uint32_t probes;   //!< probes sent since the last reply
+  };
+
+  /// (sender address, message id)
+  typedef std::pair<uint32_t, uint64_t> MessageKey;
+
+  /// A message being received
+  struct InboundMessage
+  {
+    Ipv4Address saddr;  //!< source address
+    Ipv4Address daddr;  //!< destination address
+    uint16_t sport;     //!< source port
+    uint16_t dport;     //!< destination port
+    uint32_t length;    //!< message length
+    uint32_t received;  //!< bytes received
+    uint32_t granted;   //!< bytes granted
+    uint8_t priority;   //!< priority of the last grant
+    Time lastRx;        //!< last progress, for resends
+    std::map<uint32_t, Ptr<Packet> > fragments; //!< received data by offset
+  };
+
+  /// Inbound messages needing grants, by (remaining bytes, key)
+  typedef std::set<std::pair<uint32_t, MessageKey> > Schedule;
+
+  /**
+   * \brief Send a packet with its header, queued at a priority
+   * \param p the packet
+   * \param header the header
+   * \param saddr the source address
+   * \param daddr the destination address
+   * \param priority the priority
+   */
+  void SendPacket (Ptr<Packet> p, const HomaHeader &header,
+                   Ipv4Address saddr, Ipv4Address daddr, uint8_t priority);
+
+  /**
+   * \brief Send the data packet of an outbound message at an offset
+   * \param id the message id
+   * \param msg the message
+   * \param offset the offset, a multiple of the payload size
+   * \param priority the priority
+   */
+  void SendData (uint64_t id, OutboundMessage &msg, uint32_t offset, uint8_t priority);
+
+  /**
+   * \brief Send the data granted and not sent yet
+   * \param id the message id
+   * \param msg the message
+   */
+  void SendGranted (uint64_t id, OutboundMessage &msg);
+
+  /**
+   * \brief Send a control packet to the sender of an inbound message
+   * \param type the packet type
+   * \param key the message key
+   * \param msg the message
+   * \param offset the offset
+   * \param length the length of a RESEND
+   * \param priority the priority asked
+   */
+  void SendControl (uint8_t type, const MessageKey &key, const InboundMessage &msg,
+                    uint32_t offset, uint32_t length, uint8_t priority);
+
+  /**
+   * \brief Receive a data packet
+   * \param p the payload
+   * \param homaHeader the header
+   * \param header the IPv4 header
+   * \param interface the incoming interface
+   * \return the receive status
+   */
+  enum IpL4Protocol::RxStatus ReceiveData (Ptr<Packet> p, const HomaHeader &homaHeader,
+                                           Ipv4Header const &header,
+                                           Ptr<Ipv4Interface> interface);
+
+  /**
+   * \brief Receive a GRANT, RESEND or ACK of an outbound message
+   * \param homaHeader the header
+   */
+  void ReceiveControl (const HomaHeader &homaHeader);
+
+  /**
+   * \brief Grant the next packet and look for stalled messages
+   *
+   * The only scheduler event of the receiver.
+   */
+  void RunScheduler (void);
+
+  /**
+   * \brief Run the scheduler as soon as pacing allows, if it is idle
+   */
+  void WakeScheduler (void);
+
+  /**
+   * \brief Run the scheduler at the next resend check, if it is idle
+   */
+  void WakeTimeouts (void);
+
+  /**
+   * \brief Ask the senders of the stalled messages for their missing data
+   */
+  void CheckResend (void);
+
+  /**
+   * \brief Probe the receivers of the outbound messages without reply,
+   * and drop the messages whose receiver does not answer
+   */
+  void CheckProbe (void);
+
+  /**
+   * \param length the length of a message
+   * \return the bytes of the message sent without grant
+   */
+  uint32_t GetUnscheduled (uint32_t length) const;
+
+  /**
+   * \param key the message key
+   * \return true if the message has been delivered recently
+   */
+  bool IsCompleted (const MessageKey &key) const;
+
+  Ptr<Node> m_node;                //!< the node this stack is associated with
+  Ipv4EndPointDemux *m_endPoints;  //!< the IPv4 end points
+  std::vector<Ptr<HomaSocket> > m_sockets;  //!< the sockets
+  IpL4Protocol::DownTargetCallback m_downTarget;   //!< callback to send packets over IPv4
+  IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< unused
+
+  uint32_t m_rttBytes;       //!< unscheduled bytes and grant window
+  uint32_t m_payloadSize;    //!< data bytes per packet
+  DataRate m_linkRate;       //!< grant pacing rate
+  uint32_t m_overcommit;     //!< messages granted at once
+  uint8_t m_priorities;      //!< number of priorities
+  Time m_resendTimeout;      //!< idle time before a resend request or a probe
+  uint32_t m_maxProbes;      //!< unanswered probes before a message is dropped
+  uint32_t m_completedHistory; //!< completed messages remembered
+
+  uint64_t m_nextId;         //!< id of the next outbound message
+  std::map<uint64_t, OutboundMessage> m_outbound;  //!< messages being sent
+  std::map<MessageKey, InboundMessage> m_inbound;  //!< messages being received
+  Schedule m_schedule;       //!< inbound messages needing grants
+  std::set<MessageKey> m_completed;    //!< recently delivered messages
+  std::deque<MessageKey> m_completedOrder; //!< m_completed, oldest first
+
+  EventId m_schedulerEvent;  //!< the scheduler event
+  bool m_pacing;             //!< the scheduler event is a grant
+  Time m_lastGrant;          //!< time of the last grant
+  Time m_nextResendCheck;    //!< time of the next resend check
+  uint32_t m_nGrants;        //!< grants sent
+  uint32_t m_nResends;       //!< resend requests sent
+  uint32_t m_nProbes;        //!< probes sent
+
+  /// Traced callback: message delivered, with its sender
+  TracedCallback<Ptr<const Packet>, const Address &> m_messageTrace;
+};
+
+} // namespace ns3
+
+#endif // HOMA_L4_PROTOCOL_H
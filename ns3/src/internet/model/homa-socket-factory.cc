@@ -0,0 +1,49 @@
+#include "homa-socket-factory.h"
+
+#include "ns3/socket.h"
+#include "homa-l4-protocol.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (HomaSocketFactory);
+
+TypeId
+HomaSocketFactory::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HomaSocketFactory")
+      .SetParent<SocketFactory> ()
+      .SetGroupName ("Internet")
+  ;
+  return tid;
+}
+
+HomaSocketFactory::HomaSocketFactory ()
+  : m_homa (0)
+{
+}
+
+HomaSocketFactory::~HomaSocketFactory ()
+{
+  NS_ASSERT (m_homa == 0);
+}
+
+void
+HomaSocketFactory::SetHoma (Ptr<HomaL4Protocol> homa)
+{
+  m_homa = homa;
+}
+
+Ptr<Socket>
+HomaSocketFactory::CreateSocket (void)
+{
+  return m_homa->CreateSocket ();
+}
+
+void
+HomaSocketFactory::DoDispose (void)
+{
+  m_homa = 0;
+  SocketFactory::DoDispose ();
+}
+
+} // namespace ns3
@@ -0,0 +1,46 @@
+#ifndef HOMA_SOCKET_FACTORY_H
+#define HOMA_SOCKET_FACTORY_H
+
+#include "ns3/socket-factory.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class HomaL4Protocol;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Socket factory of HomaL4Protocol, aggregated to the node by the
+ * protocol itself
+ */
+class HomaSocketFactory : public SocketFactory
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  HomaSocketFactory ();
+  virtual ~HomaSocketFactory ();
+
+  /**
+   * \brief Set the associated Homa L4 protocol.
+   * \param homa the Homa L4 protocol
+   */
+  void SetHoma (Ptr<HomaL4Protocol> homa);
+
+  virtual Ptr<Socket> CreateSocket (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  Ptr<HomaL4Protocol> m_homa; //!< the associated Homa L4 protocol
+};
+
+} // namespace ns3
+
+#endif // HOMA_SOCKET_FACTORY_H
@@ -0,0 +1,356 @@
+#include "homa-socket.h"
+
+#include <limits>
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/inet-socket-address.h"
+#include "ipv4-end-point.h"
+#include "homa-l4-protocol.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HomaSocket");
+
+NS_OBJECT_ENSURE_REGISTERED (HomaSocket);
+
+TypeId
+HomaSocket::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HomaSocket")
+      .SetParent<Socket> ()
+      .SetGroupName ("Internet")
+      .AddConstructor<HomaSocket> ()
+  ;
+  return tid;
+}
+
+HomaSocket::HomaSocket ()
+  : m_endPoint (0),
+    m_defaultPort (0),
+    m_errno (ERROR_NOTERROR),
+    m_shutdownSend (false),
+    m_shutdownRecv (false),
+    m_connected (false),
+    m_rxAvailable (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HomaSocket::~HomaSocket ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HomaSocket::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  DeallocateEndPoint ();
+  m_node = 0;
+  m_homa = 0;
+  Socket::DoDispose ();
+}
+
+void
+HomaSocket::SetNode (Ptr<Node> node)
+{
+  m_node = node;
+}
+
+void
+HomaSocket::SetHoma (Ptr<HomaL4Protocol> homa)
+{
+  m_homa = homa;
+}
+
+enum Socket::SocketErrno
+HomaSocket::GetErrno (void) const
+{
+  return m_errno;
+}
+
+enum Socket::SocketType
+HomaSocket::GetSocketType (void) const
+{
+  return NS3_SOCK_SEQPACKET;
+}
+
+Ptr<Node>
+HomaSocket::GetNode (void) const
+{
+  return m_node;
+}
+
+void
+HomaSocket::Destroy (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_endPoint = 0;
+}
+
+void
+HomaSocket::DeallocateEndPoint (void)
+{
+  if (m_endPoint != 0)
+    {
+      m_endPoint->SetDestroyCallback (MakeNullCallback<void> ());
+      m_homa->DeAllocate (m_endPoint);
+      m_endPoint = 0;
+    }
+}
+
+int
+HomaSocket::FinishBind (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_endPoint == 0)
+    {
+      m_errno = ERROR_ADDRINUSE;
+      return -1;
+    }
+  m_endPoint->SetRxCallback (MakeCallback (&HomaSocket::ForwardUp, Ptr<HomaSocket> (this)));
+  m_endPoint->SetDestroyCallback (MakeCallback (&HomaSocket::Destroy, Ptr<HomaSocket> (this)));
+  return 0;
+}
+
+int
+HomaSocket::Bind (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_endPoint = m_homa->Allocate ();
+  return FinishBind ();
+}
+
+int
+HomaSocket::Bind6 (void)
+{
+  m_errno = ERROR_AFNOSUPPORT;
+  return -1;
+}
+
+int
+HomaSocket::Bind (const Address &address)
+{
+  NS_LOG_FUNCTION (this << address);
+  if (!InetSocketAddress::IsMatchingType (address))
+    {
+      m_errno = ERROR_INVAL;
+      return -1;
+    }
+  NS_ASSERT_MSG (m_endPoint == 0, "Endpoint already allocated.");
+  InetSocketAddress transport = InetSocketAddress::ConvertFrom (address);
+  if (transport.GetIpv4 () == Ipv4Address::GetAny () && transport.GetPort () == 0)
+    {
+      m_endPoint = m_homa->Allocate ();
+    }
+  else if (transport.GetIpv4 () == Ipv4Address::GetAny ())
+    {
+      m_endPoint = m_homa->Allocate (transport.GetPort ());
+    }
+  else
+    {
+      m_endPoint = m_homa->Allocate (transport.GetIpv4 (), transport.GetPort ());
+    }
+  return FinishBind ();
+}
+
+int
+HomaSocket::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_shutdownRecv && m_shutdownSend)
+    {
+      m_errno = ERROR_BADF;
+      return -1;
+    }
+  m_shutdownRecv = true;
+  m_shutdownSend = true;
+  DeallocateEndPoint ();
+  return 0;
+}
+
+int
+HomaSocket::ShutdownSend (void)
+{
+  m_shutdownSend = true;
+  return 0;
+}
+
+int
+HomaSocket::ShutdownRecv (void)
+{
+  m_shutdownRecv = true;
+  return 0;
+}
+
+int
+HomaSocket::Connect (const Address &address)
+{
+  NS_LOG_FUNCTION (this << address);
+  if (!InetSocketAddress::IsMatchingType (address))
+    {
+      NotifyConnectionFailed ();
+      m_errno = ERROR_INVAL;
+      return -1;
+    }
+  InetSocketAddress transport = InetSocketAddress::ConvertFrom (address);
+  m_defaultAddress = Address (transport.GetIpv4 ());
+  m_defaultPort = transport.GetPort ();
+  m_connected = true;
+  NotifyConnectionSucceeded ();
+  return 0;
+}
+
+int
+HomaSocket::Listen (void)
+{
+  m_errno = ERROR_OPNOTSUPP;
+  return -1;
+}
+
+uint32_t
+HomaSocket::GetTxAvailable (void) const
+{
+  return std::numeric_limits<uint32_t>::max ();
+}
+
+int
+HomaSocket::Send (Ptr<Packet> p, uint32_t flags)
+{
+  NS_LOG_FUNCTION (this << p << flags);
+  if (!m_connected)
+    {
+      m_errno = ERROR_NOTCONN;
+      return -1;
+    }
+  return SendTo (p, flags, InetSocketAddress (Ipv4Address::ConvertFrom (m_defaultAddress), m_defaultPort));
+}
+
+int
+HomaSocket::SendTo (Ptr<Packet> p, uint32_t flags, const Address &address)
+{
+  NS_LOG_FUNCTION (this << p << flags << address);
+  if (m_shutdownSend)
+    {
+      m_errno = ERROR_SHUTDOWN;
+      return -1;
+    }
+  if (!InetSocketAddress::IsMatchingType (address))
+    {
+      m_errno = ERROR_AFNOSUPPORT;
+      return -1;
+    }
+  if (m_endPoint == 0 && Bind () == -1)
+    {
+      return -1;
+    }
+  InetSocketAddress transport = InetSocketAddress::ConvertFrom (address);
+  m_homa->SendMessage (p, m_endPoint->GetLocalAddress (), transport.GetIpv4 (),
+                       m_endPoint->GetLocalPort (), transport.GetPort ());
+  NotifyDataSent (p->GetSize ());
+  return p->GetSize ();
+}
+
+uint32_t
+HomaSocket::GetRxAvailable (void) const
+{
+  return m_rxAvailable;
+}
+
+Ptr<Packet>
+HomaSocket::Recv (uint32_t maxSize, uint32_t flags)
+{
+  Address fromAddress;
+  return RecvFrom (maxSize, flags, fromAddress);
+}
+
+Ptr<Packet>
+HomaSocket::RecvFrom (uint32_t maxSize, uint32_t flags, Address &fromAddress)
+{
+  NS_LOG_FUNCTION (this << maxSize << flags);
+  if (m_deliveryQueue.empty ())
+    {
+      m_errno = ERROR_AGAIN;
+      return 0;
+    }
+  Ptr<Packet> p = m_deliveryQueue.front ().first;
+  if (p->GetSize () > maxSize)
+    {
+      m_errno = ERROR_MSGSIZE;
+      return 0;
+    }
+  fromAddress = m_deliveryQueue.front ().second;
+  m_deliveryQueue.pop ();
+  m_rxAvailable -= p->GetSize ();
+  return p;
+}
+
+int
+HomaSocket::GetSockName (Address &address) const
+{
+  if (m_endPoint != 0)
+    {
+      address = InetSocketAddress (m_endPoint->GetLocalAddress (), m_endPoint->GetLocalPort ());
+    }
+  else
+    {
+      address = InetSocketAddress (Ipv4Address::GetZero (), 0);
+    }
+  return 0;
+}
+
+int
+HomaSocket::GetPeerName (Address &address) const
+{
+  if (!m_connected)
+    {
+      m_errno = ERROR_NOTCONN;
+      return -1;
+    }
+  address = InetSocketAddress (Ipv4Address::ConvertFrom (m_defaultAddress), m_defaultPort);
+  return 0;
+}
+
+void
+HomaSocket::BindToNetDevice (Ptr<NetDevice> netdevice)
+{
+  NS_LOG_FUNCTION (this << netdevice);
+  Socket::BindToNetDevice (netdevice);
+  if (m_endPoint == 0 && Bind () == -1)
+    {
+      return;
+    }
+  m_endPoint->BindToNetDevice (netdevice);
+}
+
+bool
+HomaSocket::SetAllowBroadcast (bool allowBroadcast)
+{
+  return !allowBroadcast;
+}
+
+bool
+HomaSocket::GetAllowBroadcast () const
+{
+  return false;
+}
+
+void
+HomaSocket::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
+                       Ptr<Ipv4Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << packet << header << port);
+  if (m_shutdownRecv)
+    {
+      return;
+    }
+  SocketPriorityTag priorityTag;
+  packet->RemovePacketTag (priorityTag);
+  m_deliveryQueue.push (std::make_pair (packet, Address (InetSocketAddress (header.GetSource (), port))));
+  m_rxAvailable += packet->GetSize ();
+  NotifyDataRecv ();
+}
+
+} // namespace ns3
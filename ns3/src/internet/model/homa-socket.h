@@ -0,0 +1,123 @@
+#ifndef HOMA_SOCKET_H
+#define HOMA_SOCKET_H
+
+#include <queue>
+
+#include "ns3/socket.h"
+#include "ns3/ptr.h"
+#include "ns3/address.h"
+#include "ipv4-header.h"
+#include "ipv4-interface.h"
+
+namespace ns3 {
+
+class Ipv4EndPoint;
+class Node;
+class Packet;
+class HomaL4Protocol;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Message socket of HomaL4Protocol
+ *
+ * Every Send or SendTo is one message, delivered whole to the receiving
+ * socket, where each Recv returns one message.  The transmission of the
+ * messages is left to HomaL4Protocol, which paces them from the
+ * receiver, so the socket has no send buffer and never blocks.
+ */
+class HomaSocket : public Socket
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  HomaSocket ();
+  virtual ~HomaSocket ();
+
+  /**
+   * \brief Set the associated node.
+   * \param node the node
+   */
+  void SetNode (Ptr<Node> node);
+  /**
+   * \brief Set the associated Homa L4 protocol.
+   * \param homa the Homa L4 protocol
+   */
+  void SetHoma (Ptr<HomaL4Protocol> homa);
+
+  virtual enum SocketErrno GetErrno (void) const;
+  virtual enum SocketType GetSocketType (void) const;
+  virtual Ptr<Node> GetNode (void) const;
+  virtual int Bind (void);
+  virtual int Bind6 (void);
+  virtual int Bind (const Address &address);
+  virtual int Close (void);
+  virtual int ShutdownSend (void);
+  virtual int ShutdownRecv (void);
+  virtual int Connect (const Address &address);
+  virtual int Listen (void);
+  virtual uint32_t GetTxAvailable (void) const;
+  virtual int Send (Ptr<Packet> p, uint32_t flags);
+  virtual int SendTo (Ptr<Packet> p, uint32_t flags, const Address &address);
+  virtual uint32_t GetRxAvailable (void) const;
+  virtual Ptr<Packet> Recv (uint32_t maxSize, uint32_t flags);
+  virtual Ptr<Packet> RecvFrom (uint32_t maxSize, uint32_t flags,
+                                Address &fromAddress);
+  virtual int GetSockName (Address &address) const;
+  virtual int GetPeerName (Address &address) const;
+  virtual void BindToNetDevice (Ptr<NetDevice> netdevice);
+  virtual bool SetAllowBroadcast (bool allowBroadcast);
+  virtual bool GetAllowBroadcast () const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Finish the binding process
+   * \returns 0 on success, -1 on failure
+   */
+  int FinishBind (void);
+
+  /**
+   * \brief Called by the L3 protocol when it received a message.
+   * \param packet the message
+   * \param header the IPv4 header
+   * \param port the source port
+   * \param incomingInterface the incoming interface
+   */
+  void ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port, Ptr<Ipv4Interface> incomingInterface);
+
+  /**
+   * \brief Kill this socket, called when the end point is destroyed
+   */
+  void Destroy (void);
+
+  /**
+   * \brief Deallocate m_endPoint
+   */
+  void DeallocateEndPoint (void);
+
+  Ipv4EndPoint *m_endPoint;     //!< the IPv4 endpoint
+  Ptr<Node> m_node;             //!< the associated node
+  Ptr<HomaL4Protocol> m_homa;   //!< the associated Homa L4 protocol
+
+  Address m_defaultAddress;     //!< default destination address
+  uint16_t m_defaultPort;       //!< default destination port
+
+  mutable enum SocketErrno m_errno; //!< socket error code
+  bool m_shutdownSend;          //!< send no longer allowed
+  bool m_shutdownRecv;          //!< receive no longer allowed
+  bool m_connected;             //!< default destination set
+
+  std::queue<std::pair<Ptr<Packet>, Address> > m_deliveryQueue; //!< received messages
+  uint32_t m_rxAvailable;       //!< bytes of the received messages
+};
+
+} // namespace ns3
+
+#endif // HOMA_SOCKET_H
@@ -29,6 +29,8 @@
 #include "ns3/boolean.h"
 #include "ns3/node.h"
 #include "ns3/enum.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/queue-disc.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
 #include "udp-header.h"
@@ -63,7 +65,13 @@ Ipv4GlobalRouting::GetTypeId (void)
                    MakeEnumChecker(ECMP_NONE, "ECMP_NONE",         // NO ECMP
                                    ECMP_HASH, "ECMP_HASH",         // Per-Flow ECMP
                                    ECMP_RANDOM, "ECMP_RANDOM",     // Per-Packet ECMP
-                                   ECMP_FLOWCELL, "ECMP_FLOWCELL"))// Per-Hop ECMP with flowcell
+                                   ECMP_FLOWCELL, "ECMP_FLOWCELL", // Per-Hop ECMP with flowcell
+                                   ECMP_FLOWLET, "ECMP_FLOWLET"))  // Per-Hop ECMP with flowlets on the least loaded egress
+    .AddAttribute ("FlowletGap",
+                   "Inactivity gap after which a flow may change egress in ECMP_FLOWLET mode",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&Ipv4GlobalRouting::m_flowletGap),
+                   MakeTimeChecker ())
     .AddAttribute ("RespondToInterfaceEvents",
                    "Set to true if you want to dynamically recompute the global routes upon Interface notification events (up/down, or add/remove address)",
                    BooleanValue (false),
@@ -247,6 +255,9 @@ Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, Ptr<const Packet> ipP
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
+      // only the longest matching prefix is kept, all the routes to that
+      // prefix are candidates for ECMP
+      uint16_t longestMask = 0;
       for (NetworkRoutesI j = m_networkRoutes.begin (); 
            j != m_networkRoutes.end (); 
            j++) 
@@ -263,6 +274,16 @@ Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, Ptr<const Packet> ipP
                       continue;
                     }
                 }
+              uint16_t maskLen = mask.GetPrefixLength ();
+              if (maskLen < longestMask)
+                {
+                  continue;
+                }
+              if (maskLen > longestMask)
+                {
+                  allRoutes.clear ();
+                  longestMask = maskLen;
+                }
               allRoutes.push_back (*j);
               NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
@@ -323,6 +344,9 @@ Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, Ptr<const Packet> ipP
         case ECMP_FLOWCELL:
           selectIndex = GetTupleValue(header,ipPayload, true) % (allRoutes.size());
           break;
+        case ECMP_FLOWLET:
+          selectIndex = SelectFlowletRoute (GetTupleValue (header, ipPayload), allRoutes, ipPayload != 0);
+          break;
         default:
           selectIndex = 0;
           break;
@@ -344,6 +368,96 @@ Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, Ptr<const Packet> ipP
     }
 }
 
+uint32_t
+Ipv4GlobalRouting::SelectFlowletRoute (uint32_t hash, const std::vector<Ipv4RoutingTableEntry *> &routes, bool record)
+{
+  NS_LOG_FUNCTION (this << hash << routes.size () << record);
+  Time now = Simulator::Now ();
+  if (record && now - m_lastPrune > m_flowletGap)
+    {
+      PruneFlowlets (now);
+    }
+  std::map<uint32_t, Flowlet>::iterator it = m_flowlets.find (hash);
+  if (it != m_flowlets.end () && now - it->second.lastSeen <= m_flowletGap)
+    {
+      for (uint32_t i = 0; i < routes.size (); i++)
+        {
+          if (routes[i]->GetInterface () == it->second.interface
+              && routes[i]->GetGateway () == it->second.gateway)
+            {
+              if (record)
+                {
+                  it->second.lastSeen = now;
+                }
+              return i;
+            }
+        }
+    }
+
+  // new flowlet, or its egress is gone: pick the least loaded egress
+  std::vector<uint32_t> candidates;
+  uint32_t minLoad = 0;
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      uint32_t load = routes.size () > 1 ? GetEgressLoad (routes[i]->GetInterface ()) : 0;
+      if (candidates.empty () || load < minLoad)
+        {
+          candidates.clear ();
+          minLoad = load;
+        }
+      if (load == minLoad)
+        {
+          candidates.push_back (i);
+        }
+    }
+  uint32_t selectIndex = candidates.size () > 1 ?
+    candidates[m_rand->GetInteger (0, candidates.size () - 1)] : candidates[0];
+  if (record)
+    {
+      Flowlet &flowlet = m_flowlets[hash];
+      flowlet.lastSeen = now;
+      flowlet.interface = routes[selectIndex]->GetInterface ();
+      flowlet.gateway = routes[selectIndex]->GetGateway ();
+      NS_LOG_LOGIC ("New flowlet of flow " << hash << " on interface " << flowlet.interface
+                    << ", " << minLoad << " bytes queued");
+    }
+  return selectIndex;
+}
+
+void
+Ipv4GlobalRouting::PruneFlowlets (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+  // an idle flowlet is never continued, its entry is useless
+  for (std::map<uint32_t, Flowlet>::iterator it = m_flowlets.begin (); it != m_flowlets.end (); )
+    {
+      if (now - it->second.lastSeen > m_flowletGap)
+        {
+          m_flowlets.erase (it++);
+        }
+      else
+        {
+          ++it;
+        }
+    }
+  m_lastPrune = now;
+}
+
+uint32_t
+Ipv4GlobalRouting::GetEgressLoad (uint32_t interface)
+{
+  if (m_tc == 0)
+    {
+      m_tc = m_ipv4->GetObject<TrafficControlLayer> ();
+      if (m_tc == 0)
+        {
+          return 0;
+        }
+    }
+  Ptr<QueueDisc> qdisc = m_tc->GetRootQueueDiscOnDevice (m_ipv4->GetNetDevice (interface));
+  return qdisc ? qdisc->GetNBytes () : 0;
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -355,6 +469,12 @@ Ipv4GlobalRouting::GetNRoutes (void) const
   return n;
 }
 
+uint32_t
+Ipv4GlobalRouting::GetNFlowlets (void) const
+{
+  return m_flowlets.size ();
+}
+
 Ipv4RoutingTableEntry *
 Ipv4GlobalRouting::GetRoute (uint32_t index) const
 {
@@ -461,6 +581,56 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+void
+Ipv4GlobalRouting::AddRoute (const Ipv4RoutingTableEntry &route)
+{
+  NS_LOG_FUNCTION (this << route);
+  if (route.IsHost ())
+    {
+      m_hostRoutes.push_back (new Ipv4RoutingTableEntry (route));
+    }
+  else
+    {
+      m_networkRoutes.push_back (new Ipv4RoutingTableEntry (route));
+    }
+}
+
+bool
+Ipv4GlobalRouting::RemoveRoute (const Ipv4RoutingTableEntry &route)
+{
+  NS_LOG_FUNCTION (this << route);
+  std::list<Ipv4RoutingTableEntry *> &routes = route.IsHost () ? m_hostRoutes : m_networkRoutes;
+  for (std::list<Ipv4RoutingTableEntry *>::iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      if ((*i)->GetDest () == route.GetDest ()
+          && (*i)->GetDestNetworkMask () == route.GetDestNetworkMask ()
+          && (*i)->GetGateway () == route.GetGateway ()
+          && (*i)->GetInterface () == route.GetInterface ())
+        {
+          delete *i;
+          routes.erase (i);
+          return true;
+        }
+    }
+  return false;
+}
+
+std::vector<Ipv4RoutingTableEntry>
+Ipv4GlobalRouting::GetRoutes (void) const
+{
+  std::vector<Ipv4RoutingTableEntry> routes;
+  routes.reserve (m_hostRoutes.size () + m_networkRoutes.size ());
+  for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+    {
+      routes.push_back (**i);
+    }
+  for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+    {
+      routes.push_back (**j);
+    }
+  return routes;
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -491,6 +661,8 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_flowlets.clear ();
+  m_tc = 0;
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -21,13 +21,17 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <map>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
@@ -39,6 +43,7 @@ class Ipv4Header;
 class Ipv4RoutingTableEntry;
 class Ipv4MulticastRoutingTableEntry;
 class Node;
+class TrafficControlLayer;
 
 typedef enum
 {
@@ -46,6 +51,7 @@ typedef enum
   ECMP_HASH,   // per-flow hash, five tuple
   ECMP_RANDOM,  // per-packet random
   ECMP_FLOWCELL, // per-hop with flowcell 64KB each change
+  ECMP_FLOWLET, // per-hop flowlets placed on the least loaded egress
 }EcmpMode_t;
 
 /**
@@ -185,6 +191,16 @@ public:
    */
   uint32_t GetNRoutes (void) const;
 
+  /**
+   * \brief Get the number of flows in the ECMP_FLOWLET flowlet table.
+   *
+   * Flows idle for more than FlowletGap are pruned, so only the recently
+   * routed flows are counted.
+   *
+   * \returns the size of the flowlet table
+   */
+  uint32_t GetNFlowlets (void) const;
+
   /**
    * \brief Get a route from the global unicast routing table.
    *
@@ -225,6 +241,27 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Add a copy of a host or network route to the table.
+   *
+   * \param route the route, a host route if its mask is /32
+   */
+  void AddRoute (const Ipv4RoutingTableEntry &route);
+
+  /**
+   * \brief Remove a host or network route from the table.
+   *
+   * \param route a route with the same destination, mask, gateway and
+   * interface as the one to remove
+   * \return true if the route was in the table
+   */
+  bool RemoveRoute (const Ipv4RoutingTableEntry &route);
+
+  /**
+   * \return a copy of the host routes followed by the network routes
+   */
+  std::vector<Ipv4RoutingTableEntry> GetRoutes (void) const;
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -279,6 +316,46 @@ private:
   // Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
   Ptr<Ipv4Route> LookupGlobal (const Ipv4Header &header, Ptr<const Packet> ipPayload, Ptr<NetDevice> oif = 0, bool host = false);
 
+  /**
+   * \brief Select the route of a packet in ECMP_FLOWLET mode.
+   *
+   * A packet continues the flowlet of its flow if the previous packet
+   * was routed less than FlowletGap ago and its egress is still a
+   * candidate.  Otherwise a new flowlet is placed on the candidate whose
+   * egress queue disc holds the fewest bytes, ties broken at random.
+   *
+   * \param hash the five tuple hash of the packet
+   * \param routes the candidate routes
+   * \param record false if the flowlet table must not be updated
+   * \return the index of the selected route
+   */
+  uint32_t SelectFlowletRoute (uint32_t hash, const std::vector<Ipv4RoutingTableEntry *> &routes, bool record);
+
+  /**
+   * \brief Remove the flowlets idle for more than FlowletGap.
+   * \param now the current time
+   */
+  void PruneFlowlets (Time now);
+
+  /**
+   * \param interface the interface index
+   * \return the bytes queued in the root queue disc of the interface
+   */
+  uint32_t GetEgressLoad (uint32_t interface);
+
+  /// A flowlet of the flowlet table
+  struct Flowlet
+  {
+    Time lastSeen;        //!< time the last packet was routed
+    uint32_t interface;   //!< egress interface
+    Ipv4Address gateway;  //!< next hop
+  };
+
+  Time m_flowletGap;                    //!< inactivity gap starting a new flowlet
+  std::map<uint32_t, Flowlet> m_flowlets; //!< flowlet table, by five tuple hash
+  Time m_lastPrune;                     //!< last sweep of the flowlet table
+  Ptr<TrafficControlLayer> m_tc;        //!< traffic control layer of the node
+
   Hasher hasher;                       //!< Used for hashing five tuple
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
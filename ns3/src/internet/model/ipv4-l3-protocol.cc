@@ -20,6 +20,7 @@
 
 #include "ns3/packet.h"
 #include "ns3/log.h"
+#include "ns3/profiler.h"
 #include "ns3/callback.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-route.h"
@@ -548,6 +549,7 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
                           const Address &to, NetDevice::PacketType packetType)
 {
   NS_LOG_FUNCTION (this << device << p << protocol << from << to << packetType);
+  NS_PROFILE_SCOPE ("ns3::Ipv4L3Protocol::Receive");
 
   NS_LOG_LOGIC ("Packet from " << from << " received on node " << 
                 m_node->GetId ());
@@ -724,6 +726,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
                       Ptr<Ipv4Route> route)
 {
   NS_LOG_FUNCTION (this << packet << source << destination << uint32_t (protocol) << route);
+  NS_PROFILE_SCOPE ("ns3::Ipv4L3Protocol::Send");
 
   Ipv4Header ipHeader;
   bool mayFragment = true;
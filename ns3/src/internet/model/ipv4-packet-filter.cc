@@ -21,8 +21,14 @@
  *           Pasquale Imputato <p.imputato@gmail.com>
  */
 
+#include <algorithm>
+#include <sstream>
+
 #include "ns3/log.h"
 #include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
 #include "ns3/tcp-header.h"
 #include "ns3/udp-header.h"
 #include "ipv4-queue-disc-item.h"
@@ -147,4 +153,171 @@ FqCoDelIpv4PacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
   return hash;
 }
 
+// ------------------------------------------------------------------------- //
+
+NS_OBJECT_ENSURE_REGISTERED (PiasIpv4PacketFilter);
+
+TypeId
+PiasIpv4PacketFilter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PiasIpv4PacketFilter")
+    .SetParent<Ipv4PacketFilter> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<PiasIpv4PacketFilter> ()
+    .AddAttribute ("Thresholds",
+                   "The demotion thresholds in bytes, increasing, separated by commas or spaces",
+                   StringValue (""),
+                   MakeStringAccessor (&PiasIpv4PacketFilter::SetThresholdsString,
+                                       &PiasIpv4PacketFilter::GetThresholdsString),
+                   MakeStringChecker ())
+    .AddAttribute ("FlowTimeout",
+                   "The idle time after which a flow starts again at the highest priority",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&PiasIpv4PacketFilter::m_timeout),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+PiasIpv4PacketFilter::PiasIpv4PacketFilter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PiasIpv4PacketFilter::~PiasIpv4PacketFilter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PiasIpv4PacketFilter::SetThresholds (const std::vector<uint64_t> &thresholds)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_UNLESS (std::is_sorted (thresholds.begin (), thresholds.end ()),
+                       "PIAS thresholds must be increasing");
+  m_thresholds = thresholds;
+}
+
+const std::vector<uint64_t> &
+PiasIpv4PacketFilter::GetThresholds (void) const
+{
+  return m_thresholds;
+}
+
+void
+PiasIpv4PacketFilter::SetThresholdsString (std::string thresholds)
+{
+  std::replace (thresholds.begin (), thresholds.end (), ',', ' ');
+  std::istringstream iss (thresholds);
+  std::vector<uint64_t> values;
+  uint64_t value;
+  while (iss >> value)
+    {
+      values.push_back (value);
+    }
+  NS_ABORT_MSG_UNLESS (iss.eof (), "Invalid PIAS thresholds \"" << thresholds << "\"");
+  SetThresholds (values);
+}
+
+std::string
+PiasIpv4PacketFilter::GetThresholdsString (void) const
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < m_thresholds.size (); i++)
+    {
+      oss << (i ? "," : "") << m_thresholds[i];
+    }
+  return oss.str ();
+}
+
+uint32_t
+PiasIpv4PacketFilter::GetNFlows (void) const
+{
+  return m_flows.size ();
+}
+
+int32_t
+PiasIpv4PacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  NS_LOG_FUNCTION (this << item);
+  Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
+
+  NS_ASSERT (ipv4Item != 0);
+
+  Ipv4Header hdr = ipv4Item->GetHeader ();
+  uint8_t prot = hdr.GetProtocol ();
+  uint16_t srcPort = 0;
+  uint16_t destPort = 0;
+
+  Ptr<Packet> pkt = ipv4Item->GetPacket ();
+
+  if (prot == 6 && hdr.GetFragmentOffset () == 0) // TCP
+    {
+      TcpHeader tcpHdr;
+      pkt->PeekHeader (tcpHdr);
+      srcPort = tcpHdr.GetSourcePort ();
+      destPort = tcpHdr.GetDestinationPort ();
+    }
+  else if (prot == 17 && hdr.GetFragmentOffset () == 0) // UDP
+    {
+      UdpHeader udpHdr;
+      pkt->PeekHeader (udpHdr);
+      srcPort = udpHdr.GetSourcePort ();
+      destPort = udpHdr.GetDestinationPort ();
+    }
+
+  uint8_t buf[13];
+  hdr.GetSource ().Serialize (buf);
+  hdr.GetDestination ().Serialize (buf + 4);
+  buf[8] = prot;
+  buf[9] = (srcPort >> 8) & 0xff;
+  buf[10] = srcPort & 0xff;
+  buf[11] = (destPort >> 8) & 0xff;
+  buf[12] = destPort & 0xff;
+  uint64_t key = Hash64 ((char*) buf, 13);
+
+  Time now = Simulator::Now ();
+  std::unordered_map<uint64_t, Flow>::iterator it = m_flows.find (key);
+  if (it == m_flows.end ())
+    {
+      // forget the idle flows from time to time, as new flows come
+      if (now - m_lastPurge > m_timeout)
+        {
+          for (std::unordered_map<uint64_t, Flow>::iterator f = m_flows.begin (); f != m_flows.end (); )
+            {
+              if (now - f->second.last > m_timeout)
+                {
+                  f = m_flows.erase (f);
+                }
+              else
+                {
+                  ++f;
+                }
+            }
+          m_lastPurge = now;
+        }
+      Flow flow;
+      flow.bytes = 0;
+      it = m_flows.insert (std::make_pair (key, flow)).first;
+    }
+  else if (now - it->second.last > m_timeout)
+    {
+      it->second.bytes = 0;
+    }
+
+  uint32_t level = std::upper_bound (m_thresholds.begin (), m_thresholds.end (), it->second.bytes)
+    - m_thresholds.begin ();
+  it->second.bytes += pkt->GetSize ();
+  it->second.last = now;
+
+  ipv4Item->SetDscp (static_cast<Ipv4Header::DscpType> (level));
+  SocketPriorityTag priorityTag;
+  priorityTag.SetPriority (level);
+  pkt->ReplacePacketTag (priorityTag);
+
+  NS_LOG_DEBUG ("Flow " << key << " sent " << it->second.bytes << " bytes, level " << level);
+
+  return level;
+}
+
 } // namespace ns3
@@ -24,7 +24,11 @@
 #ifndef IPV4_PACKET_FILTER_H
 #define IPV4_PACKET_FILTER_H
 
+#include <vector>
+#include <unordered_map>
+
 #include "ns3/object.h"
+#include "ns3/nstime.h"
 #include "ns3/packet-filter.h"
 
 namespace ns3 {
@@ -76,6 +80,75 @@ private:
   uint32_t m_perturbation; //!< hash perturbation value
 };
 
+
+/**
+ * \ingroup internet
+ *
+ * PiasIpv4PacketFilter tags the packets of the hosts for PIAS-style
+ * scheduling, which approximates shortest-job-first without knowing the
+ * flow sizes: each flow, identified by its 5-tuple, starts at priority
+ * level 0 and is demoted by one level each time the bytes it has sent
+ * cross one of the Thresholds. The level is set as the SocketPriorityTag
+ * and as the DSCP of the packet, so that the StrictPriorityQueueDisc of
+ * the switches serves it with the same priority, and returned as the
+ * class of the packet, e.g. for a StrictPriorityQueueDisc at the host.
+ *
+ * A flow idle for FlowTimeout starts again at level 0. The thresholds
+ * can be derived from the flow size distribution with a
+ * PiasThresholdTuner.
+ */
+class PiasIpv4PacketFilter : public Ipv4PacketFilter {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PiasIpv4PacketFilter ();
+  virtual ~PiasIpv4PacketFilter ();
+
+  /**
+   * \param thresholds the demotion thresholds in bytes, increasing
+   */
+  void SetThresholds (const std::vector<uint64_t> &thresholds);
+
+  /**
+   * \return the demotion thresholds in bytes
+   */
+  const std::vector<uint64_t> & GetThresholds (void) const;
+
+  /**
+   * \return the number of flows tracked
+   */
+  uint32_t GetNFlows (void) const;
+
+private:
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+
+  /**
+   * \param thresholds the demotion thresholds in bytes, separated by
+   * commas or spaces
+   */
+  void SetThresholdsString (std::string thresholds);
+  /**
+   * \return the demotion thresholds in bytes, separated by commas
+   */
+  std::string GetThresholdsString (void) const;
+
+  /// the state of a flow
+  struct Flow
+  {
+    uint64_t bytes;   //!< bytes sent
+    Time last;        //!< time of the last packet
+  };
+
+  std::vector<uint64_t> m_thresholds;  //!< demotion thresholds
+  Time m_timeout;                      //!< idle time resetting a flow
+  mutable std::unordered_map<uint64_t, Flow> m_flows; //!< flows by hash of their 5-tuple
+  mutable Time m_lastPurge;            //!< last removal of the idle flows
+};
+
 } // namespace ns3
 
 #endif /* IPV4_PACKET_FILTER */
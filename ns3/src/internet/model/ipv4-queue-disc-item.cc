@@ -92,6 +92,18 @@ Ipv4QueueDiscItem::Mark (void)
   return false;
 }
 
+bool
+Ipv4QueueDiscItem::SetDscp (Ipv4Header::DscpType dscp)
+{
+  NS_LOG_FUNCTION (this << dscp);
+  if (m_headerAdded)
+    {
+      return false;
+    }
+  m_header.SetDscp (dscp);
+  return true;
+}
+
 
 bool
 Ipv4QueueDiscItem::GetUint8Value (QueueItem::Uint8Values field, uint8_t& value) const
@@ -85,6 +85,13 @@ public:
    */
   virtual bool Mark (void);
 
+  /**
+   * \brief Set the DSCP of the packet, while its header is not added yet
+   * \param dscp the DSCP
+   * \return true if the DSCP is set, false otherwise
+   */
+  bool SetDscp (Ipv4Header::DscpType dscp);
+
 private:
   /**
    * \brief Default constructor
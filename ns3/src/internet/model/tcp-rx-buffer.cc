@@ -21,6 +21,7 @@
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 #include "tcp-rx-buffer.h"
 
 namespace ns3 {
@@ -36,6 +37,12 @@ TcpRxBuffer::GetTypeId (void)
     .SetParent<Object> ()
     .SetGroupName ("Internet")
     .AddConstructor<TcpRxBuffer> ()
+    .AddAttribute ("VirtualPayload",
+                   "Only count the received bytes instead of storing the packets; "
+                   "the data handed to the application is zero-filled",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpRxBuffer::m_virtualPayload),
+                   MakeBooleanChecker ())
     .AddTraceSource ("NextRxSequence",
                      "Next sequence number expected (RCV.NXT)",
                      MakeTraceSourceAccessor (&TcpRxBuffer::m_nextRxSeq),
@@ -52,7 +59,8 @@ TcpRxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpRxBuffer::TcpRxBuffer (uint32_t n)
-  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0)
+  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0),
+    m_virtualPayload (false), m_readSeq (n)
 {
 }
 
@@ -70,6 +78,7 @@ void
 TcpRxBuffer::SetNextRxSequence (const SequenceNumber32& s)
 {
   m_nextRxSeq = s;
+  m_readSeq = s;
 }
 
 uint32_t
@@ -104,6 +113,32 @@ TcpRxBuffer::IncNextRxSequence ()
   // this is supposed to be called only during the three-way handshake
   NS_ASSERT (m_size == 0);
   m_nextRxSeq++;
+  m_readSeq = m_nextRxSeq;
+}
+
+bool
+TcpRxBuffer::GetHeadSequence (SequenceNumber32 &head) const
+{
+  if (!m_virtualPayload)
+    {
+      if (m_data.empty ())
+        {
+          return false;
+        }
+      head = m_data.begin ()->first;
+      return true;
+    }
+  if (m_availBytes > 0)
+    {
+      head = m_readSeq;
+      return true;
+    }
+  if (!m_ranges.empty ())
+    {
+      head = m_ranges.begin ()->first;
+      return true;
+    }
+  return false;
 }
 
 // Return the lowest sequence number that this TcpRxBuffer cannot accept
@@ -114,9 +149,10 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
-  else if (m_data.size ())
+  SequenceNumber32 head;
+  if (GetHeadSequence (head))
     { // No data allowed beyond Rx window allowed
-      return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      return head + SequenceNumber32 (m_maxBuffer);
     }
   return m_nextRxSeq + SequenceNumber32 (m_maxBuffer);
 }
@@ -150,14 +186,24 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 
   // Trim packet to fit Rx window specification
   if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
-  if (m_data.size ())
+  SequenceNumber32 bufHead;
+  if (GetHeadSequence (bufHead))
     {
-      SequenceNumber32 maxSeq = m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      SequenceNumber32 maxSeq = bufHead + SequenceNumber32 (m_maxBuffer);
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  if (m_virtualPayload)
+    {
+      return AddRange (headSeq, tailSeq);
+    }
+  // Remove overlapped bytes from packet, starting from the last packet
+  // beginning at or before headSeq
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -199,7 +245,7 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  for (BufIterator i = m_data.lower_bound (m_nextRxSeq); i != m_data.end (); ++i)
     {
       if (i->first < m_nextRxSeq)
         {
@@ -220,6 +266,63 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   return true;
 }
 
+bool
+TcpRxBuffer::AddRange (SequenceNumber32 headSeq, SequenceNumber32 tailSeq)
+{
+  NS_LOG_FUNCTION (this << headSeq << tailSeq);
+
+  if (headSeq >= tailSeq)
+    {
+      NS_LOG_LOGIC ("Nothing to buffer");
+      return false;
+    }
+  // Merge with the ranges overlapping or adjacent to [headSeq, tailSeq)
+  SequenceNumber32 start = headSeq;
+  SequenceNumber32 end = tailSeq;
+  uint32_t held = 0;
+  RangeIterator i = m_ranges.upper_bound (headSeq);
+  if (i != m_ranges.begin ())
+    {
+      RangeIterator prev = i;
+      --prev;
+      if (prev->second >= headSeq)
+        {
+          i = prev;
+        }
+    }
+  while (i != m_ranges.end () && i->first <= end)
+    {
+      held += i->second - i->first;
+      if (i->first < start) start = i->first;
+      if (i->second > end) end = i->second;
+      m_ranges.erase (i++);
+    }
+  m_ranges[start] = end;
+  uint32_t added = (end - start) - held;
+  if (added == 0)
+    {
+      NS_LOG_LOGIC ("Nothing to buffer");
+      return false;
+    }
+  m_size += added;
+  NS_LOG_LOGIC ("Buffered range [" << start << ":" << end << "), " << added << " new bytes");
+
+  // Ranges are disjoint and never adjacent, only the first one may start at nextRxSeq
+  i = m_ranges.begin ();
+  if (i->first == m_nextRxSeq)
+    {
+      m_availBytes += i->second - i->first;
+      m_nextRxSeq = i->second;
+      m_ranges.erase (i);
+    }
+  NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
+  if (m_gotFin && m_nextRxSeq == m_finSeq)
+    { // Account for the FIN packet
+      ++m_nextRxSeq;
+    };
+  return true;
+}
+
 Ptr<Packet>
 TcpRxBuffer::Extract (uint32_t maxSize)
 {
@@ -228,6 +331,13 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   uint32_t extractSize = std::min (maxSize, m_availBytes);
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return 0;  // No contiguous block to return
+  if (m_virtualPayload)
+    {
+      m_size -= extractSize;
+      m_availBytes -= extractSize;
+      m_readSeq = m_readSeq + SequenceNumber32 (extractSize);
+      return Create<Packet> (extractSize);
+    }
   NS_ASSERT (m_data.size ()); // At least we have something to extract
   Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
   BufIterator i;
@@ -36,6 +36,12 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * When the VirtualPayload attribute is set, the buffer does not keep the
+ * packets: it only counts in-sequence bytes and records the out-of-order
+ * data as a set of disjoint sequence ranges.  This is suitable when the
+ * applications only look at the amount of data received, as is the case
+ * for simulated payloads created with Create<Packet> (size).
  */
 class TcpRxBuffer : public Object
 {
@@ -119,6 +125,8 @@ public:
   /**
    * Extract data from the head of the buffer as indicated by nextRxSeq.
    * The extracted data is going to be forwarded to the application.
+   * In VirtualPayload mode, the returned packet carries zero-filled data
+   * of the right size.
    *
    * \param maxSize maximum number of bytes to extract
    * \returns a packet
@@ -126,8 +134,30 @@ public:
   Ptr<Packet> Extract (uint32_t maxSize);
 
 private:
+  /**
+   * \brief Get the first byte held in the buffer
+   *
+   * This is the first byte not yet extracted if there is any in-sequence
+   * data, otherwise the first out-of-order byte.
+   *
+   * \param head the first buffered byte
+   * \returns false if the buffer is empty
+   */
+  bool GetHeadSequence (SequenceNumber32 &head) const;
+
+  /**
+   * \brief Insert a byte range in the out-of-order intervals (VirtualPayload mode)
+   *
+   * \param headSeq first byte of the range
+   * \param tailSeq byte following the range
+   * \returns True when new bytes were buffered, false otherwise.
+   */
+  bool AddRange (SequenceNumber32 headSeq, SequenceNumber32 tailSeq);
+
   /// container for data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  /// container for out-of-order byte ranges, mapping the first byte to the byte following the range
+  typedef std::map<SequenceNumber32, SequenceNumber32>::iterator RangeIterator;
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
@@ -135,6 +165,9 @@ private:
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
   std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  bool m_virtualPayload;                     //!< Keep byte counts only, the data is not stored
+  SequenceNumber32 m_readSeq;                //!< Seqnum of the first byte not extracted yet (VirtualPayload mode)
+  std::map<SequenceNumber32, SequenceNumber32> m_ranges; //!< Disjoint out-of-order ranges (VirtualPayload mode)
 };
 
 } //namepsace ns3
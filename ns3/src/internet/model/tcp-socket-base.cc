@@ -23,6 +23,7 @@
   if (m_node) { std::clog << " [node " << m_node->GetId () << "] "; }
 
 #include "ns3/abort.h"
+#include "ns3/profiler.h"
 #include "ns3/node.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/inet6-socket-address.h"
@@ -133,6 +134,35 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("AdaptiveReordering",
+                   "Raise the fast retransmit threshold above the reordering "
+                   "measured on the connection",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_adaptiveReordering),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxReordering",
+                   "Highest fast retransmit threshold reached by AdaptiveReordering",
+                   UintegerValue (300),
+                   MakeUintegerAccessor (&TcpSocketBase::m_maxReordering),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("UndoSpuriousRecovery",
+                   "Detect the spurious fast retransmits with the timestamps "
+                   "and restore the window they reduced",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_undoSpurious),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TimestampResolution",
+                   "Unit of the Timestamp option values; the RTT of a data center "
+                   "needs a finer one than the default",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&TcpSocketBase::m_tsResolution),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("AckCoalescing",
+                   "Coalesce the in-sequence segments received at the same time "
+                   "into a single delayed ACK decision, as GRO does",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_ackCoalescing),
+                   MakeBooleanChecker ())
     .AddAttribute ("UseEcn", "True to use ECN functionality",
                    BooleanValue (false),
                    MakeBooleanAccessor (&TcpSocketBase::m_ecn),
@@ -201,6 +231,10 @@ TcpSocketBase::GetTypeId (void)
                      "Sequence of last received ECN Echo",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_ecnEchoSeq),
                      "ns3::SequenceNumber32TracedValueCallback")
+    .AddTraceSource ("Reordering",
+                     "Fast retransmit threshold learnt from the reordering",
+                     MakeTraceSourceAccessor (&TcpSocketBase::m_reordering),
+                     "ns3::TracedValueCallback::Uint32")
   ;
   return tid;
 }
@@ -288,6 +322,9 @@ TcpSocketBase::TcpSocketBase (void)
     m_dupAckCount (0),
     m_delAckCount (0),
     m_delAckMaxCount (0),
+    m_ackCoalescing (false),
+    m_coalescedCount (0),
+    m_coalescedCe (false),
     m_noDelay (false),
     m_synCount (0),
     m_synRetries (0),
@@ -327,12 +364,21 @@ TcpSocketBase::TcpSocketBase (void)
     m_sndWindShift (0),
     m_timestampEnabled (true),
     m_timestampToEcho (0),
+    m_tsResolution (MilliSeconds (1)),
     m_sendPendingDataEvent (),
     // Set m_recover to the initial sequence number
     m_recover (0),
     m_retxThresh (3),
     m_limitedTx (false),
     m_retransOut (0),
+    m_adaptiveReordering (false),
+    m_maxReordering (300),
+    m_reordering (0),
+    m_undoSpurious (false),
+    m_undoPending (false),
+    m_retxTsValue (0),
+    m_priorCwnd (0),
+    m_priorSsThresh (0),
     m_congestionControl (0),
     m_isFirstPartialAck (true),
     m_ecn (false),
@@ -374,6 +420,9 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_dupAckCount (sock.m_dupAckCount),
     m_delAckCount (0),
     m_delAckMaxCount (sock.m_delAckMaxCount),
+    m_ackCoalescing (sock.m_ackCoalescing),
+    m_coalescedCount (0),
+    m_coalescedCe (false),
     m_noDelay (sock.m_noDelay),
     m_synCount (sock.m_synCount),
     m_synRetries (sock.m_synRetries),
@@ -409,17 +458,27 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_sndWindShift (sock.m_sndWindShift),
     m_timestampEnabled (sock.m_timestampEnabled),
     m_timestampToEcho (sock.m_timestampToEcho),
+    m_tsResolution (sock.m_tsResolution),
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
     m_retransOut (sock.m_retransOut),
+    m_adaptiveReordering (sock.m_adaptiveReordering),
+    m_maxReordering (sock.m_maxReordering),
+    m_reordering (sock.m_reordering),
+    m_undoSpurious (sock.m_undoSpurious),
+    m_undoPending (false),
+    m_retxTsValue (0),
+    m_priorCwnd (0),
+    m_priorSsThresh (0),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
     m_ecn (sock.m_ecn),
     m_ecnState (sock.m_ecnState),
     m_ecnEchoSeq (sock.m_ecnEchoSeq),
-    m_ceReceived (sock.m_ceReceived)
+    m_ceReceived (sock.m_ceReceived),
+    m_cWndMax (sock.m_cWndMax)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Invoked the copy constructor");
@@ -1238,6 +1297,7 @@ void
 TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
                             const Address &toAddress)
 {
+  NS_PROFILE_SCOPE ("ns3::TcpSocketBase::DoForwardUp");
   // in case the packet still has a priority tag attached, remove it
   SocketPriorityTag priorityTag;
   packet->RemovePacketTag (priorityTag);
@@ -1252,6 +1312,14 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
       return; // Discard invalid packet
     }
 
+  if (m_coalescedCount > 0 && m_ceReceived != m_coalescedCe)
+    {
+      // Never coalesce across a CE transition: acknowledge the batch with
+      // the ECN Echo state it was received with
+      m_coalesceEvent.Cancel ();
+      FlushCoalescedAck ();
+    }
+  m_coalescedCe = m_ceReceived;
   if (m_ecnState & ECN_CONN)
     {
       UpdateEcnState (tcpHeader);
@@ -1526,6 +1594,12 @@ TcpSocketBase::FastRetransmit ()
   m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_RECOVERY);
   m_tcb->m_congState = TcpSocketState::CA_RECOVERY;
 
+  // the retransmission below carries this timestamp
+  m_undoPending = m_undoSpurious && m_timestampEnabled;
+  m_retxTsValue = NowToTsValue ();
+  m_priorCwnd = m_tcb->m_cWnd;
+  m_priorSsThresh = m_tcb->m_ssThresh;
+
   m_tcb->m_ssThresh = GetSsThresh ();
   m_tcb->m_cWnd = m_tcb->m_ssThresh + m_dupAckCount * m_tcb->m_segmentSize;
 
@@ -1556,7 +1630,7 @@ TcpSocketBase::DupAck ()
   if (m_tcb->m_congState == TcpSocketState::CA_DISORDER)
     {
       //std::cout << "first 3 dupack!!!!" << std::endl;
-      if ((m_dupAckCount == m_retxThresh) && (m_highRxAckMark >= m_recover))
+      if ((m_dupAckCount == GetDupAckThreshold ()) && (m_highRxAckMark >= m_recover))
         {
           // triple duplicate ack triggers fast retransmit (RFC2582 sec.3 bullet #1)
           NS_LOG_DEBUG (TcpSocketState::TcpCongStateName[m_tcb->m_congState] <<
@@ -1581,6 +1655,56 @@ TcpSocketBase::DupAck ()
   m_congestionControl->PktsAcked (m_tcb, 1, m_lastRtt);
 }
 
+uint32_t
+TcpSocketBase::GetDupAckThreshold (void) const
+{
+  if (m_adaptiveReordering)
+    {
+      return std::max (m_retxThresh, m_reordering.Get ());
+    }
+  return m_retxThresh;
+}
+
+void
+TcpSocketBase::UpdateReordering (uint32_t degree)
+{
+  NS_LOG_FUNCTION (this << degree);
+  if (m_adaptiveReordering && degree >= m_reordering)
+    {
+      // a threshold of degree dupacks would have been one too few
+      m_reordering = std::min (degree + 1, m_maxReordering);
+      NS_LOG_INFO ("Reordering of " << degree << " segments, dupack threshold " <<
+                   GetDupAckThreshold ());
+    }
+}
+
+bool
+TcpSocketBase::IsSpuriousRecovery (const TcpHeader &tcpHeader) const
+{
+  if (!tcpHeader.HasOption (TcpOption::TS))
+    {
+      return false;
+    }
+  Ptr<const TcpOptionTS> ts = DynamicCast<const TcpOptionTS> (tcpHeader.GetOption (TcpOption::TS));
+  // serial number comparison, the timestamps wrap
+  return (int32_t) (ts->GetEcho () - m_retxTsValue) < 0;
+}
+
+void
+TcpSocketBase::UndoRecovery (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("Spurious fast retransmit, restore cwnd " << m_priorCwnd <<
+               " and ssthresh " << m_priorSsThresh);
+  m_tcb->m_cWnd = std::max (m_tcb->m_cWnd.Get (), m_priorCwnd);
+  m_tcb->m_ssThresh = std::max (m_tcb->m_ssThresh.Get (), m_priorSsThresh);
+  m_isFirstPartialAck = true;
+  // the ACK is then processed as the end of a reordering
+  m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_DISORDER);
+  m_tcb->m_congState = TcpSocketState::CA_DISORDER;
+  NS_LOG_DEBUG ("RECOVERY -> DISORDER");
+}
+
 /* Process the newly received ACK */
 void
 TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
@@ -1640,6 +1764,16 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
             }
         }
 
+      if (m_undoPending && m_tcb->m_congState == TcpSocketState::CA_RECOVERY)
+        {
+          // first ACK of the retransmitted segment
+          m_undoPending = false;
+          if (IsSpuriousRecovery (tcpHeader))
+            {
+              UndoRecovery ();
+            }
+        }
+
       /* The following switch is made because m_dupAckCount can be
        * "inflated" through out-of-order segments (e.g. from retransmission,
        * while segments have not been lost but are network-reordered). At
@@ -1669,6 +1803,7 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
         {
           // The network reorder packets. Linux changes the counting lost
           // packet algorithm from FACK to NewReno. We simply go back in Open.
+          UpdateReordering (m_dupAckCount);
           m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
           m_tcb->m_congState = TcpSocketState::CA_OPEN;
           m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt);
@@ -2451,6 +2586,8 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     { // If sending an ACK, cancel the delay ACK as well
       m_delAckEvent.Cancel ();
       m_delAckCount = 0;
+      m_coalesceEvent.Cancel ();
+      m_coalescedCount = 0;
       if (m_highTxAck < header.GetAckNumber ())
         {
           m_highTxAck = header.GetAckNumber ();
@@ -2644,6 +2781,8 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
     {
       m_delAckEvent.Cancel ();
       m_delAckCount = 0;
+      m_coalesceEvent.Cancel ();
+      m_coalescedCount = 0;
     }
 
   if (m_ecnState & ECN_SEND_CWR)
@@ -3001,6 +3140,13 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     { // A gap exists in the buffer, or we filled a gap: Always ACK
       SendACK ();
     }
+  else if (m_ackCoalescing && m_delAckCount < m_delAckMaxCount)
+    { // In-sequence packet: decide once all the segments received now are in
+      if (m_coalescedCount++ == 0)
+        {
+          m_coalesceEvent = Simulator::ScheduleNow (&TcpSocketBase::FlushCoalescedAck, this);
+        }
+    }
   else
     { // In-sequence packet: ACK if delayed ack count allows
       if (++m_delAckCount >= m_delAckMaxCount)
@@ -3073,7 +3219,7 @@ TcpSocketBase::EstimateRtt (const TcpHeader& tcpHeader)
             {
               Ptr<TcpOptionTS> ts;
               ts = DynamicCast<TcpOptionTS> (tcpHeader.GetOption (TcpOption::TS));
-              m = TcpOptionTS::ElapsedTimeFromTsValue (ts->GetEcho ());
+              m = ElapsedTimeFromTsValue (ts->GetEcho ());
             }
           else
             {
@@ -3175,6 +3321,25 @@ TcpSocketBase::DelAckTimeout (void)
   SendACK ();
 }
 
+void
+TcpSocketBase::FlushCoalescedAck (void)
+{
+  NS_LOG_FUNCTION (this << m_coalescedCount);
+  m_delAckCount += m_coalescedCount;
+  m_coalescedCount = 0;
+  if (m_delAckCount >= m_delAckMaxCount)
+    {
+      m_delAckEvent.Cancel ();
+      m_delAckCount = 0;
+      SendACK ();
+    }
+  else if (m_delAckEvent.IsExpired ())
+    {
+      m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
+                                           &TcpSocketBase::DelAckTimeout, this);
+    }
+}
+
 void
 TcpSocketBase::LastAckTimeout (void)
 {
@@ -3300,6 +3465,9 @@ TcpSocketBase::Retransmit ()
 
   m_tcb->m_nextTxSequence = m_txBuffer->HeadSequence (); // Restart from highest Ack
   m_dupAckCount = 0;
+  // a real loss: forget the reordering, it may have hidden the dupacks
+  m_undoPending = false;
+  m_reordering = 0;
 
   NS_LOG_LOGIC ("RTO. Reset cwnd to " <<  m_tcb->m_cWnd << ", ssthresh to " <<
                 m_tcb->m_ssThresh << ", restart from seqnum " << m_tcb->m_nextTxSequence);
@@ -3371,6 +3539,8 @@ TcpSocketBase::CancelAllTimers ()
   m_retxEvent.Cancel ();
   m_persistEvent.Cancel ();
   m_delAckEvent.Cancel ();
+  m_coalesceEvent.Cancel ();
+  m_coalescedCount = 0;
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
@@ -3647,7 +3817,7 @@ TcpSocketBase::AddOptionTimestamp (TcpHeader& header)
 
   Ptr<TcpOptionTS> option = CreateObject<TcpOptionTS> ();
 
-  option->SetTimestamp (TcpOptionTS::NowToTsValue ());
+  option->SetTimestamp (NowToTsValue ());
   option->SetEcho (m_timestampToEcho);
 
   header.AppendOption (option);
@@ -3655,6 +3825,23 @@ TcpSocketBase::AddOptionTimestamp (TcpHeader& header)
                option->GetTimestamp () << " echo=" << m_timestampToEcho);
 }
 
+uint32_t
+TcpSocketBase::NowToTsValue (void) const
+{
+  return (uint32_t) (Simulator::Now ().GetTimeStep () / m_tsResolution.GetTimeStep ());
+}
+
+Time
+TcpSocketBase::ElapsedTimeFromTsValue (uint32_t echoTime) const
+{
+  uint32_t now = NowToTsValue ();
+  if (now > echoTime)
+    {
+      return TimeStep ((uint64_t) (now - echoTime) * m_tsResolution.GetTimeStep ());
+    }
+  return Seconds (0.0);
+}
+
 void TcpSocketBase::UpdateWindowSize (const TcpHeader &header)
 {
   NS_LOG_FUNCTION (this << header);
@@ -875,6 +875,38 @@ protected:
    */
   void FastRetransmit ();
 
+  /**
+   * \return the number of dupacks which triggers a fast retransmit
+   *
+   * ReTxThreshold, raised to the measured reordering when
+   * AdaptiveReordering is enabled.
+   */
+  uint32_t GetDupAckThreshold (void) const;
+
+  /**
+   * \brief Record a reordering measure
+   * \param degree the number of segments received before a delayed one
+   */
+  void UpdateReordering (uint32_t degree);
+
+  /**
+   * \brief Check whether the last fast retransmit was spurious
+   *
+   * Eifel detection (RFC 3522): the first ACK covering the retransmitted
+   * segment echoes a timestamp older than the retransmission, so it has
+   * been triggered by the original segment.
+   *
+   * \param tcpHeader the first new ACK received in recovery
+   * \return true if the fast retransmit was spurious
+   */
+  bool IsSpuriousRecovery (const TcpHeader &tcpHeader) const;
+
+  /**
+   * \brief Restore the window before the last fast retransmit and leave
+   * the recovery as after a reordering
+   */
+  void UndoRecovery (void);
+
   /**
    * \brief Call Retransmit() upon RTO event
    */
@@ -890,6 +922,12 @@ protected:
    */
   virtual void DelAckTimeout (void);
 
+  /**
+   * \brief Take the delayed ACK decision for the in-sequence segments
+   * coalesced since the last ACK (AckCoalescing mode)
+   */
+  void FlushCoalescedAck (void);
+
   /**
    * \brief Timeout at LAST_ACK, close the connection
    */
@@ -964,6 +1002,18 @@ protected:
    */
   void AddOptionTimestamp (TcpHeader& header);
 
+  /**
+   * \return the current time in units of TimestampResolution, wrapping
+   * at 2^32
+   */
+  uint32_t NowToTsValue (void) const;
+
+  /**
+   * \param echoTime a timestamp echoed by the peer
+   * \return the time elapsed since echoTime was sent, 0 if it is not in the past
+   */
+  Time ElapsedTimeFromTsValue (uint32_t echoTime) const;
+
   /**
    * @brief Send Ack packet; add ecn mark if needed
    */
@@ -1015,6 +1065,10 @@ protected:
   uint32_t          m_dupAckCount;     //!< Dupack counter
   uint32_t          m_delAckCount;     //!< Delayed ACK counter
   uint32_t          m_delAckMaxCount;  //!< Number of packet to fire an ACK before delay timeout
+  bool              m_ackCoalescing;   //!< Take one ACK decision for back-to-back segments received at the same time
+  EventId           m_coalesceEvent;   //!< End of the current batch of coalesced segments
+  uint32_t          m_coalescedCount;  //!< Number of in-sequence segments in the current batch
+  bool              m_coalescedCe;     //!< CE mark of the segments in the current batch
   bool              m_noDelay;         //!< Set to true to disable Nagle's algorithm
   uint32_t          m_synCount;        //!< Count of remaining connection retries
   uint32_t          m_synRetries;      //!< Number of connection attempts
@@ -1069,6 +1123,7 @@ protected:
 
   bool     m_timestampEnabled;    //!< Timestamp option enabled
   uint32_t m_timestampToEcho;     //!< Timestamp to echo
+  Time     m_tsResolution;        //!< Unit of the timestamps sent
 
   EventId m_sendPendingDataEvent; //!< micro-delay event to send pending data
 
@@ -1078,6 +1133,16 @@ protected:
   bool                   m_limitedTx;    //!< perform limited transmit
   uint32_t               m_retransOut;   //!< Number of retransmission in this window
 
+  // Reordering
+  bool                   m_adaptiveReordering; //!< Raise the dupack threshold to the reordering
+  uint32_t               m_maxReordering;      //!< Highest dupack threshold
+  TracedValue<uint32_t>  m_reordering;         //!< Dupack threshold learnt from the reordering
+  bool                   m_undoSpurious;       //!< Undo the spurious fast retransmits
+  bool                   m_undoPending;        //!< The last fast retransmit is not checked yet
+  uint32_t               m_retxTsValue;        //!< Timestamp of the last fast retransmit
+  uint32_t               m_priorCwnd;          //!< cWnd before the last fast retransmit
+  uint32_t               m_priorSsThresh;      //!< ssThresh before the last fast retransmit
+
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control informations
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
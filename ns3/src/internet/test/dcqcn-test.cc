@@ -0,0 +1,261 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <algorithm>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/data-rate.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/dcqcn-reaction-point.h"
+#include "ns3/dcqcn-notification-point.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief FIFO queue disc setting CE on the ECN capable packets while enabled
+ */
+class DcqcnTestMarkingQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  DcqcnTestMarkingQueueDisc () : m_mark (false) {}
+
+  /// \param mark whether to mark the packets
+  void SetMark (bool mark)
+  {
+    m_mark = mark;
+  }
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item)
+  {
+    if (m_mark)
+      {
+        item->Mark ();
+      }
+    return GetInternalQueue (0)->Enqueue (item);
+  }
+  virtual Ptr<QueueDiscItem> DoDequeue (void)
+  {
+    return StaticCast<QueueDiscItem> (GetInternalQueue (0)->Dequeue ());
+  }
+  virtual Ptr<const QueueDiscItem> DoPeek (void) const
+  {
+    return StaticCast<const QueueDiscItem> (GetInternalQueue (0)->Peek ());
+  }
+  virtual bool CheckConfig (void)
+  {
+    if (GetNInternalQueues () == 0)
+      {
+        AddInternalQueue (CreateObject<DropTailQueue> ());
+      }
+    return true;
+  }
+  virtual void InitializeParams (void)
+  {
+  }
+
+  bool m_mark; //!< whether to mark the packets
+};
+
+NS_OBJECT_ENSURE_REGISTERED (DcqcnTestMarkingQueueDisc);
+
+TypeId
+DcqcnTestMarkingQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DcqcnTestMarkingQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<DcqcnTestMarkingQueueDisc> ()
+  ;
+  return tid;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief two nodes on a 1 Gb/s link, the egress of the sender marking
+ * the packets on demand
+ */
+struct DcqcnTestTopology
+{
+  DcqcnTestTopology ()
+  {
+    nodes.Create (2);
+    SimpleNetDeviceHelper simple;
+    simple.SetNetDevicePointToPointMode (true);
+    simple.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+    NetDeviceContainer devices = simple.Install (nodes);
+    InternetStackHelper internet;
+    internet.Install (nodes);
+    TrafficControlHelper tch;
+    tch.SetRootQueueDisc ("ns3::DcqcnTestMarkingQueueDisc");
+    marker = DynamicCast<DcqcnTestMarkingQueueDisc> (tch.Install (devices.Get (0)).Get (0));
+    Ipv4AddressHelper address;
+    address.SetBase ("10.0.0.0", "255.255.255.0");
+    remote = InetSocketAddress (address.Assign (devices).GetAddress (1), 4791);
+  }
+
+  NodeContainer nodes;                        //!< sender and receiver
+  Ptr<DcqcnTestMarkingQueueDisc> marker;      //!< egress of the sender
+  Address remote;                             //!< the notification point
+};
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief The reaction point cuts its rate on CNP and recovers afterwards
+ */
+class DcqcnReactionTestCase : public TestCase
+{
+public:
+  DcqcnReactionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief record the lowest rate
+   * \param oldValue the previous rate
+   * \param newValue the new rate
+   */
+  void Rate (uint64_t oldValue, uint64_t newValue);
+
+  uint64_t m_minRate; //!< lowest rate seen
+};
+
+DcqcnReactionTestCase::DcqcnReactionTestCase ()
+  : TestCase ("DCQCN cuts the rate on CE and recovers"),
+    m_minRate (0)
+{
+}
+
+void
+DcqcnReactionTestCase::Rate (uint64_t oldValue, uint64_t newValue)
+{
+  m_minRate = std::min (m_minRate, newValue);
+}
+
+void
+DcqcnReactionTestCase::DoRun (void)
+{
+  DcqcnTestTopology topology;
+  Ptr<DcqcnNotificationPoint> np = CreateObject<DcqcnNotificationPoint> ();
+  np->Setup (topology.nodes.Get (1));
+  Ptr<DcqcnReactionPoint> rp = CreateObject<DcqcnReactionPoint> ();
+  rp->SetAttribute ("LineRate", StringValue ("1Gbps"));
+  rp->Setup (topology.nodes.Get (0), topology.remote);
+  m_minRate = rp->GetRate ().GetBitRate ();
+  rp->TraceConnectWithoutContext ("Rate", MakeCallback (&DcqcnReactionTestCase::Rate, this));
+
+  rp->Send (5000000);
+  Simulator::Schedule (MilliSeconds (1), &DcqcnTestMarkingQueueDisc::SetMark, topology.marker, true);
+  Simulator::Schedule (MilliSeconds (2), &DcqcnTestMarkingQueueDisc::SetMark, topology.marker, false);
+  Simulator::Stop (MilliSeconds (20));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_GT (np->GetNMarked (), np->GetNCnp (), "CNP not rate limited");
+  NS_TEST_EXPECT_MSG_GT (np->GetNCnp (), 0, "no CNP sent");
+  // one CNP per 50 us over 1 ms, plus the marked packets in flight
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (np->GetNCnp (), 21, "too many CNP");
+  NS_TEST_EXPECT_MSG_EQ (rp->GetNCnp (), np->GetNCnp (), "CNP lost");
+  NS_TEST_EXPECT_MSG_LT (m_minRate, 500000000, "rate not cut");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (rp->GetRate ().GetBitRate (), 950000000, "rate not recovered");
+  NS_TEST_EXPECT_MSG_LT (rp->GetAlpha (), 1.0, "alpha did not decay");
+  NS_TEST_EXPECT_MSG_EQ (np->GetReceivedBytes (), rp->GetSentBytes (), "bytes lost");
+  NS_TEST_EXPECT_MSG_EQ (rp->GetSentBytes () + rp->GetPendingBytes (), 5000000, "bytes not accounted");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief The timers of the flows of a host run from a single event
+ */
+class DcqcnSchedulerTestCase : public TestCase
+{
+public:
+  /**
+   * \param flows number of flows of the host
+   */
+  DcqcnSchedulerTestCase (uint32_t flows);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_flows; //!< number of flows of the host
+};
+
+DcqcnSchedulerTestCase::DcqcnSchedulerTestCase (uint32_t flows)
+  : TestCase ("DCQCN timers are batched per host, " + std::to_string (flows) + " flows"),
+    m_flows (flows)
+{
+}
+
+void
+DcqcnSchedulerTestCase::DoRun (void)
+{
+  DcqcnTestTopology topology;
+  Ptr<DcqcnNotificationPoint> np = CreateObject<DcqcnNotificationPoint> ();
+  np->Setup (topology.nodes.Get (1));
+  std::vector<Ptr<DcqcnReactionPoint> > rps;
+  for (uint32_t i = 0; i < m_flows; i++)
+    {
+      Ptr<DcqcnReactionPoint> rp = CreateObject<DcqcnReactionPoint> ();
+      rp->SetAttribute ("LineRate", DataRateValue (DataRate (500000000 / m_flows)));
+      rp->Setup (topology.nodes.Get (0), topology.remote);
+      rp->Send (1000000);
+      rps.push_back (rp);
+    }
+  topology.marker->SetMark (true);
+  Simulator::Stop (MicroSeconds (1120));
+  Simulator::Run ();
+
+  Ptr<DcqcnScheduler> scheduler = DcqcnScheduler::GetScheduler (topology.nodes.Get (0));
+  NS_TEST_EXPECT_MSG_EQ (scheduler->GetNTicks (), 20, "one tick per 55 us expected");
+  for (uint32_t i = 0; i < m_flows; i++)
+    {
+      NS_TEST_EXPECT_MSG_GT (rps[i]->GetNCnp (), 0, "flow without CNP");
+      NS_TEST_EXPECT_MSG_GT (rps[i]->GetSentBytes (), 0, "flow not started");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief DCQCN TestSuite
+ */
+class DcqcnTestSuite : public TestSuite
+{
+public:
+  DcqcnTestSuite () : TestSuite ("dcqcn", UNIT)
+  {
+    AddTestCase (new DcqcnReactionTestCase, TestCase::QUICK);
+    AddTestCase (new DcqcnSchedulerTestCase (1), TestCase::QUICK);
+    AddTestCase (new DcqcnSchedulerTestCase (16), TestCase::QUICK);
+  }
+};
+
+static DcqcnTestSuite g_dcqcnTestSuite; //!< Static variable for test initialization
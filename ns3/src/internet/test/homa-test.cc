@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <algorithm>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/error-model.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket.h"
+#include "ns3/homa-l4-protocol.h"
+#include "ns3/homa-socket-factory.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief two nodes running Homa on a 1 Gb/s link, the receiver
+ * listening on port 9
+ */
+struct HomaTestTopology
+{
+  HomaTestTopology ()
+  {
+    nodes.Create (2);
+    SimpleNetDeviceHelper simple;
+    simple.SetNetDevicePointToPointMode (true);
+    simple.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+    devices = simple.Install (nodes);
+    InternetStackHelper internet;
+    internet.Install (nodes);
+    // the sender queues whole bursts of unscheduled data
+    TrafficControlHelper tch;
+    tch.SetRootQueueDisc ("ns3::StrictPriorityQueueDisc",
+                          "Bands", UintegerValue (8),
+                          "Limit", UintegerValue (100000));
+    tch.Install (devices);
+    Ipv4AddressHelper address;
+    address.SetBase ("10.0.0.0", "255.255.255.0");
+    remote = InetSocketAddress (address.Assign (devices).GetAddress (1), 9);
+    for (uint32_t i = 0; i < 2; i++)
+      {
+        Ptr<HomaL4Protocol> homa = CreateObject<HomaL4Protocol> ();
+        homa->SetAttribute ("LinkRate", StringValue ("1Gbps"));
+        nodes.Get (i)->AggregateObject (homa);
+        protocols.push_back (homa);
+      }
+    sender = Socket::CreateSocket (nodes.Get (0), HomaSocketFactory::GetTypeId ());
+    receiver = Socket::CreateSocket (nodes.Get (1), HomaSocketFactory::GetTypeId ());
+    receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  }
+
+  NodeContainer nodes;                        //!< sender and receiver
+  NetDeviceContainer devices;                 //!< the devices
+  std::vector<Ptr<HomaL4Protocol> > protocols; //!< Homa of the nodes
+  Ptr<Socket> sender;                         //!< the sending socket
+  Ptr<Socket> receiver;                       //!< the receiving socket
+  Address remote;                             //!< the receiving socket address
+};
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Collect the sizes of the messages received by a socket
+ */
+class HomaTestCase : public TestCase
+{
+public:
+  /**
+   * \param name the test name
+   */
+  HomaTestCase (std::string name);
+
+protected:
+  /**
+   * \brief Send a message
+   * \param socket the sending socket
+   * \param size the message size
+   * \param to the destination
+   */
+  void Send (Ptr<Socket> socket, uint32_t size, Address to);
+
+  /**
+   * \brief Receive the messages of a socket
+   * \param socket the socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  std::vector<uint32_t> m_sizes; //!< sizes of the messages received
+};
+
+HomaTestCase::HomaTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+HomaTestCase::Send (Ptr<Socket> socket, uint32_t size, Address to)
+{
+  socket->SendTo (Create<Packet> (size), 0, to);
+}
+
+void
+HomaTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      m_sizes.push_back (p->GetSize ());
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Messages are delivered whole, the shortest first, with one
+ * grant per scheduled packet
+ */
+class HomaSrptTestCase : public HomaTestCase
+{
+public:
+  HomaSrptTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HomaSrptTestCase::HomaSrptTestCase ()
+  : HomaTestCase ("Homa delivers the shortest messages first")
+{
+}
+
+void
+HomaSrptTestCase::DoRun (void)
+{
+  HomaTestTopology topology;
+  topology.receiver->SetRecvCallback (MakeCallback (&HomaSrptTestCase::Receive, this));
+  Simulator::ScheduleNow (&HomaSrptTestCase::Send, this, topology.sender, 200000, topology.remote);
+  Simulator::ScheduleNow (&HomaSrptTestCase::Send, this, topology.sender, 50000, topology.remote);
+  Simulator::ScheduleNow (&HomaSrptTestCase::Send, this, topology.sender, 5000, topology.remote);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 3, "messages lost");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[0], 5000, "wrong first message");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[1], 50000, "wrong second message");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[2], 200000, "wrong third message");
+  // 8 unscheduled packets of 1400 bytes per message
+  NS_TEST_EXPECT_MSG_EQ (topology.protocols[1]->GetNGrants (), (143 - 8) + (36 - 8), "wrong number of grants");
+  NS_TEST_EXPECT_MSG_EQ (topology.protocols[1]->GetNResends (), 0, "unexpected resend");
+  NS_TEST_EXPECT_MSG_EQ (topology.protocols[1]->GetNInbound (), 0, "message not completed");
+  NS_TEST_EXPECT_MSG_EQ (topology.protocols[0]->GetNOutbound (), 0, "message not acknowledged");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Many concurrent messages, part of the data lost on the way,
+ * are all delivered
+ */
+class HomaResendTestCase : public HomaTestCase
+{
+public:
+  /**
+   * \param messages the number of messages
+   * \param errorRate the loss rate of the data packets
+   */
+  HomaResendTestCase (uint32_t messages, double errorRate);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_messages; //!< number of messages
+  double m_errorRate;  //!< loss rate of the data packets
+};
+
+HomaResendTestCase::HomaResendTestCase (uint32_t messages, double errorRate)
+  : HomaTestCase ("Homa delivers " + std::to_string (messages) + " messages, "
+                  + std::to_string ((uint32_t) (errorRate * 100)) + "% of the data lost"),
+    m_messages (messages),
+    m_errorRate (errorRate)
+{
+}
+
+void
+HomaResendTestCase::DoRun (void)
+{
+  HomaTestTopology topology;
+  Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+  em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+  em->SetAttribute ("ErrorRate", DoubleValue (m_errorRate));
+  em->AssignStreams (1);
+  topology.devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+  topology.receiver->SetRecvCallback (MakeCallback (&HomaResendTestCase::Receive, this));
+  for (uint32_t i = 0; i < m_messages; i++)
+    {
+      Simulator::ScheduleNow (&HomaResendTestCase::Send, this, topology.sender, 15000 + i, topology.remote);
+    }
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), m_messages, "messages lost");
+  std::sort (m_sizes.begin (), m_sizes.end ());
+  for (uint32_t i = 0; i < m_messages; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_sizes[i], 15000 + i, "wrong message size");
+    }
+  NS_TEST_EXPECT_MSG_EQ (topology.protocols[1]->GetNInbound (), 0, "message not completed");
+  if (m_errorRate > 0)
+    {
+      NS_TEST_EXPECT_MSG_GT (topology.protocols[1]->GetNResends (), 0, "no resend");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief The sender recovers a message whose packets, or whose ACK,
+ * are all lost, and drops a message nobody answers
+ */
+class HomaProbeTestCase : public HomaTestCase
+{
+public:
+  /**
+   * \param loseAck lose the ACK instead of the data
+   */
+  HomaProbeTestCase (bool loseAck);
+
+private:
+  virtual void DoRun (void);
+
+  bool m_loseAck; //!< lose the ACK instead of the data
+};
+
+HomaProbeTestCase::HomaProbeTestCase (bool loseAck)
+  : HomaTestCase (loseAck ? "Homa recovers from a lost ACK"
+                          : "Homa recovers a message whose packets are all lost"),
+    m_loseAck (loseAck)
+{
+}
+
+void
+HomaProbeTestCase::DoRun (void)
+{
+  HomaTestTopology topology;
+  // everything the lossy node receives in the first 100us is lost
+  Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+  em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+  em->SetAttribute ("ErrorRate", DoubleValue (1));
+  topology.devices.Get (m_loseAck ? 0 : 1)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+  Simulator::Schedule (MicroSeconds (100), &RateErrorModel::Disable, em);
+  topology.receiver->SetRecvCallback (MakeCallback (&HomaProbeTestCase::Receive, this));
+  // sent whole without grant
+  Simulator::ScheduleNow (&HomaProbeTestCase::Send, this, topology.sender, 5000, topology.remote);
+  // no socket on port 10
+  InetSocketAddress closed = InetSocketAddress::ConvertFrom (topology.remote);
+  closed.SetPort (10);
+  Simulator::ScheduleNow (&HomaProbeTestCase::Send, this, topology.sender, 1000, closed);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 1, "message lost");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[0], 5000, "wrong message size");
+  NS_TEST_EXPECT_MSG_EQ (topology.protocols[1]->GetNInbound (), 0, "message not completed");
+  NS_TEST_EXPECT_MSG_EQ (topology.protocols[0]->GetNOutbound (), 0, "message not acknowledged or dropped");
+  // the closed port gets every probe, the message one
+  NS_TEST_EXPECT_MSG_EQ (topology.protocols[0]->GetNProbes (), 11, "wrong number of probes");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Homa TestSuite
+ */
+class HomaTestSuite : public TestSuite
+{
+public:
+  HomaTestSuite () : TestSuite ("homa", UNIT)
+  {
+    AddTestCase (new HomaSrptTestCase, TestCase::QUICK);
+    AddTestCase (new HomaResendTestCase (20, 0.05), TestCase::QUICK);
+    AddTestCase (new HomaResendTestCase (1000, 0), TestCase::QUICK);
+    AddTestCase (new HomaProbeTestCase (false), TestCase::QUICK);
+    AddTestCase (new HomaProbeTestCase (true), TestCase::QUICK);
+  }
+};
+
+static HomaTestSuite g_homaTestSuite; //!< Static variable for test initialization
@@ -15,6 +15,8 @@
  */
 
 #include <vector>
+#include <algorithm>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -41,7 +43,13 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-list-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/enum.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/traffic-control-layer.h"
 
 using namespace ns3;
 
@@ -1167,6 +1175,343 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * Check that only the longest matching network routes are candidates,
+ * whatever the order in which the routes were added
+ */
+class Ipv4GlobalRoutingLongestPrefixTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingLongestPrefixTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Route a packet from the node
+   * \param node the node
+   * \param dest the destination
+   * \returns the output device of the route
+   */
+  static Ptr<NetDevice> Route (Ptr<Node> node, Ipv4Address dest);
+};
+
+Ipv4GlobalRoutingLongestPrefixTestCase::Ipv4GlobalRoutingLongestPrefixTestCase ()
+  : TestCase ("Global network routes are selected by longest prefix")
+{
+}
+
+Ptr<NetDevice>
+Ipv4GlobalRoutingLongestPrefixTestCase::Route (Ptr<Node> node, Ipv4Address dest)
+{
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.1.1.1"));
+  header.SetDestination (dest);
+  header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  Socket::SocketErrno err;
+  Ptr<Ipv4Route> route = node->GetObject<Ipv4> ()->GetRoutingProtocol ()->RouteOutput (Create<Packet> (100), header, 0, err);
+  return route ? route->GetOutputDevice () : 0;
+}
+
+void
+Ipv4GlobalRoutingLongestPrefixTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  NodeContainer peers;
+  peers.Create (2);
+  InternetStackHelper internet;
+  internet.Install (node);
+  internet.Install (peers);
+
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer d1 = devHelper.Install (NodeContainer (node, peers.Get (0)));
+  NetDeviceContainer d2 = devHelper.Install (NodeContainer (node, peers.Get (1)));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  Ipv4InterfaceContainer i1 = ipv4.Assign (d1);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.252");
+  Ipv4InterfaceContainer i2 = ipv4.Assign (d2);
+
+  Ptr<Ipv4> ip = node->GetObject<Ipv4> ();
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (ip->GetRoutingProtocol ());
+  Ptr<Ipv4GlobalRouting> routing;
+  for (uint32_t i = 0; routing == 0 && i < list->GetNRoutingProtocols (); i++)
+    {
+      int16_t priority;
+      routing = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (i, priority));
+    }
+  NS_TEST_ASSERT_MSG_NE (routing, 0, "no global routing");
+  // the aggregate comes first, so it would win if every match was a candidate
+  routing->AddNetworkRouteTo ("10.9.0.0", "255.255.0.0", i1.GetAddress (1), ip->GetInterfaceForDevice (d1.Get (0)));
+  routing->AddNetworkRouteTo ("10.9.1.0", "255.255.255.0", i2.GetAddress (1), ip->GetInterfaceForDevice (d2.Get (0)));
+  routing->AddNetworkRouteTo ("10.9.2.0", "255.255.255.0", i2.GetAddress (1), ip->GetInterfaceForDevice (d2.Get (0)));
+  routing->AddNetworkRouteTo ("10.9.2.0", "255.255.254.0", i1.GetAddress (1), ip->GetInterfaceForDevice (d1.Get (0)));
+
+  NS_TEST_EXPECT_MSG_EQ (Route (node, "10.9.1.5"), d2.Get (0), "more specific /24 not preferred");
+  NS_TEST_EXPECT_MSG_EQ (Route (node, "10.9.2.5"), d2.Get (0), "more specific /24 not preferred over a later /23");
+  NS_TEST_EXPECT_MSG_EQ (Route (node, "10.9.3.5"), d1.Get (0), "/23 not used outside the /24");
+  NS_TEST_EXPECT_MSG_EQ (Route (node, "10.9.7.5"), d1.Get (0), "/16 not used outside the longer prefixes");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Check that ECMP_FLOWLET keeps a flowlet on its egress and places new
+ * flowlets on the least loaded one
+ */
+class Ipv4GlobalRoutingFlowletTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingFlowletTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Route a packet of the test flow
+   * \param expected the expected output device
+   * \param msg the message on failure
+   */
+  void Route (Ptr<NetDevice> expected, std::string msg);
+  /**
+   * Route a packet of a flow
+   * \param sourcePort the source port of the flow
+   * \returns the output device
+   */
+  Ptr<NetDevice> RouteFlow (uint16_t sourcePort);
+  /**
+   * Queue bytes in the root queue disc of a device
+   * \param device the device
+   * \param bytes the number of bytes
+   */
+  void Load (Ptr<NetDevice> device, uint32_t bytes);
+
+  Ptr<Node> m_node;
+};
+
+Ipv4GlobalRoutingFlowletTestCase::Ipv4GlobalRoutingFlowletTestCase ()
+  : TestCase ("Flowlet ECMP selects the least loaded egress")
+{
+}
+
+void
+Ipv4GlobalRoutingFlowletTestCase::Route (Ptr<NetDevice> expected, std::string msg)
+{
+  NS_TEST_EXPECT_MSG_EQ (RouteFlow (1000), expected, msg);
+}
+
+Ptr<NetDevice>
+Ipv4GlobalRoutingFlowletTestCase::RouteFlow (uint16_t sourcePort)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (sourcePort);
+  udpHeader.SetDestinationPort (9);
+  p->AddHeader (udpHeader);
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.1.1.1"));
+  header.SetDestination (Ipv4Address ("10.9.0.1"));
+  header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+
+  Socket::SocketErrno err;
+  Ptr<Ipv4Route> route = m_node->GetObject<Ipv4> ()->GetRoutingProtocol ()->RouteOutput (p, header, 0, err);
+  NS_TEST_EXPECT_MSG_NE (route, 0, "no route");
+  return route ? route->GetOutputDevice () : 0;
+}
+
+void
+Ipv4GlobalRoutingFlowletTestCase::Load (Ptr<NetDevice> device, uint32_t bytes)
+{
+  Ptr<QueueDisc> qdisc = m_node->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (device);
+  Ipv4Header header;
+  qdisc->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (bytes), device->GetAddress (), 0x0800, header));
+}
+
+void
+Ipv4GlobalRoutingFlowletTestCase::DoRun (void)
+{
+  m_node = CreateObject<Node> ();
+  NodeContainer peers;
+  peers.Create (2);
+  InternetStackHelper internet;
+  internet.Install (m_node);
+  internet.Install (peers);
+
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer d1 = devHelper.Install (NodeContainer (m_node, peers.Get (0)));
+  NetDeviceContainer d2 = devHelper.Install (NodeContainer (m_node, peers.Get (1)));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  Ipv4InterfaceContainer i1 = ipv4.Assign (d1);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.252");
+  Ipv4InterfaceContainer i2 = ipv4.Assign (d2);
+
+  Ptr<Ipv4> ip = m_node->GetObject<Ipv4> ();
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (ip->GetRoutingProtocol ());
+  Ptr<Ipv4GlobalRouting> routing;
+  for (uint32_t i = 0; routing == 0 && i < list->GetNRoutingProtocols (); i++)
+    {
+      int16_t priority;
+      routing = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (i, priority));
+    }
+  NS_TEST_ASSERT_MSG_NE (routing, 0, "no global routing");
+  routing->SetAttribute ("EcmpMode", EnumValue (ECMP_FLOWLET));
+  routing->AddNetworkRouteTo ("10.9.0.0", "255.255.0.0", i1.GetAddress (1), ip->GetInterfaceForDevice (d1.Get (0)));
+  routing->AddNetworkRouteTo ("10.9.0.0", "255.255.0.0", i2.GetAddress (1), ip->GetInterfaceForDevice (d2.Get (0)));
+
+  // the first flowlet avoids the loaded egress
+  Load (d1.Get (0), 3000);
+  Route (d2.Get (0), "new flowlet not on the least loaded egress");
+  // packets within the gap stay on the flowlet egress
+  Load (d2.Get (0), 6000);
+  Simulator::Schedule (MicroSeconds (50), &Ipv4GlobalRoutingFlowletTestCase::Route, this,
+                       d2.Get (0), "flowlet moved within the gap");
+  // after the gap the flow moves to the least loaded egress
+  Simulator::Schedule (MicroSeconds (500), &Ipv4GlobalRoutingFlowletTestCase::Route, this,
+                       d1.Get (0), "new flowlet not on the least loaded egress");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (routing->GetNFlowlets (), 1, "flowlet not recorded");
+  // the flowlet of the test flow is pruned once idle
+  Simulator::Schedule (MilliSeconds (1), &Ipv4GlobalRoutingFlowletTestCase::RouteFlow, this, 2000);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (routing->GetNFlowlets (), 1, "idle flowlet kept");
+  Simulator::Destroy ();
+}
+
+/**
+ * Check that a link failure in a diamond moves the routes onto the
+ * other side, and that the tables are restored when the link is back
+ */
+class Ipv4GlobalRoutingRepairTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingRepairTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param node a node
+   * \returns the global routing of the node
+   */
+  static Ptr<Ipv4GlobalRouting> GetRouting (Ptr<Node> node);
+  /**
+   * \param node a node
+   * \returns the routes of the node, printed and sorted
+   */
+  static std::vector<std::string> GetRoutes (Ptr<Node> node);
+  /**
+   * \param node a node
+   * \param dest a destination
+   * \returns the routes of the node to exactly the destination
+   */
+  static std::vector<Ipv4RoutingTableEntry> GetHostRoutes (Ptr<Node> node, Ipv4Address dest);
+};
+
+Ipv4GlobalRoutingRepairTestCase::Ipv4GlobalRoutingRepairTestCase ()
+  : TestCase ("Global routing repairs the tables around a failed link")
+{
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingRepairTestCase::GetRouting (Ptr<Node> node)
+{
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (node->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  Ptr<Ipv4GlobalRouting> routing;
+  for (uint32_t i = 0; routing == 0 && i < list->GetNRoutingProtocols (); i++)
+    {
+      int16_t priority;
+      routing = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (i, priority));
+    }
+  return routing;
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingRepairTestCase::GetRoutes (Ptr<Node> node)
+{
+  std::vector<Ipv4RoutingTableEntry> routes = GetRouting (node)->GetRoutes ();
+  std::vector<std::string> printed;
+  for (std::vector<Ipv4RoutingTableEntry>::const_iterator r = routes.begin (); r != routes.end (); r++)
+    {
+      std::ostringstream oss;
+      oss << *r;
+      printed.push_back (oss.str ());
+    }
+  std::sort (printed.begin (), printed.end ());
+  return printed;
+}
+
+std::vector<Ipv4RoutingTableEntry>
+Ipv4GlobalRoutingRepairTestCase::GetHostRoutes (Ptr<Node> node, Ipv4Address dest)
+{
+  std::vector<Ipv4RoutingTableEntry> routes = GetRouting (node)->GetRoutes ();
+  std::vector<Ipv4RoutingTableEntry> host;
+  for (std::vector<Ipv4RoutingTableEntry>::const_iterator r = routes.begin (); r != routes.end (); r++)
+    {
+      if (r->IsHost () && r->GetDest () == dest)
+        {
+          host.push_back (*r);
+        }
+    }
+  return host;
+}
+
+void
+Ipv4GlobalRoutingRepairTestCase::DoRun (void)
+{
+  // a diamond: a - b - d and a - c - d
+  NodeContainer nodes;
+  nodes.Create (4);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  NetDeviceContainer ab = devHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1)));
+  NetDeviceContainer ac = devHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (2)));
+  NetDeviceContainer bd = devHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (3)));
+  NetDeviceContainer cd = devHelper.Install (NodeContainer (nodes.Get (2), nodes.Get (3)));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  Ipv4InterfaceContainer iab = ipv4.Assign (ab);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.252");
+  Ipv4InterfaceContainer iac = ipv4.Assign (ac);
+  ipv4.SetBase ("10.1.3.0", "255.255.255.252");
+  Ipv4InterfaceContainer ibd = ipv4.Assign (bd);
+  ipv4.SetBase ("10.1.4.0", "255.255.255.252");
+  ipv4.Assign (cd);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  std::vector<std::vector<std::string> > tables;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      tables.push_back (GetRoutes (nodes.Get (i)));
+    }
+  Ipv4Address dest = ibd.GetAddress (1);
+  NS_TEST_ASSERT_MSG_EQ (GetHostRoutes (nodes.Get (0), dest).size (), 2, "no equal cost routes to d");
+
+  Ipv4GlobalRoutingHelper::RepairLinkDown (bd.Get (0)->GetChannel ());
+  // a goes through c only
+  std::vector<Ipv4RoutingTableEntry> routes = GetHostRoutes (nodes.Get (0), dest);
+  NS_TEST_ASSERT_MSG_EQ (routes.size (), 1, "route through the failed link kept");
+  NS_TEST_EXPECT_MSG_EQ (routes[0].GetGateway (), iac.GetAddress (1), "route not through c");
+  // b goes back through a
+  uint32_t failed = nodes.Get (1)->GetObject<Ipv4> ()->GetInterfaceForDevice (bd.Get (0));
+  std::vector<Ipv4RoutingTableEntry> all = GetRouting (nodes.Get (1))->GetRoutes ();
+  for (std::vector<Ipv4RoutingTableEntry>::const_iterator r = all.begin (); r != all.end (); r++)
+    {
+      NS_TEST_EXPECT_MSG_NE (r->GetInterface (), failed, "route through the failed link kept");
+    }
+  routes = GetHostRoutes (nodes.Get (1), dest);
+  NS_TEST_ASSERT_MSG_EQ (routes.size (), 1, "no route around the failed link");
+  NS_TEST_EXPECT_MSG_EQ (routes[0].GetGateway (), iab.GetAddress (0), "route not through a");
+
+  Ipv4GlobalRoutingHelper::RepairLinkUp (bd.Get (0)->GetChannel ());
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((GetRoutes (nodes.Get (i)) == tables[i]), true, "routes of node " << i << " not restored");
+    }
+
+  Simulator::Destroy ();
+}
+
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
 public:
@@ -1184,6 +1529,9 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingLongestPrefixTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingFlowletTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingRepairTestCase, TestCase::QUICK);
   }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/socket.h"
+#include "ns3/udp-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/ipv4-packet-filter.h"
+#include "ns3/pias-threshold-tuner.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief The PIAS filter demotes each flow as it sends more bytes
+ */
+class PiasFilterTestCase : public TestCase
+{
+public:
+  PiasFilterTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Classify a packet of a flow
+   * \param srcPort the source port of the flow
+   * \param size the payload size
+   * \return the level of the packet
+   */
+  int32_t Send (uint16_t srcPort, uint32_t size);
+
+  /**
+   * \brief Check the level of the next packet of a flow
+   * \param srcPort the source port of the flow
+   * \param level the level expected
+   */
+  void CheckLevel (uint16_t srcPort, int32_t level);
+
+  Ptr<PiasIpv4PacketFilter> m_filter;  //!< the filter
+  Ptr<Ipv4QueueDiscItem> m_item;       //!< the last packet classified
+};
+
+PiasFilterTestCase::PiasFilterTestCase ()
+  : TestCase ("PIAS filter demotes the flows at the thresholds")
+{
+}
+
+int32_t
+PiasFilterTestCase::Send (uint16_t srcPort, uint32_t size)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  UdpHeader udp;
+  udp.SetSourcePort (srcPort);
+  udp.SetDestinationPort (9);
+  p->AddHeader (udp);
+  Ipv4Header ipv4;
+  ipv4.SetSource (Ipv4Address ("10.0.0.1"));
+  ipv4.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipv4.SetProtocol (17);
+  m_item = Create<Ipv4QueueDiscItem> (p, Address (), 0x0800, ipv4);
+  return m_filter->Classify (m_item);
+}
+
+void
+PiasFilterTestCase::CheckLevel (uint16_t srcPort, int32_t level)
+{
+  NS_TEST_EXPECT_MSG_EQ (Send (srcPort, 92), level, "wrong level");
+}
+
+void
+PiasFilterTestCase::DoRun (void)
+{
+  m_filter = CreateObject<PiasIpv4PacketFilter> ();
+  m_filter->SetAttribute ("Thresholds", StringValue ("1000, 3000 10000"));
+  m_filter->SetAttribute ("FlowTimeout", TimeValue (MilliSeconds (10)));
+  StringValue thresholds;
+  m_filter->GetAttribute ("Thresholds", thresholds);
+  NS_TEST_EXPECT_MSG_EQ (thresholds.Get (), "1000,3000,10000", "thresholds not parsed");
+
+  // 100 byte packets
+  int32_t expected[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+  for (uint32_t i = 0; i < 11; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Send (1000, 92), expected[i], "wrong level of packet " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) m_item->GetHeader ().GetDscp (), 1, "level not set as DSCP");
+  SocketPriorityTag priorityTag;
+  NS_TEST_EXPECT_MSG_EQ (m_item->GetPacket ()->PeekPacketTag (priorityTag), true, "no priority tag");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) priorityTag.GetPriority (), 1, "level not set as priority");
+
+  NS_TEST_EXPECT_MSG_EQ (Send (1000, 9900), 1, "wrong level");
+  NS_TEST_EXPECT_MSG_EQ (Send (1000, 92), 3, "wrong level after the last threshold");
+  // another flow starts at the highest priority
+  NS_TEST_EXPECT_MSG_EQ (Send (1001, 92), 0, "new flow demoted");
+  NS_TEST_EXPECT_MSG_EQ (m_filter->GetNFlows (), 2, "wrong number of flows");
+
+  // an idle flow is reset, and forgotten when a new flow comes
+  Simulator::Schedule (MilliSeconds (5), &PiasFilterTestCase::CheckLevel, this, 1001, 0);
+  Simulator::Schedule (MilliSeconds (20), &PiasFilterTestCase::CheckLevel, this, 1000, 0);
+  Simulator::Schedule (MilliSeconds (20), &PiasFilterTestCase::CheckLevel, this, 1002, 0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (m_filter->GetNFlows (), 2, "idle flow not forgotten");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief The thresholds split the flow size distribution in quantiles
+ */
+class PiasThresholdTunerTestCase : public TestCase
+{
+public:
+  PiasThresholdTunerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PiasThresholdTunerTestCase::PiasThresholdTunerTestCase ()
+  : TestCase ("PIAS thresholds from the flow size distribution")
+{
+}
+
+void
+PiasThresholdTunerTestCase::DoRun (void)
+{
+  PiasThresholdTuner tuner;
+  NS_TEST_EXPECT_MSG_EQ (tuner.GetThresholds (4).size (), 0, "thresholds without distribution");
+  tuner.AddPoint (100000, 1);
+  tuner.AddPoint (0, 0);
+  tuner.AddPoint (10000, 0.75);
+  tuner.AddPoint (1000, 0.5);
+  NS_TEST_EXPECT_MSG_EQ (tuner.GetThresholdsString (4), "500,1000,10000", "wrong thresholds");
+  NS_TEST_EXPECT_MSG_EQ (tuner.GetThresholdsString (2), "1000", "wrong thresholds");
+  NS_TEST_EXPECT_MSG_EQ (tuner.GetThresholdsString (1), "", "wrong thresholds");
+  NS_TEST_EXPECT_MSG_EQ (tuner.LoadCdf ("no-such-file"), false, "missing file loaded");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PIAS TestSuite
+ */
+class PiasTestSuite : public TestSuite
+{
+public:
+  PiasTestSuite () : TestSuite ("pias", UNIT)
+  {
+    AddTestCase (new PiasFilterTestCase, TestCase::QUICK);
+    AddTestCase (new PiasThresholdTunerTestCase, TestCase::QUICK);
+  }
+};
+
+static PiasTestSuite g_piasTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,330 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <algorithm>
+#include <set>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/error-model.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-socket-base.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Receive error model which holds back every Nth data packet for
+ * a while, or drops it
+ */
+class TcpReorderingErrorModel : public ErrorModel
+{
+public:
+  /**
+   * \param device the device the model is installed on
+   * \param period one data packet out of period is held back
+   * \param delay how long it is held back, 0 to drop it
+   * \param count number of packets held back
+   */
+  TcpReorderingErrorModel (Ptr<SimpleNetDevice> device, uint32_t period,
+                           Time delay, uint32_t count);
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  /**
+   * \brief Deliver a packet held back
+   * \param p the packet
+   */
+  void Deliver (Ptr<Packet> p);
+
+  Ptr<SimpleNetDevice> m_device; //!< the receiving device
+  uint32_t m_period;             //!< one data packet out of period is held back
+  Time m_delay;                  //!< delay of the packets held back
+  uint32_t m_count;              //!< packets still to hold back
+  uint32_t m_data;               //!< data packets seen
+  std::set<uint64_t> m_late;     //!< uids of the packets being delivered late
+};
+
+TcpReorderingErrorModel::TcpReorderingErrorModel (Ptr<SimpleNetDevice> device, uint32_t period,
+                                                  Time delay, uint32_t count)
+  : m_device (device),
+    m_period (period),
+    m_delay (delay),
+    m_count (count),
+    m_data (0)
+{
+}
+
+bool
+TcpReorderingErrorModel::DoCorrupt (Ptr<Packet> p)
+{
+  if (m_late.erase (p->GetUid ()) > 0 || p->GetSize () < 1000)
+    {
+      return false;
+    }
+  if (++m_data % m_period != 0 || m_count == 0)
+    {
+      return false;
+    }
+  m_count--;
+  if (!m_delay.IsZero ())
+    {
+      m_late.insert (p->GetUid ());
+      Simulator::Schedule (m_delay, &TcpReorderingErrorModel::Deliver, this, p->Copy ());
+    }
+  return true;
+}
+
+void
+TcpReorderingErrorModel::DoReset (void)
+{
+}
+
+void
+TcpReorderingErrorModel::Deliver (Ptr<Packet> p)
+{
+  Mac48Address address = Mac48Address::ConvertFrom (m_device->GetAddress ());
+  m_device->Receive (p, 0x0800, address, address);
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A bulk transfer over a link which reorders or loses some
+ * data packets
+ */
+class TcpReorderingTestCase : public TestCase
+{
+public:
+  /**
+   * \param robust enable the adaptive threshold and the undo
+   * \param delay how long the packets are held back, 0 to drop them
+   * \param count number of packets held back
+   */
+  TcpReorderingTestCase (bool robust, Time delay, uint32_t count);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Configure a socket of the test
+   * \param socket the socket
+   */
+  void SetSocketAttributes (Ptr<Socket> socket);
+
+  /**
+   * \brief Fill the send buffer
+   * \param socket the sending socket
+   * \param available the space in the send buffer
+   */
+  void Send (Ptr<Socket> socket, uint32_t available);
+
+  /**
+   * \brief Read the received data
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  /**
+   * \brief Accept a connection
+   * \param socket the connected socket
+   * \param from the peer address
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+
+  /**
+   * \brief Count the congestion state changes
+   * \param oldValue the previous state
+   * \param newValue the new state
+   */
+  void CongState (TcpSocketState::TcpCongState_t oldValue,
+                  TcpSocketState::TcpCongState_t newValue);
+
+  /**
+   * \brief Record the dupack threshold learnt
+   * \param oldValue the previous threshold
+   * \param newValue the new threshold
+   */
+  void Reordering (uint32_t oldValue, uint32_t newValue);
+
+  bool m_robust;         //!< adaptive threshold and undo enabled
+  Time m_delay;          //!< delay of the packets held back
+  uint32_t m_count;      //!< number of packets held back
+  uint32_t m_sent;       //!< bytes given to the sending socket
+  uint32_t m_received;   //!< bytes read from the receiving socket
+  uint32_t m_recoveries; //!< fast retransmits
+  uint32_t m_undos;      //!< fast retransmits undone
+  uint32_t m_reordering; //!< dupack threshold learnt
+};
+
+static const uint32_t g_tcpReorderingBytes = 2000000; //!< bytes transferred
+
+TcpReorderingTestCase::TcpReorderingTestCase (bool robust, Time delay, uint32_t count)
+  : TestCase (std::string (robust ? "Reordering-robust" : "Standard") + " TCP, "
+              + std::to_string (count) + " packets " + (delay.IsZero () ? "lost" : "reordered")),
+    m_robust (robust),
+    m_delay (delay),
+    m_count (count),
+    m_sent (0),
+    m_received (0),
+    m_recoveries (0),
+    m_undos (0),
+    m_reordering (0)
+{
+}
+
+void
+TcpReorderingTestCase::Send (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_sent < g_tcpReorderingBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (socket->GetTxAvailable (), g_tcpReorderingBytes - m_sent);
+      int sent = socket->Send (Create<Packet> (size));
+      if (sent <= 0)
+        {
+          return;
+        }
+      m_sent += sent;
+    }
+}
+
+void
+TcpReorderingTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      m_received += p->GetSize ();
+    }
+}
+
+void
+TcpReorderingTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpReorderingTestCase::Receive, this));
+}
+
+void
+TcpReorderingTestCase::CongState (TcpSocketState::TcpCongState_t oldValue,
+                                  TcpSocketState::TcpCongState_t newValue)
+{
+  if (newValue == TcpSocketState::CA_RECOVERY)
+    {
+      m_recoveries++;
+    }
+  if (oldValue == TcpSocketState::CA_RECOVERY && newValue == TcpSocketState::CA_DISORDER)
+    {
+      m_undos++;
+    }
+}
+
+void
+TcpReorderingTestCase::Reordering (uint32_t oldValue, uint32_t newValue)
+{
+  m_reordering = newValue;
+}
+
+void
+TcpReorderingTestCase::SetSocketAttributes (Ptr<Socket> socket)
+{
+  // the accepted sockets are copies of the listening one
+  socket->SetAttribute ("SegmentSize", UintegerValue (1448));
+  socket->SetAttribute ("SndBufSize", UintegerValue (1 << 20));
+  socket->SetAttribute ("RcvBufSize", UintegerValue (1 << 20));
+  socket->SetAttribute ("Timestamp", BooleanValue (m_robust));
+  socket->SetAttribute ("TimestampResolution", TimeValue (MicroSeconds (1)));
+  socket->SetAttribute ("AdaptiveReordering", BooleanValue (m_robust));
+  socket->SetAttribute ("UndoSpuriousRecovery", BooleanValue (m_robust));
+}
+
+void
+TcpReorderingTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  simple.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  simple.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (10)));
+  NetDeviceContainer devices = simple.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  // about 8 packet times at 1 Gb/s
+  Ptr<SimpleNetDevice> device = DynamicCast<SimpleNetDevice> (devices.Get (1));
+  Ptr<TcpReorderingErrorModel> em = CreateObject<TcpReorderingErrorModel> (device, 100, m_delay, m_count);
+  device->SetReceiveErrorModel (em);
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  SetSocketAttributes (server);
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpReorderingTestCase::Accept, this));
+
+  Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  SetSocketAttributes (client);
+  client->TraceConnectWithoutContext ("CongState", MakeCallback (&TcpReorderingTestCase::CongState, this));
+  client->TraceConnectWithoutContext ("Reordering", MakeCallback (&TcpReorderingTestCase::Reordering, this));
+  client->SetSendCallback (MakeCallback (&TcpReorderingTestCase::Send, this));
+  // connect once the nodes are initialized
+  Simulator::ScheduleNow (&Socket::Connect, client, InetSocketAddress (interfaces.GetAddress (1), 9));
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, g_tcpReorderingBytes, "data not delivered");
+  if (m_delay.IsZero ())
+    {
+      // a recovery may repair several losses of the same window
+      NS_TEST_EXPECT_MSG_GT (m_recoveries, 0, "losses not fast retransmitted");
+      NS_TEST_EXPECT_MSG_EQ (m_undos, 0, "a genuine fast retransmit undone");
+    }
+  else if (m_robust)
+    {
+      // the first reordering is undone, then the threshold covers it
+      NS_TEST_EXPECT_MSG_EQ (m_recoveries, 1, "reordering not learnt");
+      NS_TEST_EXPECT_MSG_EQ (m_undos, 1, "spurious fast retransmit not undone");
+      NS_TEST_EXPECT_MSG_GT (m_reordering, 3, "dupack threshold not raised");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (m_recoveries, m_count, "reordering not seen as losses");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP reordering TestSuite
+ */
+class TcpReorderingTestSuite : public TestSuite
+{
+public:
+  TcpReorderingTestSuite () : TestSuite ("tcp-reordering", UNIT)
+  {
+    AddTestCase (new TcpReorderingTestCase (false, MicroSeconds (100), 5), TestCase::QUICK);
+    AddTestCase (new TcpReorderingTestCase (true, MicroSeconds (100), 5), TestCase::QUICK);
+    AddTestCase (new TcpReorderingTestCase (true, Seconds (0), 5), TestCase::QUICK);
+  }
+};
+
+static TcpReorderingTestSuite g_tcpReorderingTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/tcp-rx-buffer.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the VirtualPayload mode of TcpRxBuffer, which only keeps
+ * byte ranges, behaves like the packet mode for in-order, out-of-order,
+ * duplicated and overlapping segments
+ */
+class TcpRxBufferVirtualPayloadTestCase : public TestCase
+{
+public:
+  TcpRxBufferVirtualPayloadTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Add the same segment to both buffers and compare their state
+   * \param seq first byte of the segment
+   * \param size segment size
+   * \param added expected return value of Add
+   */
+  void AddSegment (uint32_t seq, uint32_t size, bool added);
+  /**
+   * \brief Extract from both buffers and compare the sizes
+   * \param maxSize maximum number of bytes to extract
+   * \param expected expected number of bytes extracted
+   */
+  void ExtractData (uint32_t maxSize, uint32_t expected);
+
+  Ptr<TcpRxBuffer> m_packets;  //!< Buffer storing the packets
+  Ptr<TcpRxBuffer> m_ranges;   //!< Buffer in VirtualPayload mode
+};
+
+TcpRxBufferVirtualPayloadTestCase::TcpRxBufferVirtualPayloadTestCase ()
+  : TestCase ("TcpRxBuffer VirtualPayload mode matches the packet mode")
+{
+}
+
+void
+TcpRxBufferVirtualPayloadTestCase::AddSegment (uint32_t seq, uint32_t size, bool added)
+{
+  TcpHeader header;
+  header.SetSequenceNumber (SequenceNumber32 (seq));
+  NS_TEST_ASSERT_MSG_EQ (m_packets->Add (Create<Packet> (size), header), added,
+                         "Unexpected return value in packet mode for seq " << seq);
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->Add (Create<Packet> (size), header), added,
+                         "Unexpected return value in VirtualPayload mode for seq " << seq);
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->NextRxSequence (), m_packets->NextRxSequence (),
+                         "NextRxSequence differs after seq " << seq);
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->Size (), m_packets->Size (),
+                         "Size differs after seq " << seq);
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->Available (), m_packets->Available (),
+                         "Available differs after seq " << seq);
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->MaxRxSequence (), m_packets->MaxRxSequence (),
+                         "MaxRxSequence differs after seq " << seq);
+}
+
+void
+TcpRxBufferVirtualPayloadTestCase::ExtractData (uint32_t maxSize, uint32_t expected)
+{
+  Ptr<Packet> p = m_packets->Extract (maxSize);
+  Ptr<Packet> v = m_ranges->Extract (maxSize);
+  NS_TEST_ASSERT_MSG_EQ ((p ? p->GetSize () : 0), expected, "Wrong size extracted in packet mode");
+  NS_TEST_ASSERT_MSG_EQ ((v ? v->GetSize () : 0), expected, "Wrong size extracted in VirtualPayload mode");
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->Size (), m_packets->Size (), "Size differs after extraction");
+}
+
+void
+TcpRxBufferVirtualPayloadTestCase::DoRun (void)
+{
+  m_packets = CreateObject<TcpRxBuffer> ();
+  m_ranges = CreateObject<TcpRxBuffer> ();
+  m_ranges->SetAttribute ("VirtualPayload", BooleanValue (true));
+  m_packets->SetMaxBufferSize (10000);
+  m_ranges->SetMaxBufferSize (10000);
+  m_packets->SetNextRxSequence (SequenceNumber32 (1));
+  m_ranges->SetNextRxSequence (SequenceNumber32 (1));
+
+  AddSegment (1, 1000, true);         // in order
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->NextRxSequence (), SequenceNumber32 (1001), "In-order data not accounted");
+  AddSegment (2001, 1000, true);      // hole [1001, 2001)
+  AddSegment (4001, 1000, true);      // second hole [3001, 4001)
+  AddSegment (2001, 1000, false);     // duplicate
+  AddSegment (1501, 1000, true);      // overlaps the tail of [2001, 3001)
+  AddSegment (3501, 1000, true);      // overlaps the head of [4001, 5001)
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->Size (), 4000, "Overlapping bytes counted twice");
+  AddSegment (1, 1000, false);        // old data
+  ExtractData (600, 600);
+  AddSegment (1001, 500, true);       // partially fills the first hole
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->NextRxSequence (), SequenceNumber32 (3001), "Gap fill not merged");
+  AddSegment (2501, 1500, true);      // fills the second hole
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->NextRxSequence (), SequenceNumber32 (5001), "Gap fill not merged");
+  ExtractData (10000, 4400);
+  m_packets->SetFinSequence (SequenceNumber32 (6001));
+  m_ranges->SetFinSequence (SequenceNumber32 (6001));
+  AddSegment (5001, 1000, true);
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->NextRxSequence (), SequenceNumber32 (6002), "FIN not accounted");
+  NS_TEST_ASSERT_MSG_EQ (m_ranges->Finished (), true, "Buffer not finished");
+  ExtractData (10000, 1000);
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpRxBuffer TestSuite
+ */
+class TcpRxBufferTestSuite : public TestSuite
+{
+public:
+  TcpRxBufferTestSuite () : TestSuite ("tcp-rx-buffer", UNIT)
+  {
+    AddTestCase (new TcpRxBufferVirtualPayloadTestCase (), TestCase::QUICK);
+  }
+};
+
+static TcpRxBufferTestSuite g_tcpRxBufferTestSuite; //!< Static variable for test initialization
+
+} // namespace ns3
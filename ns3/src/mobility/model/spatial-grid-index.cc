@@ -0,0 +1,256 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "spatial-grid-index.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpatialGridIndex");
+
+NS_OBJECT_ENSURE_REGISTERED (SpatialGridIndex);
+
+TypeId
+SpatialGridIndex::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SpatialGridIndex")
+    .SetParent<Object> ()
+    .SetGroupName ("Mobility")
+    .AddConstructor<SpatialGridIndex> ()
+    .AddAttribute ("CellSize", "The side of the cells of the grid (m).",
+                   DoubleValue (100.0),
+                   MakeDoubleAccessor (&SpatialGridIndex::SetCellSize,
+                                       &SpatialGridIndex::GetCellSize),
+                   MakeDoubleChecker<double> (std::numeric_limits<double>::min ()))
+  ;
+  return tid;
+}
+
+SpatialGridIndex::SpatialGridIndex ()
+  : m_cellSize (100.0),
+    m_maxSpeed (0),
+    m_dirty (true),
+    m_nRebuilds (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SpatialGridIndex::~SpatialGridIndex ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SpatialGridIndex::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_items.size (); i++)
+    {
+      if (m_items[i] != 0)
+        {
+          m_items[i]->TraceDisconnectWithoutContext ("CourseChange",
+                                                     MakeCallback (&SpatialGridIndex::CourseChanged, this));
+        }
+    }
+  m_items.clear ();
+  m_cellOf.clear ();
+  m_placed.clear ();
+  m_ids.clear ();
+  m_unplaced.clear ();
+  m_cells.clear ();
+  Object::DoDispose ();
+}
+
+void
+SpatialGridIndex::SetCellSize (double size)
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT (size > 0);
+  m_cellSize = size;
+  m_dirty = true;
+}
+
+double
+SpatialGridIndex::GetCellSize (void) const
+{
+  return m_cellSize;
+}
+
+uint32_t
+SpatialGridIndex::Add (Ptr<MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  uint32_t id = m_items.size ();
+  m_items.push_back (mobility);
+  m_cellOf.push_back (Cell (0, 0));
+  m_placed.push_back (false);
+  if (mobility == 0)
+    {
+      m_unplaced.push_back (id);
+      return id;
+    }
+  m_ids[PeekPointer (mobility)] = id;
+  mobility->TraceConnectWithoutContext ("CourseChange",
+                                        MakeCallback (&SpatialGridIndex::CourseChanged, this));
+  if (!m_dirty)
+    {
+      Place (id);
+    }
+  return id;
+}
+
+uint32_t
+SpatialGridIndex::GetN (void) const
+{
+  return m_items.size ();
+}
+
+uint32_t
+SpatialGridIndex::GetNRebuilds (void) const
+{
+  return m_nRebuilds;
+}
+
+SpatialGridIndex::Cell
+SpatialGridIndex::GetCell (const Vector &position) const
+{
+  return Cell (static_cast<int64_t> (std::floor (position.x / m_cellSize)),
+               static_cast<int64_t> (std::floor (position.y / m_cellSize)));
+}
+
+void
+SpatialGridIndex::Place (uint32_t id)
+{
+  Ptr<MobilityModel> mobility = m_items[id];
+  Cell cell = GetCell (mobility->GetPosition ());
+  Vector velocity = mobility->GetVelocity ();
+  m_maxSpeed = std::max (m_maxSpeed, std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y));
+  if (m_placed[id])
+    {
+      if (m_cellOf[id] == cell)
+        {
+          return;
+        }
+      CellMap::iterator old = m_cells.find (m_cellOf[id]);
+      NS_ASSERT (old != m_cells.end ());
+      old->second.erase (std::find (old->second.begin (), old->second.end (), id));
+      if (old->second.empty ())
+        {
+          m_cells.erase (old);
+        }
+    }
+  m_cells[cell].push_back (id);
+  m_cellOf[id] = cell;
+  m_placed[id] = true;
+}
+
+void
+SpatialGridIndex::Rebuild (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_cells.clear ();
+  std::fill (m_placed.begin (), m_placed.end (), false);
+  m_maxSpeed = 0;
+  m_built = Simulator::Now ();
+  m_dirty = false;
+  m_nRebuilds++;
+  for (uint32_t i = 0; i < m_items.size (); i++)
+    {
+      if (m_items[i] != 0)
+        {
+          Place (i);
+        }
+    }
+}
+
+void
+SpatialGridIndex::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  if (m_dirty)
+    {
+      return;
+    }
+  std::map<const MobilityModel *, uint32_t>::const_iterator it = m_ids.find (PeekPointer (mobility));
+  NS_ASSERT (it != m_ids.end ());
+  Place (it->second);
+}
+
+void
+SpatialGridIndex::Find (const Vector &position, double range, std::vector<uint32_t> *items)
+{
+  NS_LOG_FUNCTION (this << position << range);
+  items->clear ();
+  if (m_dirty)
+    {
+      Rebuild ();
+    }
+  // every item has moved by at most drift since it was placed
+  double drift = m_maxSpeed * (Simulator::Now () - m_built).GetSeconds ();
+  if (drift > m_cellSize)
+    {
+      Rebuild ();
+      drift = 0;
+    }
+  double radius = range + drift;
+  if (!(radius / m_cellSize < 1e6))
+    {
+      for (uint32_t i = 0; i < m_items.size (); i++)
+        {
+          items->push_back (i);
+        }
+      return;
+    }
+
+  Cell low = GetCell (Vector (position.x - radius, position.y - radius, 0));
+  Cell high = GetCell (Vector (position.x + radius, position.y + radius, 0));
+  double nCells = static_cast<double> (high.first - low.first + 1) * (high.second - low.second + 1);
+  if (nCells <= m_cells.size ())
+    {
+      for (int64_t x = low.first; x <= high.first; x++)
+        {
+          for (int64_t y = low.second; y <= high.second; y++)
+            {
+              CellMap::const_iterator it = m_cells.find (Cell (x, y));
+              if (it != m_cells.end ())
+                {
+                  items->insert (items->end (), it->second.begin (), it->second.end ());
+                }
+            }
+        }
+    }
+  else
+    {
+      // the query covers more cells than are occupied
+      for (CellMap::const_iterator it = m_cells.lower_bound (Cell (low.first, low.second));
+           it != m_cells.end () && it->first.first <= high.first; it++)
+        {
+          if (it->first.second >= low.second && it->first.second <= high.second)
+            {
+              items->insert (items->end (), it->second.begin (), it->second.end ());
+            }
+        }
+    }
+  items->insert (items->end (), m_unplaced.begin (), m_unplaced.end ());
+  std::sort (items->begin (), items->end ());
+}
+
+} // namespace ns3
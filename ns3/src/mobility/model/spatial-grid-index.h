@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SPATIAL_GRID_INDEX_H
+#define SPATIAL_GRID_INDEX_H
+
+#include <stdint.h>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "mobility-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mobility
+ * \brief Uniform grid of the positions of a set of mobility models.
+ *
+ * Items are binned by the x and y coordinates of their position.  The
+ * grid is maintained lazily: an item is moved to its new cell when its
+ * mobility model notifies a course change, and the whole grid is
+ * rebuilt when the items may have drifted by more than one cell since
+ * the last rebuild, given the largest speed seen then.  Between
+ * rebuilds, queries are widened by that drift, so that Find always
+ * returns a superset of the items within the requested distance.
+ *
+ * Items are never removed; the ids are allocated from 0 in the order
+ * of the calls to Add.
+ */
+class SpatialGridIndex : public Object
+{
+public:
+  /**
+   * Register this type with the TypeId system.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  SpatialGridIndex ();
+  virtual ~SpatialGridIndex ();
+
+  /**
+   * \param size the side of the cells in meters
+   */
+  void SetCellSize (double size);
+  /**
+   * \return the side of the cells in meters
+   */
+  double GetCellSize (void) const;
+
+  /**
+   * \brief add an item to the index
+   * \param mobility the mobility model of the item, 0 if it has none
+   * \return the id of the item
+   *
+   * Items without a mobility model are returned by every query.
+   */
+  uint32_t Add (Ptr<MobilityModel> mobility);
+  /**
+   * \return the number of items
+   */
+  uint32_t GetN (void) const;
+
+  /**
+   * \brief find the items which may be within a distance of a position
+   * \param position the position
+   * \param range the distance in meters, infinite to return every item
+   * \param items the ids found, in increasing order
+   */
+  void Find (const Vector &position, double range, std::vector<uint32_t> *items);
+
+  /**
+   * \return the number of times the whole grid was rebuilt
+   */
+  uint32_t GetNRebuilds (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// a cell, as the x and y indices
+  typedef std::pair<int64_t, int64_t> Cell;
+  /// the items of the occupied cells
+  typedef std::map<Cell, std::vector<uint32_t> > CellMap;
+
+  /**
+   * \param position a position
+   * \return the cell of the position
+   */
+  Cell GetCell (const Vector &position) const;
+  /**
+   * \brief move an item to the cell of its current position
+   * \param id the item
+   */
+  void Place (uint32_t id);
+  /**
+   * \brief place every item again and restart the drift bound
+   */
+  void Rebuild (void);
+  /**
+   * \brief trace sink of the CourseChange of the items
+   * \param mobility the mobility model whose course changed
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+
+  double m_cellSize;                           //!< side of the cells
+  std::vector<Ptr<MobilityModel> > m_items;    //!< mobility model of each item
+  std::vector<Cell> m_cellOf;                  //!< current cell of each placed item
+  std::vector<bool> m_placed;                  //!< whether the item is in m_cells
+  std::map<const MobilityModel *, uint32_t> m_ids; //!< item of each mobility model
+  std::vector<uint32_t> m_unplaced;            //!< items without mobility model
+  CellMap m_cells;                             //!< the occupied cells
+  Time m_built;                                //!< time of the last rebuild
+  double m_maxSpeed;                           //!< largest speed since the last rebuild
+  bool m_dirty;                                //!< whether a full rebuild is needed
+  uint32_t m_nRebuilds;                        //!< number of rebuilds
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_GRID_INDEX_H */
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/rectangle.h"
+#include "ns3/node-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/spatial-grid-index.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Check that the queries of a SpatialGridIndex over moving nodes always
+ * return every item within range, and only a fraction of all the items.
+ */
+class SpatialGridIndexTestCase : public TestCase
+{
+public:
+  SpatialGridIndexTestCase ();
+  virtual ~SpatialGridIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Query around every node and compare with the exact distances
+   */
+  void Check (void);
+
+  NodeContainer m_nodes;
+  Ptr<SpatialGridIndex> m_index;
+  uint32_t m_found;
+  uint32_t m_queried;
+};
+
+SpatialGridIndexTestCase::SpatialGridIndexTestCase ()
+  : TestCase ("SpatialGridIndex queries are a superset of the nodes in range")
+{
+}
+
+SpatialGridIndexTestCase::~SpatialGridIndexTestCase ()
+{
+}
+
+void
+SpatialGridIndexTestCase::Check (void)
+{
+  double range = 100;
+  std::vector<uint32_t> items;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Vector position = m_nodes.Get (i)->GetObject<MobilityModel> ()->GetPosition ();
+      m_index->Find (position, range, &items);
+      NS_TEST_ASSERT_MSG_EQ (std::is_sorted (items.begin (), items.end ()), true, "items not sorted");
+      for (uint32_t j = 0; j < m_nodes.GetN (); j++)
+        {
+          Vector other = m_nodes.Get (j)->GetObject<MobilityModel> ()->GetPosition ();
+          if (std::sqrt ((other.x - position.x) * (other.x - position.x)
+                         + (other.y - position.y) * (other.y - position.y)) <= range)
+            {
+              NS_TEST_ASSERT_MSG_EQ (std::binary_search (items.begin (), items.end (), j), true,
+                                     "node " << j << " in range of node " << i << " not found");
+            }
+        }
+      m_found += items.size ();
+      m_queried += m_nodes.GetN ();
+    }
+}
+
+void
+SpatialGridIndexTestCase::DoRun (void)
+{
+  m_nodes.Create (200);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                 "X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=2000.0]"),
+                                 "Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=2000.0]"));
+  // changes direction every 20 m, crosses a cell every 2.5 s
+  mobility.SetMobilityModel ("ns3::RandomWalk2dMobilityModel",
+                             "Bounds", RectangleValue (Rectangle (0.0, 2000.0, 0.0, 2000.0)),
+                             "Distance", DoubleValue (20.0),
+                             "Speed", StringValue ("ns3::ConstantRandomVariable[Constant=20.0]"));
+  mobility.Install (m_nodes);
+  mobility.AssignStreams (m_nodes, 0);
+
+  m_index = CreateObject<SpatialGridIndex> ();
+  m_index->SetCellSize (50);
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_index->Add (m_nodes.Get (i)->GetObject<MobilityModel> ()), i, "unexpected id");
+    }
+  m_found = 0;
+  m_queried = 0;
+  for (double t = 0; t < 20; t += 0.7)
+    {
+      Simulator::Schedule (Seconds (t), &SpatialGridIndexTestCase::Check, this);
+    }
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_index->GetNRebuilds (), 1, "the grid was never rebuilt");
+  NS_TEST_ASSERT_MSG_LT (m_found, m_queried / 4, "queries return too many items");
+
+  m_index->Dispose ();
+  m_index = 0;
+  Simulator::Destroy ();
+}
+
+static class SpatialGridIndexTestSuite : public TestSuite
+{
+public:
+  SpatialGridIndexTestSuite ()
+    : TestSuite ("spatial-grid-index", UNIT)
+  {
+    AddTestCase (new SpatialGridIndexTestCase (), TestCase::QUICK);
+  }
+} g_spatialGridIndexTestSuite;
@@ -78,7 +78,10 @@ AnimationInterface::AnimationInterface (const std::string fn)
     m_routingStopTime (Seconds (0)), 
     m_routingFileName (""),
     m_routingPollInterval (Seconds (5)), 
-    m_trackPackets (true)
+    m_trackPackets (true),
+    m_outputBufferSize (1 << 20),
+    m_packetSamplingInterval (1),
+    m_packetSamplingCount (0)
 {
   initialized = true;
   StartAnimation ();
@@ -224,6 +227,58 @@ AnimationInterface::SetMaxPktsPerTraceFile (uint64_t maxPacketsPerFile)
   m_maxPktsPerFile = maxPacketsPerFile;
 }
 
+void
+AnimationInterface::SetOutputBufferSize (uint32_t bytes)
+{
+  m_outputBufferSize = bytes;
+  if (m_outputBuffer.size () >= m_outputBufferSize)
+    {
+      FlushOutput (m_f);
+    }
+  if (m_routingOutputBuffer.size () >= m_outputBufferSize)
+    {
+      FlushOutput (m_routingF);
+    }
+}
+
+void
+AnimationInterface::SetPacketSampling (uint32_t interval)
+{
+  NS_ASSERT (interval > 0);
+  m_packetSamplingInterval = interval;
+}
+
+void
+AnimationInterface::SetNodeFilter (NodeContainer nc)
+{
+  m_nodeFilter.clear ();
+  for (NodeContainer::Iterator i = nc.Begin (); i != nc.End (); ++i)
+    {
+      uint32_t nodeId = (*i)->GetId ();
+      if (nodeId >= m_nodeFilter.size ())
+        {
+          m_nodeFilter.resize (nodeId + 1, false);
+        }
+      m_nodeFilter[nodeId] = true;
+    }
+}
+
+bool
+AnimationInterface::IsNodeSelected (uint32_t nodeId)
+{
+  return m_nodeFilter.empty () || (nodeId < m_nodeFilter.size () && m_nodeFilter[nodeId]);
+}
+
+bool
+AnimationInterface::SelectPacket (uint32_t fromId, uint32_t toId)
+{
+  if (!IsNodeSelected (fromId) && !IsNodeSelected (toId))
+    {
+      return false;
+    }
+  return (m_packetSamplingCount++ % m_packetSamplingInterval) == 0;
+}
+
 uint32_t 
 AnimationInterface::AddNodeCounter (std::string counterName, CounterType counterType)
 {
@@ -461,6 +516,10 @@ AnimationInterface::GetMovedNodes ()
     {
       Ptr<Node> n = *i;
       NS_ASSERT (n);
+      if (!IsNodeSelected (n->GetId ()))
+        {
+          continue;
+        }
       Ptr <MobilityModel> mobility = n->GetObject <MobilityModel> ();
       Vector newLocation;
       if (!mobility)
@@ -495,7 +554,25 @@ AnimationInterface::WriteN (const std::string& st, FILE * f)
     {
       m_writeCallback (st.c_str ());
     }
-  return WriteN (st.c_str (), st.length (), f);
+  std::string &buffer = (f == m_routingF) ? m_routingOutputBuffer : m_outputBuffer;
+  buffer += st;
+  if (buffer.size () >= m_outputBufferSize)
+    {
+      FlushOutput (f);
+    }
+  return st.length ();
+}
+
+void
+AnimationInterface::FlushOutput (FILE * f)
+{
+  if (!f)
+    {
+      return;
+    }
+  std::string &buffer = (f == m_routingF) ? m_routingOutputBuffer : m_outputBuffer;
+  WriteN (buffer.c_str (), buffer.length (), f);
+  buffer.clear ();
 }
 
 int 
@@ -747,6 +824,10 @@ AnimationInterface::DevTxTrace (std::string context,
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
   NS_ASSERT (tx);
   NS_ASSERT (rx);
+  if (!SelectPacket (tx->GetNode ()->GetId (), rx->GetNode ()->GetId ()))
+    {
+      return;
+    }
   Time now = Simulator::Now ();
   double fbTx = now.GetSeconds ();
   double lbTx = (now + txTime).GetSeconds ();
@@ -926,8 +1007,8 @@ AnimationInterface::LteSpectrumPhyTxStart (std::string context, Ptr<const Packet
       NS_LOG_INFO ("LteSpectrumPhyTxTrace for packet:" << gAnimUid);
       AnimPacketInfo pktInfo (ndev, Simulator::Now ());
       AddByteTag (gAnimUid, p);
-      AddPendingPacket (AnimationInterface::LTE, gAnimUid, pktInfo);
       OutputWirelessPacketTxInfo (p, pktInfo, gAnimUid);
+      AddPendingPacket (AnimationInterface::LTE, gAnimUid, pktInfo);
     }
 }
 
@@ -1051,7 +1132,6 @@ AnimationInterface::CsmaMacRxTrace (std::string context,
 void
 AnimationInterface::OutputWirelessPacketTxInfo (Ptr<const Packet> p, AnimPacketInfo &pktInfo, uint64_t animUid)
 {
-  CheckMaxPktsPerTraceFile ();
   uint32_t nodeId = 0;
   if (pktInfo.m_txnd)
     {
@@ -1061,12 +1141,22 @@ AnimationInterface::OutputWirelessPacketTxInfo (Ptr<const Packet> p, AnimPacketI
     {
       nodeId = pktInfo.m_txNodeId;
     }
+  pktInfo.m_selected = SelectPacket (nodeId, nodeId);
+  if (!pktInfo.m_selected)
+    {
+      return;
+    }
+  CheckMaxPktsPerTraceFile ();
   WriteXmlPRef (animUid, nodeId, pktInfo.m_fbTx, m_enablePacketMetadata? GetPacketMetadata (p):"");
 }
 
 void 
 AnimationInterface::OutputWirelessPacketRxInfo (Ptr<const Packet> p, AnimPacketInfo & pktInfo, uint64_t animUid)
 {
+  if (!pktInfo.m_selected)
+    {
+      return;
+    }
   CheckMaxPktsPerTraceFile ();
   uint32_t rxId = pktInfo.m_rxnd->GetNode ()->GetId ();
   WriteXmlP (animUid, "wpr", rxId, pktInfo.m_fbRx, pktInfo.m_lbRx);
@@ -1075,10 +1165,14 @@ AnimationInterface::OutputWirelessPacketRxInfo (Ptr<const Packet> p, AnimPacketI
 void 
 AnimationInterface::OutputCsmaPacket (Ptr<const Packet> p, AnimPacketInfo &pktInfo)
 {
-  CheckMaxPktsPerTraceFile ();
   NS_ASSERT (pktInfo.m_txnd);
   uint32_t nodeId = pktInfo.m_txnd->GetNode ()->GetId ();
   uint32_t rxId = pktInfo.m_rxnd->GetNode ()->GetId ();
+  if (!SelectPacket (nodeId, rxId))
+    {
+      return;
+    }
+  CheckMaxPktsPerTraceFile ();
 
   WriteXmlP ("p", 
              nodeId, 
@@ -1255,6 +1349,7 @@ AnimationInterface::StopAnimation (bool onlyAnimation)
     {
       // Terminate the anim element
       WriteXmlClose ("anim");
+      FlushOutput (m_f);
       std::fclose (m_f);
       m_f = 0;
     }
@@ -1265,6 +1360,7 @@ AnimationInterface::StopAnimation (bool onlyAnimation)
   if (m_routingF)
     {
       WriteXmlClose ("anim", true);
+      FlushOutput (m_routingF);
       std::fclose (m_routingF);
       m_routingF = 0;
     }
@@ -2205,6 +2301,10 @@ AnimationInterface::WriteXmlUpdateNodeSize (uint32_t nodeId, double width, doubl
 void 
 AnimationInterface::WriteXmlUpdateNodePosition (uint32_t nodeId, double x, double y)
 {
+  if (!IsNodeSelected (nodeId))
+    {
+      return;
+    }
   AnimXmlElement element ("nu");
   element.AddAttribute ("p", "p");
   element.AddAttribute ("t", Simulator::Now ().GetSeconds ());
@@ -2248,6 +2348,10 @@ AnimationInterface::WriteXmlUpdateNodeDescription (uint32_t nodeId)
 void 
 AnimationInterface::WriteXmlUpdateNodeCounter (uint32_t nodeCounterId, uint32_t nodeId, double counterValue)
 {
+  if (!IsNodeSelected (nodeId))
+    {
+      return;
+    }
   AnimXmlElement element ("nc");
   element.AddAttribute ("c", nodeCounterId);
   element.AddAttribute ("i", nodeId);
@@ -2443,7 +2547,8 @@ AnimationInterface::AnimPacketInfo::AnimPacketInfo ()
     m_txNodeId (0),
     m_fbTx (0), 
     m_lbTx (0), 
-    m_lbRx (0)
+    m_lbRx (0),
+    m_selected (true)
 {
 }
 
@@ -2454,6 +2559,9 @@ AnimationInterface::AnimPacketInfo::AnimPacketInfo (const AnimPacketInfo & pInfo
   m_fbTx = pInfo.m_fbTx;
   m_lbTx = pInfo.m_lbTx;
   m_lbRx = pInfo.m_lbRx;
+  m_fbRx = pInfo.m_fbRx;
+  m_rxnd = pInfo.m_rxnd;
+  m_selected = pInfo.m_selected;
 }
 
 AnimationInterface::AnimPacketInfo::AnimPacketInfo (Ptr <const NetDevice> txnd, 
@@ -2463,7 +2571,8 @@ AnimationInterface::AnimPacketInfo::AnimPacketInfo (Ptr <const NetDevice> txnd,
     m_txNodeId (0),
     m_fbTx (fbTx.GetSeconds ()), 
     m_lbTx (0), 
-    m_lbRx (0)
+    m_lbRx (0),
+    m_selected (true)
 {
   if (!m_txnd)
     m_txNodeId = txNodeId;
@@ -210,6 +210,42 @@ public:
    */
   void SetMaxPktsPerTraceFile (uint64_t maxPktsPerFile);
 
+  /**
+   * \brief Set the size of the output buffers
+   * \param bytes The number of bytes of XML collected before they are written
+   *        to the trace file (and to the routing trace file). 0 writes every
+   *        element as soon as it is produced.
+   *
+   * The buffers are flushed when the trace files are closed.
+   *
+   * \returns none
+   */
+  void SetOutputBufferSize (uint32_t bytes);
+
+  /**
+   * \brief Trace one packet out of every interval packets
+   * \param interval The sampling interval, 1 traces every packet
+   *
+   * Wireless packets are sampled when transmitted, so the receptions of a
+   * sampled transmission are all traced and the others are not.
+   *
+   * \returns none
+   */
+  void SetPacketSampling (uint32_t interval);
+
+  /**
+   * \brief Only write the events of some nodes
+   * \param nc The nodes to trace
+   *
+   * Point-to-point and CSMA packets are written when their transmitter or
+   * their receiver is one of these nodes, wireless packets when their
+   * transmitter is. Position and counter updates of the other nodes are not
+   * written either. The topology itself is always written completely.
+   *
+   * \returns none
+   */
+  void SetNodeFilter (NodeContainer nc);
+
   /**
    * \brief Set mobility poll interval:WARNING: setting a low interval can 
    * cause slowness
@@ -437,6 +473,7 @@ private:
     double m_fbRx;            
     double m_lbRx;
     Ptr <const NetDevice> m_rxnd;
+    bool m_selected; // false if the packet was filtered out at transmission
     void ProcessRxBegin (Ptr <const NetDevice> nd, const double fbRx);
   };
 
@@ -565,6 +602,12 @@ private:
   Time m_wifiPhyCountersPollInterval;
   static Rectangle * userBoundary;
   bool m_trackPackets;
+  uint32_t m_outputBufferSize;
+  std::string m_outputBuffer; // XML not yet written to m_f
+  std::string m_routingOutputBuffer; // XML not yet written to m_routingF
+  uint32_t m_packetSamplingInterval;
+  uint64_t m_packetSamplingCount;
+  std::vector <bool> m_nodeFilter; // indexed by node Id, empty to trace every node
 
   // Counter ID
   uint32_t m_remainingEnergyCounterId;
@@ -630,6 +673,9 @@ private:
   void AddByteTag (uint64_t animUid, Ptr<const Packet> p);
   int WriteN (const char*, uint32_t, FILE * f);
   int WriteN (const std::string&, FILE * f);
+  void FlushOutput (FILE * f);
+  bool IsNodeSelected (uint32_t nodeId);
+  bool SelectPacket (uint32_t fromId, uint32_t toId);
   std::string GetMacAddress (Ptr <NetDevice> nd);
   std::string GetIpv4Address (Ptr <NetDevice> nd);
   std::string GetNetAnimVersion ();
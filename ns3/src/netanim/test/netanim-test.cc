@@ -61,6 +61,9 @@ private:
   virtual void
   PrepareNetwork () = 0;
 
+  virtual void
+  ConfigureAnimation ();
+
   virtual void
   CheckLogic () = 0;
 
@@ -86,6 +89,7 @@ AbstractAnimationInterfaceTestCase::DoRun (void)
   PrepareNetwork ();
 
   m_anim = new AnimationInterface (m_traceFileName);
+  ConfigureAnimation ();
 
   Simulator::Run ();
   CheckLogic ();
@@ -93,6 +97,11 @@ AbstractAnimationInterfaceTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+void
+AbstractAnimationInterfaceTestCase::ConfigureAnimation ()
+{
+}
+
 void
 AbstractAnimationInterfaceTestCase::CheckFileExistence ()
 {
@@ -169,6 +178,87 @@ AnimationInterfaceTestCase::CheckLogic (void)
   NS_TEST_ASSERT_MSG_EQ (m_anim->GetTracePktCount (), 16, "Expected 16 packets traced");
 }
 
+class AnimationFilterTestCase : public AbstractAnimationInterfaceTestCase
+{
+public:
+  /**
+   * \brief Constructor.
+   */
+  AnimationFilterTestCase ();
+
+private:
+
+  virtual void
+  PrepareNetwork ();
+
+  virtual void
+  ConfigureAnimation ();
+
+  virtual void
+  CheckLogic ();
+
+};
+
+AnimationFilterTestCase::AnimationFilterTestCase () :
+  AbstractAnimationInterfaceTestCase ("Verify packet sampling and node filtering")
+{
+}
+
+void
+AnimationFilterTestCase::PrepareNetwork (void)
+{
+  // two separate echo sessions, 0 -> 1 and 2 -> 3
+  m_nodes.Create (4);
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      AnimationInterface::SetConstantPosition (m_nodes.Get (i), i, 10);
+    }
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  InternetStackHelper stack;
+  stack.Install (m_nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  for (uint32_t i = 0; i < 4; i += 2)
+    {
+      NetDeviceContainer devices = pointToPoint.Install (m_nodes.Get (i), m_nodes.Get (i + 1));
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      address.NewNetwork ();
+
+      UdpEchoServerHelper echoServer (9);
+      ApplicationContainer serverApps = echoServer.Install (m_nodes.Get (i + 1));
+      serverApps.Start (Seconds (1.0));
+      serverApps.Stop (Seconds (10.0));
+
+      UdpEchoClientHelper echoClient (interfaces.GetAddress (1), 9);
+      echoClient.SetAttribute ("MaxPackets", UintegerValue (100));
+      echoClient.SetAttribute ("Interval", TimeValue (Seconds (1.0)));
+      echoClient.SetAttribute ("PacketSize", UintegerValue (1024));
+      ApplicationContainer clientApps = echoClient.Install (m_nodes.Get (i));
+      clientApps.Start (Seconds (2.0));
+      clientApps.Stop (Seconds (10.0));
+    }
+}
+
+void
+AnimationFilterTestCase::ConfigureAnimation (void)
+{
+  m_anim->SetOutputBufferSize (256);
+  m_anim->SetNodeFilter (NodeContainer (m_nodes.Get (1)));
+  m_anim->SetPacketSampling (2);
+}
+
+void
+AnimationFilterTestCase::CheckLogic (void)
+{
+  // the 16 packets of the first session, one in two
+  NS_TEST_ASSERT_MSG_EQ (m_anim->GetTracePktCount (), 8, "Expected 8 packets traced");
+}
+
 class AnimationRemainingEnergyTestCase : public AbstractAnimationInterfaceTestCase
 {
 public:
@@ -235,6 +325,7 @@ public:
     TestSuite ("animation-interface", UNIT)
   {
     AddTestCase (new AnimationInterfaceTestCase (), TestCase::QUICK);
+    AddTestCase (new AnimationFilterTestCase (), TestCase::QUICK);
     AddTestCase (new AnimationRemainingEnergyTestCase (), TestCase::QUICK);
   }
 } g_animationInterfaceTestSuite;
@@ -195,6 +195,14 @@ public:
    */
   void Add (std::string deviceName);
 
+  /**
+   * \brief Reserve room for a number of devices, so that adding them one
+   * by one does not reallocate the container.
+   *
+   * \param n The total number of devices the container will hold.
+   */
+  void Reserve (uint32_t n);
+
 private:
   std::vector<Ptr<NetDevice> > m_devices; //!< NetDevices smart pointers
 };
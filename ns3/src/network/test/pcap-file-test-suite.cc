@@ -25,6 +25,10 @@
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -1121,6 +1125,100 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+// ===========================================================================
+// Test case to make sure that the asynchronous mode of PcapFileWrapper
+// truncates, samples and rotates the capture.
+// ===========================================================================
+class AsyncWriteTestCase : public TestCase
+{
+public:
+  AsyncWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;
+  std::string m_rotatedFilename;
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase ()
+  : TestCase ("Check that PcapFileWrapper writes truncated, sampled and rotated files asynchronously")
+{
+}
+
+void
+AsyncWriteTestCase::DoTeardown (void)
+{
+  remove (m_testFilename.c_str ());
+  remove (m_rotatedFilename.c_str ());
+}
+
+void
+AsyncWriteTestCase::DoRun (void)
+{
+  m_testFilename = CreateTempDirFilename ("async.pcap");
+  m_rotatedFilename = CreateTempDirFilename ("async-1.pcap");
+
+  //
+  // 20 packets of 1000 bytes, one in two is kept, 40 bytes are captured:
+  // records of 56 bytes, three per file in a ring of two files.  The
+  // buffer holds less than two records, so it is handed over often.
+  //
+  Ptr<PcapFileWrapper> f = CreateObject<PcapFileWrapper> ();
+  f->SetAttribute ("Asynchronous", BooleanValue (true));
+  f->SetAttribute ("CaptureSize", UintegerValue (40));
+  f->SetAttribute ("SampleInterval", UintegerValue (2));
+  f->SetAttribute ("BufferSize", UintegerValue (100));
+  f->SetAttribute ("MaxFileSize", UintegerValue (24 + 3 * 56));
+  f->SetAttribute ("MaxFiles", UintegerValue (2));
+  f->Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f->Fail (), false, "Open (" << m_testFilename << ", \"std::ios::out\") returns error");
+  f->Init (1);
+
+  uint8_t data[1000];
+  for (uint32_t i = 0; i < 20; ++i)
+    {
+      for (uint32_t j = 0; j < sizeof (data); ++j)
+        {
+          data[j] = i + j;
+        }
+      f->Write (MilliSeconds (i), Create<Packet> (data, sizeof (data)));
+    }
+  f->Close ();
+
+  //
+  // The first file was overwritten by records 6 to 8 (packets 12, 14, 16),
+  // the second one holds the last record (packet 18).
+  //
+  NS_TEST_ASSERT_MSG_EQ (CheckFileLength (m_testFilename, 24 + 3 * 56), true, "wrong size of " << m_testFilename);
+  NS_TEST_ASSERT_MSG_EQ (CheckFileLength (m_rotatedFilename, 24 + 56), true, "wrong size of " << m_rotatedFilename);
+
+  std::string filenames[2] = { m_testFilename, m_rotatedFilename };
+  uint32_t firstPacket[2] = { 12, 18 };
+  uint32_t nRecords[2] = { 3, 1 };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      PcapFile r;
+      r.Open (filenames[i], std::ios::in);
+      NS_TEST_ASSERT_MSG_EQ (r.Fail (), false, "Open (" << filenames[i] << ", \"std::ios::in\") returns error");
+      NS_TEST_ASSERT_MSG_EQ (r.GetSnapLen (), 40, "wrong snaplen in " << filenames[i]);
+      for (uint32_t k = 0; k < nRecords[i]; ++k)
+        {
+          uint8_t buffer[64];
+          uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+          r.Read (buffer, sizeof (buffer), tsSec, tsUsec, inclLen, origLen, readLen);
+          NS_TEST_ASSERT_MSG_EQ (r.Fail (), false, "Read () of " << filenames[i] << " returns error");
+          uint32_t packet = firstPacket[i] + 2 * k;
+          NS_TEST_EXPECT_MSG_EQ (tsUsec, packet * 1000, "wrong timestamp");
+          NS_TEST_EXPECT_MSG_EQ (inclLen, 40, "packet not truncated to the capture size");
+          NS_TEST_EXPECT_MSG_EQ (origLen, 1000, "wrong original length");
+          NS_TEST_EXPECT_MSG_EQ ((uint32_t)buffer[39], ((packet + 39) & 0xff), "wrong packet data");
+        }
+      r.Close ();
+    }
+}
+
 class PcapFileTestSuite : public TestSuite
 {
 public:
@@ -1138,6 +1236,7 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncWriteTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite;
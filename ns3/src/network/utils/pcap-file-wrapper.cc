@@ -16,17 +16,304 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <sstream>
 #include "ns3/log.h"
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
+#include "ns3/fatal-error.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#endif
 #include "pcap-file-wrapper.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PcapFileWrapper");
 
+/**
+ * \brief background writer shared by the asynchronous pcap files
+ *
+ * Buffers are appended to their file in submission order.  The thread
+ * is started by the first asynchronous file and stopped when the last
+ * one is closed.  Without thread support, buffers are written at once.
+ */
+class PcapAsyncWriter
+{
+public:
+  /**
+   * \return the writer
+   */
+  static PcapAsyncWriter * Get (void);
+  /**
+   * \brief register a file, starting the thread if needed
+   */
+  void Open (void);
+  /**
+   * \brief queue a buffer, waiting if too much data is pending
+   * \param filename the file
+   * \param truncate whether the file must be created
+   * \param close whether it is the last buffer of the file
+   * \param data the buffer, emptied on return
+   */
+  void Submit (std::string const &filename, bool truncate, bool close, std::vector<uint8_t> &data);
+  /**
+   * \brief wait until every queued buffer is written
+   */
+  void Drain (void);
+  /**
+   * \brief unregister a file, stopping the thread after the last one
+   */
+  void Close (void);
+
+private:
+  PcapAsyncWriter ();
+
+  /// a buffer to append to a file
+  struct Job
+  {
+    std::string filename;       //!< the file
+    bool truncate;              //!< create the file first
+    bool close;                 //!< close the file after
+    std::vector<uint8_t> data;  //!< the records
+  };
+
+  /**
+   * \brief write a buffer to its file
+   * \param job the buffer
+   */
+  void Write (Job &job);
+  /**
+   * \brief wait until at most limit bytes are pending
+   * \param limit the number of bytes
+   */
+  void WaitPending (uint64_t limit);
+
+  static const uint64_t MAX_PENDING = 256 << 20; //!< backpressure threshold
+
+  std::map<std::string, std::ofstream *> m_files; //!< open files
+  uint32_t m_users;                 //!< open asynchronous files
+#ifdef HAVE_PTHREAD_H
+  /**
+   * \brief the thread body
+   */
+  void Run (void);
+
+  std::deque<Job> m_jobs;           //!< queued buffers
+  uint64_t m_pending;               //!< bytes queued or being written
+  bool m_stop;                      //!< the thread must exit when idle
+  SystemMutex m_mutex;              //!< protects the queue
+  SystemCondition m_work;           //!< set when a buffer is queued
+  SystemCondition m_done;           //!< set when a buffer is written
+  Ptr<SystemThread> m_thread;       //!< the writer thread
+#endif
+};
+
+PcapAsyncWriter *
+PcapAsyncWriter::Get (void)
+{
+  // never deleted, the thread may outlive static destructors otherwise
+  static PcapAsyncWriter *writer = new PcapAsyncWriter ();
+  return writer;
+}
+
+PcapAsyncWriter::PcapAsyncWriter ()
+  : m_users (0)
+#ifdef HAVE_PTHREAD_H
+  , m_pending (0),
+  m_stop (false)
+#endif
+{
+}
+
+void
+PcapAsyncWriter::Open (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_users++ > 0)
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  m_stop = false;
+  m_thread = Create<SystemThread> (MakeCallback (&PcapAsyncWriter::Run, this));
+  m_thread->Start ();
+#endif
+}
+
+void
+PcapAsyncWriter::Submit (std::string const &filename, bool truncate, bool close, std::vector<uint8_t> &data)
+{
+  NS_LOG_FUNCTION (this << filename << truncate << close << data.size ());
+#ifdef HAVE_PTHREAD_H
+  WaitPending (MAX_PENDING);
+  {
+    CriticalSection cs (m_mutex);
+    m_jobs.push_back (Job ());
+    Job &job = m_jobs.back ();
+    job.filename = filename;
+    job.truncate = truncate;
+    job.close = close;
+    job.data.swap (data);
+    m_pending += job.data.size () + 1;
+  }
+  m_work.SetCondition (true);
+  m_work.Signal ();
+#else
+  Job job;
+  job.filename = filename;
+  job.truncate = truncate;
+  job.close = close;
+  job.data.swap (data);
+  Write (job);
+#endif
+}
+
+void
+PcapAsyncWriter::Drain (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  WaitPending (0);
+#endif
+}
+
+void
+PcapAsyncWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_users > 0);
+  Drain ();
+  if (--m_users > 0)
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  {
+    CriticalSection cs (m_mutex);
+    m_stop = true;
+  }
+  m_work.SetCondition (true);
+  m_work.Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+#endif
+}
+
+void
+PcapAsyncWriter::Write (Job &job)
+{
+  std::map<std::string, std::ofstream *>::iterator it = m_files.find (job.filename);
+  if (it == m_files.end () || job.truncate)
+    {
+      if (it != m_files.end ())
+        {
+          delete it->second;
+        }
+      std::ios::openmode mode = std::ios::out | std::ios::binary;
+      mode |= job.truncate ? std::ios::trunc : std::ios::app;
+      it = m_files.insert (std::make_pair (job.filename, (std::ofstream *)0)).first;
+      it->second = new std::ofstream (job.filename.c_str (), mode);
+    }
+  if (!job.data.empty ())
+    {
+      it->second->write ((const char *)&job.data[0], job.data.size ());
+    }
+  if (it->second->fail ())
+    {
+      NS_FATAL_ERROR ("Unable to write " << job.filename);
+    }
+  if (job.close)
+    {
+      delete it->second;
+      m_files.erase (it);
+    }
+}
+
+#ifdef HAVE_PTHREAD_H
+void
+PcapAsyncWriter::WaitPending (uint64_t limit)
+{
+  while (true)
+    {
+      {
+        CriticalSection cs (m_mutex);
+        if (m_pending <= limit)
+          {
+            return;
+          }
+        m_done.SetCondition (false);
+      }
+      // the timeout bounds the cost of a wakeup lost between the check and the wait
+      m_done.TimedWait (1000000);
+    }
+}
+
+void
+PcapAsyncWriter::Run (void)
+{
+  while (true)
+    {
+      Job job;
+      bool found = false;
+      {
+        CriticalSection cs (m_mutex);
+        if (!m_jobs.empty ())
+          {
+            job.filename = m_jobs.front ().filename;
+            job.truncate = m_jobs.front ().truncate;
+            job.close = m_jobs.front ().close;
+            job.data.swap (m_jobs.front ().data);
+            m_jobs.pop_front ();
+            found = true;
+          }
+        else if (m_stop)
+          {
+            return;
+          }
+        else
+          {
+            m_work.SetCondition (false);
+          }
+      }
+      if (!found)
+        {
+          m_work.TimedWait (1000000);
+          continue;
+        }
+      Write (job);
+      {
+        CriticalSection cs (m_mutex);
+        m_pending -= job.data.size () + 1;
+      }
+      m_done.SetCondition (true);
+      m_done.Signal ();
+    }
+}
+#endif
+
+/**
+ * \brief append a little endian integer, the byte order of ns-3 pcap files
+ * \param buffer the buffer
+ * \param value the value
+ * \param size the number of bytes
+ */
+static void
+AppendLittleEndian (uint8_t *buffer, uint32_t value, uint32_t size)
+{
+  for (uint32_t i = 0; i < size; i++)
+    {
+      buffer[i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED (PcapFileWrapper);
 
 TypeId 
@@ -46,12 +333,45 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("Asynchronous",
+                   "Whether files opened for writing are written by a background thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_async),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BufferSize",
+                   "Size in bytes of the buffers handed to the background thread.",
+                   UintegerValue (4 << 20),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("SampleInterval",
+                   "Capture one packet in every SampleInterval packets.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_sampleInterval),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxFileSize",
+                   "In asynchronous mode, continue in the next file of the ring "
+                   "beyond this size in bytes, 0 to never rotate.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_maxFileSize),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("MaxFiles",
+                   "Number of files in the rotation ring, the oldest is overwritten; "
+                   "0 for no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_maxFiles),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_nPackets (0),
+    m_asyncOpen (false),
+    m_truncate (false),
+    m_fileIndex (0),
+    m_captureLen (0),
+    m_fileBytes (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -86,14 +406,48 @@ void
 PcapFileWrapper::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_asyncOpen)
+    {
+      Submit (true);
+      m_asyncOpen = false;
+      PcapAsyncWriter::Get ()->Close ();
+    }
   m_file.Close ();
 }
 
+void
+PcapFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_asyncOpen)
+    {
+      Submit (false);
+      PcapAsyncWriter::Get ()->Drain ();
+    }
+}
+
 void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
+  if (m_asyncOpen)
+    {
+      Close ();
+    }
   m_file.Open (filename, mode);
+  // the file header is written by Init, the records by the writer thread
+  m_asyncOpen = m_async && (mode & std::ios::out) && !(mode & std::ios::in) && !m_file.Fail ();
+  if (m_asyncOpen)
+    {
+      m_filename = filename;
+      m_current = filename;
+      m_truncate = false;
+      m_fileIndex = 0;
+      m_fileBytes = 0;
+      m_buffer.clear ();
+      m_fileHeader.clear ();
+      PcapAsyncWriter::Get ()->Open ();
+    }
 }
 
 void
@@ -113,12 +467,137 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
     {
       m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
     } 
+  if (m_asyncOpen)
+    {
+      // keep the header for the rotated files, the writer appends to this one
+      m_captureLen = m_file.GetSnapLen ();
+      m_fileHeader.resize (24);
+      uint8_t *h = &m_fileHeader[0];
+      AppendLittleEndian (h, m_file.GetMagic (), 4);
+      AppendLittleEndian (h + 4, m_file.GetVersionMajor (), 2);
+      AppendLittleEndian (h + 6, m_file.GetVersionMinor (), 2);
+      AppendLittleEndian (h + 8, m_file.GetTimeZoneOffset (), 4);
+      AppendLittleEndian (h + 12, m_file.GetSigFigs (), 4);
+      AppendLittleEndian (h + 16, m_captureLen, 4);
+      AppendLittleEndian (h + 20, m_file.GetDataLinkType (), 4);
+      m_fileBytes = m_fileHeader.size ();
+      m_file.Close ();
+    }
+}
+
+bool
+PcapFileWrapper::Sample (void)
+{
+  return m_nPackets++ % m_sampleInterval == 0;
+}
+
+uint8_t *
+PcapFileWrapper::AppendRecord (Time t, uint32_t origLen, uint32_t &inclLen)
+{
+  inclLen = std::min (origLen, m_captureLen);
+  uint32_t size = 16 + inclLen;
+  if (m_maxFileSize > 0 && m_fileBytes > m_fileHeader.size () && m_fileBytes + size > m_maxFileSize)
+    {
+      Rotate ();
+    }
+  if (!m_buffer.empty () && m_buffer.size () + size > m_bufferSize)
+    {
+      Submit (false);
+    }
+  if (m_buffer.capacity () == 0)
+    {
+      m_buffer.reserve (m_bufferSize);
+    }
+
+  uint64_t s, sub;
+  if (m_file.IsNanoSecMode ())
+    {
+      uint64_t current = t.GetNanoSeconds ();
+      s = current / 1000000000;
+      sub = current % 1000000000;
+    }
+  else
+    {
+      uint64_t current = t.GetMicroSeconds ();
+      s = current / 1000000;
+      sub = current % 1000000;
+    }
+  uint32_t offset = m_buffer.size ();
+  m_buffer.resize (offset + size);
+  uint8_t *h = &m_buffer[offset];
+  AppendLittleEndian (h, s, 4);
+  AppendLittleEndian (h + 4, sub, 4);
+  AppendLittleEndian (h + 8, inclLen, 4);
+  AppendLittleEndian (h + 12, origLen, 4);
+  m_fileBytes += size;
+  return h + 16;
+}
+
+void
+PcapFileWrapper::Submit (bool close)
+{
+  NS_LOG_FUNCTION (this << close);
+  if (m_buffer.empty () && !close && !m_truncate)
+    {
+      return;
+    }
+  PcapAsyncWriter::Get ()->Submit (m_current, m_truncate, close, m_buffer);
+  m_truncate = false;
+}
+
+void
+PcapFileWrapper::Rotate (void)
+{
+  NS_LOG_FUNCTION (this);
+  Submit (true);
+  m_fileIndex++;
+  if (m_maxFiles > 0)
+    {
+      m_fileIndex %= m_maxFiles;
+    }
+  m_current = GetRotatedFilename (m_fileIndex);
+  m_truncate = true;
+  m_buffer = m_fileHeader;
+  m_fileBytes = m_fileHeader.size ();
+}
+
+std::string
+PcapFileWrapper::GetRotatedFilename (uint32_t index) const
+{
+  if (index == 0)
+    {
+      return m_filename;
+    }
+  // file.pcap, file-1.pcap, file-2.pcap...
+  std::ostringstream oss;
+  std::string::size_type dot = m_filename.rfind ('.');
+  std::string::size_type slash = m_filename.rfind ('/');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+      oss << m_filename << "-" << index;
+    }
+  else
+    {
+      oss << m_filename.substr (0, dot) << "-" << index << m_filename.substr (dot);
+    }
+  return oss.str ();
 }
 
 void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (!Sample ())
+    {
+      return;
+    }
+  if (m_asyncOpen)
+    {
+      uint32_t inclLen;
+      uint8_t *data = AppendRecord (t, p->GetSize (), inclLen);
+      p->CopyData (data, inclLen);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -139,6 +618,23 @@ void
 PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (!Sample ())
+    {
+      return;
+    }
+  if (m_asyncOpen)
+    {
+      uint32_t headerSize = header.GetSerializedSize ();
+      uint32_t inclLen;
+      uint8_t *data = AppendRecord (t, headerSize + p->GetSize (), inclLen);
+      Buffer headerBuffer;
+      headerBuffer.AddAtStart (headerSize);
+      header.Serialize (headerBuffer.Begin ());
+      uint32_t toCopy = std::min (headerSize, inclLen);
+      headerBuffer.CopyData (data, toCopy);
+      p->CopyData (data + toCopy, inclLen - toCopy);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -159,6 +655,17 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (!Sample ())
+    {
+      return;
+    }
+  if (m_asyncOpen)
+    {
+      uint32_t inclLen;
+      uint8_t *data = AppendRecord (t, length, inclLen);
+      std::memcpy (data, buffer, inclLen);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
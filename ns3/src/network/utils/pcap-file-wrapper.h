@@ -22,6 +22,8 @@
 #include <cstring>
 #include <limits>
 #include <fstream>
+#include <string>
+#include <vector>
 #include "ns3/ptr.h"
 #include "ns3/packet.h"
 #include "ns3/object.h"
@@ -35,6 +37,16 @@ namespace ns3 {
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * When the "Asynchronous" attribute is set, files opened for writing are
+ * not written from the simulation thread: the records, truncated to the
+ * capture size, are batched in a buffer of "BufferSize" bytes which is
+ * handed to a background writer thread shared by all the files.  Only the
+ * first "CaptureSize" bytes of a packet are copied, so capturing the
+ * headers of large packets does not serialize their payload.  In this
+ * mode, the capture can also be rotated over a ring of "MaxFiles" files
+ * of at most "MaxFileSize" bytes.  "SampleInterval" keeps one packet in
+ * every n in both modes.
  */
 class PcapFileWrapper : public Object
 {
@@ -220,10 +232,60 @@ public:
    */ 
   uint32_t GetDataLinkType (void);
 
+  /**
+   * \brief Hand the buffered records of an asynchronous file to the writer
+   * thread and wait until they are on disk.  Does nothing in the
+   * synchronous mode.
+   */
+  void Flush (void);
+
 private:
+  /**
+   * \return true if the next packet must be captured
+   */
+  bool Sample (void);
+  /**
+   * \brief append a record header to the asynchronous buffer, rotating the
+   * file first if it would exceed the maximum size
+   * \param t the timestamp
+   * \param origLen the packet size
+   * \param inclLen the number of bytes to capture
+   * \return where to copy the captured bytes
+   */
+  uint8_t * AppendRecord (Time t, uint32_t origLen, uint32_t &inclLen);
+  /**
+   * \brief hand the buffer to the writer thread
+   * \param close whether the current file is complete
+   */
+  void Submit (bool close);
+  /**
+   * \brief continue the capture in the next file of the ring
+   */
+  void Rotate (void);
+  /**
+   * \param index the position in the ring
+   * \return the name of the file
+   */
+  std::string GetRotatedFilename (uint32_t index) const;
+
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_async; //!< Write from a background thread
+  uint32_t m_bufferSize; //!< Size of the asynchronous buffers
+  uint32_t m_sampleInterval; //!< Keep one packet in every m_sampleInterval
+  uint64_t m_maxFileSize; //!< Rotate the file beyond this size, 0 for never
+  uint32_t m_maxFiles; //!< Number of files in the ring, 0 for unlimited
+  uint64_t m_nPackets; //!< Packets seen, for sampling
+  bool     m_asyncOpen; //!< An asynchronous file is being written
+  std::string m_filename; //!< Name given to Open
+  std::string m_current; //!< Name of the file being written
+  bool     m_truncate; //!< The current file must be created
+  uint32_t m_fileIndex; //!< Position of the current file in the ring
+  uint32_t m_captureLen; //!< Snaplen of the asynchronous file
+  uint64_t m_fileBytes; //!< Bytes in the current file
+  std::vector<uint8_t> m_fileHeader; //!< Serialized pcap file header
+  std::vector<uint8_t> m_buffer; //!< Records not handed to the writer yet
 };
 
 } // namespace ns3
@@ -20,10 +20,19 @@
 
 #include <queue>
 #include <iomanip>
+#include <limits>
 
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/names.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/hash.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/udp-l4-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 
 #include "ipv4-nix-vector-routing.h"
@@ -43,12 +52,31 @@ Ipv4NixVectorRouting::GetTypeId (void)
     .SetParent<Ipv4RoutingProtocol> ()
     .SetGroupName ("NixVectorRouting")
     .AddConstructor<Ipv4NixVectorRouting> ()
+    .AddAttribute ("EcmpMode",
+                   "Equal-Cost Multi-Path mode used when building nix-vectors",
+                   EnumValue (ECMP_NONE),
+                   MakeEnumAccessor (&Ipv4NixVectorRouting::m_ecmpMode),
+                   MakeEnumChecker (ECMP_NONE, "ECMP_NONE",
+                                    ECMP_HASH, "ECMP_HASH",
+                                    ECMP_FLOWLET, "ECMP_FLOWLET"))
+    .AddAttribute ("PathChoices",
+                   "Number of path choices flows are hashed to, i.e. the maximum number of cached nix-vectors per destination",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&Ipv4NixVectorRouting::m_pathChoices),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("FlowletGap",
+                   "Inactivity gap after which a flow may change path in ECMP_FLOWLET mode",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&Ipv4NixVectorRouting::m_flowletGap),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
 
 Ipv4NixVectorRouting::Ipv4NixVectorRouting ()
-  : m_totalNeighbors (0)
+  : m_ecmpMode (ECMP_NONE),
+    m_pathChoices (16),
+    m_totalNeighbors (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -75,6 +103,11 @@ Ipv4NixVectorRouting::DoDispose ()
 
   m_node = 0;
   m_ipv4 = 0;
+  m_nixCache.clear ();
+  m_ipv4RouteCache.clear ();
+  m_ecmpNixCache.clear ();
+  m_ecmpRouteCache.clear ();
+  m_flowlets.clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -112,6 +145,7 @@ Ipv4NixVectorRouting::FlushNixCache (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_nixCache.clear ();
+  m_ecmpNixCache.clear ();
 }
 
 void
@@ -119,6 +153,7 @@ Ipv4NixVectorRouting::FlushIpv4RouteCache (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_ipv4RouteCache.clear ();
+  m_ecmpRouteCache.clear ();
 }
 
 Ptr<NixVector>
@@ -487,6 +522,304 @@ Ipv4NixVectorRouting::FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address
   return index;
 }
 
+void
+Ipv4NixVectorRouting::GetNeighbors (Ptr<Node> node, std::vector<Neighbor> & neighbors)
+{
+  NS_LOG_FUNCTION (node->GetId ());
+
+  neighbors.clear ();
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+
+  // same order as the one used to number the neighbors in BuildNixVector
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+      if (localNetDevice->IsBridge ())
+        {
+          continue;
+        }
+      Ptr<Channel> channel = localNetDevice->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+
+      bool usable = localNetDevice->IsLinkUp ();
+      if (usable && ipv4)
+        {
+          int32_t interfaceIndex = ipv4->GetInterfaceForDevice (localNetDevice);
+          usable = interfaceIndex != -1 && ipv4->IsUp (interfaceIndex);
+        }
+
+      NetDeviceContainer netDeviceContainer;
+      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+      for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+        {
+          Neighbor neighbor;
+          neighbor.node = (*iter)->GetNode ()->GetId ();
+          neighbor.device = localNetDevice;
+          neighbor.usable = usable;
+          neighbors.push_back (neighbor);
+        }
+    }
+}
+
+uint32_t
+Ipv4NixVectorRouting::GetFlowHash (Ptr<const Packet> p, const Ipv4Header &header) const
+{
+  uint8_t buf[13];
+  header.GetSource ().Serialize (buf);
+  header.GetDestination ().Serialize (buf + 4);
+  buf[8] = header.GetProtocol ();
+  uint16_t sourcePort = 0;
+  uint16_t destinationPort = 0;
+
+  // as in Ipv4GlobalRouting, the ports are read from the head of the packet
+  if (p != 0 && header.GetProtocol () == TcpL4Protocol::PROT_NUMBER)
+    {
+      TcpHeader tcpHeader;
+      if (p->GetSize () >= tcpHeader.GetSerializedSize ())
+        {
+          p->PeekHeader (tcpHeader);
+          sourcePort = tcpHeader.GetSourcePort ();
+          destinationPort = tcpHeader.GetDestinationPort ();
+        }
+    }
+  else if (p != 0 && header.GetProtocol () == UdpL4Protocol::PROT_NUMBER)
+    {
+      UdpHeader udpHeader;
+      if (p->GetSize () >= udpHeader.GetSerializedSize ())
+        {
+          p->PeekHeader (udpHeader);
+          sourcePort = udpHeader.GetSourcePort ();
+          destinationPort = udpHeader.GetDestinationPort ();
+        }
+    }
+  buf[9] = sourcePort >> 8;
+  buf[10] = sourcePort & 0xff;
+  buf[11] = destinationPort >> 8;
+  buf[12] = destinationPort & 0xff;
+  return Hash32 (reinterpret_cast<char *> (buf), sizeof (buf));
+}
+
+uint32_t
+Ipv4NixVectorRouting::GetPathChoice (Ptr<const Packet> p, const Ipv4Header &header)
+{
+  uint32_t hash = GetFlowHash (p, header);
+  if (m_ecmpMode != ECMP_FLOWLET || p == 0)
+    {
+      return hash % m_pathChoices;
+    }
+
+  Time now = Simulator::Now ();
+  if (now - m_lastPrune > m_flowletGap)
+    {
+      PruneFlowlets (now);
+    }
+  std::map<uint32_t, Flowlet>::iterator it = m_flowlets.find (hash);
+  if (it == m_flowlets.end () || now - it->second.lastSeen > m_flowletGap)
+    {
+      // new flowlet, its start time picks the path choice so that an
+      // idle flow does not need to be remembered to move to another path
+      int64_t start = now.GetTimeStep ();
+      uint32_t buf[3] = { hash, static_cast<uint32_t> (start), static_cast<uint32_t> (start >> 32) };
+      it = m_flowlets.insert (std::make_pair (hash, Flowlet ())).first;
+      it->second.choice = Hash32 (reinterpret_cast<char *> (buf), sizeof (buf)) % m_pathChoices;
+      NS_LOG_LOGIC ("New flowlet of flow " << hash << " on path choice " << it->second.choice);
+    }
+  it->second.lastSeen = now;
+  return it->second.choice;
+}
+
+void
+Ipv4NixVectorRouting::PruneFlowlets (Time now)
+{
+  // the next packet of an idle flow starts a new flowlet anyway
+  for (std::map<uint32_t, Flowlet>::iterator it = m_flowlets.begin (); it != m_flowlets.end (); )
+    {
+      if (now - it->second.lastSeen > m_flowletGap)
+        {
+          m_flowlets.erase (it++);
+        }
+      else
+        {
+          ++it;
+        }
+    }
+  m_lastPrune = now;
+}
+
+uint32_t
+Ipv4NixVectorRouting::GetNFlowlets (void) const
+{
+  return m_flowlets.size ();
+}
+
+bool
+Ipv4NixVectorRouting::BuildEcmpNixVector (Ptr<Node> source, Ptr<Node> dest, Ptr<NetDevice> oif,
+                                          uint32_t choice, EcmpPath & path)
+{
+  NS_LOG_FUNCTION (source->GetId () << dest->GetId () << choice);
+
+  const uint32_t infinity = std::numeric_limits<uint32_t>::max ();
+  uint32_t numberOfNodes = NodeList::GetNNodes ();
+  std::vector<uint32_t> distance (numberOfNodes, infinity);
+  std::vector<Neighbor> neighbors;
+
+  // hop distance of every node to the destination
+  std::queue<uint32_t> greyNodeList;
+  distance.at (dest->GetId ()) = 0;
+  greyNodeList.push (dest->GetId ());
+  while (greyNodeList.size () != 0)
+    {
+      uint32_t currNode = greyNodeList.front ();
+      greyNodeList.pop ();
+      GetNeighbors (NodeList::GetNode (currNode), neighbors);
+      for (std::vector<Neighbor>::const_iterator it = neighbors.begin (); it != neighbors.end (); it++)
+        {
+          if (it->usable && distance.at (it->node) == infinity)
+            {
+              distance.at (it->node) = distance.at (currNode) + 1;
+              greyNodeList.push (it->node);
+            }
+        }
+    }
+  if (distance.at (source->GetId ()) == infinity)
+    {
+      return false;
+    }
+
+  // walk down the distances, picking one of the equal-cost next hops
+  std::vector<std::pair<uint32_t, uint32_t> > hops; // nix index, number of bits
+  Ptr<NixVector> nixVector = Create<NixVector> ();
+  path.nodes.clear ();
+  path.nodes.push_back (source->GetId ());
+  uint32_t currNode = source->GetId ();
+  while (currNode != dest->GetId ())
+    {
+      if (path.nodes.size () > numberOfNodes)
+        {
+          return false;
+        }
+      GetNeighbors (NodeList::GetNode (currNode), neighbors);
+      std::vector<uint32_t> candidates;
+      uint32_t best = infinity;
+      for (uint32_t i = 0; i < neighbors.size (); i++)
+        {
+          if (!neighbors[i].usable)
+            {
+              continue;
+            }
+          if (currNode == source->GetId () && oif && neighbors[i].device != oif)
+            {
+              continue;
+            }
+          uint32_t d = distance.at (neighbors[i].node);
+          if (d < best)
+            {
+              best = d;
+              candidates.clear ();
+            }
+          if (d == best && d != infinity)
+            {
+              candidates.push_back (i);
+            }
+        }
+      // a specified output interface may force a longer path
+      bool forced = currNode == source->GetId () && oif;
+      if (candidates.empty () || (!forced && best >= distance.at (currNode)))
+        {
+          return false;
+        }
+      uint32_t buf[2] = { choice, currNode };
+      uint32_t pick = candidates[Hash32 (reinterpret_cast<char *> (buf), sizeof (buf)) % candidates.size ()];
+      hops.push_back (std::make_pair (pick, nixVector->BitCount (neighbors.size ())));
+      currNode = neighbors[pick].node;
+      path.nodes.push_back (currNode);
+    }
+
+  // the first hop must be extracted first, hence added last
+  for (std::vector<std::pair<uint32_t, uint32_t> >::reverse_iterator it = hops.rbegin (); it != hops.rend (); it++)
+    {
+      nixVector->AddNeighborIndex (it->first, it->second);
+    }
+  path.nixVector = nixVector;
+  return true;
+}
+
+Ptr<Ipv4Route>
+Ipv4NixVectorRouting::GetEcmpRoute (Ipv4Address dest, uint32_t nodeIndex, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (dest << nodeIndex << oif);
+
+  EcmpKey_t key (dest, nodeIndex);
+  std::map<EcmpKey_t, Ptr<Ipv4Route> >::iterator it = m_ecmpRouteCache.find (key);
+  if (it != m_ecmpRouteCache.end () && (!oif || it->second->GetOutputDevice () == oif))
+    {
+      NS_LOG_LOGIC ("Found Ipv4Route in cache.");
+      return it->second;
+    }
+
+  Ipv4Address gatewayIp;
+  uint32_t index = FindNetDeviceForNixIndex (nodeIndex, gatewayIp);
+  Ptr<NetDevice> device = oif ? oif : m_node->GetDevice (index);
+  int32_t interfaceIndex = m_ipv4->GetInterfaceForDevice (device);
+  NS_ASSERT_MSG (interfaceIndex != -1, "Interface index not found for device");
+  Ipv4InterfaceAddress ifAddr = m_ipv4->GetAddress (interfaceIndex, 0);
+
+  Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+  rtentry->SetSource (ifAddr.GetLocal ());
+  rtentry->SetGateway (gatewayIp);
+  rtentry->SetDestination (dest);
+  rtentry->SetOutputDevice (device);
+  if (!oif)
+    {
+      m_ecmpRouteCache[key] = rtentry;
+    }
+  return rtentry;
+}
+
+void
+Ipv4NixVectorRouting::InvalidateLink (uint32_t a, uint32_t b) const
+{
+  NS_LOG_FUNCTION (a << b);
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Ipv4NixVectorRouting> rp = (*i)->GetObject<Ipv4NixVectorRouting> ();
+      if (!rp)
+        {
+          continue;
+        }
+      if (rp->m_ecmpMode == ECMP_NONE)
+        {
+          rp->FlushNixCache ();
+          rp->FlushIpv4RouteCache ();
+          continue;
+        }
+      std::map<EcmpKey_t, EcmpPath>::iterator it = rp->m_ecmpNixCache.begin ();
+      while (it != rp->m_ecmpNixCache.end ())
+        {
+          const std::vector<uint32_t> &nodes = it->second.nodes;
+          bool traverses = false;
+          for (uint32_t j = 1; j < nodes.size () && !traverses; j++)
+            {
+              traverses = (nodes[j - 1] == a && nodes[j] == b) || (nodes[j - 1] == b && nodes[j] == a);
+            }
+          if (traverses)
+            {
+              NS_LOG_LOGIC ("Node " << (*i)->GetId () << " drops the path to " << it->first.first
+                            << " through link " << a << "-" << b);
+              rp->m_ecmpNixCache.erase (it++);
+            }
+          else
+            {
+              it++;
+            }
+        }
+    }
+}
+
 Ptr<Ipv4Route> 
 Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
 {
@@ -498,6 +831,53 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
   CheckCacheStateAndFlush ();
 
   NS_LOG_DEBUG ("Dest IP from header: " << header.GetDestination ());
+
+  if (m_ecmpMode != ECMP_NONE)
+    {
+      Ipv4Address dest = header.GetDestination ();
+      uint32_t choice = GetPathChoice (p, header);
+      EcmpKey_t key (dest, choice);
+      EcmpPath path;
+      std::map<EcmpKey_t, EcmpPath>::iterator it = m_ecmpNixCache.find (key);
+      if (it != m_ecmpNixCache.end () && !oif)
+        {
+          NS_LOG_LOGIC ("Found Nix-vector in cache.");
+          path = it->second;
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
+          Ptr<Node> destNode = GetNodeByIp (dest);
+          if (destNode == 0 || destNode == m_node
+              || !BuildEcmpNixVector (m_node, destNode, oif, choice, path))
+            {
+              NS_LOG_ERROR ("No path to the dest: " << dest);
+              sockerr = Socket::ERROR_NOROUTETOHOST;
+              return 0;
+            }
+          if (!oif)
+            {
+              m_ecmpNixCache[key] = path;
+            }
+        }
+
+      nixVectorForPacket = path.nixVector->Copy ();
+      if (m_totalNeighbors == 0)
+        {
+          m_totalNeighbors = FindTotalNeighbors ();
+        }
+      uint32_t numberOfBits = nixVectorForPacket->BitCount (m_totalNeighbors);
+      uint32_t nodeIndex = nixVectorForPacket->ExtractNeighborIndex (numberOfBits);
+      rtentry = GetEcmpRoute (dest, nodeIndex, oif);
+      sockerr = Socket::ERROR_NOTERROR;
+      if (p)
+        {
+          NS_LOG_LOGIC ("Adding Nix-vector to packet: " << *nixVectorForPacket);
+          p->SetNixVector (nixVectorForPacket);
+        }
+      return rtentry;
+    }
+
   // check if cache
   nixVectorInCache = GetNixVectorInCache (header.GetDestination ());
 
@@ -661,7 +1041,15 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
   uint32_t numberOfBits = nixVector->BitCount (m_totalNeighbors);
   uint32_t nodeIndex = nixVector->ExtractNeighborIndex (numberOfBits);
 
-  rtentry = GetIpv4RouteInCache (header.GetDestination ());
+  if (m_ecmpMode != ECMP_NONE)
+    {
+      // the next hop depends on the path, not only on the destination
+      rtentry = GetEcmpRoute (header.GetDestination (), nodeIndex, 0);
+    }
+  else
+    {
+      rtentry = GetIpv4RouteInCache (header.GetDestination ());
+    }
   // not in cache
   if (!rtentry)
     {
@@ -720,6 +1108,19 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
           *os << *(it->second) << std::endl;
         }
     }
+  if (m_ecmpNixCache.size () > 0)
+    {
+      *os << "EcmpNixCache:" << std::endl;
+      *os << "Destination     Choice  NixVector" << std::endl;
+      for (std::map<EcmpKey_t, EcmpPath>::const_iterator it = m_ecmpNixCache.begin (); it != m_ecmpNixCache.end (); it++)
+        {
+          std::ostringstream dest;
+          dest << it->first.first;
+          *os << std::setiosflags (std::ios::left) << std::setw (16) << dest.str ();
+          *os << std::setiosflags (std::ios::left) << std::setw (8) << it->first.second;
+          *os << *(it->second.nixVector) << std::endl;
+        }
+    }
   *os << "Ipv4RouteCache:" << std::endl;
   if (m_ipv4RouteCache.size () > 0)
     {
@@ -757,7 +1158,22 @@ Ipv4NixVectorRouting::NotifyInterfaceUp (uint32_t i)
 void
 Ipv4NixVectorRouting::NotifyInterfaceDown (uint32_t i)
 {
-  g_isCacheDirty = true;
+  Ptr<NetDevice> device = m_ipv4 ? m_ipv4->GetNetDevice (i) : 0;
+  Ptr<Channel> channel = device ? device->GetChannel () : 0;
+  if (m_ecmpMode == ECMP_NONE || !m_node || !channel)
+    {
+      g_isCacheDirty = true;
+      return;
+    }
+
+  // only the paths through the links of this interface become invalid,
+  // the others remain shortest paths
+  NetDeviceContainer netDeviceContainer;
+  GetAdjacentNetDevices (device, channel, netDeviceContainer);
+  for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+    {
+      InvalidateLink (m_node->GetId (), (*iter)->GetNode ()->GetId ());
+    }
 }
 void
 Ipv4NixVectorRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
@@ -22,6 +22,7 @@
 #define IPV4_NIX_VECTOR_ROUTING_H
 
 #include <map>
+#include <vector>
 
 #include "ns3/channel.h"
 #include "ns3/node-container.h"
@@ -31,6 +32,7 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/nix-vector.h"
 #include "ns3/bridge-net-device.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
@@ -48,10 +50,26 @@ typedef std::map<Ipv4Address, Ptr<Ipv4Route> > Ipv4RouteMap_t;
 /**
  * \ingroup nix-vector-routing
  * Nix-vector routing protocol
+ *
+ * When the EcmpMode attribute is not ECMP_NONE, all the equal-cost
+ * next hops are considered while building a nix-vector.  Each flow (or
+ * each flowlet) is mapped to one of PathChoices path choices, and every
+ * hop of the path is picked among its equal-cost next hops by hashing
+ * the choice with the node id.  Nix-vectors are cached per destination
+ * and path choice; taking an interface down only invalidates the cached
+ * paths that traverse the corresponding link.
  */
 class Ipv4NixVectorRouting : public Ipv4RoutingProtocol
 {
 public:
+  /// Equal-cost multi-path modes
+  enum EcmpMode
+  {
+    ECMP_NONE,    //!< single BFS path per destination
+    ECMP_HASH,    //!< path chosen per flow by a five tuple hash
+    ECMP_FLOWLET, //!< path chosen again after each FlowletGap of inactivity
+  };
+
   Ipv4NixVectorRouting ();
   ~Ipv4NixVectorRouting ();
   /**
@@ -80,8 +98,43 @@ public:
    */
   void FlushGlobalNixRoutingCache (void) const;
 
+  /**
+   * @brief Get the number of flows tracked by the ECMP_FLOWLET mode
+   *
+   * Flows idle for more than FlowletGap are forgotten, so this only
+   * counts the recently active flows.
+   *
+   * @return the size of the flowlet table
+   */
+  uint32_t GetNFlowlets (void) const;
+
 private:
 
+  /// A neighbor of a node, in nix index order
+  struct Neighbor
+  {
+    uint32_t node;             //!< id of the neighbor node
+    Ptr<NetDevice> device;     //!< local device leading to the neighbor
+    bool usable;               //!< whether the local interface and link are up
+  };
+
+  /// A cached multipath nix-vector
+  struct EcmpPath
+  {
+    Ptr<NixVector> nixVector;    //!< the nix-vector
+    std::vector<uint32_t> nodes; //!< ids of the nodes along the path
+  };
+
+  /// Per-flow state of the flowlet mode
+  struct Flowlet
+  {
+    Time lastSeen;   //!< last packet of the flow
+    uint32_t choice; //!< current path choice
+  };
+
+  /// Key of the multipath caches: destination and path choice (or nix index)
+  typedef std::pair<Ipv4Address, uint32_t> EcmpKey_t;
+
   /* flushes the cache which stores nix-vector based on
    * destination IP */
   void FlushNixCache (void) const;
@@ -124,6 +177,34 @@ private:
    * how many neighbors it has */
   uint32_t FindTotalNeighbors (void);
 
+  /* lists the neighbors of a node in nix index order */
+  void GetNeighbors (Ptr<Node> node, std::vector<Neighbor> & neighbors);
+
+  /* hashes the five tuple of the packet, ports are skipped
+   * if the packet does not carry a TCP or UDP header */
+  uint32_t GetFlowHash (Ptr<const Packet> p, const Ipv4Header &header) const;
+
+  /* maps the flow (or flowlet) of the packet to a path choice */
+  uint32_t GetPathChoice (Ptr<const Packet> p, const Ipv4Header &header);
+
+  /* removes the flows idle for more than the flowlet gap */
+  void PruneFlowlets (Time now);
+
+  /* BFS from the destination, then walks from the source picking
+   * one of the equal-cost next hops at every node according to the
+   * path choice.  Fills the nix-vector and the nodes of the path */
+  bool BuildEcmpNixVector (Ptr<Node> source, Ptr<Node> dest, Ptr<NetDevice> oif,
+                           uint32_t choice, EcmpPath & path);
+
+  /* returns the route for the given nix index, cached per
+   * destination and nix index */
+  Ptr<Ipv4Route> GetEcmpRoute (Ipv4Address dest, uint32_t nodeIndex, Ptr<NetDevice> oif);
+
+  /* invalidates, on every node, the cached multipath nix-vectors
+   * traversing the link between the two nodes; the caches of nodes
+   * without ECMP are flushed */
+  void InvalidateLink (uint32_t a, uint32_t b) const;
+
   /* determine if the netdevice is bridged */
   Ptr<BridgeNetDevice> NetDeviceIsBridged (Ptr<NetDevice> nd) const;
 
@@ -177,6 +258,20 @@ private:
   /* Cache stores Ipv4Routes based on destination ip */
   mutable Ipv4RouteMap_t m_ipv4RouteCache;
 
+  /* Cache stores multipath nix-vectors based on destination ip and path choice */
+  mutable std::map<EcmpKey_t, EcmpPath> m_ecmpNixCache;
+
+  /* Cache stores Ipv4Routes based on destination ip and nix index */
+  mutable std::map<EcmpKey_t, Ptr<Ipv4Route> > m_ecmpRouteCache;
+
+  /* Flowlet table based on the five tuple hash */
+  std::map<uint32_t, Flowlet> m_flowlets;
+  Time m_lastPrune;        //!< last sweep of the flowlet table
+
+  EcmpMode m_ecmpMode;     //!< equal-cost multi-path mode
+  uint32_t m_pathChoices;  //!< number of path choices per destination
+  Time m_flowletGap;       //!< inactivity gap starting a new flowlet
+
   Ptr<Ipv4> m_ipv4;
   Ptr<Node> m_node;
 
@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/enum.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv4-nix-vector-routing.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+
+using namespace ns3;
+
+/**
+ * Check the path spreading of the multipath nix-vectors on a fabric with
+ * two spines:
+ *
+ *  h0 -- l0 -- s0 -- l1 -- h1
+ *          \-- s1 --/
+ */
+class NixEcmpTestCase : public TestCase
+{
+public:
+  /**
+   * \param mode the EcmpMode to test
+   */
+  NixEcmpTestCase (Ipv4NixVectorRouting::EcmpMode mode);
+private:
+  virtual void DoRun (void);
+  /**
+   * Connect two nodes with a simple channel
+   */
+  NetDeviceContainer Link (Ptr<Node> a, Ptr<Node> b);
+  /**
+   * Route one packet of the flow from h0 to h1
+   * \return the index of the spine it goes through
+   */
+  uint32_t GetSpine (uint16_t sourcePort);
+  /**
+   * Route a packet of a single flow, for the flowlet mode
+   */
+  void SendFlowlet (void);
+
+  Ipv4NixVectorRouting::EcmpMode m_mode;
+  NodeContainer m_nodes;
+  Ipv4Address m_source;
+  Ipv4Address m_destination;
+  uint32_t m_spineCount[2];
+  uint32_t m_switches;
+};
+
+NixEcmpTestCase::NixEcmpTestCase (Ipv4NixVectorRouting::EcmpMode mode)
+  : TestCase (mode == Ipv4NixVectorRouting::ECMP_HASH ?
+              "Nix-vector routing spreads flows over equal-cost paths" :
+              "Nix-vector routing moves flowlets over equal-cost paths"),
+    m_mode (mode)
+{
+}
+
+NetDeviceContainer
+NixEcmpTestCase::Link (Ptr<Node> a, Ptr<Node> b)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  Ptr<Node> nodes[2] = { a, b };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes[i]->AddDevice (device);
+      devices.Add (device);
+    }
+  return devices;
+}
+
+uint32_t
+NixEcmpTestCase::GetSpine (uint16_t sourcePort)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (sourcePort);
+  udpHeader.SetDestinationPort (9);
+  p->AddHeader (udpHeader);
+  Ipv4Header header;
+  header.SetSource (m_source);
+  header.SetDestination (m_destination);
+  header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+
+  Ptr<Ipv4RoutingProtocol> routing = m_nodes.Get (0)->GetObject<Ipv4NixVectorRouting> ();
+  Socket::SocketErrno err;
+  Ptr<Ipv4Route> route = routing->RouteOutput (p, header, 0, err);
+  NS_ASSERT (route != 0);
+  // the first hop has been extracted, l0 has 3 neighbors: h0, s0, s1
+  Ptr<NixVector> nixVector = p->GetNixVector ();
+  uint32_t index = nixVector->ExtractNeighborIndex (nixVector->BitCount (3));
+  NS_ASSERT (index == 1 || index == 2);
+  return index - 1;
+}
+
+void
+NixEcmpTestCase::SendFlowlet (void)
+{
+  uint32_t spine = GetSpine (1000);
+  m_spineCount[spine]++;
+  // packets of the same flowlet follow the same path
+  if (GetSpine (1000) != spine)
+    {
+      m_switches++;
+    }
+}
+
+void
+NixEcmpTestCase::DoRun (void)
+{
+  m_nodes.Create (6); // h0, l0, s0, s1, l1, h1
+  NetDeviceContainer links[5];
+  links[0] = Link (m_nodes.Get (0), m_nodes.Get (1));
+  links[1] = Link (m_nodes.Get (1), m_nodes.Get (2));
+  links[2] = Link (m_nodes.Get (1), m_nodes.Get (3));
+  links[3] = Link (m_nodes.Get (2), m_nodes.Get (4));
+  links[4] = Link (m_nodes.Get (3), m_nodes.Get (4));
+  NetDeviceContainer last = Link (m_nodes.Get (4), m_nodes.Get (5));
+
+  Ipv4NixVectorHelper nixRouting;
+  nixRouting.Set ("EcmpMode", EnumValue (m_mode));
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (nixRouting);
+  stack.Install (m_nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer hostInterfaces = address.Assign (links[0]);
+  m_source = hostInterfaces.GetAddress (0);
+  for (uint32_t i = 1; i < 5; i++)
+    {
+      address.NewNetwork ();
+      address.Assign (links[i]);
+    }
+  address.NewNetwork ();
+  m_destination = address.Assign (last).GetAddress (1);
+
+  m_spineCount[0] = m_spineCount[1] = 0;
+  m_switches = 0;
+  if (m_mode == Ipv4NixVectorRouting::ECMP_HASH)
+    {
+      for (uint16_t port = 1; port <= 64; port++)
+        {
+          uint32_t spine = GetSpine (port);
+          m_spineCount[spine]++;
+          NS_TEST_ASSERT_MSG_EQ (GetSpine (port), spine, "flow changed path");
+        }
+      NS_TEST_ASSERT_MSG_GT (m_spineCount[0], 0, "spine 0 not used");
+      NS_TEST_ASSERT_MSG_GT (m_spineCount[1], 0, "spine 1 not used");
+
+      // l0 to s0 goes down, only the paths through s1 remain
+      Ptr<Ipv4> ipv4 = m_nodes.Get (1)->GetObject<Ipv4> ();
+      ipv4->SetDown (ipv4->GetInterfaceForDevice (links[1].Get (0)));
+      for (uint16_t port = 1; port <= 64; port++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (GetSpine (port), 1, "path through a down link");
+        }
+    }
+  else
+    {
+      // one packet pair every ms, far above the flowlet gap
+      for (uint32_t i = 0; i < 32; i++)
+        {
+          Simulator::Schedule (MilliSeconds (i), &NixEcmpTestCase::SendFlowlet, this);
+        }
+      Simulator::Run ();
+      NS_TEST_ASSERT_MSG_EQ (m_switches, 0, "path changed within a flowlet");
+      NS_TEST_ASSERT_MSG_GT (m_spineCount[0], 0, "flowlets never on spine 0");
+      NS_TEST_ASSERT_MSG_GT (m_spineCount[1], 0, "flowlets never on spine 1");
+
+      // idle flows are pruned from the flowlet table
+      Ptr<Ipv4NixVectorRouting> routing = m_nodes.Get (0)->GetObject<Ipv4NixVectorRouting> ();
+      for (uint16_t port = 1; port <= 64; port++)
+        {
+          Simulator::Schedule (MilliSeconds (40), &NixEcmpTestCase::GetSpine, this, port);
+        }
+      Simulator::Schedule (MilliSeconds (41), &NixEcmpTestCase::GetSpine, this, 1);
+      Simulator::Run ();
+      NS_TEST_ASSERT_MSG_EQ (routing->GetNFlowlets (), 1, "idle flows kept in the flowlet table");
+    }
+
+  Simulator::Destroy ();
+}
+
+static class Ipv4NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv4NixVectorRoutingTestSuite ()
+    : TestSuite ("ipv4-nix-vector-routing", UNIT)
+  {
+    AddTestCase (new NixEcmpTestCase (Ipv4NixVectorRouting::ECMP_HASH), TestCase::QUICK);
+    AddTestCase (new NixEcmpTestCase (Ipv4NixVectorRouting::ECMP_FLOWLET), TestCase::QUICK);
+  }
+} g_ipv4NixVectorRoutingTestSuite;
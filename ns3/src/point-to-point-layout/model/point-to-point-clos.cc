@@ -0,0 +1,374 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// ns3 includes
+#include "ns3/log.h"
+#include "ns3/point-to-point-clos.h"
+
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/traffic-control-layer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointClosHelper");
+
+PointToPointClosHelper::PointToPointClosHelper (uint32_t nSpines,
+                                                uint32_t nLeaves,
+                                                uint32_t nHostsPerLeaf,
+                                                PointToPointHelper edgeHelper,
+                                                PointToPointHelper fabricHelper)
+  : m_nPods (1),
+    m_nLeavesPerPod (nLeaves),
+    m_nHostsPerLeaf (nHostsPerLeaf)
+{
+  NS_LOG_FUNCTION (this << nSpines << nLeaves << nHostsPerLeaf);
+  NS_ASSERT_MSG (nSpines > 0 && nLeaves > 0 && nHostsPerLeaf > 0, "Empty leaf-spine topology");
+
+  m_hosts.Create (nLeaves * nHostsPerLeaf);
+  m_leaves.Create (nLeaves);
+  m_spines.Create (nSpines);
+  Build (edgeHelper, fabricHelper);
+}
+
+PointToPointClosHelper::PointToPointClosHelper (uint32_t k,
+                                                PointToPointHelper edgeHelper,
+                                                PointToPointHelper fabricHelper)
+  : m_nPods (k),
+    m_nLeavesPerPod (k / 2),
+    m_nHostsPerLeaf (k / 2)
+{
+  NS_LOG_FUNCTION (this << k);
+  NS_ASSERT_MSG (k >= 2 && k % 2 == 0, "The fat-tree radix must be a positive even number");
+
+  m_hosts.Create (k * k * k / 4);
+  m_leaves.Create (k * k / 2);
+  m_aggregations.Create (k * k / 2);
+  m_spines.Create (k * k / 4);
+  Build (edgeHelper, fabricHelper);
+}
+
+PointToPointClosHelper::~PointToPointClosHelper ()
+{
+}
+
+void
+PointToPointClosHelper::Build (PointToPointHelper edgeHelper, PointToPointHelper fabricHelper)
+{
+  // size every container up front, the links are then installed without
+  // any reallocation however large the topology is
+  uint32_t nLowerLinks = m_leaves.GetN () * (m_aggregations.GetN () ? m_nLeavesPerPod : m_spines.GetN ());
+  uint32_t nUpperLinks = m_aggregations.GetN () * m_nLeavesPerPod;
+  m_edgeDevices.Reserve (m_hosts.GetN ());
+  m_hostDevices.Reserve (m_hosts.GetN ());
+  m_fabricDevices.Reserve (2 * (nLowerLinks + nUpperLinks));
+  m_lowerLinks.reserve (nLowerLinks);
+  m_upperLinks.reserve (nUpperLinks);
+
+  for (uint32_t l = 0; l < m_leaves.GetN (); ++l)
+    {
+      for (uint32_t h = l * m_nHostsPerLeaf; h < (l + 1) * m_nHostsPerLeaf; ++h)
+        {
+          NetDeviceContainer nd = edgeHelper.Install (m_leaves.Get (l), m_hosts.Get (h));
+          m_edgeDevices.Add (nd.Get (0));
+          m_hostDevices.Add (nd.Get (1));
+        }
+    }
+
+  if (m_aggregations.GetN () == 0)
+    {
+      // leaf-spine: every leaf is linked to every spine
+      for (uint32_t l = 0; l < m_leaves.GetN (); ++l)
+        {
+          for (uint32_t s = 0; s < m_spines.GetN (); ++s)
+            {
+              Link link;
+              link.lower = l;
+              link.upper = s;
+              link.devices = fabricHelper.Install (m_leaves.Get (l), m_spines.Get (s));
+              m_fabricDevices.Add (link.devices);
+              m_lowerLinks.push_back (link);
+            }
+        }
+      return;
+    }
+
+  // fat-tree: full mesh between edge and aggregation switches of a pod,
+  // the i-th aggregation switch of each pod is linked to the i-th group
+  // of k/2 core switches
+  uint32_t half = m_nLeavesPerPod;
+  for (uint32_t p = 0; p < m_nPods; ++p)
+    {
+      for (uint32_t e = p * half; e < (p + 1) * half; ++e)
+        {
+          for (uint32_t a = p * half; a < (p + 1) * half; ++a)
+            {
+              Link link;
+              link.lower = e;
+              link.upper = a;
+              link.devices = fabricHelper.Install (m_leaves.Get (e), m_aggregations.Get (a));
+              m_fabricDevices.Add (link.devices);
+              m_lowerLinks.push_back (link);
+            }
+        }
+      for (uint32_t a = p * half; a < (p + 1) * half; ++a)
+        {
+          for (uint32_t c = (a - p * half) * half; c < (a - p * half + 1) * half; ++c)
+            {
+              Link link;
+              link.lower = a;
+              link.upper = c;
+              link.devices = fabricHelper.Install (m_aggregations.Get (a), m_spines.Get (c));
+              m_fabricDevices.Add (link.devices);
+              m_upperLinks.push_back (link);
+            }
+        }
+    }
+}
+
+NodeContainer
+PointToPointClosHelper::GetHosts () const
+{
+  return m_hosts;
+}
+
+NodeContainer
+PointToPointClosHelper::GetLeaves () const
+{
+  return m_leaves;
+}
+
+NodeContainer
+PointToPointClosHelper::GetAggregations () const
+{
+  return m_aggregations;
+}
+
+NodeContainer
+PointToPointClosHelper::GetSpines () const
+{
+  return m_spines;
+}
+
+NodeContainer
+PointToPointClosHelper::GetSwitches () const
+{
+  return NodeContainer (m_leaves, m_aggregations, m_spines);
+}
+
+Ptr<Node>
+PointToPointClosHelper::GetHost (uint32_t i) const
+{
+  return m_hosts.Get (i);
+}
+
+Ptr<Node>
+PointToPointClosHelper::GetLeaf (uint32_t i) const
+{
+  return m_leaves.Get (i);
+}
+
+Ptr<Node>
+PointToPointClosHelper::GetSpine (uint32_t i) const
+{
+  return m_spines.Get (i);
+}
+
+Ipv4Address
+PointToPointClosHelper::GetHostIpv4Address (uint32_t i) const
+{
+  return m_hostInterfaces.GetAddress (i);
+}
+
+uint32_t
+PointToPointClosHelper::GetNHostsPerLeaf () const
+{
+  return m_nHostsPerLeaf;
+}
+
+void
+PointToPointClosHelper::InstallStack (InternetStackHelper stack)
+{
+  stack.Install (m_hosts);
+  stack.Install (m_leaves);
+  stack.Install (m_aggregations);
+  stack.Install (m_spines);
+}
+
+void
+PointToPointClosHelper::InstallQueueDiscs (TrafficControlHelper host,
+                                           TrafficControlHelper edge,
+                                           TrafficControlHelper fabric)
+{
+  host.Install (m_hostDevices);
+  edge.Install (m_edgeDevices);
+  fabric.Install (m_fabricDevices);
+}
+
+uint32_t
+PointToPointClosHelper::Bits (uint32_t n)
+{
+  uint32_t bits = 0;
+  while ((1u << bits) < n)
+    {
+      bits++;
+    }
+  return bits;
+}
+
+void
+PointToPointClosHelper::AddInterface (Ptr<NetDevice> device, Ipv4Address addr, Ipv4Mask mask,
+                                      Ipv4InterfaceContainer &interfaces)
+{
+  Ptr<Node> node = device->GetNode ();
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, "PointToPointClosHelper::AssignIpv4Addresses(): no IPv4 stack "
+                 "installed (maybe need to call InstallStack?)");
+
+  int32_t interface = ipv4->GetInterfaceForDevice (device);
+  if (interface == -1)
+    {
+      interface = ipv4->AddInterface (device);
+    }
+  ipv4->AddAddress (interface, Ipv4InterfaceAddress (addr, mask));
+  ipv4->SetMetric (interface, 1);
+  ipv4->SetUp (interface);
+
+  // Install the default traffic control configuration, as the
+  // Ipv4AddressHelper does, if no queue disc is installed already
+  Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer> ();
+  if (tc && tc->GetRootQueueDiscOnDevice (device) == 0)
+    {
+      TrafficControlHelper tcHelper = TrafficControlHelper::Default ();
+      tcHelper.Install (device);
+    }
+
+  interfaces.Add (ipv4, interface);
+}
+
+void
+PointToPointClosHelper::AssignIpv4Addresses (Ipv4Address hostBase, Ipv4Address fabricBase)
+{
+  NS_LOG_FUNCTION (this << hostBase << fabricBase);
+  uint32_t hostBits = Bits (m_nHostsPerLeaf) + 2;
+  uint32_t leafBits = Bits (m_nLeavesPerPod);
+  NS_ASSERT_MSG (hostBits + leafBits + Bits (m_nPods) <= 30, "Host block does not fit in IPv4");
+
+  Ipv4Mask linkMask ("255.255.255.252");
+  m_hostBase = hostBase;
+  m_edgeInterfaces.Reserve (m_hosts.GetN ());
+  m_hostInterfaces.Reserve (m_hosts.GetN ());
+  for (uint32_t l = 0; l < m_leaves.GetN (); ++l)
+    {
+      uint32_t pod = l / m_nLeavesPerPod;
+      uint32_t leafPrefix = ((pod << leafBits) | (l % m_nLeavesPerPod)) << hostBits;
+      for (uint32_t j = 0; j < m_nHostsPerLeaf; ++j)
+        {
+          uint32_t net = hostBase.Get () + leafPrefix + (j << 2);
+          uint32_t d = l * m_nHostsPerLeaf + j;
+          AddInterface (m_edgeDevices.Get (d), Ipv4Address (net + 1), linkMask, m_edgeInterfaces);
+          AddInterface (m_hostDevices.Get (d), Ipv4Address (net + 2), linkMask, m_hostInterfaces);
+        }
+    }
+
+  uint32_t net = fabricBase.Get ();
+  std::vector<Link> *tiers[] = { &m_lowerLinks, &m_upperLinks };
+  for (uint32_t t = 0; t < 2; ++t)
+    {
+      for (std::vector<Link>::iterator it = tiers[t]->begin (); it != tiers[t]->end (); ++it)
+        {
+          it->interfaces.Reserve (2);
+          AddInterface (it->devices.Get (0), Ipv4Address (net + 1), linkMask, it->interfaces);
+          AddInterface (it->devices.Get (1), Ipv4Address (net + 2), linkMask, it->interfaces);
+          net += 4;
+        }
+    }
+}
+
+Ptr<Ipv4GlobalRouting>
+PointToPointClosHelper::GetGlobalRouting (Ptr<Node> node)
+{
+  Ptr<Ipv4RoutingProtocol> proto = node->GetObject<Ipv4> ()->GetRoutingProtocol ();
+  Ptr<Ipv4GlobalRouting> global = DynamicCast<Ipv4GlobalRouting> (proto);
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (proto);
+  for (uint32_t i = 0; global == 0 && list && i < list->GetNRoutingProtocols (); ++i)
+    {
+      int16_t priority;
+      global = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (i, priority));
+    }
+  NS_ASSERT_MSG (global, "PointToPointClosHelper::PopulateRoutingTables(): "
+                 "node " << node->GetId () << " has no Ipv4GlobalRouting");
+  return global;
+}
+
+void
+PointToPointClosHelper::PopulateRoutingTables ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_hostInterfaces.GetN () == m_hosts.GetN (), "Addresses not assigned yet");
+  uint32_t hostBits = Bits (m_nHostsPerLeaf) + 2;
+  uint32_t leafBits = Bits (m_nLeavesPerPod);
+  uint32_t blockBits = hostBits + leafBits + Bits (m_nPods);
+  Ipv4Mask blockMask (~((1u << blockBits) - 1));
+  Ipv4Mask leafMask (~((1u << hostBits) - 1));
+  Ipv4Mask podMask (~((1u << (hostBits + leafBits)) - 1));
+
+  // hosts reach the whole block through their leaf
+  for (uint32_t h = 0; h < m_hosts.GetN (); ++h)
+    {
+      GetGlobalRouting (m_hosts.Get (h))->AddNetworkRouteTo (m_hostBase, blockMask,
+                                                             m_edgeInterfaces.GetAddress (h),
+                                                             m_hostInterfaces.Get (h).second);
+    }
+
+  // going up: one route for the block per uplink; the leaf and pod prefixes
+  // announced further down are longer, so local traffic never goes up
+  for (std::vector<Link>::const_iterator it = m_lowerLinks.begin (); it != m_lowerLinks.end (); ++it)
+    {
+      GetGlobalRouting (m_leaves.Get (it->lower))->AddNetworkRouteTo (m_hostBase, blockMask,
+                                                                      it->interfaces.GetAddress (1),
+                                                                      it->interfaces.Get (0).second);
+    }
+  for (std::vector<Link>::const_iterator it = m_upperLinks.begin (); it != m_upperLinks.end (); ++it)
+    {
+      GetGlobalRouting (m_aggregations.Get (it->lower))->AddNetworkRouteTo (m_hostBase, blockMask,
+                                                                            it->interfaces.GetAddress (1),
+                                                                            it->interfaces.Get (0).second);
+    }
+
+  // going down: the leaf prefix on the switches above the leaf, the pod
+  // prefix on the core switches
+  for (std::vector<Link>::const_iterator it = m_lowerLinks.begin (); it != m_lowerLinks.end (); ++it)
+    {
+      Ptr<Node> above = m_aggregations.GetN () ? m_aggregations.Get (it->upper) : m_spines.Get (it->upper);
+      uint32_t pod = it->lower / m_nLeavesPerPod;
+      uint32_t prefix = ((pod << leafBits) | (it->lower % m_nLeavesPerPod)) << hostBits;
+      GetGlobalRouting (above)->AddNetworkRouteTo (Ipv4Address (m_hostBase.Get () + prefix), leafMask,
+                                                   it->interfaces.GetAddress (0),
+                                                   it->interfaces.Get (1).second);
+    }
+  for (std::vector<Link>::const_iterator it = m_upperLinks.begin (); it != m_upperLinks.end (); ++it)
+    {
+      uint32_t pod = it->lower / m_nLeavesPerPod;
+      uint32_t prefix = pod << (hostBits + leafBits);
+      GetGlobalRouting (m_spines.Get (it->upper))->AddNetworkRouteTo (Ipv4Address (m_hostBase.Get () + prefix), podMask,
+                                                                      it->interfaces.GetAddress (0),
+                                                                      it->interfaces.Get (1).second);
+    }
+}
+
+} // namespace ns3
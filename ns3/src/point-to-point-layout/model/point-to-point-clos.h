@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Define an object to create a leaf-spine or fat-tree (Clos) topology.
+
+#ifndef POINT_TO_POINT_CLOS_HELPER_H
+#define POINT_TO_POINT_CLOS_HELPER_H
+
+#include <vector>
+
+#include "point-to-point-helper.h"
+#include "internet-stack-helper.h"
+#include "traffic-control-helper.h"
+#include "ipv4-interface-container.h"
+
+namespace ns3 {
+
+class Ipv4GlobalRouting;
+
+/**
+ * \ingroup point-to-point-layout
+ *
+ * \brief A helper to make it easier to create data center Clos
+ * topologies (two-tier leaf-spine and three-tier k-ary fat-tree)
+ * with PointToPoint links
+ *
+ * Hosts are numbered leaf by leaf (and pod by pod), so that hosts
+ * GetHost (i * hostsPerLeaf) to GetHost ((i + 1) * hostsPerLeaf - 1)
+ * hang off GetLeaf (i).  The nodes are created in the order hosts,
+ * leaves, aggregation switches, spines (core switches), hence host
+ * node ids start at the first id available when the helper is built.
+ *
+ * Host links are addressed hierarchically: each host link is a /30
+ * carved out of the host block so that all the hosts of a leaf, and
+ * all the leaves of a pod, share a common prefix.  PopulateRoutingTables
+ * then installs one aggregated route per leaf (or pod) on the upper
+ * tiers and a single route for the whole host block on the lower tiers,
+ * instead of the per-link routes computed by the global route manager.
+ * Multiple routes to the same prefix are resolved according to the
+ * Ipv4GlobalRouting EcmpMode attribute.
+ */
+class PointToPointClosHelper
+{
+public:
+  /**
+   * Create a PointToPointClosHelper in order to build a two-tier
+   * leaf-spine topology where every leaf is linked to every spine
+   *
+   * \param nSpines number of spine switches
+   * \param nLeaves number of leaf (top of rack) switches
+   * \param nHostsPerLeaf number of hosts attached to each leaf
+   * \param edgeHelper the link helper for host to leaf links
+   * \param fabricHelper the link helper for leaf to spine links
+   */
+  PointToPointClosHelper (uint32_t nSpines,
+                          uint32_t nLeaves,
+                          uint32_t nHostsPerLeaf,
+                          PointToPointHelper edgeHelper,
+                          PointToPointHelper fabricHelper);
+
+  /**
+   * Create a PointToPointClosHelper in order to build a three-tier
+   * k-ary fat-tree: k pods of k/2 edge and k/2 aggregation switches,
+   * (k/2)^2 core switches and k/2 hosts per edge switch
+   *
+   * \param k the switch radix, must be even
+   * \param edgeHelper the link helper for host to edge links
+   * \param fabricHelper the link helper for switch to switch links
+   */
+  PointToPointClosHelper (uint32_t k,
+                          PointToPointHelper edgeHelper,
+                          PointToPointHelper fabricHelper);
+
+  ~PointToPointClosHelper ();
+
+public:
+  /**
+   * \returns the container of all the hosts
+   */
+  NodeContainer GetHosts () const;
+
+  /**
+   * \returns the container of the leaf (fat-tree: edge) switches
+   */
+  NodeContainer GetLeaves () const;
+
+  /**
+   * \returns the container of the aggregation switches (empty for
+   *          leaf-spine topologies)
+   */
+  NodeContainer GetAggregations () const;
+
+  /**
+   * \returns the container of the spine (fat-tree: core) switches
+   */
+  NodeContainer GetSpines () const;
+
+  /**
+   * \returns the container of all the switches
+   */
+  NodeContainer GetSwitches () const;
+
+  /**
+   * \param i index of the host
+   * \returns a node pointer to the indexed host
+   */
+  Ptr<Node> GetHost (uint32_t i) const;
+
+  /**
+   * \param i index of the leaf
+   * \returns a node pointer to the indexed leaf
+   */
+  Ptr<Node> GetLeaf (uint32_t i) const;
+
+  /**
+   * \param i index of the spine
+   * \returns a node pointer to the indexed spine
+   */
+  Ptr<Node> GetSpine (uint32_t i) const;
+
+  /**
+   * \param i index of the host
+   * \returns the Ipv4Address of the indexed host
+   */
+  Ipv4Address GetHostIpv4Address (uint32_t i) const;
+
+  /**
+   * \returns the number of hosts attached to each leaf
+   */
+  uint32_t GetNHostsPerLeaf () const;
+
+  /**
+   * \param stack an InternetStackHelper which is used to install
+   *              on every node of the topology
+   */
+  void InstallStack (InternetStackHelper stack);
+
+  /**
+   * Install the queue discs on every device.  Must be called after
+   * InstallStack and before AssignIpv4Addresses; devices left without
+   * a queue disc get the default traffic control configuration when
+   * addresses are assigned.
+   *
+   * \param host the configuration for the host devices
+   * \param edge the configuration for the leaf devices facing the hosts
+   * \param fabric the configuration for both ends of switch to switch links
+   */
+  void InstallQueueDiscs (TrafficControlHelper host,
+                          TrafficControlHelper edge,
+                          TrafficControlHelper fabric);
+
+  /**
+   * Assign the IPv4 addresses.  Host links get a /30 out of the
+   * hierarchical host block, switch to switch links get consecutive
+   * /30 networks starting at fabricBase.
+   *
+   * \param hostBase the base address of the host block
+   * \param fabricBase the base address of the switch to switch links
+   */
+  void AssignIpv4Addresses (Ipv4Address hostBase, Ipv4Address fabricBase);
+
+  /**
+   * Install the aggregated (and possibly multipath) routes in the
+   * Ipv4GlobalRouting instance of every node.  Must be called after
+   * AssignIpv4Addresses, in place of
+   * Ipv4GlobalRoutingHelper::PopulateRoutingTables.
+   */
+  void PopulateRoutingTables ();
+
+private:
+  /**
+   * Create the nodes and the links
+   * \param edgeHelper the link helper for host links
+   * \param fabricHelper the link helper for switch to switch links
+   */
+  void Build (PointToPointHelper edgeHelper, PointToPointHelper fabricHelper);
+
+  /**
+   * Add an interface on the device and set it up
+   * \param device the device
+   * \param addr the address of the interface
+   * \param mask the mask of the interface
+   * \param interfaces the container the new interface is appended to
+   */
+  void AddInterface (Ptr<NetDevice> device, Ipv4Address addr, Ipv4Mask mask,
+                     Ipv4InterfaceContainer &interfaces);
+
+  /**
+   * \param node the node
+   * \returns the Ipv4GlobalRouting instance of the node
+   */
+  static Ptr<Ipv4GlobalRouting> GetGlobalRouting (Ptr<Node> node);
+
+  /**
+   * \param n a number
+   * \returns the number of bits needed to represent n distinct values
+   */
+  static uint32_t Bits (uint32_t n);
+
+  /// A switch to switch link; the lower tier device comes first
+  struct Link
+  {
+    uint32_t lower;                   //!< index of the lower tier switch
+    uint32_t upper;                   //!< index of the upper tier switch
+    NetDeviceContainer devices;       //!< lower and upper tier devices
+    Ipv4InterfaceContainer interfaces; //!< lower and upper tier interfaces
+  };
+
+  uint32_t m_nPods;                     //!< number of pods (1 for leaf-spine)
+  uint32_t m_nLeavesPerPod;             //!< leaves in each pod
+  uint32_t m_nHostsPerLeaf;             //!< hosts attached to each leaf
+  NodeContainer m_hosts;                //!< host nodes
+  NodeContainer m_leaves;               //!< leaf (edge) switches
+  NodeContainer m_aggregations;         //!< aggregation switches
+  NodeContainer m_spines;               //!< spine (core) switches
+  NetDeviceContainer m_hostDevices;     //!< host devices
+  NetDeviceContainer m_edgeDevices;     //!< leaf devices facing the hosts
+  NetDeviceContainer m_fabricDevices;   //!< switch to switch devices
+  std::vector<Link> m_lowerLinks;       //!< leaf to spine (fat-tree: edge to aggregation) links
+  std::vector<Link> m_upperLinks;       //!< aggregation to core links
+  Ipv4InterfaceContainer m_hostInterfaces; //!< host interfaces
+  Ipv4InterfaceContainer m_edgeInterfaces; //!< leaf interfaces facing the hosts
+  Ipv4Address m_hostBase;               //!< base of the host block
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_CLOS_HELPER_H */
@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// ns3 includes
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/point-to-point-link-failure.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/ipv4-global-routing-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointLinkFailureHelper");
+
+PointToPointLinkFailureHelper::PointToPointLinkFailureHelper ()
+  : m_repair (true)
+{
+}
+
+void
+PointToPointLinkFailureHelper::SetRepairRouting (bool repair)
+{
+  m_repair = repair;
+}
+
+void
+PointToPointLinkFailureHelper::ScheduleLinkDown (Time delay, Ptr<PointToPointChannel> channel) const
+{
+  Simulator::Schedule (delay, &PointToPointLinkFailureHelper::SetLinkDown, channel, m_repair);
+}
+
+void
+PointToPointLinkFailureHelper::ScheduleLinkUp (Time delay, Ptr<PointToPointChannel> channel) const
+{
+  Simulator::Schedule (delay, &PointToPointLinkFailureHelper::SetLinkUp, channel, m_repair);
+}
+
+void
+PointToPointLinkFailureHelper::ScheduleDataRate (Time delay, Ptr<PointToPointChannel> channel, DataRate rate) const
+{
+  Simulator::Schedule (delay, &PointToPointLinkFailureHelper::SetDataRate, channel, rate);
+}
+
+void
+PointToPointLinkFailureHelper::ScheduleDelay (Time delay, Ptr<PointToPointChannel> channel, Time linkDelay) const
+{
+  Simulator::Schedule (delay, &PointToPointChannel::SetDelay, channel, linkDelay);
+}
+
+Ptr<PointToPointChannel>
+PointToPointLinkFailureHelper::GetChannel (Ptr<Node> a, Ptr<Node> b)
+{
+  for (uint32_t i = 0; i < a->GetNDevices (); ++i)
+    {
+      Ptr<PointToPointChannel> channel = DynamicCast<PointToPointChannel> (a->GetDevice (i)->GetChannel ());
+      if (channel == 0 || channel->GetNDevices () != 2)
+        {
+          continue;
+        }
+      if (channel->GetDevice (0)->GetNode () == b || channel->GetDevice (1)->GetNode () == b)
+        {
+          return channel;
+        }
+    }
+  return 0;
+}
+
+void
+PointToPointLinkFailureHelper::SetLinkDown (Ptr<PointToPointChannel> channel, bool repair)
+{
+  NS_LOG_FUNCTION (channel << repair);
+  channel->SetLinkDown ();
+  if (repair)
+    {
+      Ipv4GlobalRoutingHelper::RepairLinkDown (channel);
+    }
+}
+
+void
+PointToPointLinkFailureHelper::SetLinkUp (Ptr<PointToPointChannel> channel, bool repair)
+{
+  NS_LOG_FUNCTION (channel << repair);
+  channel->SetLinkUp ();
+  if (repair)
+    {
+      Ipv4GlobalRoutingHelper::RepairLinkUp (channel);
+    }
+}
+
+void
+PointToPointLinkFailureHelper::SetDataRate (Ptr<PointToPointChannel> channel, DataRate rate)
+{
+  NS_LOG_FUNCTION (channel << rate);
+  for (uint32_t i = 0; i < channel->GetNDevices (); ++i)
+    {
+      channel->GetPointToPointDevice (i)->SetDataRate (rate);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Define an object to schedule link failures and degradations.
+
+#ifndef POINT_TO_POINT_LINK_FAILURE_HELPER_H
+#define POINT_TO_POINT_LINK_FAILURE_HELPER_H
+
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/point-to-point-channel.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point-layout
+ *
+ * \brief A helper to schedule the failure, recovery and degradation
+ * of PointToPoint links in the middle of a simulation
+ *
+ * A link going down or up repairs the global routing tables through
+ * Ipv4GlobalRoutingHelper::RepairLinkDown and RepairLinkUp: only the
+ * equal cost groups using the link, and those upstream of a switch left
+ * without route, are changed, instead of recomputing every table; a
+ * switch left without route goes through its neighbors which still have
+ * one.
+ * Degradations keep the routes: with ECMP_FLOWLET the flowlets move off
+ * a slower link on their own.
+ */
+class PointToPointLinkFailureHelper
+{
+public:
+  PointToPointLinkFailureHelper ();
+
+  /**
+   * \param repair false to leave the routing tables untouched when a
+   *               link goes down or up (default true)
+   */
+  void SetRepairRouting (bool repair);
+
+  /**
+   * \param delay time from now
+   * \param channel the link to cut
+   */
+  void ScheduleLinkDown (Time delay, Ptr<PointToPointChannel> channel) const;
+
+  /**
+   * \param delay time from now
+   * \param channel the link to restore
+   */
+  void ScheduleLinkUp (Time delay, Ptr<PointToPointChannel> channel) const;
+
+  /**
+   * \param delay time from now
+   * \param channel the link
+   * \param rate the new rate of both devices of the link
+   */
+  void ScheduleDataRate (Time delay, Ptr<PointToPointChannel> channel, DataRate rate) const;
+
+  /**
+   * \param delay time from now
+   * \param channel the link
+   * \param linkDelay the new propagation delay of the link
+   */
+  void ScheduleDelay (Time delay, Ptr<PointToPointChannel> channel, Time linkDelay) const;
+
+  /**
+   * \param a a node
+   * \param b another node
+   * \returns the PointToPoint link between the nodes, 0 if there is none
+   */
+  static Ptr<PointToPointChannel> GetChannel (Ptr<Node> a, Ptr<Node> b);
+
+  /**
+   * \brief Cut a link now
+   * \param channel the link
+   * \param repair true to repair the routing tables
+   */
+  static void SetLinkDown (Ptr<PointToPointChannel> channel, bool repair);
+
+  /**
+   * \brief Restore a link now
+   * \param channel the link
+   * \param repair true to restore the routing tables
+   */
+  static void SetLinkUp (Ptr<PointToPointChannel> channel, bool repair);
+
+  /**
+   * \brief Change the rate of a link now
+   * \param channel the link
+   * \param rate the new rate of both devices of the link
+   */
+  static void SetDataRate (Ptr<PointToPointChannel> channel, DataRate rate);
+
+private:
+  bool m_repair; //!< repair the routing tables
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_LINK_FAILURE_HELPER_H */
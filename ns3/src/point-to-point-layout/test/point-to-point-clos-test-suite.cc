@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/point-to-point-clos.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+
+using namespace ns3;
+
+/**
+ * \brief Build a Clos topology, check the host addresses and the size of
+ * the routing tables, then send a packet from the first host to every
+ * other host
+ */
+class PointToPointClosTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create a leaf-spine test
+   * \param nSpines number of spines
+   * \param nLeaves number of leaves
+   * \param nHostsPerLeaf number of hosts per leaf
+   */
+  PointToPointClosTestCase (uint32_t nSpines, uint32_t nLeaves, uint32_t nHostsPerLeaf);
+
+  /**
+   * \brief Create a fat-tree test
+   * \param k the switch radix
+   */
+  PointToPointClosTestCase (uint32_t k);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param node a node
+   * \returns the number of routes of the node's global routing
+   */
+  static uint32_t GetNRoutes (Ptr<Node> node);
+
+  /**
+   * \brief Receive the packets of a host
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  /**
+   * \brief Send a packet
+   * \param socket the sending socket
+   * \param to the destination
+   */
+  static void Send (Ptr<Socket> socket, Ipv4Address to);
+
+  uint32_t m_k;             //!< fat-tree radix, 0 for leaf-spine
+  uint32_t m_nSpines;       //!< number of spines
+  uint32_t m_nLeaves;       //!< number of leaves
+  uint32_t m_nHostsPerLeaf; //!< number of hosts per leaf
+  uint32_t m_received;      //!< number of received packets
+};
+
+PointToPointClosTestCase::PointToPointClosTestCase (uint32_t nSpines, uint32_t nLeaves, uint32_t nHostsPerLeaf)
+  : TestCase ("Leaf-spine addressing and routes"),
+    m_k (0),
+    m_nSpines (nSpines),
+    m_nLeaves (nLeaves),
+    m_nHostsPerLeaf (nHostsPerLeaf),
+    m_received (0)
+{
+}
+
+PointToPointClosTestCase::PointToPointClosTestCase (uint32_t k)
+  : TestCase ("Fat-tree addressing and routes"),
+    m_k (k),
+    m_nSpines (k * k / 4),
+    m_nLeaves (k * k / 2),
+    m_nHostsPerLeaf (k / 2),
+    m_received (0)
+{
+}
+
+uint32_t
+PointToPointClosTestCase::GetNRoutes (Ptr<Node> node)
+{
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (node->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  Ptr<Ipv4GlobalRouting> routing;
+  for (uint32_t i = 0; routing == 0 && i < list->GetNRoutingProtocols (); i++)
+    {
+      int16_t priority;
+      routing = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (i, priority));
+    }
+  return routing->GetNRoutes ();
+}
+
+void
+PointToPointClosTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+PointToPointClosTestCase::Send (Ptr<Socket> socket, Ipv4Address to)
+{
+  socket->SendTo (Create<Packet> (100), 0, InetSocketAddress (to, 1234));
+}
+
+void
+PointToPointClosTestCase::DoRun (void)
+{
+  PointToPointHelper p2p;
+  PointToPointClosHelper *clos = m_k
+    ? new PointToPointClosHelper (m_k, p2p, p2p)
+    : new PointToPointClosHelper (m_nSpines, m_nLeaves, m_nHostsPerLeaf, p2p, p2p);
+  NS_TEST_ASSERT_MSG_EQ (clos->GetHosts ().GetN (), m_nLeaves * m_nHostsPerLeaf, "wrong number of hosts");
+  NS_TEST_ASSERT_MSG_EQ (clos->GetLeaves ().GetN (), m_nLeaves, "wrong number of leaves");
+  NS_TEST_ASSERT_MSG_EQ (clos->GetSpines ().GetN (), m_nSpines, "wrong number of spines");
+  NS_TEST_ASSERT_MSG_EQ (clos->GetAggregations ().GetN (), m_k * m_k / 2, "wrong number of aggregation switches");
+
+  InternetStackHelper stack;
+  clos->InstallStack (stack);
+  clos->AssignIpv4Addresses (Ipv4Address ("10.0.0.0"), Ipv4Address ("10.128.0.0"));
+  clos->PopulateRoutingTables ();
+
+  // host j of leaf l is the second address of the j-th /30 of the leaf
+  // prefix; the leaf prefix holds the /30s of all the hosts of the leaf,
+  // rounded to a power of two, and the pod prefix the leaf prefixes
+  uint32_t hostBits = 2;
+  while ((1u << (hostBits - 2)) < m_nHostsPerLeaf)
+    {
+      hostBits++;
+    }
+  uint32_t leavesPerPod = m_k ? m_k / 2 : m_nLeaves;
+  uint32_t leafBits = 0;
+  while ((1u << leafBits) < leavesPerPod)
+    {
+      leafBits++;
+    }
+  for (uint32_t h = 0; h < clos->GetHosts ().GetN (); h++)
+    {
+      uint32_t l = h / m_nHostsPerLeaf;
+      uint32_t prefix = (((l / leavesPerPod) << leafBits) | (l % leavesPerPod)) << hostBits;
+      Ipv4Address expected (Ipv4Address ("10.0.0.0").Get () + prefix + ((h % m_nHostsPerLeaf) << 2) + 2);
+      NS_TEST_EXPECT_MSG_EQ (clos->GetHostIpv4Address (h), expected, "wrong address of host " << h);
+    }
+
+  // hosts and leaves: one route to the host block per uplink; switches
+  // above: one route per leaf (pod) below plus one per uplink
+  for (uint32_t h = 0; h < clos->GetHosts ().GetN (); h++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (GetNRoutes (clos->GetHost (h)), 1, "wrong routes on host " << h);
+    }
+  uint32_t leafUplinks = m_k ? m_k / 2 : m_nSpines;
+  for (uint32_t l = 0; l < m_nLeaves; l++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (GetNRoutes (clos->GetLeaf (l)), leafUplinks, "wrong routes on leaf " << l);
+    }
+  for (uint32_t a = 0; a < clos->GetAggregations ().GetN (); a++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (GetNRoutes (clos->GetAggregations ().Get (a)), m_k, "wrong routes on aggregation " << a);
+    }
+  for (uint32_t s = 0; s < m_nSpines; s++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (GetNRoutes (clos->GetSpine (s)), m_k ? m_k : m_nLeaves, "wrong routes on spine " << s);
+    }
+
+  // every host is reachable from the first one
+  Ptr<Socket> tx = Socket::CreateSocket (clos->GetHost (0), UdpSocketFactory::GetTypeId ());
+  for (uint32_t h = 1; h < clos->GetHosts ().GetN (); h++)
+    {
+      Ptr<Socket> rx = Socket::CreateSocket (clos->GetHost (h), UdpSocketFactory::GetTypeId ());
+      rx->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+      rx->SetRecvCallback (MakeCallback (&PointToPointClosTestCase::Receive, this));
+      Simulator::Schedule (MilliSeconds (h), &PointToPointClosTestCase::Send, tx, clos->GetHostIpv4Address (h));
+    }
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, clos->GetHosts ().GetN () - 1, "not every host reached");
+
+  delete clos;
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief TestSuite for the Clos topology helper
+ */
+class PointToPointClosTestSuite : public TestSuite
+{
+public:
+  PointToPointClosTestSuite ();
+};
+
+PointToPointClosTestSuite::PointToPointClosTestSuite ()
+  : TestSuite ("point-to-point-clos", UNIT)
+{
+  AddTestCase (new PointToPointClosTestCase (2, 3, 3), TestCase::QUICK);
+  AddTestCase (new PointToPointClosTestCase (4), TestCase::QUICK);
+}
+
+static PointToPointClosTestSuite g_pointToPointClosTestSuite; //!< The testsuite
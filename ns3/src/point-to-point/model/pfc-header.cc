@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "pfc-header.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (PfcHeader);
+
+/// the size of the MAC control payload, padding included
+static const uint32_t PFC_PAYLOAD_SIZE = 46;
+
+PfcHeader::PfcHeader ()
+  : m_opcode (OPCODE),
+    m_enable (0)
+{
+  for (uint8_t i = 0; i < PRIORITIES; i++)
+    {
+      m_quanta[i] = 0;
+    }
+}
+
+PfcHeader::~PfcHeader ()
+{
+}
+
+TypeId
+PfcHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PfcHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<PfcHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+PfcHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+PfcHeader::Print (std::ostream &os) const
+{
+  os << "PFC opcode=0x" << std::hex << m_opcode << std::dec;
+  for (uint8_t i = 0; i < PRIORITIES; i++)
+    {
+      if (IsEnabled (i))
+        {
+          os << " prio" << (uint32_t) i << "=" << m_quanta[i];
+        }
+    }
+}
+
+uint32_t
+PfcHeader::GetSerializedSize (void) const
+{
+  return PFC_PAYLOAD_SIZE;
+}
+
+void
+PfcHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU16 (m_opcode);
+  start.WriteHtonU16 (m_enable);
+  for (uint8_t i = 0; i < PRIORITIES; i++)
+    {
+      start.WriteHtonU16 (m_quanta[i]);
+    }
+  start.WriteU8 (0, PFC_PAYLOAD_SIZE - 4 - 2 * PRIORITIES);
+}
+
+uint32_t
+PfcHeader::Deserialize (Buffer::Iterator start)
+{
+  m_opcode = start.ReadNtohU16 ();
+  m_enable = start.ReadNtohU16 ();
+  for (uint8_t i = 0; i < PRIORITIES; i++)
+    {
+      m_quanta[i] = start.ReadNtohU16 ();
+    }
+  start.Next (PFC_PAYLOAD_SIZE - 4 - 2 * PRIORITIES);
+  return GetSerializedSize ();
+}
+
+void
+PfcHeader::SetQuanta (uint8_t priority, uint16_t quanta)
+{
+  NS_ASSERT (priority < PRIORITIES);
+  m_enable |= (1 << priority);
+  m_quanta[priority] = quanta;
+}
+
+bool
+PfcHeader::IsEnabled (uint8_t priority) const
+{
+  return priority < PRIORITIES && (m_enable & (1 << priority));
+}
+
+uint16_t
+PfcHeader::GetQuanta (uint8_t priority) const
+{
+  NS_ASSERT (priority < PRIORITIES);
+  return m_quanta[priority];
+}
+
+uint16_t
+PfcHeader::GetOpcode (void) const
+{
+  return m_opcode;
+}
+
+} // namespace ns3
@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PFC_HEADER_H
+#define PFC_HEADER_H
+
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Priority-based flow control (IEEE 802.1Qbb) PAUSE frame
+ *
+ * The MAC control payload of a PFC frame: the opcode, the class-enable
+ * vector and one pause time per priority, padded to the 46 bytes of a
+ * minimum size Ethernet payload. A pause time is expressed in quanta of
+ * 512 bit times at the speed of the link; a zero pause time resumes the
+ * priority immediately.
+ *
+ * PointToPointNetDevice carries these frames with the MAC control
+ * EtherType (0x8808) in the PPP protocol field.
+ */
+class PfcHeader : public Header
+{
+public:
+  /// the number of priorities
+  static const uint8_t PRIORITIES = 8;
+  /// the protocol number of MAC control frames
+  static const uint16_t PROT_NUMBER = 0x8808;
+  /// the PFC opcode
+  static const uint16_t OPCODE = 0x0101;
+
+  PfcHeader ();
+  virtual ~PfcHeader ();
+
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  virtual void Print (std::ostream &os) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual uint32_t GetSerializedSize (void) const;
+
+  /**
+   * \brief Set the pause time of a priority and enable it in the frame
+   * \param priority the priority
+   * \param quanta the pause time, in quanta of 512 bit times
+   */
+  void SetQuanta (uint8_t priority, uint16_t quanta);
+
+  /**
+   * \param priority the priority
+   * \return true if the frame carries a pause time for this priority
+   */
+  bool IsEnabled (uint8_t priority) const;
+
+  /**
+   * \param priority the priority
+   * \return the pause time of the priority, in quanta of 512 bit times
+   */
+  uint16_t GetQuanta (uint8_t priority) const;
+
+  /**
+   * \return the opcode of the frame
+   */
+  uint16_t GetOpcode (void) const;
+
+private:
+  uint16_t m_opcode;                  //!< MAC control opcode
+  uint16_t m_enable;                  //!< class-enable vector
+  uint16_t m_quanta[PRIORITIES];      //!< pause time of every priority
+};
+
+} // namespace ns3
+
+#endif /* PFC_HEADER_H */
@@ -73,7 +73,8 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
-    m_nDevices (0)
+    m_nDevices (0),
+    m_linkUp (true)
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_rand_delay = CreateObject<UniformRandomVariable> ();
@@ -112,6 +113,12 @@ PointToPointChannel::TransmitStart (
   NS_ASSERT (m_link[0].m_state != INITIALIZING);
   NS_ASSERT (m_link[1].m_state != INITIALIZING);
 
+  if (!m_linkUp)
+    {
+      NS_LOG_LOGIC ("Link down, frame lost");
+      return false;
+    }
+
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
   if (m_useJitter)
@@ -120,15 +127,74 @@ PointToPointChannel::TransmitStart (
                                                        m_maxJitter.GetNanoSeconds ()));
     }
 
+  Time delay = txTime + m_delay + m_link[wire].m_queueingDelay;
+  if (!m_useJitter)
+    {
+      // keep the frames in order when the delays shrink
+      Time arrival = Max (Simulator::Now () + delay, m_link[wire].m_lastArrival);
+      delay = arrival - Simulator::Now ();
+      m_link[wire].m_lastArrival = arrival;
+    }
+
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
-                                  txTime + m_delay, &PointToPointNetDevice::Receive,
+                                  delay, &PointToPointNetDevice::Receive,
                                   m_link[wire].m_dst, p);
 
   // Call the tx anim callback on the net device
-  m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+  m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, delay);
   return true;
 }
 
+void
+PointToPointChannel::SetLinkDown (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_linkUp)
+    {
+      return;
+    }
+  m_linkUp = false;
+  for (int32_t i = 0; i < m_nDevices; i++)
+    {
+      m_link[i].m_src->NotifyLinkDown ();
+    }
+}
+
+void
+PointToPointChannel::SetLinkUp (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_linkUp)
+    {
+      return;
+    }
+  m_linkUp = true;
+  for (int32_t i = 0; i < m_nDevices; i++)
+    {
+      m_link[i].m_src->NotifyLinkUp ();
+    }
+}
+
+bool
+PointToPointChannel::IsLinkUp (void) const
+{
+  return m_linkUp;
+}
+
+void
+PointToPointChannel::SetDelay (Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  m_delay = delay;
+}
+
+void
+PointToPointChannel::SetQueueingDelay (Ptr<PointToPointNetDevice> src, Time delay)
+{
+  NS_LOG_FUNCTION (this << src << delay);
+  m_link[src == m_link[0].m_src ? 0 : 1].m_queueingDelay = delay;
+}
+
 uint32_t 
 PointToPointChannel::GetNDevices (void) const
 {
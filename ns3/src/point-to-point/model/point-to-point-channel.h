@@ -77,10 +77,45 @@ public:
    * \param p Packet to transmit
    * \param src Source PointToPointNetDevice
    * \param txTime Transmit time to apply
-   * \returns true if successful (currently always true)
+   * \returns true if successful, false if the link is down
    */
   virtual bool TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+  /**
+   * \brief Cut the link
+   *
+   * The frames sent while the link is down are dropped by the devices,
+   * those already on the wire are still delivered.
+   */
+  void SetLinkDown (void);
+
+  /**
+   * \brief Restore the link
+   */
+  void SetLinkUp (void);
+
+  /**
+   * \returns true unless the link has been cut
+   */
+  bool IsLinkUp (void) const;
+
+  /**
+   * \brief Change the propagation delay, for the frames sent from now on
+   * \param delay the new delay
+   */
+  void SetDelay (Time delay);
+
+  /**
+   * \brief Delay the frames sent by a device from now on, by the queue
+   * of traffic which is not simulated as packets
+   *
+   * The frames of a wire still arrive in the order they were sent,
+   * unless jitter is used.
+   * \param src the sending device
+   * \param delay the queueing delay
+   */
+  void SetQueueingDelay (Ptr<PointToPointNetDevice> src, Time delay);
+
   /**
    * \brief Get number of devices on this channel
    * \returns number of devices on this channel
@@ -152,6 +187,7 @@ private:
 
   Time          m_delay;    //!< Propagation delay
   int32_t       m_nDevices; //!< Devices of this channel
+  bool          m_linkUp;   //!< The link has not been cut
 
   bool          m_useJitter;
   Time 					m_minJitter; //!<minimum jitter delay time for packets sent
@@ -205,6 +241,8 @@ public:
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    Time                       m_queueingDelay; //!< Delay added to the frames
+    Time                       m_lastArrival;   //!< Arrival time of the last frame
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
@@ -25,6 +25,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/socket.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -67,6 +69,13 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("PfcEnabled",
+                   "Enable priority-based flow control (802.1Qbb), with one "
+                   "transmission queue per priority. Must be set before the "
+                   "traffic control layer is set up on the device.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_pfcEnabled),
+                   MakeBooleanChecker ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -167,6 +176,25 @@ PointToPointNetDevice::GetTypeId (void)
                      "attached to the device",
                      MakeTraceSourceAccessor (&PointToPointNetDevice::m_promiscSnifferTrace),
                      "ns3::Packet::TracedCallback")
+
+    //
+    // Trace sources of priority-based flow control.
+    //
+    .AddTraceSource ("PfcTx",
+                     "A PFC frame pausing (or resuming, with 0 quanta) "
+                     "a priority has been sent to the peer",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_pfcTxTrace),
+                     "ns3::PointToPointNetDevice::PfcTracedCallback")
+    .AddTraceSource ("PfcRx",
+                     "A PFC frame pausing (or resuming, with 0 quanta) "
+                     "a priority has been received from the peer",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_pfcRxTrace),
+                     "ns3::PointToPointNetDevice::PfcTracedCallback")
+    .AddTraceSource ("Pause",
+                     "A priority paused by the peer resumes, with the "
+                     "time it has been paused",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_pauseTrace),
+                     "ns3::PointToPointNetDevice::PauseTracedCallback")
   ;
   return tid;
 }
@@ -177,9 +205,14 @@ PointToPointNetDevice::PointToPointNetDevice ()
     m_txMachineState (READY),
     m_channel (0),
     m_linkUp (false),
-    m_currentPkt (0)
+    m_currentPkt (0),
+    m_pfcEnabled (false)
 {
   NS_LOG_FUNCTION (this);
+  for (uint8_t i = 0; i < PfcHeader::PRIORITIES; i++)
+    {
+      m_paused[i] = false;
+    }
 }
 
 PointToPointNetDevice::~PointToPointNetDevice ()
@@ -218,6 +251,11 @@ PointToPointNetDevice::NotifyNewAggregate (void)
       if (ndqi != 0)
         {
           m_queueInterface = ndqi;
+          if (m_pfcEnabled)
+            {
+              ndqi->SetTxQueuesN (PfcHeader::PRIORITIES);
+              ndqi->SetSelectQueueCallback (MakeCallback (&PointToPointNetDevice::SelectPfcQueue));
+            }
         }
     }
   NetDevice::NotifyNewAggregate ();
@@ -233,6 +271,12 @@ PointToPointNetDevice::DoDispose ()
   m_currentPkt = 0;
   m_queue = 0;
   m_queueInterface = 0;
+  m_pfcIngressCallback = MakeNullCallback<bool, Ptr<PointToPointNetDevice>, Ptr<const Packet>, uint8_t> ();
+  m_pfcFrames.clear ();
+  for (uint8_t i = 0; i < PfcHeader::PRIORITIES; i++)
+    {
+      m_resumeEvent[i].Cancel ();
+    }
   NetDevice::DoDispose ();
 }
 
@@ -299,6 +343,17 @@ PointToPointNetDevice::TransmitComplete (void)
   m_phyTxEndTrace (m_currentPkt);
   m_currentPkt = 0;
 
+  // PFC frames go before any data
+  if (!m_pfcFrames.empty ())
+    {
+      Ptr<Packet> frame = m_pfcFrames.front ();
+      m_pfcFrames.pop_front ();
+      m_snifferTrace (frame);
+      m_promiscSnifferTrace (frame);
+      TransmitStart (frame);
+      return;
+    }
+
   Ptr<NetDeviceQueue> txq;
   if (m_queueInterface)
   {
@@ -309,6 +364,11 @@ PointToPointNetDevice::TransmitComplete (void)
   if (item == 0)
     {
       NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
+      if (m_pfcEnabled)
+        {
+          WakeTxQueues ();
+          return;
+        }
       if (txq)
       {
         NS_LOG_DEBUG ("The device queue is being woken up (" << m_queue->GetNPackets () <<
@@ -405,6 +465,25 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
       m_promiscSnifferTrace (packet);
       m_phyRxEndTrace (packet);
 
+      //
+      // MAC control frames are consumed by the device.
+      //
+      PppHeader ppp;
+      packet->PeekHeader (ppp);
+      if (ppp.GetProtocol () == PfcHeader::PROT_NUMBER)
+        {
+          packet->RemoveHeader (ppp);
+          ReceivePfc (packet);
+          return;
+        }
+      if (m_pfcEnabled && !m_pfcIngressCallback.IsNull ()
+          && !m_pfcIngressCallback (this, packet, GetPfcPriority (packet)))
+        {
+          NS_LOG_LOGIC ("Frame not admitted by the ingress buffer");
+          m_phyRxDropTrace (packet);
+          return;
+        }
+
       //
       // Trace sinks will expect complete packets, not packets without some of the
       // headers.
@@ -445,6 +524,14 @@ PointToPointNetDevice::NotifyLinkUp (void)
   m_linkChangeCallbacks ();
 }
 
+void
+PointToPointNetDevice::NotifyLinkDown (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_linkUp = false;
+  m_linkChangeCallbacks ();
+}
+
 void
 PointToPointNetDevice::SetIfIndex (const uint32_t index)
 {
@@ -564,7 +651,7 @@ PointToPointNetDevice::Send (
   Ptr<NetDeviceQueue> txq;
   if (m_queueInterface)
   {
-    txq = m_queueInterface->GetTxQueue (0);
+    txq = m_queueInterface->GetTxQueue (m_queueInterface->GetNTxQueues () > 1 ? GetPfcPriority (packet) : 0);
   }
 
   NS_ASSERT_MSG (!txq || !txq->IsStopped (), "Send should not be called when the device is stopped");
@@ -629,6 +716,10 @@ PointToPointNetDevice::Send (
               // Inform BQL
               txq->NotifyTransmittedBytes (m_currentPkt->GetSize ());
             }
+          if (m_pfcEnabled)
+            {
+              StopTxQueues ();
+            }
           return ret;
         }
       // We have enqueued a packet but we have not dequeued any packet. Thus, we
@@ -751,6 +842,177 @@ PointToPointNetDevice::GetMtu (void) const
   return m_mtu;
 }
 
+void
+PointToPointNetDevice::SetPfcIngressCallback (PfcIngressCallback cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_pfcIngressCallback = cb;
+}
+
+bool
+PointToPointNetDevice::IsPfcEnabled (void) const
+{
+  return m_pfcEnabled;
+}
+
+bool
+PointToPointNetDevice::IsPaused (uint8_t priority) const
+{
+  return priority < PfcHeader::PRIORITIES && m_paused[priority];
+}
+
+uint8_t
+PointToPointNetDevice::GetPfcPriority (Ptr<const Packet> p)
+{
+  SocketPriorityTag priorityTag;
+  if (p->PeekPacketTag (priorityTag))
+    {
+      return std::min<uint8_t> (priorityTag.GetPriority (), PfcHeader::PRIORITIES - 1);
+    }
+  return 0;
+}
+
+uint8_t
+PointToPointNetDevice::SelectPfcQueue (Ptr<QueueItem> item)
+{
+  return GetPfcPriority (item->GetPacket ());
+}
+
+void
+PointToPointNetDevice::SendPfc (uint8_t priority, uint16_t quanta)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) priority << quanta);
+  NS_ASSERT (priority < PfcHeader::PRIORITIES);
+  if (!IsLinkUp ())
+    {
+      return;
+    }
+  PfcHeader pfc;
+  pfc.SetQuanta (priority, quanta);
+  Ptr<Packet> frame = Create<Packet> ();
+  frame->AddHeader (pfc);
+  PppHeader ppp;
+  ppp.SetProtocol (PfcHeader::PROT_NUMBER);
+  frame->AddHeader (ppp);
+  m_pfcTxTrace (priority, quanta);
+  if (m_txMachineState == READY)
+    {
+      m_snifferTrace (frame);
+      m_promiscSnifferTrace (frame);
+      TransmitStart (frame);
+      if (m_pfcEnabled)
+        {
+          StopTxQueues ();
+        }
+    }
+  else
+    {
+      m_pfcFrames.push_back (frame);
+    }
+}
+
+void
+PointToPointNetDevice::ReceivePfc (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  PfcHeader pfc;
+  p->RemoveHeader (pfc);
+  if (pfc.GetOpcode () != PfcHeader::OPCODE || !m_pfcEnabled)
+    {
+      NS_LOG_LOGIC ("Ignoring MAC control frame");
+      return;
+    }
+  for (uint8_t i = 0; i < PfcHeader::PRIORITIES; i++)
+    {
+      if (pfc.IsEnabled (i))
+        {
+          uint16_t quanta = pfc.GetQuanta (i);
+          m_pfcRxTrace (i, quanta);
+          if (quanta == 0)
+            {
+              Resume (i);
+            }
+          else
+            {
+              // a quantum is 512 bit times
+              Pause (i, m_bps.CalculateBytesTxTime (64 * quanta));
+            }
+        }
+    }
+}
+
+void
+PointToPointNetDevice::Pause (uint8_t priority, Time duration)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) priority << duration);
+  if (!m_paused[priority])
+    {
+      m_paused[priority] = true;
+      m_pauseStart[priority] = Simulator::Now ();
+      if (m_queueInterface && priority < m_queueInterface->GetNTxQueues ())
+        {
+          m_queueInterface->GetTxQueue (priority)->Stop ();
+        }
+    }
+  // a new PAUSE replaces the remaining time of the previous one
+  m_resumeEvent[priority].Cancel ();
+  m_resumeEvent[priority] = Simulator::Schedule (duration, &PointToPointNetDevice::Resume, this, priority);
+}
+
+void
+PointToPointNetDevice::Resume (uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) priority);
+  m_resumeEvent[priority].Cancel ();
+  if (!m_paused[priority])
+    {
+      return;
+    }
+  m_paused[priority] = false;
+  m_pauseTrace (priority, Simulator::Now () - m_pauseStart[priority]);
+  if (m_txMachineState == READY && m_queue->IsEmpty ())
+    {
+      WakeTxQueues ();
+    }
+}
+
+void
+PointToPointNetDevice::StopTxQueues (void)
+{
+  if (!m_queueInterface)
+    {
+      return;
+    }
+  for (uint8_t i = 0; i < m_queueInterface->GetNTxQueues (); i++)
+    {
+      m_queueInterface->GetTxQueue (i)->Stop ();
+    }
+}
+
+void
+PointToPointNetDevice::WakeTxQueues (void)
+{
+  if (!m_queueInterface)
+    {
+      return;
+    }
+  // start all the queues the peer did not pause before waking one, since
+  // they share the root queue disc
+  int32_t wake = -1;
+  for (uint8_t i = 0; i < m_queueInterface->GetNTxQueues (); i++)
+    {
+      if (!IsPaused (i))
+        {
+          m_queueInterface->GetTxQueue (i)->Start ();
+          wake = (wake < 0) ? i : wake;
+        }
+    }
+  if (wake >= 0)
+    {
+      m_queueInterface->GetTxQueue (wake)->Wake ();
+    }
+}
+
 uint16_t
 PointToPointNetDevice::PppToEther (uint16_t proto)
 {
@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <deque>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -30,10 +31,13 @@
 #include "ns3/data-rate.h"
 #include "ns3/ptr.h"
 #include "ns3/mac48-address.h"
+#include "ns3/event-id.h"
+#include "pfc-header.h"
 
 namespace ns3 {
 
 class Queue;
+class QueueItem;
 class PointToPointChannel;
 class ErrorModel;
 
@@ -58,6 +62,17 @@ class ErrorModel;
  * Key parameters or objects that can be specified for this device 
  * include a queue, data rate, and interframe transmission gap (the 
  * propagation delay is set in the PointToPointChannel).
+ *
+ * With the PfcEnabled attribute, the device implements priority-based
+ * flow control (IEEE 802.1Qbb). It then exposes one transmission queue
+ * per priority to the traffic control layer, selected by the
+ * SocketPriorityTag of the packets, and hands at most one frame at a
+ * time to the channel, so that packets wait in the root queue disc. A
+ * PAUSE frame received for a priority stops its transmission queue for
+ * the requested time, so the queue disc no longer dequeues that
+ * priority; a PfcQueueDisc keeps serving the other priorities meanwhile.
+ * PAUSE frames are sent with SendPfc, ahead of any queued data, and are
+ * not passed to the upper layers.
  */
 class PointToPointNetDevice : public NetDevice
 {
@@ -94,6 +109,20 @@ public:
    */
   void SetDataRate (DataRate bps);
 
+  /**
+   * \brief Make the link up and running
+   *
+   * It calls also the linkChange callback.
+   */
+  void NotifyLinkUp (void);
+
+  /**
+   * \brief Take the link down, called by the channel when it fails
+   *
+   * It calls also the linkChange callback.
+   */
+  void NotifyLinkDown (void);
+
   /**
    * Set the interframe gap used to separate packets.  The interframe gap
    * defines the minimum space required between packets sent by this device.
@@ -149,6 +178,65 @@ public:
    */
   void Receive (Ptr<Packet> p);
 
+  /**
+   * \brief Callback deciding whether a data frame received by a device
+   * with PFC enabled is accepted.
+   *
+   * The arguments are the receiving device, the frame and its priority.
+   * The frame is dropped if the callback returns false.
+   */
+  typedef Callback<bool, Ptr<PointToPointNetDevice>, Ptr<const Packet>, uint8_t> PfcIngressCallback;
+
+  /**
+   * \param cb the callback checking the frames received, e.g. to account
+   * for the ingress buffer of a switch.
+   */
+  void SetPfcIngressCallback (PfcIngressCallback cb);
+
+  /**
+   * \return true if priority-based flow control is enabled
+   */
+  bool IsPfcEnabled (void) const;
+
+  /**
+   * \brief Send a PFC frame to the peer device
+   *
+   * The frame is transmitted as soon as the current frame, if any, is
+   * completely transmitted.
+   *
+   * \param priority the priority to pause or resume
+   * \param quanta the pause time in quanta of 512 bit times, 0 to resume
+   */
+  void SendPfc (uint8_t priority, uint16_t quanta);
+
+  /**
+   * \param priority a priority
+   * \return true if the peer paused the transmission of this priority
+   */
+  bool IsPaused (uint8_t priority) const;
+
+  /**
+   * \param p a packet
+   * \return the PFC priority of the packet, from its SocketPriorityTag
+   */
+  static uint8_t GetPfcPriority (Ptr<const Packet> p);
+
+  /**
+   * TracedCallback signature for PFC frames.
+   *
+   * \param [in] priority the priority paused or resumed
+   * \param [in] quanta the pause time, 0 to resume
+   */
+  typedef void (* PfcTracedCallback) (uint8_t priority, uint16_t quanta);
+
+  /**
+   * TracedCallback signature for the end of a pause.
+   *
+   * \param [in] priority the priority
+   * \param [in] duration how long the priority was paused
+   */
+  typedef void (* PauseTracedCallback) (uint8_t priority, Time duration);
+
   // The remaining methods are documented in ns3::NetDevice*
 
   virtual void SetIfIndex (const uint32_t index);
@@ -278,11 +366,40 @@ private:
   void TransmitComplete (void);
 
   /**
-   * \brief Make the link up and running
-   *
-   * It calls also the linkChange callback.
+   * \brief Process a PFC frame received from the peer
+   * \param p the frame, without its PPP header
    */
-  void NotifyLinkUp (void);
+  void ReceivePfc (Ptr<Packet> p);
+
+  /**
+   * \brief Stop the transmission of a priority
+   * \param priority the priority
+   * \param duration the pause time
+   */
+  void Pause (uint8_t priority, Time duration);
+
+  /**
+   * \brief Resume the transmission of a priority
+   * \param priority the priority
+   */
+  void Resume (uint8_t priority);
+
+  /**
+   * \brief Stop all the transmission queues while a frame is transmitted
+   */
+  void StopTxQueues (void);
+
+  /**
+   * \brief Start the transmission queues of the priorities not paused and
+   * ask the queue disc for the next packet
+   */
+  void WakeTxQueues (void);
+
+  /**
+   * \param item a queue item
+   * \return the transmission queue of the item, i.e., its PFC priority
+   */
+  static uint8_t SelectPfcQueue (Ptr<QueueItem> item);
 
   /**
    * Enumeration of the states of the transmit machine of the net device.
@@ -460,6 +577,20 @@ private:
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
 
+  bool m_pfcEnabled;                          //!< priority-based flow control enabled
+  PfcIngressCallback m_pfcIngressCallback;    //!< admission of received data frames
+  std::deque<Ptr<Packet> > m_pfcFrames;       //!< PFC frames waiting for the channel
+  bool m_paused[PfcHeader::PRIORITIES];       //!< priorities paused by the peer
+  Time m_pauseStart[PfcHeader::PRIORITIES];   //!< start of the current pauses
+  EventId m_resumeEvent[PfcHeader::PRIORITIES]; //!< end of the current pauses
+
+  /// The trace source fired when a PFC frame is sent, for each priority
+  TracedCallback<uint8_t, uint16_t> m_pfcTxTrace;
+  /// The trace source fired when a PFC frame is received, for each priority
+  TracedCallback<uint8_t, uint16_t> m_pfcRxTrace;
+  /// The trace source fired when a paused priority resumes
+  TracedCallback<uint8_t, Time> m_pauseTrace;
+
   /**
    * \brief PPP to Ethernet protocol number mapping
    * \param protocol A PPP protocol number
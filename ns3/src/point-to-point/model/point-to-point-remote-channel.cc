@@ -63,6 +63,10 @@ PointToPointRemoteChannel::TransmitStart (
   NS_LOG_LOGIC ("UID is " << p->GetUid () << ")");
 
   IsInitialized ();
+  if (!IsLinkUp ())
+    {
+      return false;
+    }
 
   uint32_t wire = src == GetSource (0) ? 0 : 1;
   Ptr<PointToPointNetDevice> dst = GetDestination (wire);
@@ -23,6 +23,8 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/boolean.h"
+#include "ns3/socket.h"
 
 using namespace ns3;
 
@@ -100,6 +102,268 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for priority-based flow control
+ *
+ * One device pauses a priority of its peer, which stops only the
+ * transmission queue of that priority until the pause time elapses.
+ */
+class PointToPointPfcTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointPfcTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Check the queues of the paused device
+   *
+   * \param device the paused device
+   */
+  void CheckPaused (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Record the end of a pause
+   *
+   * \param priority the priority
+   * \param duration the pause time
+   */
+  void Resumed (uint8_t priority, Time duration);
+
+  /**
+   * \brief Count the frames passed up by a device
+   *
+   * \param device the device
+   * \param p the frame
+   * \param protocol the protocol number
+   * \param from the sender
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  uint32_t m_received;  //!< frames passed up
+  uint32_t m_resumed;   //!< pauses ended
+  Time m_duration;      //!< duration of the last pause
+};
+
+PointToPointPfcTest::PointToPointPfcTest ()
+  : TestCase ("PointToPoint PFC"),
+    m_received (0),
+    m_resumed (0)
+{
+}
+
+void
+PointToPointPfcTest::CheckPaused (Ptr<PointToPointNetDevice> device)
+{
+  Ptr<NetDeviceQueueInterface> iface = device->GetObject<NetDeviceQueueInterface> ();
+  NS_TEST_EXPECT_MSG_EQ (device->IsPaused (3), true, "priority 3 not paused");
+  NS_TEST_EXPECT_MSG_EQ (device->IsPaused (0), false, "priority 0 paused");
+  NS_TEST_EXPECT_MSG_EQ (iface->GetTxQueue (3)->IsStopped (), true, "queue 3 not stopped");
+  NS_TEST_EXPECT_MSG_EQ (iface->GetTxQueue (0)->IsStopped (), false, "queue 0 stopped");
+
+  // other priorities still go through
+  Ptr<Packet> p = Create<Packet> (100);
+  SocketPriorityTag priorityTag;
+  priorityTag.SetPriority (0);
+  p->AddPacketTag (priorityTag);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+void
+PointToPointPfcTest::Resumed (uint8_t priority, Time duration)
+{
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) priority, 3, "wrong priority resumed");
+  m_resumed++;
+  m_duration = duration;
+}
+
+bool
+PointToPointPfcTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+PointToPointPfcTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->SetAttribute ("PfcEnabled", BooleanValue (true));
+  devA->SetDataRate (DataRate ("1Mbps"));
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue> ());
+  devB->SetAttribute ("PfcEnabled", BooleanValue (true));
+  devB->SetDataRate (DataRate ("1Mbps"));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  Ptr<NetDeviceQueueInterface> ifaceA = CreateObject<NetDeviceQueueInterface> ();
+  devA->AggregateObject (ifaceA);
+  ifaceA->CreateTxQueues ();
+  Ptr<NetDeviceQueueInterface> ifaceB = CreateObject<NetDeviceQueueInterface> ();
+  devB->AggregateObject (ifaceB);
+  ifaceB->CreateTxQueues ();
+  NS_TEST_ASSERT_MSG_EQ (ifaceA->GetNTxQueues (), 8, "one queue per priority expected");
+
+  devA->SetReceiveCallback (MakeCallback (&PointToPointPfcTest::Receive, this));
+  devB->SetReceiveCallback (MakeCallback (&PointToPointPfcTest::Receive, this));
+  devA->TraceConnectWithoutContext ("Pause", MakeCallback (&PointToPointPfcTest::Resumed, this));
+
+  // 1000 quanta of 512 bits at 1 Mb/s
+  Simulator::Schedule (Seconds (1.0), &PointToPointNetDevice::SendPfc, devB, 3, 1000);
+  Simulator::Schedule (Seconds (1.1), &PointToPointPfcTest::CheckPaused, this, devA);
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_resumed, 1, "the pause did not end once");
+  NS_TEST_EXPECT_MSG_EQ (m_duration, MicroSeconds (512000), "wrong pause time");
+  NS_TEST_EXPECT_MSG_EQ (devA->IsPaused (3), false, "priority 3 still paused");
+  NS_TEST_EXPECT_MSG_EQ (ifaceA->GetTxQueue (3)->IsStopped (), false, "queue 3 still stopped");
+  // only the data frame is passed up
+  NS_TEST_EXPECT_MSG_EQ (m_received, 1, "wrong number of frames received");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test class for link failures
+ *
+ * Frames sent while the link is down are dropped, and delivered again
+ * once it is back up.
+ */
+class PointToPointLinkFailureTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointLinkFailureTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send one frame from a device
+   *
+   * \param device the sending device
+   */
+  void SendOnePacket (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Count the frames passed up by a device
+   *
+   * \param device the device
+   * \param p the frame
+   * \param protocol the protocol number
+   * \param from the sender
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Count the frames dropped by a device
+   *
+   * \param p the frame
+   */
+  void Drop (Ptr<const Packet> p);
+
+  uint32_t m_received; //!< frames passed up
+  uint32_t m_dropped;  //!< frames dropped
+};
+
+PointToPointLinkFailureTest::PointToPointLinkFailureTest ()
+  : TestCase ("PointToPoint link failure"),
+    m_received (0),
+    m_dropped (0)
+{
+}
+
+void
+PointToPointLinkFailureTest::SendOnePacket (Ptr<PointToPointNetDevice> device)
+{
+  device->Send (Create<Packet> (100), device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointLinkFailureTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+PointToPointLinkFailureTest::Drop (Ptr<const Packet> p)
+{
+  m_dropped++;
+}
+
+void
+PointToPointLinkFailureTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue> ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  Ptr<NetDeviceQueueInterface> ifaceA = CreateObject<NetDeviceQueueInterface> ();
+  devA->AggregateObject (ifaceA);
+  ifaceA->CreateTxQueues ();
+  Ptr<NetDeviceQueueInterface> ifaceB = CreateObject<NetDeviceQueueInterface> ();
+  devB->AggregateObject (ifaceB);
+  ifaceB->CreateTxQueues ();
+
+  devB->SetReceiveCallback (MakeCallback (&PointToPointLinkFailureTest::Receive, this));
+  devA->TraceConnectWithoutContext ("MacTxDrop", MakeCallback (&PointToPointLinkFailureTest::Drop, this));
+  devA->TraceConnectWithoutContext ("PhyTxDrop", MakeCallback (&PointToPointLinkFailureTest::Drop, this));
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointLinkFailureTest::SendOnePacket, this, devA);
+  Simulator::Schedule (Seconds (2.0), &PointToPointChannel::SetLinkDown, channel);
+  Simulator::Schedule (Seconds (2.1), &PointToPointLinkFailureTest::SendOnePacket, this, devA);
+  Simulator::Schedule (Seconds (3.0), &PointToPointChannel::SetLinkUp, channel);
+  Simulator::Schedule (Seconds (3.1), &PointToPointLinkFailureTest::SendOnePacket, this, devA);
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 2, "wrong number of frames received");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped, 1, "frame sent on a link down not dropped");
+  NS_TEST_EXPECT_MSG_EQ (channel->IsLinkUp (), true, "link not back up");
+  NS_TEST_EXPECT_MSG_EQ (devA->IsLinkUp (), true, "device not back up");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -116,6 +380,8 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPfcTest, TestCase::QUICK);
+  AddTestCase (new PointToPointLinkFailureTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
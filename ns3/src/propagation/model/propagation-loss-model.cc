@@ -29,6 +29,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include <cmath>
+#include <limits>
 
 namespace ns3 {
 
@@ -82,6 +83,28 @@ PropagationLossModel::CalcRxPower (double txPowerDbm,
   return self;
 }
 
+double
+PropagationLossModel::GetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  double range = DoGetMaxRange (txPowerDbm, rxPowerDbm);
+  if (m_next != 0)
+    {
+      double next = m_next->GetMaxRange (txPowerDbm, rxPowerDbm);
+      if (std::isinf (range) || std::isinf (next))
+        {
+          return std::numeric_limits<double>::infinity ();
+        }
+      range = std::min (range, next);
+    }
+  return range;
+}
+
+double
+PropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  return std::numeric_limits<double>::infinity ();
+}
+
 int64_t
 PropagationLossModel::AssignStreams (int64_t stream)
 {
@@ -277,6 +300,18 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FriisPropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  double budget = txPowerDbm - rxPowerDbm;
+  if (budget < m_minLoss)
+    {
+      return 0;
+    }
+  // invert lossDb = 20 log10 (4 * pi * d / lambda) + 10 log10 (L)
+  return m_lambda / (4 * M_PI) * std::pow (10.0, (budget - 10 * std::log10 (m_systemLoss)) / 20);
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -540,6 +575,19 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+LogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (m_exponent <= 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  // no loss is applied within the reference distance
+  double distance = m_referenceDistance
+    * std::pow (10.0, (txPowerDbm - m_referenceLoss - rxPowerDbm) / (10 * m_exponent));
+  return std::max (distance, m_referenceDistance);
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -642,6 +690,34 @@ ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+ThreeLogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (m_exponent0 <= 0 || m_exponent1 <= 0 || m_exponent2 <= 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  double budget = txPowerDbm - rxPowerDbm;
+  // no loss is applied below the first distance field
+  if (budget <= m_referenceLoss)
+    {
+      return m_distance0;
+    }
+  double distance = m_distance0 * std::pow (10.0, (budget - m_referenceLoss) / (10 * m_exponent0));
+  if (distance < m_distance1)
+    {
+      return distance;
+    }
+  double loss = m_referenceLoss + 10 * m_exponent0 * std::log10 (m_distance1 / m_distance0);
+  distance = m_distance1 * std::pow (10.0, (budget - loss) / (10 * m_exponent1));
+  if (distance < m_distance2)
+    {
+      return distance;
+    }
+  loss += 10 * m_exponent1 * std::log10 (m_distance2 / m_distance1);
+  return m_distance2 * std::pow (10.0, (budget - loss) / (10 * m_exponent2));
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (NakagamiPropagationLossModel);
@@ -930,6 +1006,16 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+RangePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (rxPowerDbm <= -1000)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  return txPowerDbm >= rxPowerDbm ? m_range : 0;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
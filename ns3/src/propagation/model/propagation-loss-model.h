@@ -106,6 +106,22 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Returns the distance beyond which the Rx Power computed by
+   * CalcRxPower is below a threshold, taking into account all the
+   * PropagationLossModel(s) chained to the current one.
+   *
+   * The range of a chain is the smallest range of its models, which
+   * assumes that no model of the chain amplifies the signal.  It is
+   * infinite as soon as one model of the chain cannot bound it, e.g.
+   * because it is random or does not depend on the distance.
+   *
+   * \param txPowerDbm transmission power (in dBm)
+   * \param rxPowerDbm the reception threshold (in dBm)
+   * \returns the range (in meters), possibly infinite
+   */
+  double GetMaxRange (double txPowerDbm, double rxPowerDbm) const;
+
 private:
   /**
    * \brief Copy constructor
@@ -140,6 +156,16 @@ private:
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
+  /**
+   * Returns the range of this particular PropagationLossModel; the
+   * default implementation returns infinity.
+   *
+   * \param txPowerDbm transmission power (in dBm)
+   * \param rxPowerDbm the reception threshold (in dBm)
+   * \returns the distance beyond which DoCalcRxPower is below rxPowerDbm
+   */
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
+
   Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -322,6 +348,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +557,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   /**
    *  Creates a default reference loss model
@@ -613,6 +641,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   double m_distance0; //!< Beginning of the first (near) distance field
   double m_distance1; //!< Beginning of the second (middle) distance field.
@@ -852,6 +881,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
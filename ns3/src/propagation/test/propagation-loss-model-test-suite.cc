@@ -25,6 +25,9 @@
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("PropagationLossModelsTest");
@@ -436,6 +439,65 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class MaxRangePropagationLossModelTestCase : public TestCase
+{
+public:
+  MaxRangePropagationLossModelTestCase ();
+  virtual ~MaxRangePropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that the rx power crosses the threshold at the range of the model
+   */
+  void CheckRange (Ptr<PropagationLossModel> model, double txPowerDbm, double rxPowerDbm);
+};
+
+MaxRangePropagationLossModelTestCase::MaxRangePropagationLossModelTestCase ()
+  : TestCase ("Test PropagationLossModel::GetMaxRange")
+{
+}
+
+MaxRangePropagationLossModelTestCase::~MaxRangePropagationLossModelTestCase ()
+{
+}
+
+void
+MaxRangePropagationLossModelTestCase::CheckRange (Ptr<PropagationLossModel> model, double txPowerDbm, double rxPowerDbm)
+{
+  double range = model->GetMaxRange (txPowerDbm, rxPowerDbm);
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0,0,0));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  b->SetPosition (Vector (range * 0.999,0,0));
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (model->CalcRxPower (txPowerDbm, a, b), rxPowerDbm, "below the threshold within range " << range);
+  b->SetPosition (Vector (range * 1.001,0,0));
+  NS_TEST_EXPECT_MSG_LT (model->CalcRxPower (txPowerDbm, a, b), rxPowerDbm, "above the threshold beyond range " << range);
+}
+
+void
+MaxRangePropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  CheckRange (friis, 20, -90);
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  CheckRange (logDistance, 16, -110);
+  Ptr<ThreeLogDistancePropagationLossModel> threeLog = CreateObject<ThreeLogDistancePropagationLossModel> ();
+  // one threshold in each distance field
+  CheckRange (threeLog, 0, -60);
+  CheckRange (threeLog, 0, -100);
+  CheckRange (threeLog, 0, -190);
+
+  // a chain is bounded by its shortest range
+  double range = logDistance->GetMaxRange (16, -110);
+  logDistance->SetNext (friis);
+  NS_TEST_EXPECT_MSG_EQ_TOL (logDistance->GetMaxRange (16, -110), std::min (range, friis->GetMaxRange (16, -110)), 1e-6, "wrong range of a chain");
+  // and unbounded as soon as one model is
+  friis->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+  NS_TEST_EXPECT_MSG_EQ (std::isinf (logDistance->GetMaxRange (16, -110)), true, "a random model bounds the range");
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +512,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new MaxRangePropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
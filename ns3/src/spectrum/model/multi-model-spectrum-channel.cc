@@ -34,7 +34,11 @@
 #include <ns3/propagation-delay-model.h>
 #include <ns3/antenna-model.h>
 #include <ns3/angles.h>
+#include <ns3/enum.h>
+#include <ns3/spatial-grid-index.h>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <utility>
 #include "multi-model-spectrum-channel.h"
 
@@ -82,6 +86,10 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_fanOut (FANOUT_ALL),
+    m_maxAntennaGainDb (0.0),
+    m_maxRange (0.0),
+    m_cellSize (0.0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -95,6 +103,13 @@ MultiModelSpectrumChannel::DoDispose ()
   m_spectrumPropagationLoss = 0;
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  if (m_index != 0)
+    {
+      m_index->Dispose ();
+      m_index = 0;
+    }
+  m_phys.clear ();
+  m_phyIds.clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -119,6 +134,34 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("FanOut",
+                   "How a transmission is delivered to the receivers: evaluate all of them, "
+                   "only those found by a spatial index within the distance at which the loss "
+                   "can stay below MaxLossDb, or all of them while checking that the receivers "
+                   "outside the indexed range are beyond MaxLossDb.",
+                   EnumValue (MultiModelSpectrumChannel::FANOUT_ALL),
+                   MakeEnumAccessor (&MultiModelSpectrumChannel::m_fanOut),
+                   MakeEnumChecker (MultiModelSpectrumChannel::FANOUT_ALL, "All",
+                                    MultiModelSpectrumChannel::FANOUT_INDEXED, "Indexed",
+                                    MultiModelSpectrumChannel::FANOUT_VALIDATE, "Validate"))
+    .AddAttribute ("MaxAntennaGain",
+                   "The largest sum of the TX and RX antenna gains in dB, "
+                   "used to derive the indexed range from MaxLossDb.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxAntennaGainDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "The distance (m) beyond which the Indexed fan-out does not evaluate a receiver; "
+                   "0 to derive it from the propagation loss model and MaxLossDb.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("GridCellSize",
+                   "The cell size (m) of the spatial index of the receivers; "
+                   "0 to use the indexed range.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_cellSize),
+                   MakeDoubleChecker<double> (0.0))
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -172,6 +215,13 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 
   ++m_numDevices;
 
+  if (m_phyIds.find (phy) == m_phyIds.end ())
+    {
+      // indexed on the next transmission, when its mobility model is known
+      m_phyIds[phy] = m_phys.size ();
+      m_phys.push_back (phy);
+    }
+
   RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.find (rxSpectrumModelUid);
 
   if (rxInfoIterator == m_rxSpectrumModelInfoMap.end ())
@@ -272,6 +322,12 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  std::set<Ptr<SpectrumPhy> > candidates;
+  if (m_fanOut != FANOUT_ALL)
+    {
+      FindCandidates (txMobility, &candidates);
+    }
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -294,86 +350,159 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
         }
 
 
+      if (m_fanOut == FANOUT_INDEXED)
+        {
+          for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = candidates.begin ();
+               rxPhyIterator != candidates.end ();
+               ++rxPhyIterator)
+            {
+              if (rxInfoIterator->second.m_rxPhySet.find (*rxPhyIterator) != rxInfoIterator->second.m_rxPhySet.end ())
+                {
+                  Deliver (txParams, convertedTxPowerSpectrum, txMobility, *rxPhyIterator);
+                }
+            }
+          continue;
+        }
+
       for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
            rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
            ++rxPhyIterator)
         {
-          NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
-                         "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
-
-          if ((*rxPhyIterator) != txParams->txPhy)
+          bool delivered = Deliver (txParams, convertedTxPowerSpectrum, txMobility, *rxPhyIterator);
+          if (m_fanOut == FANOUT_VALIDATE && delivered
+              && candidates.find (*rxPhyIterator) == candidates.end ())
             {
-              NS_LOG_LOGIC (" copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
-              Time delay = MicroSeconds (0);
+              NS_FATAL_ERROR ("receiver " << *rxPhyIterator << " outside the indexed range of "
+                              << GetMaxRange () << "m gets a signal at "
+                              << txMobility->GetDistanceFrom ((*rxPhyIterator)->GetMobility ()) << "m");
+            }
+        }
+    }
 
-              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+}
 
-              if (txMobility && receiverMobility)
-                {
-                  double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
-                    {
-                      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
-                      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-                      pathLossDb -= txAntennaGain;
-                    }
-                  Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
-                  if (rxAntenna != 0)
-                    {
-                      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
-                      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
-                      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-                      pathLossDb -= rxAntennaGain;
-                    }
-                  if (m_propagationLoss)
-                    {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
-                      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-                      pathLossDb -= propagationGainDb;
-                    }                    
-                  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
-                  m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
-                  if ( pathLossDb > m_maxLossDb)
-                    {
-                      // beyond range
-                      continue;
-                    }
-                  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-                  *(rxParams->psd) *= pathGainLinear;              
-
-                  if (m_spectrumPropagationLoss)
-                    {
-                      rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
-                    }
-
-                  if (m_propagationDelay)
-                    {
-                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
-                    }
-                }
+bool
+MultiModelSpectrumChannel::Deliver (Ptr<SpectrumSignalParameters> txParams, Ptr<SpectrumValue> txPowerSpectrum,
+                                    Ptr<MobilityModel> txMobility, Ptr<SpectrumPhy> receiver)
+{
+  NS_ASSERT_MSG (receiver->GetRxSpectrumModel ()->GetUid () == txPowerSpectrum->GetSpectrumModelUid (),
+                 "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
 
-              Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-              if (netDev)
-                {
-                  // the receiver has a NetDevice, so we expect that it is attached to a Node
-                  uint32_t dstNode =  netDev->GetNode ()->GetId ();
-                  Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
-                                                  rxParams, *rxPhyIterator);
-                }
-              else
-                {
-                  // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-                  Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
-                                       rxParams, *rxPhyIterator);
-                }
-            }
+  if (receiver == txParams->txPhy)
+    {
+      return false;
+    }
+
+  NS_LOG_LOGIC (" copying signal parameters " << txParams);
+  Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+  rxParams->psd = Copy<SpectrumValue> (txPowerSpectrum);
+  Time delay = MicroSeconds (0);
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+
+  if (txMobility && receiverMobility)
+    {
+      double pathLossDb = 0;
+      if (rxParams->txAntenna != 0)
+        {
+          Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
+          double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
+          NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+          pathLossDb -= txAntennaGain;
+        }
+      Ptr<AntennaModel> rxAntenna = receiver->GetRxAntenna ();
+      if (rxAntenna != 0)
+        {
+          Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
+          double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+          NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+          pathLossDb -= rxAntennaGain;
+        }
+      if (m_propagationLoss)
+        {
+          double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+          NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+          pathLossDb -= propagationGainDb;
+        }
+      NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");
+      m_pathLossTrace (txParams->txPhy, receiver, pathLossDb);
+      if ( pathLossDb > m_maxLossDb)
+        {
+          // beyond range
+          return false;
+        }
+      double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+      *(rxParams->psd) *= pathGainLinear;
+
+      if (m_spectrumPropagationLoss)
+        {
+          rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
         }
 
+      if (m_propagationDelay)
+        {
+          delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
+        }
+    }
+
+  Ptr<NetDevice> netDev = receiver->GetDevice ();
+  if (netDev)
+    {
+      // the receiver has a NetDevice, so we expect that it is attached to a Node
+      uint32_t dstNode =  netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
+                                      rxParams, receiver);
     }
+  else
+    {
+      // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+      Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
+                           rxParams, receiver);
+    }
+  return true;
+}
 
+void
+MultiModelSpectrumChannel::FindCandidates (Ptr<MobilityModel> txMobility, std::set<Ptr<SpectrumPhy> > *candidates)
+{
+  double range = GetMaxRange ();
+  if (m_index == 0 && txMobility != 0 && !std::isinf (range))
+    {
+      m_index = CreateObject<SpatialGridIndex> ();
+      m_index->SetCellSize (m_cellSize > 0 ? m_cellSize : std::max (range, 1.0));
+    }
+  if (m_index == 0 || txMobility == 0)
+    {
+      // the range is unbounded, every receiver is a candidate
+      candidates->insert (m_phys.begin (), m_phys.end ());
+      return;
+    }
+  for (uint32_t i = m_index->GetN (); i < m_phys.size (); i++)
+    {
+      m_index->Add (m_phys[i]->GetMobility ());
+    }
+  std::vector<uint32_t> ids;
+  m_index->Find (txMobility->GetPosition (), range, &ids);
+  for (std::vector<uint32_t>::const_iterator it = ids.begin (); it != ids.end (); ++it)
+    {
+      candidates->insert (m_phys[*it]);
+    }
+}
+
+double
+MultiModelSpectrumChannel::GetMaxRange (void) const
+{
+  if (m_maxRange > 0)
+    {
+      return m_maxRange;
+    }
+  if (m_propagationLoss == 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  // the loss exceeds MaxLossDb where the propagation gain is below
+  // -MaxLossDb - MaxAntennaGain
+  return m_propagationLoss->GetMaxRange (m_maxAntennaGainDb, -m_maxLossDb);
 }
 
 void
@@ -29,9 +29,13 @@
 #include <ns3/propagation-delay-model.h>
 #include <map>
 #include <set>
+#include <vector>
 
 namespace ns3 {
 
+class SpatialGridIndex;
+class MobilityModel;
+
 
 /**
  * \ingroup spectrum
@@ -102,6 +106,14 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * By default, a transmission is evaluated for every receiving
+ * SpectrumPhy.  With the Indexed fan-out, the receivers are kept in a
+ * SpatialGridIndex and only those within the distance at which the
+ * loss can stay below MaxLossDb are evaluated; the PathLoss trace is
+ * then only fired for them.  The Validate fan-out evaluates every
+ * receiver like the default one, and stops the simulation if a
+ * receiver outside the indexed range gets a signal.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -109,6 +121,16 @@ class MultiModelSpectrumChannel : public SpectrumChannel
 public:
   MultiModelSpectrumChannel ();
 
+  /**
+   * \brief how a transmission is delivered to the receivers
+   */
+  enum FanOut
+  {
+    FANOUT_ALL,       //!< evaluate every receiver
+    FANOUT_INDEXED,   //!< evaluate the receivers in range
+    FANOUT_VALIDATE   //!< evaluate every receiver, check the indexed range
+  };
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -133,6 +155,12 @@ public:
    */
   virtual Ptr<SpectrumPropagationLossModel> GetSpectrumPropagationLossModel (void);
 
+  /**
+   * \return the distance beyond which the loss exceeds MaxLossDb:
+   *         MaxRange if set, otherwise derived from the propagation loss
+   *         model and MaxAntennaGain, possibly infinite
+   */
+  double GetMaxRange (void) const;
 
 protected:
   void DoDispose ();
@@ -158,6 +186,26 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * Compute the signal received by one SpectrumPhy and schedule its
+   * reception, unless the loss exceeds MaxLossDb.
+   *
+   * @param txParams The signal parameters of the transmission.
+   * @param txPowerSpectrum The transmitted PSD, in the RX SpectrumModel.
+   * @param txMobility The mobility model of the transmitter.
+   * @param receiver A pointer to the receiver SpectrumPhy.
+   *
+   * @return true if a reception was scheduled
+   */
+  bool Deliver (Ptr<SpectrumSignalParameters> txParams, Ptr<SpectrumValue> txPowerSpectrum,
+                Ptr<MobilityModel> txMobility, Ptr<SpectrumPhy> receiver);
+
+  /**
+   * @param txMobility The mobility model of the transmitter.
+   * @param candidates The receivers which may be within range.
+   */
+  void FindCandidates (Ptr<MobilityModel> txMobility, std::set<Ptr<SpectrumPhy> > *candidates);
+
   /**
    * Propagation delay model to be used with this channel.
    */
@@ -201,6 +249,43 @@ private:
    */
   double m_maxLossDb;
 
+  /**
+   * How a transmission is delivered to the receivers.
+   */
+  enum FanOut m_fanOut;
+
+  /**
+   * Bound of the sum of the TX and RX antenna gains [dB], used to
+   * derive the range from MaxLossDb.
+   */
+  double m_maxAntennaGainDb;
+
+  /**
+   * Fixed range [m], 0 to derive it from the propagation loss model.
+   */
+  double m_maxRange;
+
+  /**
+   * Cell size of the index [m], 0 to use the range.
+   */
+  double m_cellSize;
+
+  /**
+   * Positions of the receivers, created on first use.
+   */
+  Ptr<SpatialGridIndex> m_index;
+
+  /**
+   * Every receiver ever added, in the order of the first call to AddRx;
+   * the ids of m_index are the positions in this vector.
+   */
+  std::vector<Ptr<SpectrumPhy> > m_phys;
+
+  /**
+   * Position of each receiver in m_phys.
+   */
+  std::map<Ptr<SpectrumPhy>, uint32_t> m_phyIds;
+
   /**
    * \deprecated The non-const \c Ptr<SpectrumPhy> argument
    * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
@@ -48,6 +48,8 @@
 #include <ns3/packet-socket-address.h>
 #include <ns3/packet-socket-client.h>
 #include <ns3/config.h>
+#include <ns3/double.h>
+#include <ns3/multi-model-spectrum-channel.h>
 
 
 using namespace ns3;
@@ -209,6 +211,82 @@ SpectrumIdealPhyTestCase::DoRun (void)
 }
 
 
+/**
+ * Check that the Indexed fan-out of MultiModelSpectrumChannel skips the
+ * receivers beyond MaxLossDb, and that Validate accepts its range.
+ */
+class SpectrumFanOutTestCase : public TestCase
+{
+public:
+  SpectrumFanOutTestCase (std::string fanOut);
+  virtual ~SpectrumFanOutTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void PathLoss (Ptr<SpectrumPhy> txPhy, Ptr<SpectrumPhy> rxPhy, double lossDb);
+
+  std::string m_fanOut;
+  uint32_t m_nPathLoss;
+};
+
+SpectrumFanOutTestCase::SpectrumFanOutTestCase (std::string fanOut)
+  : TestCase ("MultiModelSpectrumChannel FanOut=" + fanOut),
+    m_fanOut (fanOut)
+{
+}
+
+SpectrumFanOutTestCase::~SpectrumFanOutTestCase ()
+{
+}
+
+void
+SpectrumFanOutTestCase::PathLoss (Ptr<SpectrumPhy> txPhy, Ptr<SpectrumPhy> rxPhy, double lossDb)
+{
+  m_nPathLoss++;
+}
+
+void
+SpectrumFanOutTestCase::DoRun (void)
+{
+  NodeContainer c;
+  c.Create (3);
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (10.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (9000.0, 0.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (c);
+
+  SpectrumChannelHelper channelHelper;
+  channelHelper.SetChannel ("ns3::MultiModelSpectrumChannel",
+                            "FanOut", StringValue (m_fanOut),
+                            "MaxLossDb", DoubleValue (150));
+  channelHelper.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  channelHelper.AddPropagationLoss ("ns3::LogDistancePropagationLossModel");
+  Ptr<SpectrumChannel> channel = channelHelper.Create ();
+  channel->TraceConnectWithoutContext ("PathLoss", MakeCallback (&SpectrumFanOutTestCase::PathLoss, this));
+  // the default log distance model loses 150 dB at 2781 m
+  NS_TEST_ASSERT_MSG_EQ_TOL (DynamicCast<MultiModelSpectrumChannel> (channel)->GetMaxRange (), 2781, 1, "unexpected range");
+
+  WifiSpectrumValue5MhzFactory sf;
+  AdhocAlohaNoackIdealPhyHelper deviceHelper;
+  deviceHelper.SetChannel (channel);
+  deviceHelper.SetTxPowerSpectralDensity (sf.CreateTxPowerSpectralDensity (0.1, 1));
+  deviceHelper.SetNoisePowerSpectralDensity (sf.CreateConstant (1.381e-23 * 290));
+  NetDeviceContainer devices = deviceHelper.Install (c);
+
+  m_nPathLoss = 0;
+  Simulator::Schedule (Seconds (1.0), &NetDevice::Send, devices.Get (0),
+                       Create<Packet> (50), devices.Get (0)->GetBroadcast (), 1);
+  Simulator::Run ();
+  // the receiver at 9 km is only evaluated without the index
+  NS_TEST_ASSERT_MSG_EQ (m_nPathLoss, (m_fanOut == "Indexed" ? 1 : 2), "wrong number of evaluated receivers");
+
+  Simulator::Destroy ();
+}
+
 
 
 class SpectrumIdealPhyTestSuite : public TestSuite
@@ -243,6 +321,9 @@ SpectrumIdealPhyTestSuite::SpectrumIdealPhyTestSuite ()
       AddTestCase (new SpectrumIdealPhyTestCase (snr, static_cast<uint64_t> (achievableRate*2),    false,  "ns3::MultiModelSpectrumChannel"), TestCase::QUICK);
       AddTestCase (new SpectrumIdealPhyTestCase (snr, static_cast<uint64_t> (achievableRate*4),    false,  "ns3::MultiModelSpectrumChannel"), TestCase::QUICK);
     }
+  AddTestCase (new SpectrumFanOutTestCase ("All"), TestCase::QUICK);
+  AddTestCase (new SpectrumFanOutTestCase ("Indexed"), TestCase::QUICK);
+  AddTestCase (new SpectrumFanOutTestCase ("Validate"), TestCase::QUICK);
 }
 
 static SpectrumIdealPhyTestSuite g_spectrumIdealPhyTestSuite;
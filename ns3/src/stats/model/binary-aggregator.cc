@@ -0,0 +1,326 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+
+#include "binary-aggregator.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryAggregator");
+
+NS_OBJECT_ENSURE_REGISTERED (BinaryAggregator);
+
+/// the first bytes of a file written by a BinaryAggregator
+static const char BINARY_AGGREGATOR_MAGIC[8] = { 'n', 's', '3', 's', 't', 'a', 't', 's' };
+/// record tag declaring a context
+static const uint32_t BINARY_AGGREGATOR_CONTEXT = 1;
+/// record tag of a block of samples
+static const uint32_t BINARY_AGGREGATOR_BLOCK = 2;
+
+/**
+ * \brief append raw bytes to a buffer
+ * \param buffer the buffer
+ * \param data the bytes
+ * \param size the number of bytes
+ */
+static void
+Append (std::vector<uint8_t> &buffer, const void *data, std::size_t size)
+{
+  const uint8_t *bytes = static_cast<const uint8_t *> (data);
+  buffer.insert (buffer.end (), bytes, bytes + size);
+}
+
+TypeId
+BinaryAggregator::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::BinaryAggregator")
+    .SetParent<DataCollectionObject> ()
+    .SetGroupName ("Stats")
+    .AddAttribute ("BlockSize",
+                   "The number of samples of a context written together.",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&BinaryAggregator::m_blockSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("BufferSize",
+                   "The maximum number of bytes queued to the writer thread "
+                   "before the simulation waits for it.",
+                   UintegerValue (16 << 20),
+                   MakeUintegerAccessor (&BinaryAggregator::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+
+  return tid;
+}
+
+BinaryAggregator::BinaryAggregator (const std::string &outputFileName)
+  : m_outputFileName (outputFileName),
+    m_closed (false),
+    m_blockSize (4096),
+    m_bufferSize (16 << 20)
+#ifdef HAVE_PTHREAD_H
+  , m_pending (0),
+  m_stop (false)
+#endif
+{
+  NS_LOG_FUNCTION (this << outputFileName);
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_init (&m_mutex, 0);
+  pthread_cond_init (&m_work, 0);
+  pthread_cond_init (&m_done, 0);
+#endif
+
+  m_file.open (m_outputFileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open ())
+    {
+      NS_FATAL_ERROR ("Unable to open " << m_outputFileName);
+    }
+  m_file.write (BINARY_AGGREGATOR_MAGIC, sizeof (BINARY_AGGREGATOR_MAGIC));
+}
+
+BinaryAggregator::~BinaryAggregator ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+#ifdef HAVE_PTHREAD_H
+  pthread_cond_destroy (&m_done);
+  pthread_cond_destroy (&m_work);
+  pthread_mutex_destroy (&m_mutex);
+#endif
+}
+
+void
+BinaryAggregator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  DataCollectionObject::DoDispose ();
+}
+
+void
+BinaryAggregator::Write1d (std::string context, double v1)
+{
+  NS_LOG_FUNCTION (this << context << v1);
+  Write2d (context, Simulator::Now ().GetSeconds (), v1);
+}
+
+void
+BinaryAggregator::Write2d (std::string context, double v1, double v2)
+{
+  NS_LOG_FUNCTION (this << context << v1 << v2);
+
+  if (!m_enabled || m_closed)
+    {
+      return;
+    }
+  std::map<std::string, uint32_t>::iterator it = m_ids.find (context);
+  if (it == m_ids.end ())
+    {
+      uint32_t id = m_series.size ();
+      it = m_ids.insert (std::make_pair (context, id)).first;
+      m_series.push_back (Columns ());
+      uint32_t length = context.size ();
+      Append (m_records, &BINARY_AGGREGATOR_CONTEXT, sizeof (uint32_t));
+      Append (m_records, &id, sizeof (uint32_t));
+      Append (m_records, &length, sizeof (uint32_t));
+      Append (m_records, context.data (), length);
+    }
+  Columns &series = m_series[it->second];
+  series.time.push_back (v1);
+  series.value.push_back (v2);
+  if (series.time.size () >= m_blockSize)
+    {
+      FlushBlock (it->second);
+      Submit ();
+    }
+}
+
+void
+BinaryAggregator::FlushBlock (uint32_t id)
+{
+  Columns &series = m_series[id];
+  uint32_t n = series.time.size ();
+  if (n == 0)
+    {
+      return;
+    }
+  Append (m_records, &BINARY_AGGREGATOR_BLOCK, sizeof (uint32_t));
+  Append (m_records, &id, sizeof (uint32_t));
+  Append (m_records, &n, sizeof (uint32_t));
+  Append (m_records, &series.time[0], n * sizeof (double));
+  Append (m_records, &series.value[0], n * sizeof (double));
+  series.time.clear ();
+  series.value.clear ();
+}
+
+void
+BinaryAggregator::Submit (void)
+{
+  if (m_records.empty ())
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  if (m_thread == 0)
+    {
+      m_stop = false;
+      m_thread = Create<SystemThread> (MakeCallback (&BinaryAggregator::Run, this));
+      m_thread->Start ();
+    }
+  // let a buffer larger than the limit through once the queue is empty
+  uint64_t size = m_records.size ();
+  uint64_t limit = size < m_bufferSize ? m_bufferSize - size : 0;
+  pthread_mutex_lock (&m_mutex);
+  while (m_pending > limit)
+    {
+      pthread_cond_wait (&m_done, &m_mutex);
+    }
+  m_jobs.push_back (std::vector<uint8_t> ());
+  m_jobs.back ().swap (m_records);
+  m_pending += size;
+  pthread_cond_signal (&m_work);
+  pthread_mutex_unlock (&m_mutex);
+#else
+  WriteData (m_records);
+  m_records.clear ();
+#endif
+}
+
+void
+BinaryAggregator::WriteData (std::vector<uint8_t> const &data)
+{
+  m_file.write ((const char *)&data[0], data.size ());
+  if (m_file.fail ())
+    {
+      NS_FATAL_ERROR ("Unable to write " << m_outputFileName);
+    }
+}
+
+void
+BinaryAggregator::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_closed)
+    {
+      return;
+    }
+  for (uint32_t id = 0; id < m_series.size (); id++)
+    {
+      FlushBlock (id);
+    }
+  Submit ();
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      pthread_mutex_lock (&m_mutex);
+      m_stop = true;
+      pthread_cond_signal (&m_work);
+      pthread_mutex_unlock (&m_mutex);
+      // the thread writes every queued buffer before it exits
+      m_thread->Join ();
+      m_thread = 0;
+    }
+#endif
+  m_file.close ();
+  m_series.clear ();
+  m_ids.clear ();
+  m_closed = true;
+}
+
+#ifdef HAVE_PTHREAD_H
+void
+BinaryAggregator::Run (void)
+{
+  pthread_mutex_lock (&m_mutex);
+  while (true)
+    {
+      while (m_jobs.empty () && !m_stop)
+        {
+          pthread_cond_wait (&m_work, &m_mutex);
+        }
+      if (m_jobs.empty ())
+        {
+          break;
+        }
+      std::vector<uint8_t> data;
+      data.swap (m_jobs.front ());
+      m_jobs.pop_front ();
+      pthread_mutex_unlock (&m_mutex);
+      WriteData (data);
+      pthread_mutex_lock (&m_mutex);
+      m_pending -= data.size ();
+      pthread_cond_signal (&m_done);
+    }
+  pthread_mutex_unlock (&m_mutex);
+}
+#endif
+
+bool
+BinaryAggregator::Read (const std::string &fileName, std::map<std::string, Columns> *columns)
+{
+  NS_LOG_FUNCTION (fileName << columns);
+
+  std::ifstream file (fileName.c_str (), std::ios::in | std::ios::binary);
+  char magic[sizeof (BINARY_AGGREGATOR_MAGIC)];
+  if (!file.read (magic, sizeof (magic))
+      || std::memcmp (magic, BINARY_AGGREGATOR_MAGIC, sizeof (magic)) != 0)
+    {
+      return false;
+    }
+  std::vector<std::string> names;
+  uint32_t tag;
+  while (file.read ((char *)&tag, sizeof (tag)))
+    {
+      uint32_t id;
+      uint32_t n;
+      if (!file.read ((char *)&id, sizeof (id)) || !file.read ((char *)&n, sizeof (n)))
+        {
+          return false;
+        }
+      if (tag == BINARY_AGGREGATOR_CONTEXT)
+        {
+          std::string name (n, '\0');
+          if (id != names.size () || (n > 0 && !file.read (&name[0], n)))
+            {
+              return false;
+            }
+          names.push_back (name);
+        }
+      else if (tag == BINARY_AGGREGATOR_BLOCK && id < names.size ())
+        {
+          Columns &series = (*columns)[names[id]];
+          std::size_t offset = series.time.size ();
+          series.time.resize (offset + n);
+          series.value.resize (offset + n);
+          if (!file.read ((char *)&series.time[offset], n * sizeof (double))
+              || !file.read ((char *)&series.value[offset], n * sizeof (double)))
+            {
+              return false;
+            }
+        }
+      else
+        {
+          return false;
+        }
+    }
+  return file.eof ();
+}
+
+} // namespace ns3
@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_AGGREGATOR_H
+#define BINARY_AGGREGATOR_H
+
+#include <fstream>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/core-config.h"
+#include "ns3/data-collection-object.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include "ns3/system-thread.h"
+#endif
+
+namespace ns3 {
+
+/**
+ * \ingroup aggregator
+ *
+ * This aggregator writes the values it receives to a columnar binary
+ * file, for probes sampled too often for the text aggregators.
+ *
+ * The values of each context (usually the probe path) are collected
+ * in blocks of BlockSize samples, stored as an array of timestamps
+ * followed by an array of values, both as doubles in the native byte
+ * order.  Full blocks are written by a background thread; the
+ * simulation waits when more than BufferSize bytes are queued, so the
+ * memory used is bounded by BufferSize plus one block per context.
+ *
+ * The file starts with the 8 bytes "ns3stats" and is followed by
+ * records which start with a uint32_t tag:
+ *  - 1: declares a context: uint32_t id, uint32_t length, the name;
+ *  - 2: a block: uint32_t id, uint32_t n, n timestamps, n values.
+ *
+ * Read () loads such a file back.
+ **/
+class BinaryAggregator : public DataCollectionObject
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+
+  /**
+   * \param outputFileName name of the file to write.
+   */
+  BinaryAggregator (const std::string &outputFileName);
+
+  virtual ~BinaryAggregator ();
+
+  /**
+   * \param context specifies the series the value belongs to.
+   * \param v1 value for the new data point.
+   *
+   * \brief Writes 1 value with the current simulation time, in
+   * seconds, as timestamp.
+   */
+  void Write1d (std::string context, double v1);
+
+  /**
+   * \param context specifies the series the values belong to.
+   * \param v1 timestamp for the new data point.
+   * \param v2 value for the new data point.
+   *
+   * \brief Writes a timestamp and a value, as received from the
+   * Output trace source of a TimeSeriesAdaptor.
+   */
+  void Write2d (std::string context, double v1, double v2);
+
+  /**
+   * \brief Writes the pending samples and closes the file.
+   *
+   * Values received afterwards are ignored.  This is done
+   * automatically when the aggregator is disposed or destroyed.
+   */
+  void Close (void);
+
+  /**
+   * \brief The samples of one context, as columns
+   */
+  struct Columns
+  {
+    std::vector<double> time;  //!< the timestamps
+    std::vector<double> value; //!< the values
+  };
+
+  /**
+   * \param fileName the file written by a BinaryAggregator
+   * \param columns the samples of each context, appended to
+   * \return false if the file can not be read or is truncated
+   */
+  static bool Read (const std::string &fileName, std::map<std::string, Columns> *columns);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Serialize the buffered samples of a context
+   * \param id the context
+   */
+  void FlushBlock (uint32_t id);
+  /**
+   * \brief Append the buffered records to the file
+   */
+  void Submit (void);
+  /**
+   * \brief Write a buffer of records to the file
+   * \param data the records
+   */
+  void WriteData (std::vector<uint8_t> const &data);
+
+  std::string m_outputFileName;           //!< the file
+  std::ofstream m_file;                   //!< the open file
+  bool m_closed;                          //!< whether Close has been called
+  uint32_t m_blockSize;                   //!< samples per block
+  uint32_t m_bufferSize;                  //!< maximum bytes queued to the writer
+  std::map<std::string, uint32_t> m_ids;  //!< the id of each context
+  std::vector<Columns> m_series;          //!< the buffered samples of each context
+  std::vector<uint8_t> m_records;         //!< serialized records not yet submitted
+
+#ifdef HAVE_PTHREAD_H
+  /**
+   * \brief the writer thread body
+   */
+  void Run (void);
+
+  // SystemCondition has its own mutex, so it can not test a predicate
+  // protected by another one without losing wakeups: the queue state and
+  // both conditions share m_mutex instead
+  std::deque<std::vector<uint8_t> > m_jobs; //!< buffers queued to the writer
+  uint64_t m_pending;                     //!< bytes queued or being written
+  bool m_stop;                            //!< the thread must exit when idle
+  pthread_mutex_t m_mutex;                //!< protects the queue state
+  pthread_cond_t m_work;                  //!< signaled when a buffer is queued or on stop
+  pthread_cond_t m_done;                  //!< signaled when a buffer is written
+  Ptr<SystemThread> m_thread;             //!< the writer thread
+#endif
+};
+
+} // namespace ns3
+
+#endif // BINARY_AGGREGATOR_H
@@ -35,6 +35,9 @@ namespace ns3 {
  * \ingroup aggregator
  *
  * This aggregator sends values it receives to a file.
+ *
+ * The lines are buffered by the file stream, not flushed one by one,
+ * and are complete once the aggregator is destroyed.
  **/
 class FileAggregator : public DataCollectionObject
 {
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "sqlite-aggregator.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SqliteAggregator");
+
+NS_OBJECT_ENSURE_REGISTERED (SqliteAggregator);
+
+TypeId
+SqliteAggregator::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::SqliteAggregator")
+    .SetParent<DataCollectionObject> ()
+    .SetGroupName ("Stats")
+    .AddAttribute ("TransactionSize",
+                   "The number of rows inserted in each transaction.",
+                   UintegerValue (10000),
+                   MakeUintegerAccessor (&SqliteAggregator::m_transactionSize),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+
+  return tid;
+}
+
+SqliteAggregator::SqliteAggregator (const std::string &outputFileName,
+                                    const std::string &table)
+  : m_db (0),
+    m_insert (0),
+    m_transactionSize (10000),
+    m_rows (0)
+{
+  NS_LOG_FUNCTION (this << outputFileName << table);
+
+  if (sqlite3_open (outputFileName.c_str (), &m_db) != SQLITE_OK)
+    {
+      NS_FATAL_ERROR ("Could not open sqlite3 database \"" << outputFileName
+                      << "\": " << sqlite3_errmsg (m_db));
+    }
+  Exec ("create table if not exists " + table + " (context text, x real, y real)");
+  std::string insert = "insert into " + table + " (context, x, y) values (?, ?, ?)";
+  if (sqlite3_prepare_v2 (m_db, insert.c_str (), -1, &m_insert, NULL) != SQLITE_OK)
+    {
+      NS_FATAL_ERROR ("sqlite3 error: \"" << sqlite3_errmsg (m_db) << "\"");
+    }
+}
+
+SqliteAggregator::~SqliteAggregator ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+SqliteAggregator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  DataCollectionObject::DoDispose ();
+}
+
+void
+SqliteAggregator::Exec (const std::string &sql)
+{
+  NS_LOG_FUNCTION (this << sql);
+  char *errMsg = 0;
+  if (sqlite3_exec (m_db, sql.c_str (), NULL, NULL, &errMsg) != SQLITE_OK)
+    {
+      NS_LOG_ERROR ("sqlite3 error: \"" << errMsg << "\"");
+      sqlite3_free (errMsg);
+    }
+}
+
+void
+SqliteAggregator::Write1d (std::string context, double v1)
+{
+  NS_LOG_FUNCTION (this << context << v1);
+  Write2d (context, Simulator::Now ().GetSeconds (), v1);
+}
+
+void
+SqliteAggregator::Write2d (std::string context, double v1, double v2)
+{
+  NS_LOG_FUNCTION (this << context << v1 << v2);
+
+  if (!m_enabled || m_db == 0)
+    {
+      return;
+    }
+  if (m_rows == 0)
+    {
+      Exec ("BEGIN");
+    }
+  sqlite3_reset (m_insert);
+  sqlite3_bind_text (m_insert, 1, context.c_str (), context.length (), SQLITE_STATIC);
+  sqlite3_bind_double (m_insert, 2, v1);
+  sqlite3_bind_double (m_insert, 3, v2);
+  if (sqlite3_step (m_insert) != SQLITE_DONE)
+    {
+      NS_LOG_ERROR ("sqlite3 error: \"" << sqlite3_errmsg (m_db) << "\"");
+    }
+  if (++m_rows >= m_transactionSize)
+    {
+      Exec ("COMMIT");
+      m_rows = 0;
+    }
+}
+
+void
+SqliteAggregator::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_db == 0)
+    {
+      return;
+    }
+  if (m_rows > 0)
+    {
+      Exec ("COMMIT");
+      m_rows = 0;
+    }
+  sqlite3_finalize (m_insert);
+  m_insert = 0;
+  sqlite3_close (m_db);
+  m_db = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SQLITE_AGGREGATOR_H
+#define SQLITE_AGGREGATOR_H
+
+#include <string>
+#include "ns3/data-collection-object.h"
+
+#include <sqlite3.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup aggregator
+ *
+ * This aggregator inserts the values it receives in a table of a
+ * SQLite database, with columns (context, x, y).
+ *
+ * The rows are inserted with one prepared statement, reused for every
+ * value, inside transactions of TransactionSize rows: committing each
+ * row separately would make the database sync to disk per sample.
+ * The last transaction is committed by Close, which is called when
+ * the aggregator is disposed or destroyed.
+ **/
+class SqliteAggregator : public DataCollectionObject
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+
+  /**
+   * \param outputFileName name of the database to write.
+   * \param table name of the table, created if needed.
+   */
+  SqliteAggregator (const std::string &outputFileName,
+                    const std::string &table = "Samples");
+
+  virtual ~SqliteAggregator ();
+
+  /**
+   * \param context specifies where the data point came from.
+   * \param v1 value for the new data point.
+   *
+   * \brief Inserts 1 value, with the current simulation time, in
+   * seconds, as x.
+   */
+  void Write1d (std::string context, double v1);
+
+  /**
+   * \param context specifies where the data point came from.
+   * \param v1 x value for the new data point.
+   * \param v2 y value for the new data point.
+   *
+   * \brief Inserts 2 values.
+   */
+  void Write2d (std::string context, double v1, double v2);
+
+  /**
+   * \brief Commits the pending rows and closes the database.
+   *
+   * Values received afterwards are ignored.
+   */
+  void Close (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Execute a statement without result
+   * \param sql the statement
+   */
+  void Exec (const std::string &sql);
+
+  sqlite3 *m_db;              //!< the database, 0 once closed
+  sqlite3_stmt *m_insert;     //!< the prepared insert statement
+  uint32_t m_transactionSize; //!< rows per transaction
+  uint32_t m_rows;            //!< rows in the open transaction
+};
+
+} // namespace ns3
+
+#endif // SQLITE_AGGREGATOR_H
@@ -126,6 +126,9 @@ SqliteDataOutput::Output (DataCollector &dc)
       return;
     }
 
+  // one transaction for every row, rather than one per statement
+  Exec ("BEGIN");
+
   Exec ("create table if not exists Experiments (run, experiment, strategy, input, description text)");
 
   sqlite3_stmt *stmt;
@@ -172,7 +175,6 @@ SqliteDataOutput::Output (DataCollector &dc)
     }
   sqlite3_finalize (stmt);
 
-  Exec ("BEGIN");
   SqliteOutputCallback callback (this, run);
   for (DataCalculatorList::iterator i = dc.DataCalculatorBegin ();
        i != dc.DataCalculatorEnd (); i++) {
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include "ns3/binary-aggregator.h"
+#include "ns3/time-series-adaptor.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Write interleaved series through a BinaryAggregator with blocks larger
+ * than its buffer, and read them back.
+ */
+class BinaryAggregatorTestCase : public TestCase
+{
+public:
+  BinaryAggregatorTestCase ();
+  virtual ~BinaryAggregatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryAggregatorTestCase::BinaryAggregatorTestCase ()
+  : TestCase ("BinaryAggregator writes the samples of every context")
+{
+}
+
+BinaryAggregatorTestCase::~BinaryAggregatorTestCase ()
+{
+}
+
+void
+BinaryAggregatorTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("binary-aggregator.bin");
+  Ptr<BinaryAggregator> aggregator = CreateObject<BinaryAggregator> (fileName);
+  aggregator->SetAttribute ("BlockSize", UintegerValue (100));
+  // smaller than one block, so the writer is always drained first
+  aggregator->SetAttribute ("BufferSize", UintegerValue (1000));
+
+  uint32_t n = 10000;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      for (uint32_t j = 0; j < 3; j++)
+        {
+          std::ostringstream context;
+          context << "/probe/" << j;
+          if (j < 2 || i % 7 == 0)
+            {
+              aggregator->Write2d (context.str (), i * 1e-3, i * (j + 1.5));
+            }
+        }
+    }
+
+  // samples from a TimeSeriesAdaptor, timestamped with the simulation time
+  Ptr<TimeSeriesAdaptor> adaptor = CreateObject<TimeSeriesAdaptor> ();
+  adaptor->TraceConnect ("Output", "adaptor", MakeCallback (&BinaryAggregator::Write2d, aggregator));
+  for (uint32_t i = 1; i <= 10; i++)
+    {
+      Simulator::Schedule (Seconds (i), &TimeSeriesAdaptor::TraceSinkDouble, adaptor, 0.0, i);
+    }
+  Simulator::Schedule (Seconds (3.5), &BinaryAggregator::Write1d, aggregator, "now", 42.0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  aggregator->Disable ();
+  aggregator->Write2d ("disabled", 0.0, 0.0);
+  aggregator->Enable ();
+  aggregator->Close ();
+  aggregator->Write2d ("closed", 0.0, 0.0);
+
+  std::map<std::string, BinaryAggregator::Columns> columns;
+  NS_TEST_ASSERT_MSG_EQ (BinaryAggregator::Read (fileName, &columns), true, "file not readable");
+  NS_TEST_ASSERT_MSG_EQ (columns.size (), 5, "wrong number of contexts");
+  for (uint32_t j = 0; j < 3; j++)
+    {
+      std::ostringstream context;
+      context << "/probe/" << j;
+      BinaryAggregator::Columns &series = columns[context.str ()];
+      uint32_t expected = (j < 2) ? n : (n + 6) / 7;
+      NS_TEST_ASSERT_MSG_EQ (series.time.size (), expected, "wrong number of samples");
+      NS_TEST_ASSERT_MSG_EQ (series.value.size (), expected, "wrong number of samples");
+      for (uint32_t k = 0; k < expected; k++)
+        {
+          uint32_t i = (j < 2) ? k : k * 7;
+          NS_TEST_ASSERT_MSG_EQ (series.time[k], i * 1e-3, "wrong timestamp");
+          NS_TEST_ASSERT_MSG_EQ (series.value[k], i * (j + 1.5), "wrong value");
+        }
+    }
+  BinaryAggregator::Columns &adapted = columns["adaptor"];
+  NS_TEST_ASSERT_MSG_EQ (adapted.time.size (), 10, "wrong number of adaptor samples");
+  for (uint32_t i = 0; i < adapted.time.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (adapted.time[i], i + 1.0, "wrong adaptor timestamp");
+      NS_TEST_ASSERT_MSG_EQ (adapted.value[i], i + 1.0, "wrong adaptor value");
+    }
+  NS_TEST_ASSERT_MSG_EQ (columns["now"].time.size (), 1, "wrong number of Write1d samples");
+  NS_TEST_ASSERT_MSG_EQ (columns["now"].time[0], 3.5, "wrong Write1d timestamp");
+}
+
+/**
+ * Reject files which are not complete BinaryAggregator files.
+ */
+class BinaryAggregatorTruncatedTestCase : public TestCase
+{
+public:
+  BinaryAggregatorTruncatedTestCase ();
+  virtual ~BinaryAggregatorTruncatedTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryAggregatorTruncatedTestCase::BinaryAggregatorTruncatedTestCase ()
+  : TestCase ("BinaryAggregator::Read rejects truncated files")
+{
+}
+
+BinaryAggregatorTruncatedTestCase::~BinaryAggregatorTruncatedTestCase ()
+{
+}
+
+void
+BinaryAggregatorTruncatedTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("binary-aggregator-truncated.bin");
+  Ptr<BinaryAggregator> aggregator = CreateObject<BinaryAggregator> (fileName);
+  aggregator->Write2d ("a", 1.0, 2.0);
+  aggregator->Close ();
+
+  std::map<std::string, BinaryAggregator::Columns> columns;
+  NS_TEST_ASSERT_MSG_EQ (BinaryAggregator::Read (fileName, &columns), true, "file not readable");
+
+  std::ifstream in (fileName.c_str (), std::ios::binary);
+  std::string content ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+  in.close ();
+  std::ofstream out (fileName.c_str (), std::ios::binary | std::ios::trunc);
+  out.write (content.data (), content.size () - 4);
+  out.close ();
+  columns.clear ();
+  NS_TEST_ASSERT_MSG_EQ (BinaryAggregator::Read (fileName, &columns), false, "truncated file accepted");
+  NS_TEST_ASSERT_MSG_EQ (BinaryAggregator::Read (fileName + ".missing", &columns), false, "missing file accepted");
+}
+
+static class BinaryAggregatorTestSuite : public TestSuite
+{
+public:
+  BinaryAggregatorTestSuite ()
+    : TestSuite ("binary-aggregator", UNIT)
+  {
+    AddTestCase (new BinaryAggregatorTestCase (), TestCase::QUICK);
+    AddTestCase (new BinaryAggregatorTruncatedTestCase (), TestCase::QUICK);
+  }
+} g_binaryAggregatorTestSuite;
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <sqlite3.h>
+
+#include "ns3/sqlite-aggregator.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Insert rows over several transactions, including a partial last one,
+ * and count them back.
+ */
+class SqliteAggregatorTestCase : public TestCase
+{
+public:
+  SqliteAggregatorTestCase ();
+  virtual ~SqliteAggregatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param db the database
+   * \param sql a query returning one number
+   * \return the number
+   */
+  double Query (sqlite3 *db, std::string sql);
+};
+
+SqliteAggregatorTestCase::SqliteAggregatorTestCase ()
+  : TestCase ("SqliteAggregator inserts every row")
+{
+}
+
+SqliteAggregatorTestCase::~SqliteAggregatorTestCase ()
+{
+}
+
+double
+SqliteAggregatorTestCase::Query (sqlite3 *db, std::string sql)
+{
+  sqlite3_stmt *stmt;
+  sqlite3_prepare_v2 (db, sql.c_str (), -1, &stmt, NULL);
+  double result = -1;
+  if (sqlite3_step (stmt) == SQLITE_ROW)
+    {
+      result = sqlite3_column_double (stmt, 0);
+    }
+  sqlite3_finalize (stmt);
+  return result;
+}
+
+void
+SqliteAggregatorTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("sqlite-aggregator.db");
+  std::remove (fileName.c_str ());
+  Ptr<SqliteAggregator> aggregator = CreateObject<SqliteAggregator> (fileName, "Cwnd");
+  aggregator->SetAttribute ("TransactionSize", UintegerValue (1000));
+  for (uint32_t i = 0; i < 2500; i++)
+    {
+      aggregator->Write2d ((i % 2) ? "odd" : "even", i, 2.0 * i);
+    }
+  aggregator->Close ();
+  aggregator->Write2d ("closed", 0.0, 0.0);
+
+  sqlite3 *db;
+  NS_TEST_ASSERT_MSG_EQ (sqlite3_open (fileName.c_str (), &db), SQLITE_OK, "database not readable");
+  NS_TEST_EXPECT_MSG_EQ (Query (db, "select count(*) from Cwnd"), 2500, "wrong number of rows");
+  NS_TEST_EXPECT_MSG_EQ (Query (db, "select count(*) from Cwnd where context = 'odd'"), 1250, "wrong number of rows");
+  NS_TEST_EXPECT_MSG_EQ (Query (db, "select sum(y) - 2 * sum(x) from Cwnd"), 0, "wrong values");
+  sqlite3_close (db);
+}
+
+static class SqliteAggregatorTestSuite : public TestSuite
+{
+public:
+  SqliteAggregatorTestSuite ()
+    : TestSuite ("sqlite-aggregator", UNIT)
+  {
+    AddTestCase (new SqliteAggregatorTestCase (), TestCase::QUICK);
+  }
+} g_sqliteAggregatorTestSuite;
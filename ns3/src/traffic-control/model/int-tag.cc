@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "int-tag.h"
+#include "ns3/assert.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (IntTag);
+
+const uint8_t IntTag::MAX_HOPS;
+
+static const uint16_t INT_CE_FLAG = 0x8000;
+static const uint16_t INT_QDEPTH_MAX = 0x7fff;
+static const int64_t INT_SOJOURN_UNIT = 100; // ns
+
+TypeId
+IntTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IntTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<IntTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+IntTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+IntTag::IntTag ()
+  : m_nTraversed (0)
+{
+}
+
+uint32_t
+IntTag::GetSerializedSize (void) const
+{
+  return 1 + 6 * GetNHops ();
+}
+
+void
+IntTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU8 (m_nTraversed);
+  for (uint8_t i = 0; i < GetNHops (); i++)
+    {
+      buf.WriteU16 (m_node[i]);
+      buf.WriteU16 (m_qFlags[i]);
+      buf.WriteU16 (m_sojourn[i]);
+    }
+}
+
+void
+IntTag::Deserialize (TagBuffer buf)
+{
+  m_nTraversed = buf.ReadU8 ();
+  for (uint8_t i = 0; i < GetNHops (); i++)
+    {
+      m_node[i] = buf.ReadU16 ();
+      m_qFlags[i] = buf.ReadU16 ();
+      m_sojourn[i] = buf.ReadU16 ();
+    }
+}
+
+void
+IntTag::Print (std::ostream &os) const
+{
+  os << "hops=" << (uint32_t) m_nTraversed;
+  for (uint8_t i = 0; i < GetNHops (); i++)
+    {
+      Hop hop = GetHop (i);
+      os << " [node=" << hop.nodeId << " qlen=" << hop.qDepth
+         << " sojourn=" << hop.sojourn.GetNanoSeconds () << "ns"
+         << (hop.ce ? " CE" : "") << "]";
+    }
+}
+
+bool
+IntTag::AddHop (uint32_t nodeId, uint32_t qDepth, Time sojourn, bool ce)
+{
+  if (m_nTraversed < 0xff)
+    {
+      m_nTraversed++;
+    }
+  if (m_nTraversed > MAX_HOPS)
+    {
+      return false;
+    }
+  uint8_t i = m_nTraversed - 1;
+  m_node[i] = static_cast<uint16_t> (nodeId);
+  m_qFlags[i] = static_cast<uint16_t> (std::min<uint32_t> (qDepth, INT_QDEPTH_MAX));
+  if (ce)
+    {
+      m_qFlags[i] |= INT_CE_FLAG;
+    }
+  int64_t units = sojourn.GetNanoSeconds () / INT_SOJOURN_UNIT;
+  m_sojourn[i] = static_cast<uint16_t> (std::min<int64_t> (std::max<int64_t> (units, 0), 0xffff));
+  return true;
+}
+
+uint8_t
+IntTag::GetNHops (void) const
+{
+  return std::min (m_nTraversed, MAX_HOPS);
+}
+
+uint8_t
+IntTag::GetNTraversed (void) const
+{
+  return m_nTraversed;
+}
+
+IntTag::Hop
+IntTag::GetHop (uint8_t i) const
+{
+  NS_ASSERT (i < GetNHops ());
+  Hop hop;
+  hop.nodeId = m_node[i];
+  hop.qDepth = m_qFlags[i] & INT_QDEPTH_MAX;
+  hop.ce = (m_qFlags[i] & INT_CE_FLAG) != 0;
+  hop.sojourn = NanoSeconds (m_sojourn[i] * INT_SOJOURN_UNIT);
+  return hop;
+}
+
+} // namespace ns3
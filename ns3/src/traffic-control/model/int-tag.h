@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INT_TAG_H
+#define INT_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief In-band network telemetry carried as a packet tag
+ *
+ * Every queue disc with the InbandTelemetry attribute enabled appends one
+ * hop record to this tag when it dequeues a packet. A hop record holds the
+ * id of the node forwarding the packet, the number of packets left in the
+ * queue disc, the time the packet spent in the queue disc and whether the
+ * queue disc marked the packet CE.
+ *
+ * Records are packed into 6 bytes each so that the whole tag fits into the
+ * packet tag serialization buffer: the queue depth saturates at 32767
+ * packets and the sojourn time is kept in units of 100ns, saturating at
+ * about 6.5ms. At most MAX_HOPS records are kept; further hops are counted
+ * but not recorded.
+ */
+class IntTag : public Tag
+{
+public:
+  /// Maximum number of hop records carried by the tag
+  static const uint8_t MAX_HOPS = 5;
+
+  /**
+   * \brief Telemetry collected at a single hop
+   */
+  struct Hop
+  {
+    uint16_t nodeId;  //!< id of the forwarding node
+    uint16_t qDepth;  //!< packets left in the queue disc at dequeue time
+    bool ce;          //!< true if the packet was marked CE at this hop
+    Time sojourn;     //!< time spent in the queue disc
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+
+  IntTag ();
+
+  /**
+   * \brief Append a hop record
+   * \param nodeId the id of the forwarding node
+   * \param qDepth the number of packets left in the queue disc
+   * \param sojourn the time spent in the queue disc
+   * \param ce true if the packet was marked CE at this hop
+   * \return false if the tag is full and the record was not stored
+   */
+  bool AddHop (uint32_t nodeId, uint32_t qDepth, Time sojourn, bool ce);
+  /**
+   * \return the number of hop records stored in the tag
+   */
+  uint8_t GetNHops (void) const;
+  /**
+   * \return the number of hops traversed, including those not recorded
+   */
+  uint8_t GetNTraversed (void) const;
+  /**
+   * \param i the index of the hop record
+   * \return the i-th hop record
+   */
+  Hop GetHop (uint8_t i) const;
+
+private:
+  uint8_t m_nTraversed;         //!< number of hops traversed
+  uint16_t m_node[MAX_HOPS];    //!< node ids
+  uint16_t m_qFlags[MAX_HOPS];  //!< queue depth (low 15 bits) and CE flag (high bit)
+  uint16_t m_sojourn[MAX_HOPS]; //!< sojourn times in units of 100ns
+};
+
+} // namespace ns3
+
+#endif /* INT_TAG_H */
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/object-factory.h"
+#include "ns3/net-device.h"
+#include "ns3/socket.h"
+#include "pfc-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PfcQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (PfcQueueDisc);
+
+/// the number of PFC priorities, i.e., of default classes
+static const uint32_t PFC_PRIORITIES = 8;
+
+TypeId PfcQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PfcQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<PfcQueueDisc> ()
+    .AddAttribute ("Limit",
+                   "The maximum number of packets of each default child queue disc.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&PfcQueueDisc::m_limit),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+PfcQueueDisc::PfcQueueDisc ()
+  : m_next (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PfcQueueDisc::~PfcQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PfcQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_devQueueIface = 0;
+  QueueDisc::DoDispose ();
+}
+
+uint32_t
+PfcQueueDisc::GetBand (Ptr<const QueueDiscItem> item) const
+{
+  uint8_t priority = 0;
+  SocketPriorityTag priorityTag;
+  if (item->GetPacket ()->PeekPacketTag (priorityTag))
+    {
+      priority = priorityTag.GetPriority ();
+    }
+  return std::min<uint32_t> (priority, GetNQueueDiscClasses () - 1);
+}
+
+bool
+PfcQueueDisc::IsStopped (uint32_t band) const
+{
+  // single queue devices are only asked for packets when their queue runs
+  return m_devQueueIface && m_devQueueIface->GetNTxQueues () > 1
+         && band < m_devQueueIface->GetNTxQueues ()
+         && m_devQueueIface->GetTxQueue (band)->IsStopped ();
+}
+
+bool
+PfcQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  uint32_t band = GetBand (item);
+  // If the child queue disc drops the packet, it notifies this queue disc
+  // through the parent drop callback
+  bool retval = GetQueueDiscClass (band)->GetQueueDisc ()->Enqueue (item);
+
+  NS_LOG_LOGIC ("Number packets band " << band << ": " << GetQueueDiscClass (band)->GetQueueDisc ()->GetNPackets ());
+
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+PfcQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t n = GetNQueueDiscClasses ();
+  for (uint32_t k = 0; k < n; k++)
+    {
+      uint32_t band = (m_next + k) % n;
+      if (IsStopped (band))
+        {
+          continue;
+        }
+      Ptr<QueueDiscItem> item = GetQueueDiscClass (band)->GetQueueDisc ()->Dequeue ();
+      if (item != 0)
+        {
+          NS_LOG_LOGIC ("Popped from band " << band << ": " << item);
+          m_next = (band + 1) % n;
+          return item;
+        }
+    }
+
+  NS_LOG_LOGIC ("No packet of a running band");
+  return 0;
+}
+
+Ptr<const QueueDiscItem>
+PfcQueueDisc::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t n = GetNQueueDiscClasses ();
+  for (uint32_t k = 0; k < n; k++)
+    {
+      uint32_t band = (m_next + k) % n;
+      if (IsStopped (band))
+        {
+          continue;
+        }
+      Ptr<const QueueDiscItem> item = GetQueueDiscClass (band)->GetQueueDisc ()->Peek ();
+      if (item != 0)
+        {
+          return item;
+        }
+    }
+  return 0;
+}
+
+bool
+PfcQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("PfcQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  if (GetNPacketFilters () != 0)
+    {
+      NS_LOG_ERROR ("PfcQueueDisc needs no packet filter");
+      return false;
+    }
+
+  if (GetNQueueDiscClasses () == 0)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId ("ns3::PfifoFastQueueDisc");
+      factory.Set ("Limit", UintegerValue (m_limit));
+      for (uint32_t i = 0; i < PFC_PRIORITIES; i++)
+        {
+          Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass> ();
+          c->SetQueueDisc (factory.Create<QueueDisc> ());
+          AddQueueDiscClass (c);
+        }
+    }
+
+  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
+    {
+      GetQueueDiscClass (i)->GetQueueDisc ()->Initialize ();
+    }
+
+  return true;
+}
+
+void
+PfcQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNetDevice ())
+    {
+      m_devQueueIface = GetNetDevice ()->GetObject<NetDeviceQueueInterface> ();
+    }
+}
+
+} // namespace ns3
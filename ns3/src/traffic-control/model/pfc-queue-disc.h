@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PFC_QUEUE_DISC_H
+#define PFC_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+
+namespace ns3 {
+
+class NetDeviceQueueInterface;
+
+/**
+ * \ingroup traffic-control
+ *
+ * A queue disc with one class per priority, for the switch ports of a
+ * fabric running priority-based flow control. Packets are classified by
+ * their SocketPriorityTag (priorities beyond the last class go to the
+ * last class) and the classes are served round robin.
+ *
+ * The device of a PFC port has one transmission queue per priority and
+ * stops the queue of a priority paused by the peer. Unlike single-queue
+ * discs, which would dequeue a packet of the paused priority and block
+ * the port until it resumes, this queue disc skips the classes whose
+ * transmission queue is stopped.
+ *
+ * If no class is provided, one class per PFC priority is created, with a
+ * child PfifoFastQueueDisc of Limit packets. Other child queue discs,
+ * e.g. RedQueueDisc for per-priority ECN marking, can be attached with
+ * the TrafficControlHelper. No packet filter can be provided.
+ */
+class PfcQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PfcQueueDisc ();
+  virtual ~PfcQueueDisc ();
+
+  /**
+   * \param item a queue disc item
+   * \return the class of the item
+   */
+  uint32_t GetBand (Ptr<const QueueDiscItem> item) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual Ptr<const QueueDiscItem> DoPeek (void) const;
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \param band a class
+   * \return true if the device stopped the transmission queue of the class
+   */
+  bool IsStopped (uint32_t band) const;
+
+  uint32_t m_limit;                            //!< Limit of the default child queue discs
+  uint32_t m_next;                             //!< the class served first at the next dequeue
+  Ptr<NetDeviceQueueInterface> m_devQueueIface; //!< the transmission queues of the device
+};
+
+} // namespace ns3
+
+#endif /* PFC_QUEUE_DISC_H */
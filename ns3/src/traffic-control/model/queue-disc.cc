@@ -25,7 +25,11 @@
 #include "ns3/packet.h"
 #include "ns3/socket.h"
 #include "ns3/unused.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
 #include "queue-disc.h"
+#include "int-tag.h"
 
 namespace ns3 {
 
@@ -35,7 +39,9 @@ QueueDiscItem::QueueDiscItem (Ptr<Packet> p, const Address& addr, uint16_t proto
   : QueueItem (p),
     m_address (addr),
     m_protocol (protocol),
-    m_txq (0)
+    m_txq (0),
+    m_tstamp (Simulator::Now ()),
+    m_markedHere (false)
 {
 }
 
@@ -68,6 +74,30 @@ QueueDiscItem::SetTxQueueIndex (uint8_t txq)
   m_txq = txq;
 }
 
+Time
+QueueDiscItem::GetTimeStamp (void) const
+{
+  return m_tstamp;
+}
+
+void
+QueueDiscItem::SetTimeStamp (Time t)
+{
+  m_tstamp = t;
+}
+
+bool
+QueueDiscItem::IsMarkedHere (void) const
+{
+  return m_markedHere;
+}
+
+void
+QueueDiscItem::SetMarkedHere (bool marked)
+{
+  m_markedHere = marked;
+}
+
 void
 QueueDiscItem::Print (std::ostream& os) const
 {
@@ -148,6 +178,12 @@ TypeId QueueDisc::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QueueDisc::m_classes),
                    MakeObjectVectorChecker<QueueDiscClass> ())
+    .AddAttribute ("InbandTelemetry",
+                   "Append an IntTag hop record (node, queue depth, sojourn time, CE mark) "
+                   "to every dequeued packet. Enable it on root queue discs only.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QueueDisc::m_telemetry),
+                   MakeBooleanChecker ())
     .AddTraceSource ("Enqueue", "Enqueue a packet in the queue disc",
                      MakeTraceSourceAccessor (&QueueDisc::m_traceEnqueue),
                      "ns3::QueueItem::TracedCallback")
@@ -181,9 +217,14 @@ QueueDisc::QueueDisc ()
      m_nTotalDroppedBytes (0),
      m_nTotalRequeuedPackets (0),
      m_nTotalRequeuedBytes (0),
-     m_running (false)
+     m_running (false),
+     m_telemetry (false)
 {
   NS_LOG_FUNCTION (this);
+#ifdef ENABLE_PROFILING
+  m_profileEnqueue = Profiler::Register ("ns3::QueueDisc::Enqueue");
+  m_profileDequeue = Profiler::Register ("ns3::QueueDisc::Dequeue");
+#endif
 }
 
 void
@@ -216,6 +257,11 @@ QueueDisc::DoInitialize (void)
   NS_UNUSED (ok); // suppress compiler warning
   InitializeParams ();
 
+#ifdef ENABLE_PROFILING
+  m_profileEnqueue = Profiler::Register (GetInstanceTypeId ().GetName () + "::Enqueue");
+  m_profileDequeue = Profiler::Register (GetInstanceTypeId ().GetName () + "::Dequeue");
+#endif
+
   // Check the configuration and initialize the parameters of the child queue discs
   for (std::vector<Ptr<QueueDiscClass> >::iterator cl = m_classes.begin ();
        cl != m_classes.end (); cl++)
@@ -447,10 +493,38 @@ QueueDisc::NotifyParentDrop (Ptr<QueueItem> item)
     }
 }
 
+bool
+QueueDisc::Mark (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  bool retval = item->Mark ();
+  if (retval)
+    {
+      item->SetMarkedHere (true);
+    }
+  return retval;
+}
+
+void
+QueueDisc::AddTelemetry (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  IntTag tag;
+  Ptr<Packet> p = item->GetPacket ();
+  p->RemovePacketTag (tag);
+  tag.AddHop (m_device ? m_device->GetNode ()->GetId () : 0,
+              m_nPackets,
+              Simulator::Now () - item->GetTimeStamp (),
+              item->IsMarkedHere ());
+  p->AddPacketTag (tag);
+  item->SetMarkedHere (false);
+}
+
 bool
 QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
+  NS_PROFILE_SCOPE_ID (m_profileEnqueue);
 
   m_nPackets++;
   m_nBytes += item->GetPacketSize ();
@@ -460,6 +534,7 @@ QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
   m_traceEnqueue (item);
 
+  item->SetTimeStamp (Simulator::Now ());
   return DoEnqueue (item);
 }
 
@@ -467,6 +542,7 @@ Ptr<QueueDiscItem>
 QueueDisc::Dequeue (void)
 {
   NS_LOG_FUNCTION (this);
+  NS_PROFILE_SCOPE_ID (m_profileDequeue);
 
   Ptr<QueueDiscItem> item;
   item = DoDequeue ();
@@ -476,6 +552,11 @@ QueueDisc::Dequeue (void)
       m_nPackets--;
       m_nBytes -= item->GetPacketSize ();
 
+      if (m_telemetry)
+        {
+          AddTelemetry (item);
+        }
+
       NS_LOG_LOGIC ("m_traceDequeue (p)");
       m_traceDequeue (item);
     }
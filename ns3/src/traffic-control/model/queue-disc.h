@@ -24,6 +24,8 @@
 #include "ns3/traced-value.h"
 #include <ns3/queue.h>
 #include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/profiler.h"
 #include <vector>
 #include "packet-filter.h"
 
@@ -98,6 +100,29 @@ public:
    */
   virtual bool Mark (void) = 0;
 
+  /**
+   * \brief Get the time the item was enqueued in the queue disc
+   * \return the enqueue timestamp
+   */
+  Time GetTimeStamp (void) const;
+
+  /**
+   * \brief Set the time the item was enqueued in the queue disc
+   * \param t the enqueue timestamp
+   */
+  void SetTimeStamp (Time t);
+
+  /**
+   * \return true if the item was marked by the queue disc it is stored in
+   */
+  bool IsMarkedHere (void) const;
+
+  /**
+   * \brief Record whether the item was marked by the queue disc it is stored in
+   * \param marked true if the item was marked
+   */
+  void SetMarkedHere (bool marked);
+
 private:
   /**
    * \brief Default constructor
@@ -122,6 +147,8 @@ private:
   Address m_address;      //!< MAC destination address
   uint16_t m_protocol;    //!< L3 Protocol number
   uint8_t m_txq;          //!< Transmission queue index
+  Time m_tstamp;          //!< Enqueue timestamp
+  bool m_markedHere;      //!< True if marked by the current queue disc
 };
 
 
@@ -458,6 +485,17 @@ protected:
    */
   void Drop (Ptr<QueueItem> item);
 
+  /**
+   *  \brief Mark a packet as a substitute for dropping it
+   *
+   *  Queue discs should call this method instead of QueueDiscItem::Mark so
+   *  that the marking can be reported by the in-band telemetry.
+   *
+   *  \param item item that has to be marked
+   *  \return true if the packet gets marked, false otherwise
+   */
+  bool Mark (Ptr<QueueDiscItem> item);
+
 private:
   /**
    *  \brief Notify the parent queue disc of a packet drop
@@ -465,6 +503,12 @@ private:
    */
   void NotifyParentDrop (Ptr<QueueItem> item);
 
+  /**
+   *  \brief Append an in-band telemetry hop record to the packet of the item
+   *  \param item the item being dequeued
+   */
+  void AddTelemetry (Ptr<QueueDiscItem> item);
+
   /**
    * This function actually enqueues a packet into the queue disc.
    * \param item item to enqueue
@@ -559,6 +603,11 @@ private:
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
   ParentDropCallback m_parentDropCallback;   //!< Parent drop callback
+  bool m_telemetry;                 //!< True to append in-band telemetry on dequeue
+#ifdef ENABLE_PROFILING
+  Profiler::Id m_profileEnqueue;    //!< Timer of Enqueue, per queue disc type
+  Profiler::Id m_profileDequeue;    //!< Timer of Dequeue, per queue disc type
+#endif
 
   /// Traced callback: fired when a packet is enqueued
   TracedCallback<Ptr<const QueueItem> > m_traceEnqueue;
@@ -56,6 +56,9 @@
  * comments have also been ported from NS-2
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "ns3/log.h"
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
@@ -208,13 +211,19 @@ TypeId RedQueueDisc::GetTypeId (void)
                    DoubleValue (2.0),
                    MakeDoubleAccessor (&RedQueueDisc::m_markP),
                    MakeDoubleChecker <double> (0, 2))
+    .AddAttribute ("VirtualBacklogRatio",
+                   "Queue length held by the traffic outside the queue disc when it saturates the link, as a fraction of MinTh",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&RedQueueDisc::m_virtualBacklogRatio),
+                   MakeDoubleChecker <double> (0))
   ;
 
   return tid;
 }
 
 RedQueueDisc::RedQueueDisc () :
-  QueueDisc ()
+  QueueDisc (),
+  m_virtualLoad (0)
 {
   NS_LOG_FUNCTION (this);
   m_uv = CreateObject<UniformRandomVariable> ();
@@ -308,6 +317,34 @@ RedQueueDisc::GetStats ()
   return m_stats;
 }
 
+void
+RedQueueDisc::SetVirtualLoad (double load)
+{
+  NS_LOG_FUNCTION (this << load);
+  m_virtualLoad = load;
+}
+
+double
+RedQueueDisc::GetVirtualBacklog (void) const
+{
+  if (m_virtualLoad <= 0)
+    {
+      return 0;
+    }
+  double limit = m_virtualBacklogRatio * m_minTh;
+  if (m_virtualLoad >= 1)
+    {
+      return limit;
+    }
+  // mean number of packets waiting in an M/D/1 queue
+  double backlog = m_virtualLoad * m_virtualLoad / (2 * (1 - m_virtualLoad));
+  if (m_mode == Queue::QUEUE_MODE_BYTES)
+    {
+      backlog *= m_meanPktSize;
+    }
+  return std::min (backlog, limit);
+}
+
 int64_t 
 RedQueueDisc::AssignStreams (int64_t stream)
 {
@@ -355,7 +392,16 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       m_idle = 0;
     }
 
-  m_qAvg = Estimator (nQueued, m + 1, m_qAvg, m_qW);
+  // the marking and early drops also see the queue of the virtual load,
+  // as an arrival finds it: exponentially distributed around its mean,
+  // so that a load near saturation alone crosses the thresholds
+  double virtualBacklog = GetVirtualBacklog ();
+  if (virtualBacklog > 0)
+    {
+      virtualBacklog *= -std::log (1 - m_uv->GetValue ());
+    }
+  uint32_t nCounted = nQueued + (uint32_t) virtualBacklog;
+  m_qAvg = Estimator (nCounted, m + 1, m_qAvg, m_qW);
 
   NS_LOG_DEBUG ("\t bytesInQueue  " << GetInternalQueue (0)->GetNBytes () << "\tQavg " << m_qAvg);
   NS_LOG_DEBUG ("\t packetsInQueue  " << GetInternalQueue (0)->GetNPackets () << "\tQavg " << m_qAvg);
@@ -364,7 +410,7 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   m_countBytes += item->GetPacketSize ();
 
   uint32_t dropType = DTYPE_NONE;
-  if (m_qAvg >= m_minTh && nQueued > 1)
+  if (m_qAvg >= m_minTh && nCounted > 1)
     {
       if (!m_useMarkP &&
           ((!m_isGentle && m_qAvg >= m_maxTh) ||
@@ -385,7 +431,7 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
           m_countBytes = item->GetPacketSize ();
           m_old = 1;
         }
-      else if (DropEarly (item, nQueued))
+      else if (DropEarly (item, nCounted))
         {
           NS_LOG_LOGIC ("DropEarly returns 1");
           dropType = DTYPE_UNFORCED;
@@ -670,7 +716,7 @@ RedQueueDisc::DropEarly (Ptr<QueueDiscItem> item, uint32_t qSize)
       /// implemented by FujiZ
       if (m_useEcn && (!m_useMarkP || m_vProb1 < m_markP))
         {
-          if (item->Mark ())
+          if (Mark (item))
             {
               NS_LOG_DEBUG ("\t Marking due to Prob Mark " << m_qAvg);
               m_stats.unforcedMark++;
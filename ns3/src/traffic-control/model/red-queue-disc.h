@@ -194,6 +194,28 @@ public:
    */
   Stats GetStats ();
 
+  /**
+   * \brief Set the load of the traffic sharing the link without going
+   * through the queue disc, such as fluid flows.
+   *
+   * The queue this traffic would build is added to the queue length in
+   * the marking and early drop decisions, but not to the limit: the mean
+   * queue of an M/D/1 queue at this load, up to VirtualBacklogRatio times
+   * MinTh, which it holds when it saturates the link.  With the default
+   * ratio of 1 a saturating load alone reaches MinTh, as the senders it
+   * stands for would, and marks or drops the packets.
+   *
+   * \param load The load, 1 or more if the traffic saturates the link.
+   */
+  void SetVirtualLoad (double load);
+
+  /**
+   * \brief Get the queue length added by the virtual load.
+   *
+   * \returns The queue length in bytes or packets, as the queue limit.
+   */
+  double GetVirtualBacklog (void) const;
+
  /**
   * Assign a fixed random variable stream number to the random variables
   * used by this model.  Return the number of streams (possibly zero) that
@@ -303,6 +325,8 @@ private:
   /// set useMarkP true and set markP to 2.0 to always mark instead of drop
   bool m_useMarkP;          //!< For deciding when to drop
   double m_markP;           //!< when p < markP, mark chosen packets; else drop
+  double m_virtualLoad;     //!< Load of the traffic outside the queue disc
+  double m_virtualBacklogRatio; //!< Virtual queue at saturation, as a fraction of MinTh
 
   // ** Variables maintained by RED
   double m_vProb1;          //!< Prob. of packet drop before "count"
@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <sstream>
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
+#include "ns3/object-factory.h"
+#include "ns3/drop-tail-queue.h"
+#include "strict-priority-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StrictPriorityQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (StrictPriorityQueueDisc);
+
+TypeId StrictPriorityQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::StrictPriorityQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<StrictPriorityQueueDisc> ()
+    .AddAttribute ("Bands",
+                   "The number of bands, if no internal queue is provided.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&StrictPriorityQueueDisc::m_bands),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Limit",
+                   "The maximum number of packets of all the bands.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&StrictPriorityQueueDisc::m_limit),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("EcnThresholds",
+                   "The ECN marking thresholds of the bands, in packets, separated by "
+                   "commas or spaces. The last one applies to the remaining bands. "
+                   "Empty to never mark.",
+                   StringValue (""),
+                   MakeStringAccessor (&StrictPriorityQueueDisc::m_ecnThresholdsString),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+StrictPriorityQueueDisc::StrictPriorityQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+StrictPriorityQueueDisc::~StrictPriorityQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+StrictPriorityQueueDisc::GetBand (Ptr<QueueDiscItem> item)
+{
+  uint32_t band = 0;
+  int32_t ret = PacketFilter::PF_NO_MATCH;
+  if (GetNPacketFilters () > 0)
+    {
+      ret = Classify (item);
+    }
+  if (ret != PacketFilter::PF_NO_MATCH)
+    {
+      band = std::max (ret, 0);
+    }
+  else
+    {
+      uint8_t tos;
+      if (item->GetUint8Value (QueueItem::IP_DSFIELD, tos))
+        {
+          band = tos >> 2;
+        }
+    }
+  return std::min (band, GetNInternalQueues () - 1);
+}
+
+uint32_t
+StrictPriorityQueueDisc::GetNMarked (uint32_t band) const
+{
+  return band < m_nMarked.size () ? m_nMarked[band] : 0;
+}
+
+bool
+StrictPriorityQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetNPackets () > m_limit)
+    {
+      NS_LOG_LOGIC ("Queue disc limit exceeded -- dropping packet");
+      Drop (item);
+      return false;
+    }
+
+  uint32_t band = GetBand (item);
+  Ptr<Queue> queue = GetInternalQueue (band);
+  if (band < m_ecnThresholds.size () && queue->GetNPackets () >= m_ecnThresholds[band]
+      && Mark (item))
+    {
+      NS_LOG_LOGIC ("Marked in band " << band);
+      m_nMarked[band]++;
+    }
+
+  // If Queue::Enqueue fails, QueueDisc::Drop is called by the internal queue
+  // because QueueDisc::AddInternalQueue sets the drop callback
+  bool retval = queue->Enqueue (item);
+
+  NS_LOG_LOGIC ("Number packets band " << band << ": " << queue->GetNPackets ());
+
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+StrictPriorityQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<QueueDiscItem> item;
+
+  for (uint32_t i = 0; i < GetNInternalQueues (); i++)
+    {
+      if ((item = StaticCast<QueueDiscItem> (GetInternalQueue (i)->Dequeue ())) != 0)
+        {
+          NS_LOG_LOGIC ("Popped from band " << i << ": " << item);
+          return item;
+        }
+    }
+
+  NS_LOG_LOGIC ("Queue empty");
+  return item;
+}
+
+Ptr<const QueueDiscItem>
+StrictPriorityQueueDisc::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<const QueueDiscItem> item;
+
+  for (uint32_t i = 0; i < GetNInternalQueues (); i++)
+    {
+      if ((item = StaticCast<const QueueDiscItem> (GetInternalQueue (i)->Peek ())) != 0)
+        {
+          NS_LOG_LOGIC ("Peeked from band " << i << ": " << item);
+          return item;
+        }
+    }
+
+  NS_LOG_LOGIC ("Queue empty");
+  return item;
+}
+
+bool
+StrictPriorityQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("StrictPriorityQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNInternalQueues () == 0)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId ("ns3::DropTailQueue");
+      factory.Set ("Mode", EnumValue (Queue::QUEUE_MODE_PACKETS));
+      factory.Set ("MaxPackets", UintegerValue (m_limit));
+      for (uint32_t i = 0; i < m_bands; i++)
+        {
+          AddInternalQueue (factory.Create<Queue> ());
+        }
+    }
+
+  for (uint32_t i = 0; i < GetNInternalQueues (); i++)
+    {
+      if (GetInternalQueue (i)->GetMode () != Queue::QUEUE_MODE_PACKETS)
+        {
+          NS_LOG_ERROR ("StrictPriorityQueueDisc needs internal queues operating in packet mode");
+          return false;
+        }
+    }
+
+  std::string thresholds = m_ecnThresholdsString;
+  std::replace (thresholds.begin (), thresholds.end (), ',', ' ');
+  std::istringstream iss (thresholds);
+  m_ecnThresholds.clear ();
+  uint32_t threshold;
+  while (iss >> threshold)
+    {
+      m_ecnThresholds.push_back (threshold);
+    }
+  if (!iss.eof ())
+    {
+      NS_LOG_ERROR ("Invalid ECN thresholds \"" << m_ecnThresholdsString << "\"");
+      return false;
+    }
+
+  return true;
+}
+
+void
+StrictPriorityQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_ecnThresholds.empty ())
+    {
+      m_ecnThresholds.resize (GetNInternalQueues (), m_ecnThresholds.back ());
+    }
+  m_nMarked.assign (GetNInternalQueues (), 0);
+}
+
+} // namespace ns3
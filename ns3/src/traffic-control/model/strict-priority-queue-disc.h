@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef STRICT_PRIORITY_QUEUE_DISC_H
+#define STRICT_PRIORITY_QUEUE_DISC_H
+
+#include <vector>
+#include "ns3/queue-disc.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * A strict priority queue disc with one FIFO per band: band 0 is always
+ * served first, band 1 only when band 0 is empty, and so on.
+ *
+ * The band of a packet is given by the packet filters when there are
+ * any, e.g. the PiasIpv4PacketFilter of the hosts, and otherwise by the
+ * DSCP of its IP header (DSCP 0 is band 0), so that switches serve the
+ * priorities set by the hosts. Bands beyond the last one map to the last
+ * one.
+ *
+ * Each band marks the ECN capable packets arriving when the band holds
+ * at least its ECN threshold, in packets, as DCTCP-style switches do. The
+ * bands share a buffer of Limit packets.
+ */
+class StrictPriorityQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  StrictPriorityQueueDisc ();
+  virtual ~StrictPriorityQueueDisc ();
+
+  /**
+   * \param item a queue disc item
+   * \return the band of the item
+   */
+  uint32_t GetBand (Ptr<QueueDiscItem> item);
+
+  /**
+   * \param band a band
+   * \return the number of packets marked in this band
+   */
+  uint32_t GetNMarked (uint32_t band) const;
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual Ptr<const QueueDiscItem> DoPeek (void) const;
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  uint32_t m_bands;                      //!< number of bands
+  uint32_t m_limit;                      //!< packets of all the bands
+  std::string m_ecnThresholdsString;     //!< ECN thresholds attribute
+  std::vector<uint32_t> m_ecnThresholds; //!< ECN threshold of each band, in packets
+  std::vector<uint32_t> m_nMarked;       //!< packets marked in each band
+};
+
+} // namespace ns3
+
+#endif /* STRICT_PRIORITY_QUEUE_DISC_H */
@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/int-tag.h"
+#include "ns3/red-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+class IntTestItem : public QueueDiscItem {
+public:
+  IntTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol);
+  virtual ~IntTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+
+private:
+  IntTestItem ();
+  IntTestItem (const IntTestItem &);
+  IntTestItem &operator = (const IntTestItem &);
+};
+
+IntTestItem::IntTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol)
+  : QueueDiscItem (p, addr, protocol)
+{
+}
+
+IntTestItem::~IntTestItem ()
+{
+}
+
+void
+IntTestItem::AddHeader (void)
+{
+}
+
+bool
+IntTestItem::Mark (void)
+{
+  return false;
+}
+
+/**
+ * Check the encoding of hop records, including saturation and overflow
+ */
+class IntTagTestCase : public TestCase
+{
+public:
+  IntTagTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+IntTagTestCase::IntTagTestCase ()
+  : TestCase ("Encoding of IntTag hop records")
+{
+}
+
+void
+IntTagTestCase::DoRun (void)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  IntTag tag;
+  tag.AddHop (3, 12, NanoSeconds (1250), false);
+  tag.AddHop (70000, 40000, MilliSeconds (10), true);
+  p->AddPacketTag (tag);
+
+  IntTag copy;
+  NS_TEST_ASSERT_MSG_EQ (p->PeekPacketTag (copy), true, "tag not found");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetNHops (), 2, "wrong number of hops");
+  IntTag::Hop hop = copy.GetHop (0);
+  NS_TEST_ASSERT_MSG_EQ (hop.nodeId, 3, "wrong node id");
+  NS_TEST_ASSERT_MSG_EQ (hop.qDepth, 12, "wrong queue depth");
+  NS_TEST_ASSERT_MSG_EQ (hop.ce, false, "unexpected CE mark");
+  NS_TEST_ASSERT_MSG_EQ (hop.sojourn, NanoSeconds (1200), "sojourn not truncated to 100ns units");
+  hop = copy.GetHop (1);
+  NS_TEST_ASSERT_MSG_EQ (hop.qDepth, 0x7fff, "queue depth does not saturate");
+  NS_TEST_ASSERT_MSG_EQ (hop.ce, true, "CE mark lost");
+  NS_TEST_ASSERT_MSG_EQ (hop.sojourn, NanoSeconds (0xffff * 100), "sojourn does not saturate");
+
+  for (uint32_t i = 0; i < IntTag::MAX_HOPS; i++)
+    {
+      copy.AddHop (i, 0, Seconds (0), false);
+    }
+  NS_TEST_ASSERT_MSG_EQ (copy.GetNHops (), IntTag::MAX_HOPS, "too many hops recorded");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetNTraversed (), IntTag::MAX_HOPS + 2, "traversed hops not counted");
+}
+
+/**
+ * Check that a queue disc with InbandTelemetry enabled appends hop records
+ */
+class IntQueueDiscTestCase : public TestCase
+{
+public:
+  IntQueueDiscTestCase ();
+private:
+  virtual void DoRun (void);
+  void Dequeue (Ptr<QueueDisc> queue, Time expectedSojourn, uint16_t expectedDepth);
+};
+
+IntQueueDiscTestCase::IntQueueDiscTestCase ()
+  : TestCase ("Queue disc appends IntTag hop records on dequeue")
+{
+}
+
+void
+IntQueueDiscTestCase::Dequeue (Ptr<QueueDisc> queue, Time expectedSojourn, uint16_t expectedDepth)
+{
+  Ptr<QueueDiscItem> item = queue->Dequeue ();
+  NS_TEST_ASSERT_MSG_NE (item, 0, "no item dequeued");
+  IntTag tag;
+  NS_TEST_ASSERT_MSG_EQ (item->GetPacket ()->PeekPacketTag (tag), true, "no telemetry added");
+  NS_TEST_ASSERT_MSG_EQ (tag.GetNHops (), 1, "wrong number of hops");
+  NS_TEST_ASSERT_MSG_EQ (tag.GetHop (0).sojourn, expectedSojourn, "wrong sojourn time");
+  NS_TEST_ASSERT_MSG_EQ (tag.GetHop (0).qDepth, expectedDepth, "wrong queue depth");
+}
+
+void
+IntQueueDiscTestCase::DoRun (void)
+{
+  Ptr<RedQueueDisc> queue = CreateObject<RedQueueDisc> ();
+  queue->SetAttribute ("InbandTelemetry", BooleanValue (true));
+  queue->SetAttribute ("MinTh", DoubleValue (50));
+  queue->SetAttribute ("MaxTh", DoubleValue (80));
+  queue->SetAttribute ("QueueLimit", UintegerValue (100));
+  queue->Initialize ();
+
+  Address dest;
+  queue->Enqueue (Create<IntTestItem> (Create<Packet> (1000), dest, 0));
+  queue->Enqueue (Create<IntTestItem> (Create<Packet> (1000), dest, 0));
+  Simulator::Schedule (MicroSeconds (5), &IntQueueDiscTestCase::Dequeue, this, queue, MicroSeconds (5), 1);
+  Simulator::Schedule (MicroSeconds (7), &IntQueueDiscTestCase::Dequeue, this, queue, MicroSeconds (7), 0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+static class IntTagTestSuite : public TestSuite
+{
+public:
+  IntTagTestSuite ()
+    : TestSuite ("int-tag", UNIT)
+  {
+    AddTestCase (new IntTagTestCase (), TestCase::QUICK);
+    AddTestCase (new IntQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_intTagTestSuite;
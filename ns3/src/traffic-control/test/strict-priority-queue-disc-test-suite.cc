@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/strict-priority-queue-disc.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/int-tag.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue disc item with a DS field, ECN capable
+ */
+class StrictPriorityTestItem : public QueueDiscItem {
+public:
+  /**
+   * \param p the packet
+   * \param dscp the DSCP of the packet
+   */
+  StrictPriorityTestItem (Ptr<Packet> p, uint8_t dscp)
+    : QueueDiscItem (p, Address (), 0),
+      m_dscp (dscp),
+      m_marked (false)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+  virtual bool Mark (void)
+  {
+    m_marked = true;
+    return true;
+  }
+  virtual bool GetUint8Value (Uint8Values field, uint8_t &value) const
+  {
+    value = m_dscp << 2;
+    return field == IP_DSFIELD;
+  }
+
+  uint8_t m_dscp; //!< DSCP of the packet
+  bool m_marked;  //!< whether the packet was marked
+};
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Strict priority service and per band ECN marking
+ */
+class StrictPriorityQueueDiscTestCase : public TestCase
+{
+public:
+  StrictPriorityQueueDiscTestCase ();
+  virtual void DoRun (void);
+};
+
+StrictPriorityQueueDiscTestCase::StrictPriorityQueueDiscTestCase ()
+  : TestCase ("Sanity check on the strict priority queue disc implementation")
+{
+}
+
+void
+StrictPriorityQueueDiscTestCase::DoRun (void)
+{
+  Ptr<StrictPriorityQueueDisc> qdisc = CreateObject<StrictPriorityQueueDisc> ();
+  qdisc->SetAttribute ("Bands", UintegerValue (4));
+  qdisc->SetAttribute ("Limit", UintegerValue (20));
+  qdisc->SetAttribute ("EcnThresholds", StringValue ("2, 5"));
+  qdisc->SetAttribute ("InbandTelemetry", BooleanValue (true));
+  qdisc->Initialize ();
+  NS_TEST_ASSERT_MSG_EQ (qdisc->GetNInternalQueues (), 4, "wrong number of bands");
+
+  // DSCP 7 goes to the last band
+  uint8_t dscps[] = { 3, 7, 1, 0, 2, 1, 0, 1, 0, 0 };
+  std::vector<Ptr<StrictPriorityTestItem> > items;
+  for (uint32_t i = 0; i < sizeof (dscps); i++)
+    {
+      items.push_back (Create<StrictPriorityTestItem> (Create<Packet> (100), dscps[i]));
+      qdisc->Enqueue (items.back ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), 10, "packets not enqueued");
+
+  // band 0 marks from its third packet, band 1 (threshold 5) never here
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNMarked (0), 2, "wrong marks in band 0");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNMarked (1), 0, "wrong marks in band 1");
+  NS_TEST_EXPECT_MSG_EQ (items[8]->m_marked, true, "third packet of band 0 not marked");
+  NS_TEST_EXPECT_MSG_EQ (items[6]->m_marked, false, "second packet of band 0 marked");
+
+  // strict priority, FIFO in each band
+  uint32_t expected[] = { 3, 6, 8, 9, 2, 5, 7, 4, 0, 1 };
+  for (uint32_t i = 0; i < sizeof (expected) / sizeof (expected[0]); i++)
+    {
+      Ptr<QueueDiscItem> item = qdisc->Dequeue ();
+      NS_TEST_ASSERT_MSG_EQ (item, items[expected[i]], "wrong dequeue order at " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (qdisc->Dequeue (), 0, "queue disc not empty");
+
+  // the telemetry reports the marks
+  IntTag tag;
+  NS_TEST_ASSERT_MSG_EQ (items[8]->GetPacket ()->PeekPacketTag (tag), true, "no telemetry");
+  NS_TEST_EXPECT_MSG_EQ (tag.GetHop (0).ce, true, "mark not reported");
+  NS_TEST_ASSERT_MSG_EQ (items[6]->GetPacket ()->PeekPacketTag (tag), true, "no telemetry");
+  NS_TEST_EXPECT_MSG_EQ (tag.GetHop (0).ce, false, "mark reported on an unmarked packet");
+
+  // the bands share the limit
+  for (uint32_t i = 0; i < 25; i++)
+    {
+      qdisc->Enqueue (Create<StrictPriorityTestItem> (Create<Packet> (100), i % 4));
+    }
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), 20, "limit not enforced");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetTotalDroppedPackets (), 5, "wrong number of drops");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief StrictPriorityQueueDisc TestSuite
+ */
+static class StrictPriorityQueueDiscTestSuite : public TestSuite
+{
+public:
+  StrictPriorityQueueDiscTestSuite ()
+    : TestSuite ("strict-priority-queue-disc", UNIT)
+  {
+    AddTestCase (new StrictPriorityQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_strictPriorityQueueDiscTestSuite;
@@ -104,9 +104,10 @@ InterferenceHelper::Event::GetPreambleType (void) const
  *       short period of time.
  ****************************************************************/
 
-InterferenceHelper::NiChange::NiChange (Time time, double delta)
+InterferenceHelper::NiChange::NiChange (Time time, double power, Ptr<Event> event)
   : m_time (time),
-    m_delta (delta)
+    m_power (power),
+    m_event (event)
 {
 }
 
@@ -117,9 +118,21 @@ InterferenceHelper::NiChange::GetTime (void) const
 }
 
 double
-InterferenceHelper::NiChange::GetDelta (void) const
+InterferenceHelper::NiChange::GetPower (void) const
 {
-  return m_delta;
+  return m_power;
+}
+
+void
+InterferenceHelper::NiChange::AddPower (double power)
+{
+  m_power += power;
+}
+
+Ptr<InterferenceHelper::Event>
+InterferenceHelper::NiChange::GetEvent (void) const
+{
+  return m_event;
 }
 
 bool
@@ -135,9 +148,9 @@ InterferenceHelper::NiChange::operator < (const InterferenceHelper::NiChange& o)
 
 InterferenceHelper::InterferenceHelper ()
   : m_errorRateModel (0),
-    m_firstPower (0.0),
     m_rxing (false)
 {
+  EraseEvents ();
 }
 
 InterferenceHelper::~InterferenceHelper ()
@@ -199,18 +212,12 @@ Time
 InterferenceHelper::GetEnergyDuration (double energyW)
 {
   Time now = Simulator::Now ();
-  double noiseInterferenceW = 0.0;
   Time end = now;
-  noiseInterferenceW = m_firstPower;
-  for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
+  NiChanges::const_iterator i = std::lower_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (now, 0.0, 0));
+  for (; i != m_niChanges.end (); i++)
     {
-      noiseInterferenceW += i->GetDelta ();
       end = i->GetTime ();
-      if (end < now)
-        {
-          continue;
-        }
-      if (noiseInterferenceW < energyW)
+      if (i->GetPower () < energyW)
         {
           break;
         }
@@ -221,23 +228,18 @@ InterferenceHelper::GetEnergyDuration (double energyW)
 void
 InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
 {
-  Time now = Simulator::Now ();
   if (!m_rxing)
     {
-      NiChanges::iterator nowIterator = GetPosition (now);
-      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
-        {
-          m_firstPower += i->GetDelta ();
-        }
-      m_niChanges.erase (m_niChanges.begin (), nowIterator);
-      m_niChanges.insert (m_niChanges.begin (), NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      Prune (Simulator::Now ());
     }
-  else
+  //only the changes within the event carry its power, so the cost is
+  //proportional to the overlap with other events, not to the history
+  std::size_t start = AddNiChangeEvent (event->GetStartTime (), event);
+  std::size_t end = AddNiChangeEvent (event->GetEndTime (), event);
+  for (std::size_t i = start; i < end; i++)
     {
-      AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      m_niChanges[i].AddPower (event->GetRxPowerW ());
     }
-  AddNiChangeEvent (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
-
 }
 
 
@@ -259,18 +261,20 @@ InterferenceHelper::CalculateSnr (double signal, double noiseInterference, uint3
 double
 InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event> event, NiChanges *ni) const
 {
-  double noiseInterference = m_firstPower;
   NS_ASSERT (m_rxing);
-  for (NiChanges::const_iterator i = m_niChanges.begin () + 1; i != m_niChanges.end (); i++)
+  NiChanges::const_iterator i = std::lower_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (event->GetStartTime (), 0.0, 0));
+  while (i != m_niChanges.end () && i->GetEvent () != event)
     {
-      if ((event->GetEndTime () == i->GetTime ()) && event->GetRxPowerW () == -i->GetDelta ())
-        {
-          break;
-        }
-      ni->push_back (*i);
+      i++;
     }
-  ni->insert (ni->begin (), NiChange (event->GetStartTime (), noiseInterference));
-  ni->push_back (NiChange (event->GetEndTime (), 0));
+  NS_ASSERT_MSG (i != m_niChanges.end (), "event not found");
+  double noiseInterference = (i == m_niChanges.begin ()) ? i->GetPower () - event->GetRxPowerW () : (i - 1)->GetPower ();
+  ni->push_back (NiChange (event->GetStartTime (), noiseInterference, event));
+  for (i++; i != m_niChanges.end () && i->GetEvent () != event; i++)
+    {
+      ni->push_back (NiChange (i->GetTime (), std::max (0.0, i->GetPower () - event->GetRxPowerW ()), i->GetEvent ()));
+    }
+  ni->push_back (NiChange (event->GetEndTime (), 0.0, event));
   return noiseInterference;
 }
 
@@ -300,7 +304,7 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const InterferenceHelper::Event
   Time plcpHsigHeaderStart = plcpHeaderStart + WifiPhy::GetPlcpHeaderDuration (event->GetTxVector (), preamble); //packet start time + preamble + L-SIG
   Time plcpHtTrainingSymbolsStart = plcpHsigHeaderStart + WifiPhy::GetPlcpHtSigHeaderDuration (preamble) + WifiPhy::GetPlcpVhtSigA1Duration (preamble) + WifiPhy::GetPlcpVhtSigA2Duration (preamble); //packet start time + preamble + L-SIG + HT-SIG or VHT-SIG-A (A1 + A2)
   Time plcpPayloadStart = plcpHtTrainingSymbolsStart + WifiPhy::GetPlcpHtTrainingSymbolDuration (preamble, event->GetTxVector ()) + WifiPhy::GetPlcpVhtSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or VHT-SIG-A (A1 + A2) + (V)HT Training + VHT-SIG-B
-  double noiseInterferenceW = (*j).GetDelta ();
+  double noiseInterferenceW = (*j).GetPower ();
   double powerW = event->GetRxPowerW ();
   j++;
   while (ni->end () != j)
@@ -330,7 +334,7 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const InterferenceHelper::Event
           NS_LOG_DEBUG ("previous is before payload and current is in the payload: mode=" << payloadMode << ", psr=" << psr);
         }
 
-      noiseInterferenceW += (*j).GetDelta ();
+      noiseInterferenceW = (*j).GetPower ();
       previous = (*j).GetTime ();
       j++;
     }
@@ -364,7 +368,7 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const InterferenceHelper::Event>
   Time plcpHsigHeaderStart = plcpHeaderStart + WifiPhy::GetPlcpHeaderDuration (event->GetTxVector (), preamble); //packet start time + preamble + L-SIG
   Time plcpHtTrainingSymbolsStart = plcpHsigHeaderStart + WifiPhy::GetPlcpHtSigHeaderDuration (preamble) + WifiPhy::GetPlcpVhtSigA1Duration (preamble) + WifiPhy::GetPlcpVhtSigA2Duration (preamble); //packet start time + preamble + L-SIG + HT-SIG or VHT-SIG-A (A1 + A2)
   Time plcpPayloadStart = plcpHtTrainingSymbolsStart + WifiPhy::GetPlcpHtTrainingSymbolDuration (preamble, event->GetTxVector ()) + WifiPhy::GetPlcpVhtSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or VHT-SIG-A (A1 + A2) + (V)HT Training + VHT-SIG-B
-  double noiseInterferenceW = (*j).GetDelta ();
+  double noiseInterferenceW = (*j).GetPower ();
   double powerW = event->GetRxPowerW ();
   j++;
   while (ni->end () != j)
@@ -784,7 +788,7 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const InterferenceHelper::Event>
             }
         }
 
-      noiseInterferenceW += (*j).GetDelta ();
+      noiseInterferenceW = (*j).GetPower ();
       previous = (*j).GetTime ();
       j++;
     }
@@ -837,20 +841,32 @@ void
 InterferenceHelper::EraseEvents (void)
 {
   m_niChanges.clear ();
+  m_niChanges.push_back (NiChange (Seconds (0), 0.0, 0));
   m_rxing = false;
-  m_firstPower = 0.0;
 }
 
 InterferenceHelper::NiChanges::iterator
 InterferenceHelper::GetPosition (Time moment)
 {
-  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0));
+  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0.0, 0));
+}
+
+std::size_t
+InterferenceHelper::AddNiChangeEvent (Time moment, Ptr<Event> event)
+{
+  NiChanges::iterator it = GetPosition (moment);
+  NS_ASSERT (it != m_niChanges.begin ());
+  double power = (it - 1)->GetPower ();
+  it = m_niChanges.insert (it, NiChange (moment, power, event));
+  return it - m_niChanges.begin ();
 }
 
 void
-InterferenceHelper::AddNiChangeEvent (NiChange change)
+InterferenceHelper::Prune (Time moment)
 {
-  m_niChanges.insert (GetPosition (change.GetTime ()), change);
+  NiChanges::iterator it = GetPosition (moment);
+  NS_ASSERT (it != m_niChanges.begin ());
+  m_niChanges.erase (m_niChanges.begin (), it - 1);
 }
 
 void
@@ -865,6 +881,7 @@ InterferenceHelper::NotifyRxEnd ()
 {
   NS_LOG_FUNCTION (this);
   m_rxing = false;
+  Prune (Simulator::Now ());
 }
 
 } //namespace ns3
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <vector>
+#include <deque>
 #include <list>
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
@@ -224,17 +225,23 @@ private:
 private:
   /**
    * Noise and Interference (thus Ni) event.
+   *
+   * Each change records the aggregate power received from the change
+   * time onwards, so the power at any instant is read from the last
+   * change before it instead of being summed from the beginning.
    */
   class NiChange
   {
 public:
     /**
-     * Create a NiChange at the given time and the amount of NI change.
+     * Create a NiChange at the given time with the aggregate power
+     * in effect from then on.
      *
      * \param time time of the event
-     * \param delta the power
+     * \param power the aggregate power (W)
+     * \param event the event which starts or ends at this time
      */
-    NiChange (Time time, double delta);
+    NiChange (Time time, double power, Ptr<Event> event);
     /**
      * Return the event time.
      *
@@ -242,11 +249,23 @@ public:
      */
     Time GetTime (void) const;
     /**
-     * Return the power
+     * Return the aggregate power
+     *
+     * \return the power (W)
+     */
+    double GetPower (void) const;
+    /**
+     * Add the given power to the aggregate power
+     *
+     * \param power the power (W)
+     */
+    void AddPower (double power);
+    /**
+     * Return the event which starts or ends at this time.
      *
-     * \return the power
+     * \return the event
      */
-    double GetDelta (void) const;
+    Ptr<Event> GetEvent (void) const;
     /**
      * Compare the event time of two NiChange objects (a < o).
      *
@@ -258,12 +277,13 @@ public:
 
 private:
     Time m_time;
-    double m_delta;
+    double m_power;
+    Ptr<Event> m_event;
   };
   /**
-   * typedef for a vector of NiChanges
+   * typedef for a time-ordered sequence of NiChanges
    */
-  typedef std::vector <NiChange> NiChanges;
+  typedef std::deque <NiChange> NiChanges;
   /**
    * typedef for a list of Events
    */
@@ -330,18 +350,31 @@ private:
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
-  /// Experimental: needed for energy duration calculation
+  /**
+   * Changes since the start of the oldest event still of interest.
+   * The first change carries the power in effect before the others.
+   */
   NiChanges m_niChanges;
-  double m_firstPower;
   bool m_rxing;
   /// Returns an iterator to the first nichange, which is later than moment
   NiChanges::iterator GetPosition (Time moment);
   /**
-   * Add NiChange to the list at the appropriate position.
+   * Add a NiChange for the given event at the appropriate position,
+   * carrying the power in effect just before it.
+   *
+   * \param moment the time of the change
+   * \param event the event which starts or ends at this time
+   *
+   * \return the index of the new change
+   */
+  std::size_t AddNiChangeEvent (Time moment, Ptr<Event> event);
+  /**
+   * Drop the changes which no longer matter at the given time, keeping
+   * the last one at or before it for the current power.
    *
-   * \param change
+   * \param moment the current time
    */
-  void AddNiChangeEvent (NiChange change);
+  void Prune (Time moment);
 };
 
 } //namespace ns3
@@ -25,10 +25,15 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
 #include "ns3/object-factory.h"
 #include "yans-wifi-channel.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
+#include "ns3/spatial-grid-index.h"
+#include <cmath>
+#include <limits>
 
 namespace ns3 {
 
@@ -51,11 +56,42 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("FanOut",
+                   "How a transmission is delivered to the PHYs of the channel: to all of them, "
+                   "to the PHYs within range above RxSensitivity found by a spatial index, "
+                   "or to all of them while checking that the PHYs outside the indexed range "
+                   "receive the signal below RxSensitivity.",
+                   EnumValue (YansWifiChannel::FANOUT_ALL),
+                   MakeEnumAccessor (&YansWifiChannel::m_fanOut),
+                   MakeEnumChecker (YansWifiChannel::FANOUT_ALL, "All",
+                                    YansWifiChannel::FANOUT_INDEXED, "Indexed",
+                                    YansWifiChannel::FANOUT_VALIDATE, "Validate"))
+    .AddAttribute ("RxSensitivity",
+                   "The power (dBm) below which the Indexed fan-out does not deliver a signal.",
+                   DoubleValue (-110.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_rxSensitivity),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "The distance (m) beyond which the Indexed fan-out does not deliver a signal; "
+                   "0 to derive it from the propagation loss model and RxSensitivity.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("GridCellSize",
+                   "The cell size (m) of the spatial index of the PHYs; "
+                   "0 to use the range of the first indexed transmission.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cellSize),
+                   MakeDoubleChecker<double> (0.0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_fanOut (FANOUT_ALL),
+    m_rxSensitivity (-110.0),
+    m_maxRange (0.0),
+    m_cellSize (0.0)
 {
 }
 
@@ -65,6 +101,17 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  if (m_index != 0)
+    {
+      m_index->Dispose ();
+      m_index = 0;
+    }
+  WifiChannel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
 {
@@ -83,46 +130,129 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  struct Parameters parameters;
+  parameters.type = mpdutype;
+  parameters.duration = duration;
+  parameters.txVector = txVector;
+  parameters.preamble = preamble;
+
+  if (m_fanOut == FANOUT_ALL)
+    {
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
+        {
+          Deliver (j, sender, senderMobility, packet, txPowerDbm, parameters, false);
+        }
+      return;
+    }
+
+  std::vector<uint32_t> candidates;
+  FindCandidates (senderMobility, txPowerDbm, &candidates);
+  if (m_fanOut == FANOUT_INDEXED)
+    {
+      for (std::vector<uint32_t>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
+        {
+          Deliver (*i, sender, senderMobility, packet, txPowerDbm, parameters, true);
+        }
+      return;
+    }
+
+  NS_ASSERT (m_fanOut == FANOUT_VALIDATE);
+  std::vector<uint32_t>::const_iterator candidate = candidates.begin ();
+  for (uint32_t j = 0; j < m_phyList.size (); j++)
     {
-      if (sender != (*i))
+      double rxPowerDbm = Deliver (j, sender, senderMobility, packet, txPowerDbm, parameters, false);
+      if (candidate != candidates.end () && *candidate == j)
         {
-          //For now don't account for inter channel interference
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
-            {
-              continue;
-            }
-
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
-            {
-              dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
-            }
-
-          struct Parameters parameters;
-          parameters.rxPowerDbm = rxPowerDbm;
-          parameters.type = mpdutype;
-          parameters.duration = duration;
-          parameters.txVector = txVector;
-          parameters.preamble = preamble;
-
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, parameters);
+          candidate++;
         }
+      else if (rxPowerDbm >= m_rxSensitivity)
+        {
+          NS_FATAL_ERROR ("PHY " << j << " outside the indexed range of " << GetMaxRange (txPowerDbm)
+                          << "m receives " << rxPowerDbm << "dBm at "
+                          << senderMobility->GetDistanceFrom (m_phyList[j]->GetMobility ()) << "m");
+        }
+    }
+}
+
+double
+YansWifiChannel::Deliver (uint32_t j, Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                          Ptr<const Packet> packet, double txPowerDbm, struct Parameters parameters,
+                          bool cutoff) const
+{
+  Ptr<YansWifiPhy> receiver = m_phyList[j];
+  if (sender == receiver)
+    {
+      return -std::numeric_limits<double>::infinity ();
+    }
+  //For now don't account for inter channel interference
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return -std::numeric_limits<double>::infinity ();
+    }
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  if (cutoff && rxPowerDbm < m_rxSensitivity)
+    {
+      return rxPowerDbm;
+    }
+  Ptr<Packet> copy = packet->Copy ();
+  Ptr<Object> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+    }
+
+  parameters.rxPowerDbm = rxPowerDbm;
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive, this,
+                                  j, copy, parameters);
+  return rxPowerDbm;
+}
+
+void
+YansWifiChannel::FindCandidates (Ptr<MobilityModel> senderMobility, double txPowerDbm,
+                                 std::vector<uint32_t> *candidates) const
+{
+  double range = GetMaxRange (txPowerDbm);
+  if (m_index == 0 && !std::isinf (range))
+    {
+      m_index = CreateObject<SpatialGridIndex> ();
+      m_index->SetCellSize (m_cellSize > 0 ? m_cellSize : std::max (range, 1.0));
+    }
+  if (m_index == 0)
+    {
+      // the range is unbounded, every PHY is a candidate
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
+        {
+          candidates->push_back (j);
+        }
+      return;
+    }
+  // the PHYs are indexed in the order of the PHY list
+  for (uint32_t j = m_index->GetN (); j < m_phyList.size (); j++)
+    {
+      m_index->Add (m_phyList[j]->GetMobility ());
+    }
+  m_index->Find (senderMobility->GetPosition (), range, candidates);
+}
+
+double
+YansWifiChannel::GetMaxRange (double txPowerDbm) const
+{
+  if (m_maxRange > 0)
+    {
+      return m_maxRange;
     }
+  return m_loss->GetMaxRange (txPowerDbm, m_rxSensitivity);
 }
 
 void
@@ -36,6 +36,8 @@ namespace ns3 {
 class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
+class SpatialGridIndex;
+class MobilityModel;
 
 struct Parameters
 {
@@ -57,12 +59,30 @@ struct Parameters
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * By default, every transmission is delivered to every PHY of the
+ * channel.  With the Indexed fan-out, the PHYs are kept in a
+ * SpatialGridIndex and a transmission is only delivered to the PHYs
+ * within the range of the loss model, and only if the signal is
+ * received above RxSensitivity.  The Validate fan-out delivers to
+ * every PHY like the default one, and stops the simulation if a PHY
+ * outside the indexed range receives a signal above RxSensitivity.
  */
 class YansWifiChannel : public WifiChannel
 {
 public:
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief how a transmission is delivered to the PHYs
+   */
+  enum FanOut
+  {
+    FANOUT_ALL,       //!< deliver to every PHY
+    FANOUT_INDEXED,   //!< deliver to the PHYs in range, above RxSensitivity
+    FANOUT_VALIDATE   //!< deliver to every PHY, check the indexed range
+  };
+
   YansWifiChannel ();
   virtual ~YansWifiChannel ();
 
@@ -114,6 +134,17 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \param txPowerDbm the tx power
+   * \return the distance beyond which a signal is received below
+   *         RxSensitivity: MaxRange if set, otherwise derived from the
+   *         propagation loss model, possibly infinite
+   */
+  double GetMaxRange (double txPowerDbm) const;
+
+
+protected:
+  virtual void DoDispose (void);
 
 private:
   /**
@@ -134,9 +165,40 @@ private:
    */
   void Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const;
 
+  /**
+   * Compute the signal received by one PHY and schedule its reception.
+   *
+   * \param j index of the receiving YansWifiPhy in the PHY list
+   * \param sender the sending YansWifiPhy
+   * \param senderMobility the mobility model of the sender
+   * \param packet the packet being sent
+   * \param txPowerDbm the tx power
+   * \param parameters the parameters of the transmission
+   * \param cutoff whether to drop a signal below RxSensitivity
+   * \return the received power in dBm, -infinity if the PHY does not
+   *         listen to the transmission
+   */
+  double Deliver (uint32_t j, Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                  Ptr<const Packet> packet, double txPowerDbm, struct Parameters parameters,
+                  bool cutoff) const;
+
+  /**
+   * \param senderMobility the mobility model of the sender
+   * \param txPowerDbm the tx power
+   * \param candidates the indices in the PHY list of the PHYs which may
+   *        be within the range of the transmission, in increasing order
+   */
+  void FindCandidates (Ptr<MobilityModel> senderMobility, double txPowerDbm,
+                       std::vector<uint32_t> *candidates) const;
+
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  enum FanOut m_fanOut;                //!< how transmissions are delivered
+  double m_rxSensitivity;              //!< signals below are not delivered by the Indexed fan-out
+  double m_maxRange;                   //!< fixed range, 0 to derive it from the loss model
+  double m_cellSize;                   //!< cell size of the index, 0 for the first range
+  mutable Ptr<SpatialGridIndex> m_index; //!< positions of the PHYs, created on first use
 };
 
 } //namespace ns3
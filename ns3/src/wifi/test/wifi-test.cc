@@ -21,6 +21,9 @@
  *          Sébastien Deronne <sebastien.deronne@gmail.com>
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "ns3/yans-wifi-helper.h"
 #include "ns3/mobility-helper.h"
 #include "ns3/wifi-net-device.h"
@@ -28,6 +31,8 @@
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/yans-error-rate-model.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/interference-helper.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/test.h"
 #include "ns3/pointer.h"
@@ -1090,6 +1095,278 @@ Bug2222TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_countInternalCollisions, 1, "unexpected number of internal collisions!");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Check the fan-out modes of YansWifiChannel: a station far beyond the
+ * range of the loss model does not see the transmissions with the
+ * Indexed fan-out, and sees them again once it has moved in range.
+ */
+class YansWifiChannelFanOutTest : public TestCase
+{
+public:
+  /**
+   * \param fanOut the FanOut attribute of the channel
+   */
+  YansWifiChannelFanOutTest (std::string fanOut);
+
+  virtual void DoRun (void);
+
+
+private:
+  Ptr<Node> CreateOne (Vector pos, Ptr<YansWifiChannel> channel);
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  void Signal (Ptr<const Packet> p);
+
+  std::string m_fanOut;
+  uint32_t m_signals;
+  ObjectFactory m_manager;
+  ObjectFactory m_mac;
+};
+
+YansWifiChannelFanOutTest::YansWifiChannelFanOutTest (std::string fanOut)
+  : TestCase ("YansWifiChannel FanOut=" + fanOut),
+    m_fanOut (fanOut)
+{
+}
+
+void
+YansWifiChannelFanOutTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelFanOutTest::Signal (Ptr<const Packet> p)
+{
+  m_signals++;
+}
+
+Ptr<Node>
+YansWifiChannelFanOutTest::CreateOne (Vector pos, Ptr<YansWifiChannel> channel)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+
+  Ptr<WifiMac> mac = m_mac.Create<WifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (mobility);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<WifiRemoteStationManager> manager = m_manager.Create<WifiRemoteStationManager> ();
+
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (manager);
+  node->AddDevice (dev);
+
+  return node;
+}
+
+void
+YansWifiChannelFanOutTest::DoRun (void)
+{
+  m_mac.SetTypeId ("ns3::AdhocWifiMac");
+  m_manager.SetTypeId ("ns3::ConstantRateWifiManager");
+  m_signals = 0;
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("FanOut", StringValue (m_fanOut));
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  // 16 dBm over the default log distance model falls to -110 dBm at 440.6 m
+  NS_TEST_ASSERT_MSG_EQ_TOL (channel->GetMaxRange (16), 440.6, 0.1, "unexpected range");
+
+  Ptr<Node> sender = CreateOne (Vector (0.0, 0.0, 0.0), channel);
+  CreateOne (Vector (10.0, 0.0, 0.0), channel);
+  Ptr<Node> far = CreateOne (Vector (5000.0, 0.0, 0.0), channel);
+  DynamicCast<WifiNetDevice> (far->GetDevice (0))->GetPhy ()->TraceConnectWithoutContext ("PhyRxBegin", MakeCallback (&YansWifiChannelFanOutTest::Signal, this));
+  DynamicCast<WifiNetDevice> (far->GetDevice (0))->GetPhy ()->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&YansWifiChannelFanOutTest::Signal, this));
+
+  Ptr<WifiNetDevice> senderDevice = DynamicCast<WifiNetDevice> (sender->GetDevice (0));
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelFanOutTest::SendOnePacket, this, senderDevice);
+  Simulator::Schedule (Seconds (2.0), &MobilityModel::SetPosition, far->GetObject<MobilityModel> (), Vector (20.0, 0.0, 0.0));
+  Simulator::Schedule (Seconds (3.0), &YansWifiChannelFanOutTest::SendOnePacket, this, senderDevice);
+  Simulator::Stop (Seconds (4.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_signals, (m_fanOut == "Indexed" ? 1 : 2), "wrong number of signals at the far station");
+
+  Simulator::Destroy ();
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Check the noise and interference tracked by InterferenceHelper against a
+ * brute-force sum over every signal, while many overlapping foreign signals
+ * arrive between and during receptions.
+ */
+class InterferenceHelperTrackingTest : public TestCase
+{
+public:
+  InterferenceHelperTrackingTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /// A signal seen by the helper
+  struct Signal
+  {
+    Time start;   ///< start time
+    Time end;     ///< end time
+    double power; ///< power (W)
+  };
+
+  /**
+   * \param moment the time
+   * \return the brute-force power after every change at or before moment
+   */
+  double GetPowerAt (Time moment) const;
+  /// Add a foreign signal to the helper and to the reference
+  void AddSignal (void);
+  /// Start a reception and check the SNR at its start
+  void StartRx (void);
+  /**
+   * Check the SNR and PER at the end of a reception
+   * \param event the event being received
+   * \param noise the expected interference at its start (W)
+   */
+  void EndRx (Ptr<InterferenceHelper::Event> event, double noise);
+  /// Check GetEnergyDuration against the reference
+  void CheckEnergy (void);
+
+  InterferenceHelper *m_interference;
+  std::vector<Signal> m_signals;
+  Ptr<UniformRandomVariable> m_random;
+  WifiTxVector m_txVector;
+  double m_noiseFloorW;
+};
+
+InterferenceHelperTrackingTest::InterferenceHelperTrackingTest ()
+  : TestCase ("InterferenceHelper tracks the interference of overlapping signals")
+{
+}
+
+double
+InterferenceHelperTrackingTest::GetPowerAt (Time moment) const
+{
+  double power = 0;
+  for (std::vector<Signal>::const_iterator i = m_signals.begin (); i != m_signals.end (); i++)
+    {
+      if (i->start <= moment && i->end > moment)
+        {
+          power += i->power;
+        }
+    }
+  return power;
+}
+
+void
+InterferenceHelperTrackingTest::AddSignal (void)
+{
+  Signal signal;
+  signal.start = Simulator::Now ();
+  signal.end = signal.start + NanoSeconds (m_random->GetInteger (20000, 300000));
+  signal.power = 1e-12 * std::pow (10.0, m_random->GetValue (0, 3));
+  m_signals.push_back (signal);
+  m_interference->AddForeignSignal (signal.end - signal.start, signal.power);
+}
+
+void
+InterferenceHelperTrackingTest::StartRx (void)
+{
+  double noise = GetPowerAt (Simulator::Now ());
+  Signal signal;
+  signal.start = Simulator::Now ();
+  signal.end = signal.start + MicroSeconds (400);
+  signal.power = 1e-8;
+  m_signals.push_back (signal);
+  Ptr<InterferenceHelper::Event> event = m_interference->Add (1000, m_txVector, WIFI_PREAMBLE_LONG, signal.end - signal.start, signal.power);
+  m_interference->NotifyRxStart ();
+  Simulator::Schedule (signal.end - signal.start, &InterferenceHelperTrackingTest::EndRx, this, event, noise);
+}
+
+void
+InterferenceHelperTrackingTest::EndRx (Ptr<InterferenceHelper::Event> event, double noise)
+{
+  double expected = event->GetRxPowerW () / (m_noiseFloorW + noise);
+  struct InterferenceHelper::SnrPer header = m_interference->CalculatePlcpHeaderSnrPer (event);
+  struct InterferenceHelper::SnrPer payload = m_interference->CalculatePlcpPayloadSnrPer (event);
+  m_interference->NotifyRxEnd ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (header.snr, expected, expected * 1e-9, "wrong SNR at " << Simulator::Now ());
+  NS_TEST_ASSERT_MSG_EQ_TOL (payload.snr, expected, expected * 1e-9, "wrong SNR at " << Simulator::Now ());
+  NS_TEST_ASSERT_MSG_EQ ((payload.per >= 0 && payload.per <= 1), true, "PER out of range");
+  NS_TEST_ASSERT_MSG_EQ ((header.per >= 0 && header.per <= 1), true, "PER out of range");
+}
+
+void
+InterferenceHelperTrackingTest::CheckEnergy (void)
+{
+  double energyW = 1e-10;
+  Time now = Simulator::Now ();
+  std::vector<Time> changes;
+  for (std::vector<Signal>::const_iterator i = m_signals.begin (); i != m_signals.end (); i++)
+    {
+      if (i->start >= now)
+        {
+          changes.push_back (i->start);
+        }
+      if (i->end >= now)
+        {
+          changes.push_back (i->end);
+        }
+    }
+  std::sort (changes.begin (), changes.end ());
+  Time end = now;
+  for (std::vector<Time>::const_iterator i = changes.begin (); i != changes.end (); i++)
+    {
+      end = *i;
+      if (GetPowerAt (*i) < energyW)
+        {
+          break;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_interference->GetEnergyDuration (energyW), end - now, "wrong energy duration at " << now);
+}
+
+void
+InterferenceHelperTrackingTest::DoRun (void)
+{
+  m_interference = new InterferenceHelper ();
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  m_interference->SetNoiseFigure (5.0);
+  m_interference->SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+  m_txVector.SetMode (WifiPhy::GetOfdmRate6Mbps ());
+  m_txVector.SetChannelWidth (20);
+  m_noiseFloorW = 5.0 * 1.3803e-23 * 290.0 * 20 * 1000000;
+
+  // about five foreign signals in the air at any time
+  Time t = MicroSeconds (1);
+  while (t < MilliSeconds (100))
+    {
+      Simulator::Schedule (t, &InterferenceHelperTrackingTest::AddSignal, this);
+      t += NanoSeconds (m_random->GetInteger (1, 60000));
+    }
+  for (t = MicroSeconds (500); t < MilliSeconds (100); t += MicroSeconds (1000))
+    {
+      Simulator::Schedule (t, &InterferenceHelperTrackingTest::StartRx, this);
+      Simulator::Schedule (t + MicroSeconds (700) + NanoSeconds (1), &InterferenceHelperTrackingTest::CheckEnergy, this);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  delete m_interference;
+}
+
 //-----------------------------------------------------------------------------
 
 class WifiTestSuite : public TestSuite
@@ -1108,6 +1385,10 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug730TestCase, TestCase::QUICK); //Bug 730
   AddTestCase (new SetChannelFrequencyTest, TestCase::QUICK);
   AddTestCase (new Bug2222TestCase, TestCase::QUICK); //Bug 2222
+  AddTestCase (new YansWifiChannelFanOutTest ("All"), TestCase::QUICK);
+  AddTestCase (new YansWifiChannelFanOutTest ("Indexed"), TestCase::QUICK);
+  AddTestCase (new YansWifiChannelFanOutTest ("Validate"), TestCase::QUICK);
+  AddTestCase (new InterferenceHelperTrackingTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite;
@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Cost of configuring a new object, as done for every flow by the
+// data center scratch programs: seven attributes set by name, through
+// pre-resolved AttributeHandles, or through an ObjectFactory.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/object.h"
+#include "ns3/object-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/nstime.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * An object with the attributes of a per-flow application
+ */
+class BenchObject : public Object
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchObject")
+      .SetParent<Object> ()
+      .HideFromDocumentation ()
+      .AddConstructor<BenchObject> ()
+      .AddAttribute ("FlowSize", "help text",
+                     UintegerValue (0),
+                     MakeUintegerAccessor (&BenchObject::m_flowSize),
+                     MakeUintegerChecker<uint64_t> ())
+      .AddAttribute ("FlowId", "help text",
+                     UintegerValue (0),
+                     MakeUintegerAccessor (&BenchObject::m_flowId),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("QueueIndex", "help text",
+                     UintegerValue (0),
+                     MakeUintegerAccessor (&BenchObject::m_queueIndex),
+                     MakeUintegerChecker<uint8_t> ())
+      .AddAttribute ("Deadline", "help text",
+                     TimeValue (Seconds (0)),
+                     MakeTimeAccessor (&BenchObject::m_deadline),
+                     MakeTimeChecker ())
+      .AddAttribute ("Rate", "help text",
+                     DoubleValue (0),
+                     MakeDoubleAccessor (&BenchObject::m_rate),
+                     MakeDoubleChecker<double> ())
+      .AddAttribute ("Enabled", "help text",
+                     BooleanValue (false),
+                     MakeBooleanAccessor (&BenchObject::m_enabled),
+                     MakeBooleanChecker ())
+      .AddAttribute ("Peer", "help text",
+                     PointerValue (),
+                     MakePointerAccessor (&BenchObject::m_peer),
+                     MakePointerChecker<Object> ())
+    ;
+    return tid;
+  }
+
+private:
+  uint64_t m_flowSize;
+  uint32_t m_flowId;
+  uint8_t m_queueIndex;
+  Time m_deadline;
+  double m_rate;
+  bool m_enabled;
+  Ptr<Object> m_peer;
+};
+
+static Ptr<Object> g_peer;
+
+static void
+benchByName (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<BenchObject> o = CreateObject<BenchObject> ();
+      o->SetAttribute ("FlowSize", UintegerValue (i * 1000));
+      o->SetAttribute ("FlowId", UintegerValue (i));
+      o->SetAttribute ("QueueIndex", UintegerValue (i % 8));
+      o->SetAttribute ("Deadline", TimeValue (MicroSeconds (i)));
+      o->SetAttribute ("Rate", DoubleValue (i));
+      o->SetAttribute ("Enabled", BooleanValue (true));
+      o->SetAttribute ("Peer", PointerValue (g_peer));
+    }
+}
+
+static void
+benchHandle (uint32_t n)
+{
+  TypeId tid = BenchObject::GetTypeId ();
+  AttributeHandle<UintegerValue> flowSize = tid.LookupAttributeHandle<UintegerValue> ("FlowSize");
+  AttributeHandle<UintegerValue> flowId = tid.LookupAttributeHandle<UintegerValue> ("FlowId");
+  AttributeHandle<UintegerValue> queueIndex = tid.LookupAttributeHandle<UintegerValue> ("QueueIndex");
+  AttributeHandle<TimeValue> deadline = tid.LookupAttributeHandle<TimeValue> ("Deadline");
+  AttributeHandle<DoubleValue> rate = tid.LookupAttributeHandle<DoubleValue> ("Rate");
+  AttributeHandle<BooleanValue> enabled = tid.LookupAttributeHandle<BooleanValue> ("Enabled");
+  AttributeHandle<PointerValue> peer = tid.LookupAttributeHandle<PointerValue> ("Peer");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<BenchObject> o = CreateObject<BenchObject> ();
+      flowSize.Set (o, UintegerValue (i * 1000));
+      flowId.Set (o, UintegerValue (i));
+      queueIndex.Set (o, UintegerValue (i % 8));
+      deadline.Set (o, TimeValue (MicroSeconds (i)));
+      rate.Set (o, DoubleValue (i));
+      enabled.Set (o, BooleanValue (true));
+      peer.Set (o, PointerValue (g_peer));
+    }
+}
+
+static void
+benchFactoryByName (uint32_t n)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (BenchObject::GetTypeId ());
+  for (uint32_t i = 0; i < n; i++)
+    {
+      factory.Set ("FlowSize", UintegerValue (i * 1000));
+      factory.Set ("FlowId", UintegerValue (i));
+      factory.Set ("QueueIndex", UintegerValue (i % 8));
+      factory.Set ("Deadline", TimeValue (MicroSeconds (i)));
+      factory.Set ("Rate", DoubleValue (i));
+      factory.Set ("Enabled", BooleanValue (true));
+      factory.Set ("Peer", PointerValue (g_peer));
+      factory.Create ();
+    }
+}
+
+static void
+benchFactoryHandle (uint32_t n)
+{
+  TypeId tid = BenchObject::GetTypeId ();
+  AttributeHandle<UintegerValue> flowSize = tid.LookupAttributeHandle<UintegerValue> ("FlowSize");
+  AttributeHandle<UintegerValue> flowId = tid.LookupAttributeHandle<UintegerValue> ("FlowId");
+  AttributeHandle<UintegerValue> queueIndex = tid.LookupAttributeHandle<UintegerValue> ("QueueIndex");
+  AttributeHandle<TimeValue> deadline = tid.LookupAttributeHandle<TimeValue> ("Deadline");
+  AttributeHandle<DoubleValue> rate = tid.LookupAttributeHandle<DoubleValue> ("Rate");
+  AttributeHandle<BooleanValue> enabled = tid.LookupAttributeHandle<BooleanValue> ("Enabled");
+  AttributeHandle<PointerValue> peer = tid.LookupAttributeHandle<PointerValue> ("Peer");
+  ObjectFactory factory;
+  factory.SetTypeId (tid);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      factory.Set (flowSize, UintegerValue (i * 1000));
+      factory.Set (flowId, UintegerValue (i));
+      factory.Set (queueIndex, UintegerValue (i % 8));
+      factory.Set (deadline, TimeValue (MicroSeconds (i)));
+      factory.Set (rate, DoubleValue (i));
+      factory.Set (enabled, BooleanValue (true));
+      factory.Set (peer, PointerValue (g_peer));
+      factory.Create ();
+    }
+}
+
+static void
+benchCreateOnly (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      CreateObject<BenchObject> ();
+    }
+}
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) (n);
+      minDelay = std::min (minDelay, (uint64_t)time.End ());
+    }
+  minDelay = std::max (minDelay, (uint64_t)1);
+  std::cout << n * 1000.0 / minDelay << " objects/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 100000;
+  uint32_t minIterations = 1;
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the per-object configuration cost of attributes");
+  cmd.AddValue ("n", "number of objects", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  g_peer = CreateObject<Object> ();
+  std::cout << "Running bench-attributes with n=" << n << std::endl;
+  runBench (&benchCreateOnly, n, minIterations, "CreateObject only");
+  runBench (&benchByName, n, minIterations, "CreateObject + 7 SetAttribute by name");
+  runBench (&benchHandle, n, minIterations, "CreateObject + 7 AttributeHandle::Set");
+  runBench (&benchFactoryByName, n, minIterations, "ObjectFactory::Set by name + Create");
+  runBench (&benchFactoryHandle, n, minIterations, "ObjectFactory::Set by handle + Create");
+  g_peer = 0;
+  return 0;
+}